@@ -52,6 +52,7 @@
 
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include "nordic_common.h"
 #include "nrf.h"
@@ -65,6 +66,8 @@
 #include "nrf_ble_gatt.h"
 #include "nrf_ble_qwr.h"
 #include "app_timer.h"
+#include "app_scheduler.h"
+#include "fds.h"
 #include "ble_nus.h"
 #include "app_uart.h"
 #include "app_util_platform.h"
@@ -84,6 +87,8 @@
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 #include "nrf_log_default_backends.h"
+#include "saadc_convert.h"
+#include "saadc_stats.h"
 
 #define APP_BLE_CONN_CFG_TAG            1                                           /**< A tag identifying the SoftDevice BLE configuration. */
 
@@ -109,10 +114,123 @@
 #define UART_TX_BUF_SIZE                256                                         /**< UART TX buffer size. */
 #define UART_RX_BUF_SIZE                256                                         /**< UART RX buffer size. */
 
-#define SAADC_SAMPLES_IN_BUFFER         4
+#define SAADC_VDD_MV                    3000                                        /**< Supply voltage, used to convert channels with NRF_SAADC_REFERENCE_VDD4 to mV. */
+
+/**@brief SAADC channel table, one row per channel: X(channel index, positive input, gain, reference).
+ *
+ * @details The channel configurations, count and mask are generated from this table at build time. The conversion
+ *          to mV is derived from the channel configurations in saadc_init, see saadc_convert.h.
+ */
+#define SAADC_CHANNEL_TABLE(X)                                                      \
+    X(0, NRF_SAADC_INPUT_AIN4, NRF_SAADC_GAIN1_4, NRF_SAADC_REFERENCE_VDD4)         \
+    X(1, NRF_SAADC_INPUT_AIN5, NRF_SAADC_GAIN1_4, NRF_SAADC_REFERENCE_VDD4)         \
+    X(2, NRF_SAADC_INPUT_AIN6, NRF_SAADC_GAIN1_4, NRF_SAADC_REFERENCE_VDD4)         \
+    X(3, NRF_SAADC_INPUT_AIN7, NRF_SAADC_GAIN1_4, NRF_SAADC_REFERENCE_VDD4)
+
+#define SAADC_CHANNEL_COUNT_X(index, input, gain, reference)       + 1
+#define SAADC_CHANNEL_MASK_X(index, input, gain, reference)        | (1UL << (index))
+#define SAADC_CHANNEL_INPUT_BIT_X(index, input, gain, reference)   | (1UL << (input))
+#define SAADC_CHANNEL_INPUT_SUM_X(index, input, gain, reference)   + (1UL << (input))
+
+#define SAADC_SAMPLES_IN_BUFFER         (0 SAADC_CHANNEL_TABLE(SAADC_CHANNEL_COUNT_X))  /**< One scan of all channels in the table. */
 #define SAADC_SAMPLE_RATE               250                                         /**< SAADC sample rate in ms. */               
+#define SAADC_RESOLUTION                NRF_SAADC_RESOLUTION_12BIT                  /**< SAADC resolution, also selects the sample size of NUS_FRAME_FORMAT_PACKED. */
+#define SAADC_RESOLUTION_BITS           (8 + 2 * SAADC_RESOLUTION)                  /**< Bits per sample, from the NRF_SAADC_RESOLUTION_8BIT to _14BIT enumeration. */
+#define SAADC_CHANNEL_MASK              (0 SAADC_CHANNEL_TABLE(SAADC_CHANNEL_MASK_X)) /**< Channels enabled in saadc_init, one bit per channel. */
+#define SAADC_DEFERRED_PROCESSING       1                                           /**< Set to 1 to process SAADC buffers in main context through app_scheduler, or 0 to process them in the SAADC interrupt. */
+#define SAADC_STATS_ENABLED             1                                           /**< Set to 1 to log min/max/mean/RMS/variance of each channel every SAADC_STATS_WINDOW buffers, instead of printing every sample. */
+#define SAADC_STATS_WINDOW              4                                           /**< Number of SAADC buffers summarized in each statistics log entry. */
+#define SAADC_ISR_STATS_INTERVAL        64                                          /**< Log the worst-case SAADC interrupt duration every n buffers. */
+#define SAADC_USER_CAL_ENABLED          1                                           /**< Set to 1 to correct every SAADC buffer with the two-point gain/offset calibration of each channel, stored in flash. See cal_command_parse for the commands. */
+#define CAL_CAPTURE_SCANS               16                                          /**< Number of scans averaged for each calibration point. */
+#define CAL_GAIN_MIN_Q15                16384                                       /**< Smallest accepted gain correction, 0.5. */
+#define CAL_GAIN_MAX_Q15                65535                                       /**< Largest accepted gain correction, just below 2.0. */
+#define CAL_OFFSET_MAX                  (1L << (SAADC_RESOLUTION_BITS - 2))         /**< Largest accepted offset correction in either direction, a quarter of the single-ended code range. */
+#define CAL_FILE_ID                     0x5AAD                                      /**< FDS file of the calibration record. */
+#define CAL_RECORD_KEY                  0x0001                                      /**< FDS key of the calibration record. */
+#define CAL_REPLY_LEN                   96                                          /**< Calibration reply buffer, fits the longest reply with every number at its widest. */
+#define CAL_BENCHMARK_ENABLED           0                                           /**< Set to 1 to log the cycles/sample of cal_apply at startup, and the CPU load it would add at 8 kHz. */
+#define CAL_BENCHMARK_SAMPLES           1024                                        /**< Number of samples corrected in the benchmark. */
+#define SAADC_COV_FILTER_ENABLED        0                                           /**< Set to 1 to only send and print channels whose value has changed by more than the deadband since their last report. Requires NUS_BINARY_STREAM_ENABLED 0. */
+#define SAADC_COV_DEADBAND              8                                           /**< Absolute deadband in raw SAADC codes. */
+#define SAADC_COV_DEADBAND_PERMILLE     0                                           /**< Relative deadband in 1/1000 of the last reported value. The larger of the two deadbands is used. */
+#define SAADC_COV_KEEPALIVE_MS          10000                                       /**< Report each channel at least this often, even when its value has not changed. */
+#define SAADC_COV_MIN_INTERVAL_MS       0                                           /**< Minimum time between two reports of the same channel. 0 reports every change. */
+#define SAADC_COV_STATS_INTERVAL        240                                         /**< Log the reports and estimated airtime against the unfiltered stream every n buffers. */
+#define SAADC_COV_KEEPALIVE_SCANS       (SAADC_COV_KEEPALIVE_MS / SAADC_SAMPLE_RATE)    /**< Keep-alive in SAADC buffers. */
+#define SAADC_COV_MIN_INTERVAL_SCANS    (SAADC_COV_MIN_INTERVAL_MS / SAADC_SAMPLE_RATE) /**< Minimum report interval in SAADC buffers. */
+
+#if SAADC_USER_CAL_ENABLED
+#define SCHED_MAX_EVENT_DATA_SIZE       MAX(sizeof(saadc_sched_evt_t), sizeof(cal_cmd_t))   /**< Maximum size of scheduler events, one copy of a SAADC buffer or a calibration command. */
+#else
+#define SCHED_MAX_EVENT_DATA_SIZE       sizeof(saadc_sched_evt_t)                   /**< Maximum size of scheduler events, one copy of a SAADC buffer. */
+#endif
+#define SCHED_QUEUE_SIZE                16                                          /**< Maximum number of SAADC buffers waiting to be processed in main context. */
+
+#define NUS_BINARY_STREAM_ENABLED       1                                           /**< Set to 1 to stream samples in binary frames of m_ble_nus_max_data_len bytes, or 0 to send one text string per SAADC buffer. */
+#define NUS_FRAME_HEADER_LEN            4                                           /**< Sequence number (2 bytes), channel mask (1 byte) and sample format (1 byte). */
+#define NUS_FRAME_FORMAT_RAW16          0                                           /**< Samples are sent as 16-bit little endian values. */
+#define NUS_FRAME_FORMAT_DELTA_RICE     1                                           /**< Samples are sent as adaptive Rice codes of the difference to the previous scan. */
+#define NUS_FRAME_FORMAT_PACKED         2                                           /**< Samples are packed to SAADC_RESOLUTION_BITS bits each, e.g. two 12-bit samples in 3 bytes. */
+#define NUS_FRAME_FORMAT                NUS_FRAME_FORMAT_RAW16                      /**< Format of the binary frames, one of NUS_FRAME_FORMAT_RAW16, _DELTA_RICE or _PACKED. */
+#define NUS_PACKED_HEADER_LEN           1                                           /**< Bits per sample (1 byte), following the frame header in NUS_FRAME_FORMAT_PACKED. */
+#define NUS_PACKED_SCAN_BITS            (SAADC_SAMPLES_IN_BUFFER * SAADC_RESOLUTION_BITS) /**< Bits needed for one packed scan of all channels. */
+#define NUS_PACK_BENCHMARK_ENABLED      0                                           /**< Set to 1 to log the cycles/sample of packing and unpacking NUS_FRAME_FORMAT_PACKED frames at startup, and check the round trip. */
+#define NUS_PACK_BENCHMARK_SCANS        256                                         /**< Number of scans packed in the benchmark. */
+#define NUS_PACK_BENCHMARK_FRAMES       CEIL_DIV(NUS_PACK_BENCHMARK_SCANS, (BLE_NUS_MAX_DATA_LEN - NUS_FRAME_HEADER_LEN - NUS_PACKED_HEADER_LEN) * 8 / NUS_PACKED_SCAN_BITS) /**< Frames needed for the benchmark scans. */
+#define NUS_RICE_ESCAPE                 16                                          /**< Quotients from this value are escaped, and the 16-bit value is sent instead. */
+#define NUS_RICE_A_INIT                 8                                           /**< Initial running sum of coded values, selects k = 3 for the first difference in a frame. */
+#define NUS_RICE_RESET                  32                                          /**< The running sum and count are halved when the count reaches this value. */
+#define NUS_RICE_SCAN_BITS_MAX          (SAADC_SAMPLES_IN_BUFFER * (NUS_RICE_ESCAPE + 16)) /**< Worst case size of one coded scan. */
+#define NUS_TEXT_CHANNEL_LEN            12                                          /**< Longest text of one channel in a text notification, "\r\nCH7: -2048". */
+#define NUS_TEXT_LEN                    (SAADC_SAMPLES_IN_BUFFER * NUS_TEXT_CHANNEL_LEN + 1) /**< Text notification buffer, including the terminating zero of sprintf. */
+#define NUS_SCAN_LEN                    (SAADC_SAMPLES_IN_BUFFER * sizeof(nrf_saadc_value_t)) /**< Bytes needed for one scan of all channels. */
+
+#define NUS_TX_QUEUE_SIZE               8                                           /**< Number of frames that can wait for a free SoftDevice TX buffer. */
+#define NUS_TX_QUEUE_DROP_OLDEST        1                                           /**< Policy when the TX queue is full. 1: discard the oldest queued frame. 0: reject the new frame, so the producer must hold it and retry. */
+#define NUS_BENCHMARK_ENABLED           0                                           /**< Set to 1 to measure the latency from SAADC DONE to notification TX complete, and the delivered samples/s. */
+#define NUS_BENCHMARK_REPORT_FRAMES     256                                         /**< Log the benchmark every n completed notifications with samples. */
+#define NUS_BENCHMARK_HIST_BINS         16                                          /**< Number of latency histogram bins. */
+#define NUS_BENCHMARK_HIST_BIN_MS       20                                          /**< Width of each latency histogram bin. */
+#define NUS_BENCHMARK_INFLIGHT_SIZE     16                                          /**< Notifications that can be tracked between ble_nus_data_send and TX complete. */
+#define NUS_TX_STATS_INTERVAL           256                                         /**< Log TX queue counters every n sent frames. */
+#define NUS_AIRTIME_OVERHEAD_BYTES      17                                          /**< Bytes sent on air per notification besides the NUS data: preamble, access address, header, CRC, L2CAP and ATT headers. */
+#define NUS_AIRTIME_US_PER_BYTE         8                                           /**< Airtime of one byte on the 1M PHY. */
+
+#if NUS_PACK_BENCHMARK_ENABLED && (!NUS_BINARY_STREAM_ENABLED || (NUS_FRAME_FORMAT != NUS_FRAME_FORMAT_PACKED))
+#error "NUS_PACK_BENCHMARK_ENABLED requires NUS_BINARY_STREAM_ENABLED 1 and NUS_FRAME_FORMAT_PACKED."
+#endif
+
+#if SAADC_COV_FILTER_ENABLED && NUS_BINARY_STREAM_ENABLED
+#error "SAADC_COV_FILTER_ENABLED requires NUS_BINARY_STREAM_ENABLED 0, the binary frames carry consecutive scans without timestamps."
+#endif
 
 
+STATIC_ASSERT(SAADC_SAMPLES_IN_BUFFER <= NRF_SAADC_CHANNEL_COUNT, "The SAADC has 8 channels");
+STATIC_ASSERT(SAADC_CHANNEL_MASK == (1UL << SAADC_SAMPLES_IN_BUFFER) - 1, "Duplicate or missing channel index in SAADC_CHANNEL_TABLE");
+STATIC_ASSERT((0 SAADC_CHANNEL_TABLE(SAADC_CHANNEL_INPUT_BIT_X)) == (0 SAADC_CHANNEL_TABLE(SAADC_CHANNEL_INPUT_SUM_X)),
+              "Duplicate analog input in SAADC_CHANNEL_TABLE");
+
+/**@brief Same as NRF_DRV_SAADC_DEFAULT_CHANNEL_CONFIG_SE, with the gain and reference from the table. */
+#define SAADC_CHANNEL_CONFIG_X(index, input, gain_value, reference_value)  \
+    {                                                                       \
+        .resistor_p = NRF_SAADC_RESISTOR_DISABLED,                          \
+        .resistor_n = NRF_SAADC_RESISTOR_DISABLED,                          \
+        .gain       = gain_value,                                           \
+        .reference  = reference_value,                                      \
+        .acq_time   = NRF_SAADC_ACQTIME_10US,                               \
+        .mode       = NRF_SAADC_MODE_SINGLE_ENDED,                          \
+        .burst      = NRF_SAADC_BURST_DISABLED,                             \
+        .pin_p      = input,                                                \
+        .pin_n      = NRF_SAADC_INPUT_DISABLED,                             \
+    },
+
+static const nrf_saadc_channel_config_t m_channel_configs[SAADC_SAMPLES_IN_BUFFER] =   /**< Channel configurations, channel n in entry n. */
+{
+    SAADC_CHANNEL_TABLE(SAADC_CHANNEL_CONFIG_X)
+};
+static saadc_convert_t m_convert[SAADC_SAMPLES_IN_BUFFER];                          /**< Conversion of each channel to mV, from m_channel_configs. */
+
 BLE_NUS_DEF(m_nus, NRF_SDH_BLE_TOTAL_LINK_COUNT);                                   /**< BLE NUS service instance. */
 NRF_BLE_GATT_DEF(m_gatt);                                                           /**< GATT module instance. */
 NRF_BLE_QWR_DEF(m_qwr);                                                             /**< Context for the Queued Write module.*/
@@ -131,6 +249,69 @@ static const nrf_drv_timer_t   m_timer = NRF_DRV_TIMER_INSTANCE(3);
 static nrf_saadc_value_t       m_buffer_pool[2][SAADC_SAMPLES_IN_BUFFER];
 static nrf_ppi_channel_t       m_ppi_channel;
 static uint32_t                m_adc_evt_counter;
+static uint32_t                m_saadc_isr_cycles_max;                              /**< Longest time spent in saadc_callback, in CPU cycles. */
+static uint32_t                m_saadc_sched_overflows;                             /**< SAADC buffers lost because the scheduler queue was full. */
+
+/**@brief SAADC buffer copy passed to main context through app_scheduler. */
+typedef struct
+{
+#if NUS_BENCHMARK_ENABLED
+    uint32_t          ticks;                                                        /**< RTC1 counter value of the DONE event. */
+#endif
+    nrf_saadc_value_t samples[SAADC_SAMPLES_IN_BUFFER];
+} saadc_sched_evt_t;
+
+/**@brief Frame waiting in the NUS TX queue. */
+typedef struct
+{
+    uint8_t  data[BLE_NUS_MAX_DATA_LEN];
+    uint16_t length;
+#if NUS_BENCHMARK_ENABLED
+    uint32_t ticks;                                                                 /**< RTC1 counter value when the oldest sample in the frame was taken. */
+    uint16_t samples;                                                               /**< Number of SAADC samples in the frame, 0 for UART data. */
+#endif
+} nus_tx_frame_t;
+
+/**@brief NUS TX queue counters. */
+typedef struct
+{
+    uint32_t queued;                                                                /**< Frames accepted into the queue. */
+    uint32_t sent;                                                                  /**< Frames accepted by the SoftDevice. */
+    uint32_t dropped;                                                               /**< Frames discarded because the queue was full or the peer was not ready. A held back binary frame counts once per rejected put. */
+} nus_tx_stats_t;
+
+static nus_tx_frame_t          m_nus_tx_queue[NUS_TX_QUEUE_SIZE];
+static uint32_t                m_nus_tx_head;                                       /**< Index of the oldest queued frame. */
+static uint32_t                m_nus_tx_count;                                      /**< Number of queued frames. */
+static nus_tx_stats_t          m_nus_tx_stats;
+
+#if NUS_BINARY_STREAM_ENABLED
+/**@brief Binary NUS frame being filled with samples from consecutive SAADC buffers. */
+typedef struct
+{
+    uint8_t  data[BLE_NUS_MAX_DATA_LEN];
+    uint16_t length;                                                                /**< Number of bytes written to data, including the header. */
+    uint16_t capacity;                                                              /**< Frame length in bytes, fixed when the frame is started. */
+#if NUS_BENCHMARK_ENABLED
+    uint32_t ticks;                                                                 /**< RTC1 counter value of the DONE event of the first scan. */
+    uint16_t samples;                                                               /**< Number of SAADC samples in the frame. */
+#endif
+#if (NUS_FRAME_FORMAT != NUS_FRAME_FORMAT_RAW16)
+    uint32_t bit_buf;                                                               /**< Bits not yet written to data. */
+    uint8_t  bit_count;                                                             /**< Number of bits in bit_buf, 0 to 7 between calls. */
+#endif
+#if (NUS_FRAME_FORMAT == NUS_FRAME_FORMAT_DELTA_RICE)
+    uint16_t scans;                                                                 /**< Number of scans in the frame. */
+    nrf_saadc_value_t prev[SAADC_SAMPLES_IN_BUFFER];                                /**< Previous sample of each channel. */
+    uint32_t rice_a[SAADC_SAMPLES_IN_BUFFER];                                       /**< Running sum of coded values of each channel. */
+    uint32_t rice_n[SAADC_SAMPLES_IN_BUFFER];                                       /**< Number of values in rice_a. */
+#endif
+} nus_frame_t;
+
+static nus_frame_t             m_nus_frame;
+static uint16_t                m_nus_frame_seq;
+static uint32_t                m_nus_frame_discarded_scans;                         /**< Scans discarded while a full frame was held back by the TX queue. */
+#endif
 
 
 /**@brief Function for assert macro callback.
@@ -200,550 +381,1943 @@ static void nrf_qwr_error_handler(uint32_t nrf_error)
 }
 
 
-/**@brief Function for handling the data from the Nordic UART Service.
- *
- * @details This function will process the data received from the Nordic UART BLE Service and send
- *          it to the UART module.
- *
- * @param[in] p_evt       Nordic UART Service event.
- */
-/**@snippet [Handling the data received over BLE] */
-static void nus_data_handler(ble_nus_evt_t * p_evt)
+#if NUS_BENCHMARK_ENABLED
+/**@brief Notification handed to the SoftDevice, waiting for BLE_GATTS_EVT_HVN_TX_COMPLETE. */
+typedef struct
+{
+    uint32_t ticks;                                                                 /**< RTC1 counter value when the oldest sample in the notification was taken. */
+    uint16_t samples;                                                               /**< Number of SAADC samples in the notification, 0 for UART data. */
+} nus_benchmark_inflight_t;
+
+/**@brief End-to-end benchmark state. */
+typedef struct
 {
+    nus_benchmark_inflight_t inflight[NUS_BENCHMARK_INFLIGHT_SIZE];
+    uint32_t inflight_head;                                                         /**< Index of the oldest notification in flight. */
+    uint32_t inflight_count;                                                        /**< Number of notifications in flight. */
+    uint32_t inflight_overflows;                                                    /**< Notifications sent while inflight was full. Their latency is not measured. */
+    uint32_t buffer_ticks;                                                          /**< RTC1 counter value of the DONE event of the buffer being processed. */
+    uint32_t start_ticks;                                                           /**< RTC1 counter value at the start of the report interval. */
+    uint32_t frames;                                                                /**< Notifications with samples completed since the last report. */
+    uint32_t samples;                                                               /**< Samples delivered since the last report. */
+    uint32_t latency_max_us;                                                        /**< Longest latency since the last report. */
+    uint32_t histogram[NUS_BENCHMARK_HIST_BINS];                                    /**< Latency histogram, NUS_BENCHMARK_HIST_BIN_MS per bin. The last bin counts everything above. */
+} nus_benchmark_t;
+
+static nus_benchmark_t m_nus_benchmark;
+
+
+/**@brief Function for converting RTC1 ticks to microseconds. */
+static uint32_t nus_benchmark_ticks_to_us(uint32_t ticks)
+{
+    return (uint32_t)(((uint64_t)ticks * 1000000 * (APP_TIMER_CONFIG_RTC_FREQUENCY + 1)) / APP_TIMER_CLOCK_FREQ);
+}
 
-    if (p_evt->type == BLE_NUS_EVT_RX_DATA)
+
+/**@brief Function for recording a notification accepted by the SoftDevice. Called with interrupts disabled.
+ */
+static void nus_benchmark_sent(uint32_t ticks, uint16_t samples)
+{
+    if (m_nus_benchmark.inflight_count == NUS_BENCHMARK_INFLIGHT_SIZE)
     {
-        uint32_t err_code;
+        m_nus_benchmark.inflight_overflows++;
+        return;
+    }
 
-        NRF_LOG_DEBUG("Received data from BLE NUS. Writing data on UART.");
-        NRF_LOG_HEXDUMP_DEBUG(p_evt->params.rx_data.p_data, p_evt->params.rx_data.length);
+    nus_benchmark_inflight_t * p_entry = &m_nus_benchmark.inflight[(m_nus_benchmark.inflight_head +
+                                                                     m_nus_benchmark.inflight_count) % NUS_BENCHMARK_INFLIGHT_SIZE];
+    p_entry->ticks   = ticks;
+    p_entry->samples = samples;
+    m_nus_benchmark.inflight_count++;
+}
 
-        for (uint32_t i = 0; i < p_evt->params.rx_data.length; i++)
+
+/**@brief Function for clearing the histogram and counters, and starting a new report interval. */
+static void nus_benchmark_interval_start(uint32_t now)
+{
+    memset(m_nus_benchmark.histogram, 0, sizeof(m_nus_benchmark.histogram));
+    m_nus_benchmark.frames         = 0;
+    m_nus_benchmark.samples        = 0;
+    m_nus_benchmark.latency_max_us = 0;
+    m_nus_benchmark.start_ticks    = now;
+}
+
+
+/**@brief Function for logging and restarting the benchmark. */
+static void nus_benchmark_report(uint32_t now)
+{
+    uint32_t elapsed_us = nus_benchmark_ticks_to_us(app_timer_cnt_diff_compute(now, m_nus_benchmark.start_ticks));
+
+    NRF_LOG_INFO("NUS benchmark: %d samples/s in %d notifications, latency max %d ms, untracked %d",
+                 (uint32_t)(((uint64_t)m_nus_benchmark.samples * 1000000) / MAX(elapsed_us, 1)),
+                 m_nus_benchmark.frames,
+                 m_nus_benchmark.latency_max_us / 1000,
+                 m_nus_benchmark.inflight_overflows);
+
+    for (uint32_t i = 0; i < NUS_BENCHMARK_HIST_BINS; i++)
+    {
+        if (m_nus_benchmark.histogram[i] != 0)
         {
-            do
-            {
-                err_code = app_uart_put(p_evt->params.rx_data.p_data[i]);
-                if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_BUSY))
-                {
-                    NRF_LOG_ERROR("Failed receiving NUS message. Error 0x%x. ", err_code);
-                    APP_ERROR_CHECK(err_code);
-                }
-            } while (err_code == NRF_ERROR_BUSY);
+            NRF_LOG_INFO("  %4d ms%s: %d",
+                         i * NUS_BENCHMARK_HIST_BIN_MS,
+                         (i == NUS_BENCHMARK_HIST_BINS - 1) ? " +" : "",
+                         m_nus_benchmark.histogram[i]);
         }
-        if (p_evt->params.rx_data.p_data[p_evt->params.rx_data.length - 1] == '\r')
+    }
+
+    nus_benchmark_interval_start(now);
+}
+
+
+/**@brief Function for handling BLE_GATTS_EVT_HVN_TX_COMPLETE. Notifications complete in the order they were sent.
+ *
+ * @param[in] count  Number of notifications transmitted.
+ */
+static void nus_benchmark_tx_complete(uint8_t count)
+{
+    uint32_t now    = app_timer_cnt_get();
+    bool     report = false;
+
+    CRITICAL_REGION_ENTER();
+    while ((count-- > 0) && (m_nus_benchmark.inflight_count > 0))
+    {
+        nus_benchmark_inflight_t const * p_entry = &m_nus_benchmark.inflight[m_nus_benchmark.inflight_head];
+
+        if (p_entry->samples > 0)
         {
-            while (app_uart_put('\n') == NRF_ERROR_BUSY);
+            uint32_t latency_us = nus_benchmark_ticks_to_us(app_timer_cnt_diff_compute(now, p_entry->ticks));
+
+            m_nus_benchmark.histogram[MIN(latency_us / (NUS_BENCHMARK_HIST_BIN_MS * 1000), NUS_BENCHMARK_HIST_BINS - 1)]++;
+            m_nus_benchmark.latency_max_us = MAX(m_nus_benchmark.latency_max_us, latency_us);
+            m_nus_benchmark.samples       += p_entry->samples;
+            report = (++m_nus_benchmark.frames == NUS_BENCHMARK_REPORT_FRAMES);
         }
+
+        m_nus_benchmark.inflight_head = (m_nus_benchmark.inflight_head + 1) % NUS_BENCHMARK_INFLIGHT_SIZE;
+        m_nus_benchmark.inflight_count--;
     }
+    CRITICAL_REGION_EXIT();
 
+    if (report)
+    {
+        nus_benchmark_report(now);
+    }
 }
-/**@snippet [Handling the data received over BLE] */
 
 
-/**@brief Function for initializing services that will be used by the application.
+/**@brief Function for restarting the measurement on connect and disconnect. Notifications in flight are discarded.
  */
-static void services_init(void)
+static void nus_benchmark_restart(void)
 {
-    uint32_t           err_code;
-    ble_nus_init_t     nus_init;
-    nrf_ble_qwr_init_t qwr_init = {0};
+    CRITICAL_REGION_ENTER();
+    m_nus_benchmark.inflight_count = 0;
+    CRITICAL_REGION_EXIT();
 
-    // Initialize Queued Write Module.
-    qwr_init.error_handler = nrf_qwr_error_handler;
+    nus_benchmark_interval_start(app_timer_cnt_get());
+}
+#endif
 
-    err_code = nrf_ble_qwr_init(&m_qwr, &qwr_init);
-    APP_ERROR_CHECK(err_code);
 
-    // Initialize NUS.
-    memset(&nus_init, 0, sizeof(nus_init));
+/**@brief Function for sending queued frames until the SoftDevice runs out of TX buffers.
+ *
+ * @details Called when a frame has been queued and on BLE_NUS_EVT_TX_RDY. Frames that cannot be
+ *          sent because there is no connection, or notifications are disabled, are dropped.
+ *          Never waits for TX buffers to become available.
+ */
+static void nus_tx_queue_drain(void)
+{
+    bool log_stats = false;
 
-    nus_init.data_handler = nus_data_handler;
+    CRITICAL_REGION_ENTER();
+    while (m_nus_tx_count > 0)
+    {
+        nus_tx_frame_t * p_frame  = &m_nus_tx_queue[m_nus_tx_head];
+        uint16_t         length   = p_frame->length;
+        ret_code_t       err_code = ble_nus_data_send(&m_nus, p_frame->data, &length, m_conn_handle);
 
-    err_code = ble_nus_init(&m_nus, &nus_init);
-    APP_ERROR_CHECK(err_code);
+        if (err_code == NRF_ERROR_RESOURCES)
+        {
+            break;                                                                  // Continue on BLE_NUS_EVT_TX_RDY
+        }
+        if (err_code == NRF_SUCCESS)
+        {
+#if NUS_BENCHMARK_ENABLED
+            nus_benchmark_sent(p_frame->ticks, p_frame->samples);
+#endif
+            m_nus_tx_stats.sent++;
+            log_stats = (m_nus_tx_stats.sent % NUS_TX_STATS_INTERVAL) == 0;
+        }
+        else if ((err_code == NRF_ERROR_INVALID_STATE) || (err_code == NRF_ERROR_NOT_FOUND))
+        {
+            m_nus_tx_stats.dropped++;
+        }
+        else
+        {
+            APP_ERROR_CHECK(err_code);
+        }
+
+        m_nus_tx_head = (m_nus_tx_head + 1) % NUS_TX_QUEUE_SIZE;
+        m_nus_tx_count--;
+    }
+    CRITICAL_REGION_EXIT();
+
+    if (log_stats)
+    {
+        NRF_LOG_INFO("NUS TX: queued %d, sent %d, dropped %d",
+                     m_nus_tx_stats.queued, m_nus_tx_stats.sent, m_nus_tx_stats.dropped);
+    }
 }
 
 
-/**@brief Function for handling an event from the Connection Parameters Module.
+/**@brief Function for putting a frame in the NUS TX queue and starting transmission.
  *
- * @details This function will be called for all events in the Connection Parameters Module
- *          which are passed to the application.
+ * @param[in] p_data   Data to send. Copied into the queue.
+ * @param[in] length   Number of bytes, at most m_ble_nus_max_data_len.
+ * @param[in] ticks    RTC1 counter value when the oldest sample in the frame was taken. Only used with NUS_BENCHMARK_ENABLED.
+ * @param[in] samples  Number of SAADC samples in the frame, 0 for other data. Only used with NUS_BENCHMARK_ENABLED.
  *
- * @note All this function does is to disconnect. This could have been done by simply setting
- *       the disconnect_on_fail config parameter, but instead we use the event handler
- *       mechanism to demonstrate its use.
+ * @details Discarded frames are counted in m_nus_tx_stats.dropped here, in the same critical region as the queue update,
+ *          so callers must not count them again.
  *
- * @param[in] p_evt  Event received from the Connection Parameters Module.
+ * @retval NRF_SUCCESS       Frame queued. With NUS_TX_QUEUE_DROP_OLDEST, the oldest frame may have been discarded.
+ * @retval NRF_ERROR_NO_MEM  Queue full and NUS_TX_QUEUE_DROP_OLDEST is 0. The frame was not queued.
  */
-static void on_conn_params_evt(ble_conn_params_evt_t * p_evt)
+static ret_code_t nus_tx_queue_put(uint8_t const * p_data, uint16_t length, uint32_t ticks, uint16_t samples)
 {
-    uint32_t err_code;
+    ret_code_t err_code = NRF_SUCCESS;
 
-    if (p_evt->evt_type == BLE_CONN_PARAMS_EVT_FAILED)
+#if !NUS_BENCHMARK_ENABLED
+    UNUSED_PARAMETER(ticks);
+    UNUSED_PARAMETER(samples);
+#endif
+
+    CRITICAL_REGION_ENTER();
+    if (m_nus_tx_count == NUS_TX_QUEUE_SIZE)
     {
-        err_code = sd_ble_gap_disconnect(m_conn_handle, BLE_HCI_CONN_INTERVAL_UNACCEPTABLE);
-        APP_ERROR_CHECK(err_code);
+#if NUS_TX_QUEUE_DROP_OLDEST
+        m_nus_tx_head = (m_nus_tx_head + 1) % NUS_TX_QUEUE_SIZE;
+        m_nus_tx_count--;
+#else
+        err_code = NRF_ERROR_NO_MEM;
+#endif
+        m_nus_tx_stats.dropped++;
+    }
+
+    if (err_code == NRF_SUCCESS)
+    {
+        nus_tx_frame_t * p_frame = &m_nus_tx_queue[(m_nus_tx_head + m_nus_tx_count) % NUS_TX_QUEUE_SIZE];
+        memcpy(p_frame->data, p_data, length);
+        p_frame->length = length;
+#if NUS_BENCHMARK_ENABLED
+        p_frame->ticks   = ticks;
+        p_frame->samples = samples;
+#endif
+        m_nus_tx_count++;
+        m_nus_tx_stats.queued++;
     }
+    CRITICAL_REGION_EXIT();
+
+    nus_tx_queue_drain();
+    return err_code;
 }
 
 
-/**@brief Function for handling errors from the Connection Parameters module.
- *
- * @param[in] nrf_error  Error code containing information about what went wrong.
+/**@brief Function for discarding all queued frames, e.g. on disconnect.
  */
-static void conn_params_error_handler(uint32_t nrf_error)
+static void nus_tx_queue_flush(void)
 {
-    APP_ERROR_HANDLER(nrf_error);
+    CRITICAL_REGION_ENTER();
+    m_nus_tx_stats.dropped += m_nus_tx_count;
+    m_nus_tx_count = 0;
+    CRITICAL_REGION_EXIT();
 }
 
+#if SAADC_USER_CAL_ENABLED
+/**@brief Calibration commands. */
+typedef enum
+{
+    CAL_CMD_LOW,                                                                    /**< Capture the low point of a channel. */
+    CAL_CMD_HIGH,                                                                   /**< Capture the high point of a channel. */
+    CAL_CMD_SAVE,                                                                   /**< Write the calibration to flash. */
+    CAL_CMD_CLEAR,                                                                  /**< Remove the calibration, in RAM and flash. */
+    CAL_CMD_SHOW,                                                                   /**< Print the calibration. */
+} cal_cmd_op_t;
+
+/**@brief Calibration command, parsed in interrupt context and executed in main context through app_scheduler. */
+typedef struct
+{
+    uint8_t op;                                                                     /**< One of cal_cmd_op_t. */
+    uint8_t channel;                                                                /**< Channel of CAL_CMD_LOW and CAL_CMD_HIGH. */
+    int32_t mv;                                                                     /**< Input voltage applied to the channel for CAL_CMD_LOW and CAL_CMD_HIGH. */
+} cal_cmd_t;
 
-/**@brief Function for initializing the Connection Parameters module.
+/**@brief Gain and offset correction of each channel. Stored in flash as one FDS record.
+ *
+ * @details A raw sample x of channel ch is corrected to ((x - offset[ch]) * gain_q15[ch]) >> 15, rounded.
  */
-static void conn_params_init(void)
+typedef struct
 {
-    uint32_t               err_code;
-    ble_conn_params_init_t cp_init;
-
-    memset(&cp_init, 0, sizeof(cp_init));
-
-    cp_init.p_conn_params                  = NULL;
-    cp_init.first_conn_params_update_delay = FIRST_CONN_PARAMS_UPDATE_DELAY;
-    cp_init.next_conn_params_update_delay  = NEXT_CONN_PARAMS_UPDATE_DELAY;
-    cp_init.max_conn_params_update_count   = MAX_CONN_PARAMS_UPDATE_COUNT;
-    cp_init.start_on_notify_cccd_handle    = BLE_GATT_HANDLE_INVALID;
-    cp_init.disconnect_on_fail             = false;
-    cp_init.evt_handler                    = on_conn_params_evt;
-    cp_init.error_handler                  = conn_params_error_handler;
+    uint32_t channel_mask;                                                          /**< SAADC_CHANNEL_MASK of the channel table the record was captured with. */
+    int32_t  gain_q15[SAADC_SAMPLES_IN_BUFFER];                                     /**< Gain correction, 32768 is 1.0. */
+    int32_t  offset[SAADC_SAMPLES_IN_BUFFER];                                       /**< Offset correction in SAADC codes, subtracted before the gain. */
+} cal_record_t;
 
-    err_code = ble_conn_params_init(&cp_init);
-    APP_ERROR_CHECK(err_code);
+/**@brief Calibration point being captured. */
+typedef struct
+{
+    volatile bool active;                                                           /**< Set when the capture is started, cleared when CAL_CAPTURE_SCANS scans are summed. */
+    uint8_t       channel;
+    uint8_t       point;                                                            /**< 0 for the low point, 1 for the high point. */
+    uint16_t      scans;                                                            /**< Number of scans in sum. */
+    int32_t       sum;                                                              /**< Sum of the raw samples of the channel. */
+} cal_capture_t;
+
+static cal_record_t  m_cal;                                                         /**< Correction applied to every SAADC buffer. */
+static cal_record_t  m_cal_flash;                                                   /**< Record being written to flash, must stay valid until the FDS write completes. */
+static cal_capture_t m_cal_capture;
+static int32_t       m_cal_point_sum[SAADC_SAMPLES_IN_BUFFER][2];                   /**< Raw sum of CAL_CAPTURE_SCANS scans at the low and high point of each channel. */
+static int32_t       m_cal_point_mv[SAADC_SAMPLES_IN_BUFFER][2];                    /**< Input voltage of the low and high point of each channel. */
+static uint8_t       m_cal_point_valid[SAADC_SAMPLES_IN_BUFFER];                    /**< Captured points of each channel, bit 0 low and bit 1 high. */
+
+
+/**@brief Function for setting an identity correction on all channels.
+ */
+static void cal_record_reset(cal_record_t * p_cal)
+{
+    p_cal->channel_mask = SAADC_CHANNEL_MASK;
+    for (uint32_t ch = 0; ch < SAADC_SAMPLES_IN_BUFFER; ch++)
+    {
+        p_cal->gain_q15[ch] = 1L << 15;
+        p_cal->offset[ch]   = 0;
+    }
 }
 
 
-/**@brief Function for putting the chip into sleep mode.
+/**@brief Function for replacing the correction applied to the SAADC buffers.
  *
- * @note This function will not return.
+ * @details The SAADC buffers may be processed in the SAADC interrupt, see SAADC_DEFERRED_PROCESSING.
  */
-static void sleep_mode_enter(void)
+static void cal_record_set(cal_record_t const * p_cal)
 {
-    uint32_t err_code = bsp_indication_set(BSP_INDICATE_IDLE);
-    APP_ERROR_CHECK(err_code);
+    CRITICAL_REGION_ENTER();
+    m_cal = *p_cal;
+    CRITICAL_REGION_EXIT();
+}
 
-    // Prepare wakeup buttons.
-    err_code = bsp_btn_ble_sleep_mode_prepare();
-    APP_ERROR_CHECK(err_code);
 
-    // Go to system-off mode (this function will not return; wakeup will cause a reset).
-    err_code = sd_power_system_off();
-    APP_ERROR_CHECK(err_code);
+/**@brief Function for checking that the correction of every channel is within CAL_GAIN_MIN_Q15 to
+ *        CAL_GAIN_MAX_Q15 and +/-CAL_OFFSET_MAX.
+ *
+ * @details Within these limits (p_in - offset) * gain of a 14-bit sample fits in 32 bits.
+ */
+static bool cal_record_valid(cal_record_t const * p_cal)
+{
+    for (uint32_t ch = 0; ch < SAADC_SAMPLES_IN_BUFFER; ch++)
+    {
+        if ((p_cal->gain_q15[ch] < CAL_GAIN_MIN_Q15) || (p_cal->gain_q15[ch] > CAL_GAIN_MAX_Q15) ||
+            (p_cal->offset[ch] < -CAL_OFFSET_MAX) || (p_cal->offset[ch] > CAL_OFFSET_MAX))
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 
-/**@brief Function for handling advertising events.
+/**@brief Function for correcting interleaved samples with the gain and offset of each channel.
  *
- * @details This function will be called for advertising events which are passed to the application.
+ * @details The constants of a channel are loaded once, so the inner loop is a load, subtract,
+ *          multiply-accumulate, shift, two compares and a store per sample. A gain above 1.0 or an offset
+ *          can move a sample out of the result range of the channel, so the result is clamped to -2^m to
+ *          2^m - 1, the results from minus to plus the full scale voltage. m is SAADC_RESOLUTION_BITS
+ *          single-ended and one less differential, so small negative single-ended results are kept.
  *
- * @param[in] ble_adv_evt  Advertising event.
+ * @param[in]  p_cal     Correction of each channel.
+ * @param[in]  p_in      Raw samples, sample i belongs to channel i % SAADC_SAMPLES_IN_BUFFER.
+ * @param[out] p_out     Corrected samples, may be the same as p_in.
+ * @param[in]  size      Number of samples, a multiple of SAADC_SAMPLES_IN_BUFFER.
  */
-static void on_adv_evt(ble_adv_evt_t ble_adv_evt)
+static void cal_apply(cal_record_t const * p_cal, nrf_saadc_value_t const * p_in, nrf_saadc_value_t * p_out, uint32_t size)
 {
-    uint32_t err_code;
+    for (uint32_t ch = 0; ch < SAADC_SAMPLES_IN_BUFFER; ch++)
+    {
+        bool    differential = (m_channel_configs[ch].mode == NRF_SAADC_MODE_DIFFERENTIAL);
+        int32_t gain         = p_cal->gain_q15[ch];
+        int32_t offset       = p_cal->offset[ch];
+        int32_t code_max     = (1L << (SAADC_RESOLUTION_BITS - (differential ? 1 : 0))) - 1;
+        int32_t code_min     = -code_max - 1;
 
-    switch (ble_adv_evt)
+        for (uint32_t i = ch; i < size; i += SAADC_SAMPLES_IN_BUFFER)
+        {
+            int32_t value = ((p_in[i] - offset) * gain + (1L << 14)) >> 15;
+            p_out[i] = (nrf_saadc_value_t)MIN(MAX(value, code_min), code_max);
+        }
+    }
+}
+
+
+/**@brief Function for sending a calibration reply on UART, and on NUS when connected.
+ */
+static void cal_reply(char const * p_text)
+{
+    printf("%s\r\n", p_text);
+    if (m_conn_handle != BLE_CONN_HANDLE_INVALID)
     {
-        case BLE_ADV_EVT_FAST:
-            err_code = bsp_indication_set(BSP_INDICATE_ADVERTISING);
-            APP_ERROR_CHECK(err_code);
-            break;
-        case BLE_ADV_EVT_IDLE:
-            sleep_mode_enter();
-            break;
-        default:
-            break;
+        UNUSED_RETURN_VALUE(nus_tx_queue_put((uint8_t const *)p_text, strlen(p_text), 0, 0));
     }
 }
 
 
-/**@brief Function for handling BLE events.
+/**@brief Function for computing the correction of a channel from its low and high point.
  *
- * @param[in]   p_ble_evt   Bluetooth stack event.
- * @param[in]   p_context   Unused.
+ * @details The ideal result of each point is computed from the applied voltage with the conversion
+ *          constants of the channel, see saadc_convert.h. The gain maps the raw difference between the
+ *          points to the ideal difference, and the offset makes the low point exact.
  */
-static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
+static void cal_compute(uint8_t ch)
 {
-    uint32_t err_code;
+    char           text[CAL_REPLY_LEN];
+    int64_t        n        = CAL_CAPTURE_SCANS;
+    int64_t        sum_low  = m_cal_point_sum[ch][0];
+    int64_t        sum_high = m_cal_point_sum[ch][1];
+    // Ideal results, 2^m codes at the full scale voltage
+    int64_t        ideal_low  = ((int64_t)m_cal_point_mv[ch][0] * 1000 << m_convert[ch].result_bits) / m_convert[ch].full_scale_uv;
+    int64_t        ideal_high = ((int64_t)m_cal_point_mv[ch][1] * 1000 << m_convert[ch].result_bits) / m_convert[ch].full_scale_uv;
+    int64_t        gain;
+    int64_t        offset;
+    cal_record_t   cal;
+
+    if ((m_cal_point_mv[ch][1] <= m_cal_point_mv[ch][0]) || (sum_high <= sum_low))
+    {
+        snprintf(text, sizeof(text), "CAL CH%u: high point must be above the low point", ch);
+        cal_reply(text);
+        return;
+    }
 
-    switch (p_ble_evt->header.evt_id)
+    gain = ((ideal_high - ideal_low) * n * (1L << 15)) / (sum_high - sum_low);
+    if ((gain < CAL_GAIN_MIN_Q15) || (gain > CAL_GAIN_MAX_Q15))
     {
-        case BLE_GAP_EVT_CONNECTED:
-            NRF_LOG_INFO("Connected");
-            err_code = bsp_indication_set(BSP_INDICATE_CONNECTED);
-            APP_ERROR_CHECK(err_code);
-            m_conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
-            err_code = nrf_ble_qwr_conn_handle_assign(&m_qwr, m_conn_handle);
-            APP_ERROR_CHECK(err_code);
-            break;
+        snprintf(text, sizeof(text), "CAL CH%u: gain %ld/32768 out of range, check the inputs", ch, (long)gain);
+        cal_reply(text);
+        return;
+    }
 
-        case BLE_GAP_EVT_DISCONNECTED:
-            NRF_LOG_INFO("Disconnected");
-            // LED indication will be changed when advertising starts.
-            m_conn_handle = BLE_CONN_HANDLE_INVALID;
-            break;
+    offset = (sum_low * gain - ideal_low * n * (1L << 15)) / (n * gain);
+    if ((offset < -CAL_OFFSET_MAX) || (offset > CAL_OFFSET_MAX))
+    {
+        snprintf(text, sizeof(text), "CAL CH%u: offset %ld out of range, check the inputs", ch, (long)offset);
+        cal_reply(text);
+        return;
+    }
 
-        case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
-        {
-            NRF_LOG_DEBUG("PHY update request.");
-            ble_gap_phys_t const phys =
-            {
-                .rx_phys = BLE_GAP_PHY_AUTO,
-                .tx_phys = BLE_GAP_PHY_AUTO,
-            };
-            err_code = sd_ble_gap_phy_update(p_ble_evt->evt.gap_evt.conn_handle, &phys);
-            APP_ERROR_CHECK(err_code);
-        } break;
+    cal                   = m_cal;
+    cal.gain_q15[ch]      = (int32_t)gain;
+    cal.offset[ch]        = (int32_t)offset;
+    cal_record_set(&cal);
 
-        case BLE_GAP_EVT_SEC_PARAMS_REQUEST:
-            // Pairing not supported
-            err_code = sd_ble_gap_sec_params_reply(m_conn_handle, BLE_GAP_SEC_STATUS_PAIRING_NOT_SUPP, NULL, NULL);
-            APP_ERROR_CHECK(err_code);
-            break;
+    snprintf(text, sizeof(text), "CAL CH%u: gain %ld/32768, offset %ld, send \"cal save\" to store",
+             ch, (long)cal.gain_q15[ch], (long)cal.offset[ch]);
+    cal_reply(text);
+}
 
-        case BLE_GATTS_EVT_SYS_ATTR_MISSING:
-            // No system attributes have been stored.
-            err_code = sd_ble_gatts_sys_attr_set(m_conn_handle, NULL, 0, 0);
-            APP_ERROR_CHECK(err_code);
+
+/**@brief Function for adding one scan of raw samples to the calibration point being captured.
+ *
+ * @details Called for every SAADC buffer before the correction is applied.
+ */
+static void cal_capture_scan(nrf_saadc_value_t const * p_scan)
+{
+    if (!m_cal_capture.active)
+    {
+        return;
+    }
+
+    m_cal_capture.sum += p_scan[m_cal_capture.channel];
+    if (++m_cal_capture.scans < CAL_CAPTURE_SCANS)
+    {
+        return;
+    }
+
+    uint8_t ch    = m_cal_capture.channel;
+    uint8_t point = m_cal_capture.point;
+    char    text[CAL_REPLY_LEN];
+
+    m_cal_point_sum[ch][point] = m_cal_capture.sum;
+    m_cal_point_valid[ch]     |= 1 << point;
+    m_cal_capture.active       = false;
+
+    snprintf(text, sizeof(text), "CAL CH%u: %s point %ld mV, raw %ld",
+             ch, point ? "high" : "low", (long)m_cal_point_mv[ch][point], (long)(m_cal_capture.sum / CAL_CAPTURE_SCANS));
+    cal_reply(text);
+
+    if (m_cal_point_valid[ch] == 0x03)
+    {
+        cal_compute(ch);
+    }
+}
+
+
+/**@brief Function for writing the current calibration to flash.
+ */
+static void cal_flash_save(void)
+{
+    ret_code_t        err_code;
+    fds_record_desc_t desc  = {0};
+    fds_find_token_t  token = {0};
+    fds_record_t      record =
+    {
+        .file_id           = CAL_FILE_ID,
+        .key               = CAL_RECORD_KEY,
+        .data.p_data       = &m_cal_flash,
+        .data.length_words = BYTES_TO_WORDS(sizeof(m_cal_flash)),
+    };
+
+    m_cal_flash = m_cal;
+    if (fds_record_find(CAL_FILE_ID, CAL_RECORD_KEY, &desc, &token) == NRF_SUCCESS)
+    {
+        err_code = fds_record_update(&desc, &record);
+    }
+    else
+    {
+        err_code = fds_record_write(NULL, &record);
+    }
+
+    if (err_code == FDS_ERR_NO_SPACE_IN_FLASH)
+    {
+        // Old versions of the record are only removed by garbage collection. It is not queued while the FDS
+        // queue is full, which is not an error
+        if (fds_gc() == NRF_SUCCESS)
+        {
+            cal_reply("CAL: flash full, garbage collection started, save again");
+        }
+        else
+        {
+            cal_reply("CAL: flash busy, save again");
+        }
+    }
+    else if (err_code != NRF_SUCCESS)
+    {
+        cal_reply("CAL: flash busy, save again");
+    }
+}
+
+
+/**@brief Function for loading the calibration from flash. An identity correction is used when no
+ *        record is found, the record was captured with another channel table, or a correction in it is
+ *        out of range.
+ */
+static void cal_flash_load(void)
+{
+    fds_record_desc_t  desc  = {0};
+    fds_find_token_t   token = {0};
+    fds_flash_record_t flash_record;
+    cal_record_t       cal;
+
+    cal_record_reset(&cal);
+    if ((fds_record_find(CAL_FILE_ID, CAL_RECORD_KEY, &desc, &token) == NRF_SUCCESS) &&
+        (fds_record_open(&desc, &flash_record) == NRF_SUCCESS))
+    {
+        if ((flash_record.p_header->length_words == BYTES_TO_WORDS(sizeof(cal))) &&
+            (((cal_record_t const *)flash_record.p_data)->channel_mask == SAADC_CHANNEL_MASK))
+        {
+            memcpy(&cal, flash_record.p_data, sizeof(cal));
+            if (cal_record_valid(&cal))
+            {
+                NRF_LOG_INFO("Calibration loaded from flash.");
+            }
+            else
+            {
+                NRF_LOG_WARNING("Calibration in flash out of range, not used.");
+                cal_record_reset(&cal);
+            }
+        }
+        APP_ERROR_CHECK(fds_record_close(&desc));
+    }
+    cal_record_set(&cal);
+}
+
+
+/**@brief Function for handling FDS events.
+ */
+static void cal_fds_evt_handler(fds_evt_t const * p_evt)
+{
+    switch (p_evt->id)
+    {
+        case FDS_EVT_INIT:
+            APP_ERROR_CHECK(p_evt->result);
+            cal_flash_load();
             break;
 
-        case BLE_GATTC_EVT_TIMEOUT:
-            // Disconnect on GATT Client timeout event.
-            err_code = sd_ble_gap_disconnect(p_ble_evt->evt.gattc_evt.conn_handle,
-                                             BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
-            APP_ERROR_CHECK(err_code);
+        case FDS_EVT_WRITE:
+        case FDS_EVT_UPDATE:
+            cal_reply((p_evt->result == NRF_SUCCESS) ? "CAL: saved" : "CAL: save failed");
             break;
 
-        case BLE_GATTS_EVT_TIMEOUT:
-            // Disconnect on GATT Server timeout event.
-            err_code = sd_ble_gap_disconnect(p_ble_evt->evt.gatts_evt.conn_handle,
-                                             BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
-            APP_ERROR_CHECK(err_code);
+        case FDS_EVT_DEL_FILE:
+            cal_reply((p_evt->result == NRF_SUCCESS) ? "CAL: cleared" : "CAL: clear failed");
             break;
 
         default:
-            // No implementation needed.
             break;
     }
 }
 
 
-/**@brief Function for the SoftDevice initialization.
- *
- * @details This function initializes the SoftDevice and the BLE event interrupt.
+/**@brief Function for initializing the calibration. The record is loaded on FDS_EVT_INIT, until then
+ *        an identity correction is used. Requires the SoftDevice to be enabled.
  */
-static void ble_stack_init(void)
+static void cal_init(void)
 {
-    ret_code_t err_code;
+    cal_record_reset(&m_cal);
+    APP_ERROR_CHECK(fds_register(cal_fds_evt_handler));
+    APP_ERROR_CHECK(fds_init());
+}
 
-    err_code = nrf_sdh_enable_request();
-    APP_ERROR_CHECK(err_code);
 
-    // Configure the BLE stack using the default settings.
-    // Fetch the start address of the application RAM.
-    uint32_t ram_start = 0;
-    err_code = nrf_sdh_ble_default_cfg_set(APP_BLE_CONN_CFG_TAG, &ram_start);
-    APP_ERROR_CHECK(err_code);
+/**@brief Function for executing a calibration command in main context, called from app_sched_execute().
+ */
+static void cal_command_handler(void * p_event_data, uint16_t event_size)
+{
+    cal_cmd_t const * p_cmd = p_event_data;
+    cal_record_t      cal;
+    char              text[CAL_REPLY_LEN];
 
-    // Enable BLE stack.
-    err_code = nrf_sdh_ble_enable(&ram_start);
-    APP_ERROR_CHECK(err_code);
+    UNUSED_PARAMETER(event_size);
 
-    // Register a handler for BLE events.
-    NRF_SDH_BLE_OBSERVER(m_ble_observer, APP_BLE_OBSERVER_PRIO, ble_evt_handler, NULL);
+    switch (p_cmd->op)
+    {
+        case CAL_CMD_LOW:
+        case CAL_CMD_HIGH:
+            if (m_cal_capture.active)
+            {
+                cal_reply("CAL: capture in progress");
+                break;
+            }
+            m_cal_point_mv[p_cmd->channel][p_cmd->op == CAL_CMD_HIGH] = p_cmd->mv;
+            m_cal_point_valid[p_cmd->channel] &= ~(1 << (p_cmd->op == CAL_CMD_HIGH));
+            m_cal_capture.channel = p_cmd->channel;
+            m_cal_capture.point   = (p_cmd->op == CAL_CMD_HIGH);
+            m_cal_capture.scans   = 0;
+            m_cal_capture.sum     = 0;
+            m_cal_capture.active  = true;                                           // Set last, the capture may run in the SAADC interrupt
+            break;
+
+        case CAL_CMD_SAVE:
+            cal_flash_save();
+            break;
+
+        case CAL_CMD_CLEAR:
+            cal_record_reset(&cal);
+            cal_record_set(&cal);
+            memset(m_cal_point_valid, 0, sizeof(m_cal_point_valid));
+            if (fds_file_delete(CAL_FILE_ID) != NRF_SUCCESS)
+            {
+                cal_reply("CAL: flash busy, clear again");
+            }
+            break;
+
+        case CAL_CMD_SHOW:
+            for (uint32_t ch = 0; ch < SAADC_SAMPLES_IN_BUFFER; ch++)
+            {
+                snprintf(text, sizeof(text), "CAL CH%u: gain %ld/32768, offset %ld",
+                         ch, (long)m_cal.gain_q15[ch], (long)m_cal.offset[ch]);
+                cal_reply(text);
+            }
+            break;
+
+        default:
+            break;
+    }
 }
 
 
-/**@brief Function for handling events from the GATT library. */
-void gatt_evt_handler(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_t const * p_evt)
+/**@brief Function for parsing a decimal number of a calibration command.
+ *
+ * @param[in]  p_text   Text starting with the number. Leading spaces are skipped.
+ * @param[in]  min      Smallest accepted value.
+ * @param[in]  max      Largest accepted value.
+ * @param[out] p_value  Parsed value.
+ * @param[out] pp_end   First character after the number.
+ *
+ * @return True if the text starts with a number in min..max.
+ */
+static bool cal_number_parse(char const * p_text, long min, long max, long * p_value, char ** pp_end)
 {
-    if ((m_conn_handle == p_evt->conn_handle) && (p_evt->evt_id == NRF_BLE_GATT_EVT_ATT_MTU_UPDATED))
+    long value = strtol(p_text, pp_end, 10);
+
+    // Out of range values, including overflows clamped to LONG_MIN or LONG_MAX, are rejected before narrowing
+    if ((*pp_end == p_text) || (value < min) || (value > max))
     {
-        m_ble_nus_max_data_len = p_evt->params.att_mtu_effective - OPCODE_LENGTH - HANDLE_LENGTH;
-        NRF_LOG_INFO("Data len is set to 0x%X(%d)", m_ble_nus_max_data_len, m_ble_nus_max_data_len);
+        return false;
     }
-    NRF_LOG_DEBUG("ATT MTU exchange completed. central 0x%x peripheral 0x%x",
-                  p_gatt->att_mtu_desired_central,
-                  p_gatt->att_mtu_desired_periph);
+    *p_value = value;
+    return true;
 }
 
 
-/**@brief Function for initializing the GATT library. */
-void gatt_init(void)
+/**@brief Function for parsing a calibration command received on NUS or UART.
+ *
+ * @details Commands, one per line:
+ *          - "cal lo <channel> <mV>": capture the low point of a channel, with a known voltage applied.
+ *          - "cal hi <channel> <mV>": capture the high point. The correction is computed when both
+ *            points of the channel are captured, and applied to all following buffers.
+ *          - "cal save": write the calibration of all channels to flash.
+ *          - "cal clear": remove the calibration of all channels, in RAM and flash.
+ *          - "cal show": print the calibration of all channels.
+ *
+ * @return True if the data was a calibration command, and should not be forwarded.
+ */
+static bool cal_command_parse(uint8_t const * p_data, uint16_t length)
 {
-    ret_code_t err_code;
+    char      line[32];
+    char    * p_end;
+    cal_cmd_t cmd = {0};
 
-    err_code = nrf_ble_gatt_init(&m_gatt, gatt_evt_handler);
-    APP_ERROR_CHECK(err_code);
+    if ((length < 3) || (strncmp((char const *)p_data, "cal", 3) != 0))
+    {
+        return false;
+    }
 
-    err_code = nrf_ble_gatt_att_mtu_periph_set(&m_gatt, NRF_SDH_BLE_GATT_MAX_MTU_SIZE);
-    APP_ERROR_CHECK(err_code);
+    length = MIN(length, sizeof(line) - 1);
+    memcpy(line, p_data, length);
+    line[length] = '\0';
+
+    if ((strncmp(line, "cal lo ", 7) == 0) || (strncmp(line, "cal hi ", 7) == 0))
+    {
+        long channel;
+        long mv;
+
+        if (!cal_number_parse(&line[7], 0, SAADC_SAMPLES_IN_BUFFER - 1, &channel, &p_end))
+        {
+            cal_reply("CAL: invalid channel");
+            return true;
+        }
+        // The voltage must be within the single-ended input range of the channel, and end the command
+        if (!cal_number_parse(p_end, 0, m_convert[channel].full_scale_uv / 1000, &mv, &p_end) ||
+            (p_end[strspn(p_end, " \r\n")] != '\0'))
+        {
+            cal_reply("CAL: invalid voltage");
+            return true;
+        }
+        cmd.op      = (line[4] == 'h') ? CAL_CMD_HIGH : CAL_CMD_LOW;
+        cmd.channel = (uint8_t)channel;
+        cmd.mv      = (int32_t)mv;
+    }
+    else if (strncmp(line, "cal save", 8) == 0)
+    {
+        cmd.op = CAL_CMD_SAVE;
+    }
+    else if (strncmp(line, "cal clear", 9) == 0)
+    {
+        cmd.op = CAL_CMD_CLEAR;
+    }
+    else if (strncmp(line, "cal show", 8) == 0)
+    {
+        cmd.op = CAL_CMD_SHOW;
+    }
+    else
+    {
+        cal_reply("CAL: use cal lo|hi <channel> <mV>, cal save, cal clear or cal show");
+        return true;
+    }
+
+    if (app_sched_event_put(&cmd, sizeof(cmd), cal_command_handler) != NRF_SUCCESS)
+    {
+        cal_reply("CAL: busy, try again");
+    }
+    return true;
 }
 
 
-/**@brief Function for handling events from the BSP module.
+#if CAL_BENCHMARK_ENABLED
+/**@brief Function for logging the cycles/sample of cal_apply, and the CPU load it would add at 8 kHz.
  *
- * @param[in]   event   Event generated by button press.
+ * @details Runs once at startup, on CAL_BENCHMARK_SAMPLES samples. Requires the DWT cycle counter,
+ *          see cycle_counter_init.
  */
-void bsp_event_handler(bsp_event_t event)
+static void cal_benchmark(void)
 {
-    uint32_t err_code;
-    switch (event)
+    static nrf_saadc_value_t samples[CAL_BENCHMARK_SAMPLES];
+    cal_record_t             cal;
+    uint32_t                 cycles;
+    uint32_t                 start;
+    uint32_t                 load;
+
+    cal_record_reset(&cal);
+    for (uint32_t ch = 0; ch < SAADC_SAMPLES_IN_BUFFER; ch++)
     {
-        case BSP_EVENT_SLEEP:
-            sleep_mode_enter();
-            break;
+        cal.gain_q15[ch] = 33000 - 100 * ch;
+        cal.offset[ch]   = 5;
+    }
+    for (uint32_t i = 0; i < CAL_BENCHMARK_SAMPLES; i++)
+    {
+        samples[i] = (nrf_saadc_value_t)((i * 2654435761u) >> 20);
+    }
 
-        case BSP_EVENT_DISCONNECT:
-            err_code = sd_ble_gap_disconnect(m_conn_handle, BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
-            if (err_code != NRF_ERROR_INVALID_STATE)
-            {
-                APP_ERROR_CHECK(err_code);
-            }
-            break;
+    start  = DWT->CYCCNT;
+    cal_apply(&cal, samples, samples, CAL_BENCHMARK_SAMPLES);
+    cycles = DWT->CYCCNT - start;
 
-        case BSP_EVENT_WHITELIST_OFF:
-            if (m_conn_handle == BLE_CONN_HANDLE_INVALID)
+    // CPU load in 0.01 % at 8000 samples/s
+    load   = (uint32_t)((uint64_t)cycles * 8000 * 10000 / CAL_BENCHMARK_SAMPLES / SystemCoreClock);
+
+    NRF_LOG_INFO("Calibration: %u.%02u cycles/sample, %u.%02u %% CPU at 8 kHz",
+                 cycles / CAL_BENCHMARK_SAMPLES, (cycles * 100 / CAL_BENCHMARK_SAMPLES) % 100,
+                 load / 100, load % 100);
+}
+#endif
+#endif
+
+
+/**@brief Function for handling the data from the Nordic UART Service.
+ *
+ * @details This function will process the data received from the Nordic UART BLE Service and send
+ *          it to the UART module.
+ *
+ * @param[in] p_evt       Nordic UART Service event.
+ */
+/**@snippet [Handling the data received over BLE] */
+static void nus_data_handler(ble_nus_evt_t * p_evt)
+{
+
+    if (p_evt->type == BLE_NUS_EVT_TX_RDY)
+    {
+        nus_tx_queue_drain();
+    }
+    else if (p_evt->type == BLE_NUS_EVT_RX_DATA)
+    {
+        uint32_t err_code;
+
+#if SAADC_USER_CAL_ENABLED
+        if (cal_command_parse(p_evt->params.rx_data.p_data, p_evt->params.rx_data.length))
+        {
+            return;
+        }
+#endif
+
+        NRF_LOG_DEBUG("Received data from BLE NUS. Writing data on UART.");
+        NRF_LOG_HEXDUMP_DEBUG(p_evt->params.rx_data.p_data, p_evt->params.rx_data.length);
+
+        for (uint32_t i = 0; i < p_evt->params.rx_data.length; i++)
+        {
+            do
             {
-                err_code = ble_advertising_restart_without_whitelist(&m_advertising);
-                if (err_code != NRF_ERROR_INVALID_STATE)
+                err_code = app_uart_put(p_evt->params.rx_data.p_data[i]);
+                if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_BUSY))
                 {
+                    NRF_LOG_ERROR("Failed receiving NUS message. Error 0x%x. ", err_code);
                     APP_ERROR_CHECK(err_code);
                 }
-            }
-            break;
+            } while (err_code == NRF_ERROR_BUSY);
+        }
+        if (p_evt->params.rx_data.p_data[p_evt->params.rx_data.length - 1] == '\r')
+        {
+            while (app_uart_put('\n') == NRF_ERROR_BUSY);
+        }
+    }
+
+}
+/**@snippet [Handling the data received over BLE] */
+
+
+/**@brief Function for initializing services that will be used by the application.
+ */
+static void services_init(void)
+{
+    uint32_t           err_code;
+    ble_nus_init_t     nus_init;
+    nrf_ble_qwr_init_t qwr_init = {0};
+
+    // Initialize Queued Write Module.
+    qwr_init.error_handler = nrf_qwr_error_handler;
+
+    err_code = nrf_ble_qwr_init(&m_qwr, &qwr_init);
+    APP_ERROR_CHECK(err_code);
+
+    // Initialize NUS.
+    memset(&nus_init, 0, sizeof(nus_init));
+
+    nus_init.data_handler = nus_data_handler;
+
+    err_code = ble_nus_init(&m_nus, &nus_init);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for handling an event from the Connection Parameters Module.
+ *
+ * @details This function will be called for all events in the Connection Parameters Module
+ *          which are passed to the application.
+ *
+ * @note All this function does is to disconnect. This could have been done by simply setting
+ *       the disconnect_on_fail config parameter, but instead we use the event handler
+ *       mechanism to demonstrate its use.
+ *
+ * @param[in] p_evt  Event received from the Connection Parameters Module.
+ */
+static void on_conn_params_evt(ble_conn_params_evt_t * p_evt)
+{
+    uint32_t err_code;
+
+    if (p_evt->evt_type == BLE_CONN_PARAMS_EVT_FAILED)
+    {
+        err_code = sd_ble_gap_disconnect(m_conn_handle, BLE_HCI_CONN_INTERVAL_UNACCEPTABLE);
+        APP_ERROR_CHECK(err_code);
+    }
+}
+
+
+/**@brief Function for handling errors from the Connection Parameters module.
+ *
+ * @param[in] nrf_error  Error code containing information about what went wrong.
+ */
+static void conn_params_error_handler(uint32_t nrf_error)
+{
+    APP_ERROR_HANDLER(nrf_error);
+}
+
+
+/**@brief Function for initializing the Connection Parameters module.
+ */
+static void conn_params_init(void)
+{
+    uint32_t               err_code;
+    ble_conn_params_init_t cp_init;
+
+    memset(&cp_init, 0, sizeof(cp_init));
+
+    cp_init.p_conn_params                  = NULL;
+    cp_init.first_conn_params_update_delay = FIRST_CONN_PARAMS_UPDATE_DELAY;
+    cp_init.next_conn_params_update_delay  = NEXT_CONN_PARAMS_UPDATE_DELAY;
+    cp_init.max_conn_params_update_count   = MAX_CONN_PARAMS_UPDATE_COUNT;
+    cp_init.start_on_notify_cccd_handle    = BLE_GATT_HANDLE_INVALID;
+    cp_init.disconnect_on_fail             = false;
+    cp_init.evt_handler                    = on_conn_params_evt;
+    cp_init.error_handler                  = conn_params_error_handler;
+
+    err_code = ble_conn_params_init(&cp_init);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for putting the chip into sleep mode.
+ *
+ * @note This function will not return.
+ */
+static void sleep_mode_enter(void)
+{
+    uint32_t err_code = bsp_indication_set(BSP_INDICATE_IDLE);
+    APP_ERROR_CHECK(err_code);
+
+    // Prepare wakeup buttons.
+    err_code = bsp_btn_ble_sleep_mode_prepare();
+    APP_ERROR_CHECK(err_code);
+
+    // Go to system-off mode (this function will not return; wakeup will cause a reset).
+    err_code = sd_power_system_off();
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for handling advertising events.
+ *
+ * @details This function will be called for advertising events which are passed to the application.
+ *
+ * @param[in] ble_adv_evt  Advertising event.
+ */
+static void on_adv_evt(ble_adv_evt_t ble_adv_evt)
+{
+    uint32_t err_code;
+
+    switch (ble_adv_evt)
+    {
+        case BLE_ADV_EVT_FAST:
+            err_code = bsp_indication_set(BSP_INDICATE_ADVERTISING);
+            APP_ERROR_CHECK(err_code);
+            break;
+        case BLE_ADV_EVT_IDLE:
+            sleep_mode_enter();
+            break;
+        default:
+            break;
+    }
+}
+
+
+/**@brief Function for handling BLE events.
+ *
+ * @param[in]   p_ble_evt   Bluetooth stack event.
+ * @param[in]   p_context   Unused.
+ */
+static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    uint32_t err_code;
+
+    switch (p_ble_evt->header.evt_id)
+    {
+        case BLE_GAP_EVT_CONNECTED:
+            NRF_LOG_INFO("Connected");
+            err_code = bsp_indication_set(BSP_INDICATE_CONNECTED);
+            APP_ERROR_CHECK(err_code);
+            m_conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+            err_code = nrf_ble_qwr_conn_handle_assign(&m_qwr, m_conn_handle);
+            APP_ERROR_CHECK(err_code);
+#if NUS_BENCHMARK_ENABLED
+            nus_benchmark_restart();
+#endif
+            break;
+
+        case BLE_GAP_EVT_DISCONNECTED:
+            NRF_LOG_INFO("Disconnected");
+            // LED indication will be changed when advertising starts.
+            m_conn_handle = BLE_CONN_HANDLE_INVALID;
+            nus_tx_queue_flush();
+            NRF_LOG_INFO("NUS TX: queued %d, sent %d, dropped %d",
+                         m_nus_tx_stats.queued, m_nus_tx_stats.sent, m_nus_tx_stats.dropped);
+#if NUS_BENCHMARK_ENABLED
+            nus_benchmark_restart();
+#endif
+            break;
+
+#if NUS_BENCHMARK_ENABLED
+        case BLE_GATTS_EVT_HVN_TX_COMPLETE:
+            nus_benchmark_tx_complete(p_ble_evt->evt.gatts_evt.params.hvn_tx_complete.count);
+            break;
+#endif
+
+        case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
+        {
+            NRF_LOG_DEBUG("PHY update request.");
+            ble_gap_phys_t const phys =
+            {
+                .rx_phys = BLE_GAP_PHY_AUTO,
+                .tx_phys = BLE_GAP_PHY_AUTO,
+            };
+            err_code = sd_ble_gap_phy_update(p_ble_evt->evt.gap_evt.conn_handle, &phys);
+            APP_ERROR_CHECK(err_code);
+        } break;
+
+        case BLE_GAP_EVT_SEC_PARAMS_REQUEST:
+            // Pairing not supported
+            err_code = sd_ble_gap_sec_params_reply(m_conn_handle, BLE_GAP_SEC_STATUS_PAIRING_NOT_SUPP, NULL, NULL);
+            APP_ERROR_CHECK(err_code);
+            break;
+
+        case BLE_GATTS_EVT_SYS_ATTR_MISSING:
+            // No system attributes have been stored.
+            err_code = sd_ble_gatts_sys_attr_set(m_conn_handle, NULL, 0, 0);
+            APP_ERROR_CHECK(err_code);
+            break;
+
+        case BLE_GATTC_EVT_TIMEOUT:
+            // Disconnect on GATT Client timeout event.
+            err_code = sd_ble_gap_disconnect(p_ble_evt->evt.gattc_evt.conn_handle,
+                                             BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+            APP_ERROR_CHECK(err_code);
+            break;
+
+        case BLE_GATTS_EVT_TIMEOUT:
+            // Disconnect on GATT Server timeout event.
+            err_code = sd_ble_gap_disconnect(p_ble_evt->evt.gatts_evt.conn_handle,
+                                             BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+            APP_ERROR_CHECK(err_code);
+            break;
+
+        default:
+            // No implementation needed.
+            break;
+    }
+}
+
+
+/**@brief Function for the SoftDevice initialization.
+ *
+ * @details This function initializes the SoftDevice and the BLE event interrupt.
+ */
+static void ble_stack_init(void)
+{
+    ret_code_t err_code;
+
+    err_code = nrf_sdh_enable_request();
+    APP_ERROR_CHECK(err_code);
+
+    // Configure the BLE stack using the default settings.
+    // Fetch the start address of the application RAM.
+    uint32_t ram_start = 0;
+    err_code = nrf_sdh_ble_default_cfg_set(APP_BLE_CONN_CFG_TAG, &ram_start);
+    APP_ERROR_CHECK(err_code);
+
+    // Enable BLE stack.
+    err_code = nrf_sdh_ble_enable(&ram_start);
+    APP_ERROR_CHECK(err_code);
+
+    // Register a handler for BLE events.
+    NRF_SDH_BLE_OBSERVER(m_ble_observer, APP_BLE_OBSERVER_PRIO, ble_evt_handler, NULL);
+}
+
+
+/**@brief Function for handling events from the GATT library. */
+void gatt_evt_handler(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_t const * p_evt)
+{
+    if ((m_conn_handle == p_evt->conn_handle) && (p_evt->evt_id == NRF_BLE_GATT_EVT_ATT_MTU_UPDATED))
+    {
+        m_ble_nus_max_data_len = p_evt->params.att_mtu_effective - OPCODE_LENGTH - HANDLE_LENGTH;
+        NRF_LOG_INFO("Data len is set to 0x%X(%d)", m_ble_nus_max_data_len, m_ble_nus_max_data_len);
+    }
+    NRF_LOG_DEBUG("ATT MTU exchange completed. central 0x%x peripheral 0x%x",
+                  p_gatt->att_mtu_desired_central,
+                  p_gatt->att_mtu_desired_periph);
+}
+
+
+/**@brief Function for initializing the GATT library. */
+void gatt_init(void)
+{
+    ret_code_t err_code;
+
+    err_code = nrf_ble_gatt_init(&m_gatt, gatt_evt_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrf_ble_gatt_att_mtu_periph_set(&m_gatt, NRF_SDH_BLE_GATT_MAX_MTU_SIZE);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for handling events from the BSP module.
+ *
+ * @param[in]   event   Event generated by button press.
+ */
+void bsp_event_handler(bsp_event_t event)
+{
+    uint32_t err_code;
+    switch (event)
+    {
+        case BSP_EVENT_SLEEP:
+            sleep_mode_enter();
+            break;
+
+        case BSP_EVENT_DISCONNECT:
+            err_code = sd_ble_gap_disconnect(m_conn_handle, BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+            if (err_code != NRF_ERROR_INVALID_STATE)
+            {
+                APP_ERROR_CHECK(err_code);
+            }
+            break;
+
+        case BSP_EVENT_WHITELIST_OFF:
+            if (m_conn_handle == BLE_CONN_HANDLE_INVALID)
+            {
+                err_code = ble_advertising_restart_without_whitelist(&m_advertising);
+                if (err_code != NRF_ERROR_INVALID_STATE)
+                {
+                    APP_ERROR_CHECK(err_code);
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+/**@brief   Function for handling app_uart events.
+ *
+ * @details This function will receive a single character from the app_uart module and append it to
+ *          a string. The string will be be sent over BLE when the last character received was a
+ *          'new line' '\n' (hex 0x0A) or if the string has reached the maximum data length.
+ */
+/**@snippet [Handling the data received over UART] */
+void uart_event_handle(app_uart_evt_t * p_event)
+{
+    static uint8_t data_array[BLE_NUS_MAX_DATA_LEN];
+    static uint8_t index = 0;
+    uint32_t       err_code;
+
+    switch (p_event->evt_type)
+    {
+        case APP_UART_DATA_READY:
+            UNUSED_VARIABLE(app_uart_get(&data_array[index]));
+            index++;
+
+            if ((data_array[index - 1] == '\n') ||
+                (data_array[index - 1] == '\r') ||
+                (index >= m_ble_nus_max_data_len))
+            {
+#if SAADC_USER_CAL_ENABLED
+                if ((index > 1) && cal_command_parse(data_array, index - 1))
+                {
+                    // Handled locally, not sent over BLE
+                }
+                else
+#endif
+                if (index > 1)
+                {
+                    NRF_LOG_DEBUG("Ready to send data over BLE NUS");
+                    NRF_LOG_HEXDUMP_DEBUG(data_array, index);
+
+                    // Sent from the TX queue, no waiting for TX buffers in interrupt context
+                    err_code = nus_tx_queue_put(data_array, index, 0, 0);
+                    if (err_code == NRF_ERROR_NO_MEM)
+                    {
+                        NRF_LOG_WARNING("NUS TX queue full, UART data dropped.");
+                    }
+                }
+
+                index = 0;
+            }
+            break;
+
+        case APP_UART_COMMUNICATION_ERROR:
+            APP_ERROR_HANDLER(p_event->data.error_communication);
+            break;
+
+        case APP_UART_FIFO_ERROR:
+            APP_ERROR_HANDLER(p_event->data.error_code);
+            break;
+
+        default:
+            break;
+    }
+}
+/**@snippet [Handling the data received over UART] */
+
+
+/**@brief  Function for initializing the UART module.
+ */
+/**@snippet [UART Initialization] */
+static void uart_init(void)
+{
+    uint32_t                     err_code;
+    app_uart_comm_params_t const comm_params =
+    {
+        .rx_pin_no    = RX_PIN_NUMBER,
+        .tx_pin_no    = TX_PIN_NUMBER,
+        .rts_pin_no   = RTS_PIN_NUMBER,
+        .cts_pin_no   = CTS_PIN_NUMBER,
+        .flow_control = APP_UART_FLOW_CONTROL_DISABLED,
+        .use_parity   = false,
+#if defined (UART_PRESENT)
+        .baud_rate    = NRF_UART_BAUDRATE_115200
+#else
+        .baud_rate    = NRF_UARTE_BAUDRATE_115200
+#endif
+    };
+
+    APP_UART_FIFO_INIT(&comm_params,
+                       UART_RX_BUF_SIZE,
+                       UART_TX_BUF_SIZE,
+                       uart_event_handle,
+                       APP_IRQ_PRIORITY_LOWEST,
+                       err_code);
+    APP_ERROR_CHECK(err_code);
+}
+/**@snippet [UART Initialization] */
+
+
+/**@brief Function for initializing the Advertising functionality.
+ */
+static void advertising_init(void)
+{
+    uint32_t               err_code;
+    ble_advertising_init_t init;
+
+    memset(&init, 0, sizeof(init));
+
+    init.advdata.name_type          = BLE_ADVDATA_FULL_NAME;
+    init.advdata.include_appearance = false;
+    init.advdata.flags              = BLE_GAP_ADV_FLAGS_LE_ONLY_LIMITED_DISC_MODE;
+
+    init.srdata.uuids_complete.uuid_cnt = sizeof(m_adv_uuids) / sizeof(m_adv_uuids[0]);
+    init.srdata.uuids_complete.p_uuids  = m_adv_uuids;
+
+    init.config.ble_adv_fast_enabled  = true;
+    init.config.ble_adv_fast_interval = APP_ADV_INTERVAL;
+    init.config.ble_adv_fast_timeout  = APP_ADV_DURATION;
+    init.evt_handler = on_adv_evt;
+
+    err_code = ble_advertising_init(&m_advertising, &init);
+    APP_ERROR_CHECK(err_code);
+
+    ble_advertising_conn_cfg_tag_set(&m_advertising, APP_BLE_CONN_CFG_TAG);
+}
+
+
+/**@brief Function for initializing buttons and leds.
+ *
+ * @param[out] p_erase_bonds  Will be true if the clear bonding button was pressed to wake the application up.
+ */
+static void buttons_leds_init(bool * p_erase_bonds)
+{
+    bsp_event_t startup_event;
+
+    uint32_t err_code = bsp_init(BSP_INIT_LEDS | BSP_INIT_BUTTONS, bsp_event_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = bsp_btn_ble_init(NULL, &startup_event);
+    APP_ERROR_CHECK(err_code);
+
+    *p_erase_bonds = (startup_event == BSP_EVENT_CLEAR_BONDING_DATA);
+}
+
+
+/**@brief Function for initializing the nrf log module.
+ */
+static void log_init(void)
+{
+    ret_code_t err_code = NRF_LOG_INIT(NULL);
+    APP_ERROR_CHECK(err_code);
+
+    NRF_LOG_DEFAULT_BACKENDS_INIT();
+}
+
+
+/**@brief Function for initializing power management.
+ */
+static void power_management_init(void)
+{
+    ret_code_t err_code;
+    err_code = nrf_pwr_mgmt_init();
+    APP_ERROR_CHECK(err_code);
+}
+
+
+/**@brief Function for handling the idle state (main loop).
+ *
+ * @details If there is no pending log operation, then sleep until next the next event occurs.
+ */
+static void idle_state_handle(void)
+{
+    app_sched_execute();
+    UNUSED_RETURN_VALUE(NRF_LOG_PROCESS());
+    nrf_pwr_mgmt_run();
+}
+
+
+/**@brief Function for starting advertising.
+ */
+static void advertising_start(void)
+{
+    uint32_t err_code = ble_advertising_start(&m_advertising, BLE_ADV_MODE_FAST);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+void timer_handler(nrf_timer_event_t event_type, void* p_context)
+{
+
+}
+
+
+void saadc_sampling_event_init(void)
+{
+    ret_code_t err_code;
+    err_code = nrf_drv_ppi_init();
+    APP_ERROR_CHECK(err_code);
+    
+    nrf_drv_timer_config_t timer_config = NRF_DRV_TIMER_DEFAULT_CONFIG;
+    timer_config.frequency = NRF_TIMER_FREQ_31250Hz;
+    err_code = nrf_drv_timer_init(&m_timer, &timer_config, timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    /* setup m_timer for compare event */
+    uint32_t ticks = nrf_drv_timer_ms_to_ticks(&m_timer,SAADC_SAMPLE_RATE);
+    nrf_drv_timer_extended_compare(&m_timer, NRF_TIMER_CC_CHANNEL0, ticks, NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK, false);
+    nrf_drv_timer_enable(&m_timer);
+
+    uint32_t timer_compare_event_addr = nrf_drv_timer_compare_event_address_get(&m_timer, NRF_TIMER_CC_CHANNEL0);
+    uint32_t saadc_sample_event_addr = nrf_drv_saadc_sample_task_get();
+
+    /* setup ppi channel so that timer compare event is triggering sample task in SAADC */
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_channel);
+    APP_ERROR_CHECK(err_code);
+    
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_channel, timer_compare_event_addr, saadc_sample_event_addr);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+void saadc_sampling_event_enable(void)
+{
+    ret_code_t err_code = nrf_drv_ppi_channel_enable(m_ppi_channel);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+#if NUS_BINARY_STREAM_ENABLED
+#if (NUS_FRAME_FORMAT != NUS_FRAME_FORMAT_RAW16)
+/**@brief Function for appending bits to the frame, most significant bit first.
+ *
+ * @param[in] value  Bits to append, in the least significant bits.
+ * @param[in] bits   Number of bits, 1 to 16.
+ */
+static void nus_frame_bits_put(uint32_t value, uint8_t bits)
+{
+    m_nus_frame.bit_buf    = (m_nus_frame.bit_buf << bits) | (value & ((1UL << bits) - 1));
+    m_nus_frame.bit_count += bits;
+
+    while (m_nus_frame.bit_count >= 8)
+    {
+        m_nus_frame.bit_count -= 8;
+        m_nus_frame.data[m_nus_frame.length++] = (uint8_t)(m_nus_frame.bit_buf >> m_nus_frame.bit_count);
+    }
+}
+
+
+#endif
+
+
+#if (NUS_FRAME_FORMAT == NUS_FRAME_FORMAT_DELTA_RICE)
+/**@brief Function for encoding one sample as the Rice code of the zigzag mapped difference to the previous
+ *        sample on the same channel.
+ *
+ * @details The Rice parameter k adapts to the running mean of the coded values. Quotients of
+ *          NUS_RICE_ESCAPE or more are sent as NUS_RICE_ESCAPE one bits followed by the 16-bit value,
+ *          which bounds a sample to 32 bits.
+ */
+static void nus_frame_rice_put(uint32_t ch, nrf_saadc_value_t value)
+{
+    int16_t  delta = (int16_t)(value - m_nus_frame.prev[ch]);
+    uint16_t zz    = (uint16_t)(((uint16_t)delta << 1) ^ (uint16_t)(delta >> 15));
+    uint8_t  k     = 0;
+
+    while ((k < 15) && (((uint32_t)m_nus_frame.rice_n[ch] << k) < m_nus_frame.rice_a[ch]))
+    {
+        k++;
+    }
+
+    uint32_t q = zz >> k;
+    if (q < NUS_RICE_ESCAPE)
+    {
+        nus_frame_bits_put(((1UL << q) - 1) << 1, q + 1);
+        if (k > 0)
+        {
+            nus_frame_bits_put(zz, k);
+        }
+    }
+    else
+    {
+        nus_frame_bits_put((1UL << NUS_RICE_ESCAPE) - 1, NUS_RICE_ESCAPE);
+        nus_frame_bits_put(zz, 16);
+    }
+
+    m_nus_frame.prev[ch]    = value;
+    m_nus_frame.rice_a[ch] += zz;
+    if (++m_nus_frame.rice_n[ch] == NUS_RICE_RESET)
+    {
+        m_nus_frame.rice_a[ch] >>= 1;
+        m_nus_frame.rice_n[ch] >>= 1;
+    }
+}
+#endif
+
+
+/**@brief Function for starting a new binary frame.
+ */
+static void nus_frame_start(void)
+{
+    m_nus_frame.data[0] = (uint8_t)m_nus_frame_seq;
+    m_nus_frame.data[1] = (uint8_t)(m_nus_frame_seq >> 8);
+    m_nus_frame.data[2] = SAADC_CHANNEL_MASK;
+    m_nus_frame.length  = NUS_FRAME_HEADER_LEN;
+    m_nus_frame_seq++;
+#if NUS_BENCHMARK_ENABLED
+    m_nus_frame.ticks   = m_nus_benchmark.buffer_ticks;
+    m_nus_frame.samples = 0;
+#endif
+
+#if (NUS_FRAME_FORMAT == NUS_FRAME_FORMAT_DELTA_RICE)
+    // Every frame can be decoded on its own, the encoder restarts from the first scan
+    m_nus_frame.data[3]   = NUS_FRAME_FORMAT_DELTA_RICE;
+    m_nus_frame.capacity  = m_ble_nus_max_data_len;
+    m_nus_frame.length   += 1;                                                      // Scan count, written when the frame is sent
+    m_nus_frame.bit_count = 0;
+    m_nus_frame.scans     = 0;
+    for (uint32_t ch = 0; ch < SAADC_SAMPLES_IN_BUFFER; ch++)
+    {
+        m_nus_frame.rice_a[ch] = NUS_RICE_A_INIT;
+        m_nus_frame.rice_n[ch] = 1;
+    }
+#elif (NUS_FRAME_FORMAT == NUS_FRAME_FORMAT_PACKED)
+    m_nus_frame.data[3]   = NUS_FRAME_FORMAT_PACKED;
+    m_nus_frame.data[4]   = SAADC_RESOLUTION_BITS;
+    m_nus_frame.length   += NUS_PACKED_HEADER_LEN;
+    m_nus_frame.capacity  = m_ble_nus_max_data_len;
+    m_nus_frame.bit_count = 0;
+#else
+    uint16_t scans = (m_ble_nus_max_data_len - NUS_FRAME_HEADER_LEN) / NUS_SCAN_LEN;
+
+    m_nus_frame.data[3]  = NUS_FRAME_FORMAT_RAW16;
+    m_nus_frame.capacity = NUS_FRAME_HEADER_LEN + scans * NUS_SCAN_LEN;
+#endif
+}
+
+
+/**@brief Function for checking if one more scan is guaranteed to fit in the frame.
+ */
+static bool nus_frame_scan_fits(void)
+{
+#if (NUS_FRAME_FORMAT == NUS_FRAME_FORMAT_DELTA_RICE)
+    return (m_nus_frame.scans < UINT8_MAX) &&
+           (m_nus_frame.length + (m_nus_frame.bit_count + NUS_RICE_SCAN_BITS_MAX + 7) / 8 <= m_nus_frame.capacity);
+#elif (NUS_FRAME_FORMAT == NUS_FRAME_FORMAT_PACKED)
+    return (m_nus_frame.length + (m_nus_frame.bit_count + NUS_PACKED_SCAN_BITS + 7) / 8 <= m_nus_frame.capacity);
+#else
+    return (m_nus_frame.length + NUS_SCAN_LEN <= m_nus_frame.capacity);
+#endif
+}
+
+
+/**@brief Function for adding one scan of all channels to the frame.
+ */
+static void nus_frame_scan_put(nrf_saadc_value_t const * p_scan)
+{
+#if NUS_BENCHMARK_ENABLED
+    m_nus_frame.samples += SAADC_SAMPLES_IN_BUFFER;
+#endif
+
+#if (NUS_FRAME_FORMAT == NUS_FRAME_FORMAT_DELTA_RICE)
+    for (uint32_t ch = 0; ch < SAADC_SAMPLES_IN_BUFFER; ch++)
+    {
+        if (m_nus_frame.scans == 0)
+        {
+            // First scan is sent uncoded, and is the reference for the differences
+            nus_frame_bits_put((uint16_t)p_scan[ch], 16);
+            m_nus_frame.prev[ch] = p_scan[ch];
+        }
+        else
+        {
+            nus_frame_rice_put(ch, p_scan[ch]);
+        }
+    }
+    m_nus_frame.scans++;
+#elif (NUS_FRAME_FORMAT == NUS_FRAME_FORMAT_PACKED)
+    for (uint32_t ch = 0; ch < SAADC_SAMPLES_IN_BUFFER; ch++)
+    {
+        // Single-ended results can be slightly negative due to offset, these are sent as 0
+        int16_t value = MAX(p_scan[ch], 0);
+        nus_frame_bits_put((uint32_t)MIN(value, (1 << SAADC_RESOLUTION_BITS) - 1), SAADC_RESOLUTION_BITS);
+    }
+#else
+    for (uint16_t ch = 0; ch < SAADC_SAMPLES_IN_BUFFER; ch++)
+    {
+        uint16_t adc_value = p_scan[ch];
+        m_nus_frame.data[m_nus_frame.length++] = (uint8_t)adc_value;
+        m_nus_frame.data[m_nus_frame.length++] = (uint8_t)(adc_value >> 8);
+    }
+#endif
+}
+
+
+/**@brief Function for queueing the current binary frame for transmission and starting a new one.
+ *
+ * @retval true   Frame queued.
+ * @retval false  TX queue full. The frame is kept and queued again with the next SAADC buffer.
+ */
+static bool nus_frame_send(void)
+{
+#if (NUS_FRAME_FORMAT != NUS_FRAME_FORMAT_RAW16)
+    // Pad the last byte with zero bits
+    if (m_nus_frame.bit_count > 0)
+    {
+        nus_frame_bits_put(0, 8 - m_nus_frame.bit_count);
+    }
+#endif
+#if (NUS_FRAME_FORMAT == NUS_FRAME_FORMAT_DELTA_RICE)
+    m_nus_frame.data[NUS_FRAME_HEADER_LEN] = (uint8_t)m_nus_frame.scans;
+#endif
+
+#if NUS_BENCHMARK_ENABLED
+    if (nus_tx_queue_put(m_nus_frame.data, m_nus_frame.length, m_nus_frame.ticks, m_nus_frame.samples) != NRF_SUCCESS)
+#else
+    if (nus_tx_queue_put(m_nus_frame.data, m_nus_frame.length, 0, 0) != NRF_SUCCESS)
+#endif
+    {
+        return false;
+    }
+
+    m_nus_frame.length = 0;
+    return true;
+}
+
+
+/**@brief Function for appending one SAADC buffer to the binary frame.
+ *
+ * @details Frames are queued for transmission when they are full. Each frame holds as many complete
+ *          scans as fit in m_ble_nus_max_data_len bytes, which is exactly 244 bytes with the 247 byte
+ *          ATT MTU. While a full frame is held back by the TX queue, new scans are discarded.
+ *
+ *          Frame layout: seq (uint16 LE) | channel mask | format | samples, see README.md.
+ *
+ * @param[in] p_buffer  Samples from one SAADC DONE event.
+ * @param[in] size      Number of samples in the buffer.
+ */
+static void nus_frame_append(nrf_saadc_value_t const * p_buffer, uint16_t size)
+{
+    for (uint16_t i = 0; i < size; i += SAADC_SAMPLES_IN_BUFFER)
+    {
+        if ((m_nus_frame.length != 0) && !nus_frame_scan_fits() && !nus_frame_send())
+        {
+            m_nus_frame_discarded_scans++;
+            continue;
+        }
 
-        default:
-            break;
+        if (m_nus_frame.length == 0)
+        {
+            nus_frame_start();
+        }
+
+        nus_frame_scan_put(&p_buffer[i]);
+
+        if (!nus_frame_scan_fits())
+        {
+            UNUSED_RETURN_VALUE(nus_frame_send());
+        }
     }
 }
 
 
-/**@brief   Function for handling app_uart events.
+#if NUS_PACK_BENCHMARK_ENABLED
+/**@brief Function for unpacking the samples of a NUS_FRAME_FORMAT_PACKED frame, the inverse of nus_frame_scan_put.
  *
- * @details This function will receive a single character from the app_uart module and append it to
- *          a string. The string will be be sent over BLE when the last character received was a
- *          'new line' '\n' (hex 0x0A) or if the string has reached the maximum data length.
+ * @param[in]  p_frame    Frame, including the header.
+ * @param[in]  length     Frame length in bytes.
+ * @param[out] p_samples  Samples, interleaved as CH0 CH1 CH2 CH3 CH0 ...
+ *
+ * @return Number of samples, a multiple of SAADC_SAMPLES_IN_BUFFER. The padding bits are ignored.
  */
-/**@snippet [Handling the data received over UART] */
-void uart_event_handle(app_uart_evt_t * p_event)
+static uint16_t nus_frame_unpack(uint8_t const * p_frame, uint16_t length, nrf_saadc_value_t * p_samples)
 {
-    static uint8_t data_array[BLE_NUS_MAX_DATA_LEN];
-    static uint8_t index = 0;
-    uint32_t       err_code;
+    uint32_t bit_buf   = 0;
+    uint8_t  bit_count = 0;
+    uint16_t count     = 0;
 
-    switch (p_event->evt_type)
+    // Samples are at least 8 bits, so each byte completes at most one sample
+    for (uint16_t i = NUS_FRAME_HEADER_LEN + NUS_PACKED_HEADER_LEN; i < length; i++)
     {
-        case APP_UART_DATA_READY:
-            UNUSED_VARIABLE(app_uart_get(&data_array[index]));
-            index++;
+        bit_buf    = (bit_buf << 8) | p_frame[i];
+        bit_count += 8;
+        if (bit_count >= SAADC_RESOLUTION_BITS)
+        {
+            bit_count -= SAADC_RESOLUTION_BITS;
+            p_samples[count++] = (nrf_saadc_value_t)((bit_buf >> bit_count) & ((1UL << SAADC_RESOLUTION_BITS) - 1));
+        }
+    }
+    return count - (count % SAADC_SAMPLES_IN_BUFFER);
+}
 
-            if ((data_array[index - 1] == '\n') ||
-                (data_array[index - 1] == '\r') ||
-                (index >= m_ble_nus_max_data_len))
-            {
-                if (index > 1)
-                {
-                    NRF_LOG_DEBUG("Ready to send data over BLE NUS");
-                    NRF_LOG_HEXDUMP_DEBUG(data_array, index);
 
-                    do
-                    {
-                        uint16_t length = (uint16_t)index;
-                        err_code = ble_nus_data_send(&m_nus, data_array, &length, m_conn_handle);
-                        if ((err_code != NRF_ERROR_INVALID_STATE) &&
-                            (err_code != NRF_ERROR_RESOURCES) &&
-                            (err_code != NRF_ERROR_NOT_FOUND))
-                        {
-                            APP_ERROR_CHECK(err_code);
-                        }
-                    } while (err_code == NRF_ERROR_RESOURCES);
-                }
+/**@brief Function for logging the cycles/sample of packing and unpacking, and checking the round trip.
+ *
+ * @details Runs once at startup, before the SAADC is started, on NUS_PACK_BENCHMARK_SCANS scans of
+ *          pseudo-random samples. Frames are filled to BLE_NUS_MAX_DATA_LEN bytes, and the packing time
+ *          includes copying each full frame out, as nus_tx_queue_put does. Requires the DWT cycle counter,
+ *          see cycle_counter_init.
+ */
+static void nus_pack_benchmark(void)
+{
+    static nrf_saadc_value_t scans[NUS_PACK_BENCHMARK_SCANS * SAADC_SAMPLES_IN_BUFFER];
+    static nrf_saadc_value_t unpacked[NUS_PACK_BENCHMARK_SCANS * SAADC_SAMPLES_IN_BUFFER];
+    static uint8_t           frames[NUS_PACK_BENCHMARK_FRAMES][BLE_NUS_MAX_DATA_LEN];
+    static uint16_t          frame_lengths[NUS_PACK_BENCHMARK_FRAMES];
+    uint32_t                 samples        = NUS_PACK_BENCHMARK_SCANS * SAADC_SAMPLES_IN_BUFFER;
+    uint32_t                 frame_count    = 0;
+    uint32_t                 frame_bytes    = 0;
+    uint32_t                 unpacked_count = 0;
+    uint32_t                 pack_cycles;
+    uint32_t                 unpack_cycles;
+    uint32_t                 start;
+
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        scans[i] = (nrf_saadc_value_t)((i * 2654435761u) >> (32 - SAADC_RESOLUTION_BITS));
+    }
 
-                index = 0;
+    start = DWT->CYCCNT;
+    m_nus_frame.length = 0;
+    for (uint32_t i = 0; i < samples; i += SAADC_SAMPLES_IN_BUFFER)
+    {
+        if (m_nus_frame.length == 0)
+        {
+            nus_frame_start();
+            m_nus_frame.capacity = BLE_NUS_MAX_DATA_LEN;
+        }
+        nus_frame_scan_put(&scans[i]);
+        if (!nus_frame_scan_fits() || (i + SAADC_SAMPLES_IN_BUFFER == samples))
+        {
+            if (m_nus_frame.bit_count > 0)
+            {
+                nus_frame_bits_put(0, 8 - m_nus_frame.bit_count);
             }
-            break;
-
-        case APP_UART_COMMUNICATION_ERROR:
-            APP_ERROR_HANDLER(p_event->data.error_communication);
-            break;
-
-        case APP_UART_FIFO_ERROR:
-            APP_ERROR_HANDLER(p_event->data.error_code);
-            break;
+            memcpy(frames[frame_count], m_nus_frame.data, m_nus_frame.length);
+            frame_lengths[frame_count++] = m_nus_frame.length;
+            frame_bytes       += m_nus_frame.length;
+            m_nus_frame.length = 0;
+        }
+    }
+    pack_cycles = DWT->CYCCNT - start;
 
-        default:
-            break;
+    start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < frame_count; i++)
+    {
+        unpacked_count += nus_frame_unpack(frames[i], frame_lengths[i], &unpacked[unpacked_count]);
     }
-}
-/**@snippet [Handling the data received over UART] */
+    unpack_cycles = DWT->CYCCNT - start;
 
+    m_nus_frame_seq = 0;
 
-/**@brief  Function for initializing the UART module.
- */
-/**@snippet [UART Initialization] */
-static void uart_init(void)
-{
-    uint32_t                     err_code;
-    app_uart_comm_params_t const comm_params =
+    if ((unpacked_count != samples) || (memcmp(scans, unpacked, sizeof(scans)) != 0))
     {
-        .rx_pin_no    = RX_PIN_NUMBER,
-        .tx_pin_no    = TX_PIN_NUMBER,
-        .rts_pin_no   = RTS_PIN_NUMBER,
-        .cts_pin_no   = CTS_PIN_NUMBER,
-        .flow_control = APP_UART_FLOW_CONTROL_DISABLED,
-        .use_parity   = false,
-#if defined (UART_PRESENT)
-        .baud_rate    = NRF_UART_BAUDRATE_115200
-#else
-        .baud_rate    = NRF_UARTE_BAUDRATE_115200
-#endif
-    };
+        NRF_LOG_ERROR("Packing: round trip mismatch, %d of %d samples unpacked", unpacked_count, samples);
+        return;
+    }
 
-    APP_UART_FIFO_INIT(&comm_params,
-                       UART_RX_BUF_SIZE,
-                       UART_TX_BUF_SIZE,
-                       uart_event_handle,
-                       APP_IRQ_PRIORITY_LOWEST,
-                       err_code);
-    APP_ERROR_CHECK(err_code);
+    // Bits sent per sample in 0.01 bit, including the frame headers
+    uint32_t bits = frame_bytes * 8 * 100 / samples;
+
+    NRF_LOG_INFO("Packing: %u.%02u cycles/sample, unpacking: %u.%02u cycles/sample, %u.%02u bits/sample in %d frames",
+                 pack_cycles / samples, (pack_cycles * 100 / samples) % 100,
+                 unpack_cycles / samples, (unpack_cycles * 100 / samples) % 100,
+                 bits / 100, bits % 100, frame_count);
 }
-/**@snippet [UART Initialization] */
+#endif
+#endif
 
 
-/**@brief Function for initializing the Advertising functionality.
- */
-static void advertising_init(void)
-{
-    uint32_t               err_code;
-    ble_advertising_init_t init;
+#if SAADC_STATS_ENABLED
+SAADC_STATS_WINDOW_DEF(m_stats, SAADC_SAMPLES_IN_BUFFER, SAADC_STATS_WINDOW);                   /**< Statistics of each channel in the scan, summarized every SAADC_STATS_WINDOW buffers. */
+#endif
 
-    memset(&init, 0, sizeof(init));
 
-    init.advdata.name_type          = BLE_ADVDATA_FULL_NAME;
-    init.advdata.include_appearance = false;
-    init.advdata.flags              = BLE_GAP_ADV_FLAGS_LE_ONLY_LIMITED_DISC_MODE;
+#if SAADC_COV_FILTER_ENABLED
+/**@brief Change-of-value state of one channel. */
+typedef struct
+{
+    nrf_saadc_value_t last;                                                         /**< Last reported value. */
+    uint32_t          silent;                                                       /**< Buffers since the last report. */
+} cov_channel_t;
 
-    init.srdata.uuids_complete.uuid_cnt = sizeof(m_adv_uuids) / sizeof(m_adv_uuids[0]);
-    init.srdata.uuids_complete.p_uuids  = m_adv_uuids;
+/**@brief Change-of-value filter counters, restarted every SAADC_COV_STATS_INTERVAL buffers. */
+typedef struct
+{
+    uint32_t scans;                                                                 /**< Buffers passed through the filter. */
+    uint32_t reports;                                                               /**< Channel values reported. */
+    uint32_t notifications;                                                         /**< Notifications queued. Buffers without reports are not sent. */
+    uint32_t airtime_us;                                                            /**< Estimated airtime of the queued notifications. */
+    uint32_t airtime_unfiltered_us;                                                 /**< Estimated airtime if every buffer had been sent with all channels. */
+} cov_stats_t;
 
-    init.config.ble_adv_fast_enabled  = true;
-    init.config.ble_adv_fast_interval = APP_ADV_INTERVAL;
-    init.config.ble_adv_fast_timeout  = APP_ADV_DURATION;
-    init.evt_handler = on_adv_evt;
+static cov_channel_t m_cov[SAADC_SAMPLES_IN_BUFFER];
+static cov_stats_t   m_cov_stats;
 
-    err_code = ble_advertising_init(&m_advertising, &init);
-    APP_ERROR_CHECK(err_code);
 
-    ble_advertising_conn_cfg_tag_set(&m_advertising, APP_BLE_CONN_CFG_TAG);
+/**@brief Function for initializing the change-of-value filter, so every channel is reported in the first buffer.
+ */
+static void cov_filter_init(cov_channel_t * p_cov, uint32_t channels)
+{
+    for (uint32_t ch = 0; ch < channels; ch++)
+    {
+        p_cov[ch].last   = 0;
+        p_cov[ch].silent = SAADC_COV_KEEPALIVE_SCANS;
+    }
 }
 
 
-/**@brief Function for initializing buttons and leds.
+/**@brief Function for selecting the channels of one scan that should be reported.
  *
- * @param[out] p_erase_bonds  Will be true if the clear bonding button was pressed to wake the application up.
+ * @details A channel is reported when it has moved by more than the deadband since its last report, and
+ *          was not reported within SAADC_COV_MIN_INTERVAL_MS, or when it was silent for SAADC_COV_KEEPALIVE_MS.
+ *
+ * @param[in] p_cov     Filter state, one entry per channel.
+ * @param[in] channels  Number of channels in the scan.
+ * @param[in] p_scan    One sample of each channel.
+ *
+ * @return Mask of the channels to report.
  */
-static void buttons_leds_init(bool * p_erase_bonds)
+static uint32_t cov_filter_scan(cov_channel_t * p_cov, uint32_t channels, nrf_saadc_value_t const * p_scan)
 {
-    bsp_event_t startup_event;
+    uint32_t mask = 0;
 
-    uint32_t err_code = bsp_init(BSP_INIT_LEDS | BSP_INIT_BUTTONS, bsp_event_handler);
-    APP_ERROR_CHECK(err_code);
+    for (uint32_t ch = 0; ch < channels; ch++)
+    {
+        cov_channel_t * p        = &p_cov[ch];
+        int32_t         delta    = p_scan[ch] - p->last;
+        int32_t         deadband = ((p->last < 0 ? -p->last : p->last) * SAADC_COV_DEADBAND_PERMILLE) / 1000;
 
-    err_code = bsp_btn_ble_init(NULL, &startup_event);
-    APP_ERROR_CHECK(err_code);
+        if (deadband < SAADC_COV_DEADBAND)
+        {
+            deadband = SAADC_COV_DEADBAND;
+        }
 
-    *p_erase_bonds = (startup_event == BSP_EVENT_CLEAR_BONDING_DATA);
+        p->silent++;
+        if ((p->silent >= SAADC_COV_KEEPALIVE_SCANS) ||
+            (((delta > deadband) || (delta < -deadband)) && (p->silent >= SAADC_COV_MIN_INTERVAL_SCANS)))
+        {
+            p->last   = p_scan[ch];
+            p->silent = 0;
+            mask     |= 1UL << ch;
+        }
+    }
+    return mask;
 }
 
 
-/**@brief Function for initializing the nrf log module.
+/**@brief Function for adding one buffer to the filter counters. Logs the reduction every SAADC_COV_STATS_INTERVAL buffers.
+ *
+ * @param[in] reports           Number of channel values reported.
+ * @param[in] length            Length of the notification, 0 if nothing was sent.
+ * @param[in] length_unfiltered Length of the notification with all channels.
  */
-static void log_init(void)
+static void cov_filter_stats(uint32_t reports, uint16_t length, uint16_t length_unfiltered)
 {
-    ret_code_t err_code = NRF_LOG_INIT(NULL);
-    APP_ERROR_CHECK(err_code);
+    m_cov_stats.reports               += reports;
+    m_cov_stats.airtime_unfiltered_us += (NUS_AIRTIME_OVERHEAD_BYTES + length_unfiltered) * NUS_AIRTIME_US_PER_BYTE;
+    if (length > 0)
+    {
+        m_cov_stats.notifications++;
+        m_cov_stats.airtime_us += (NUS_AIRTIME_OVERHEAD_BYTES + length) * NUS_AIRTIME_US_PER_BYTE;
+    }
 
-    NRF_LOG_DEFAULT_BACKENDS_INIT();
+    if (++m_cov_stats.scans < SAADC_COV_STATS_INTERVAL)
+    {
+        return;
+    }
+
+    NRF_LOG_INFO("Change-of-value: %u of %u values in %u of %u notifications, airtime %u of %u us",
+                 m_cov_stats.reports,
+                 m_cov_stats.scans * SAADC_SAMPLES_IN_BUFFER,
+                 m_cov_stats.notifications,
+                 m_cov_stats.scans,
+                 m_cov_stats.airtime_us,
+                 m_cov_stats.airtime_unfiltered_us);
+    memset(&m_cov_stats, 0, sizeof(m_cov_stats));
 }
+#endif
 
 
-/**@brief Function for initializing power management.
+/**@brief Function for enabling the DWT cycle counter, used to measure the SAADC interrupt duration.
  */
-static void power_management_init(void)
+static void cycle_counter_init(void)
 {
-    ret_code_t err_code;
-    err_code = nrf_pwr_mgmt_init();
-    APP_ERROR_CHECK(err_code);
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }
 
 
-/**@brief Function for handling the idle state (main loop).
+/**@brief Function for processing one SAADC buffer. Formats and transmits the samples.
  *
- * @details If there is no pending log operation, then sleep until next the next event occurs.
+ * @param[in] p_buffer  Samples from one SAADC DONE event.
+ * @param[in] size      Number of samples in the buffer.
  */
-static void idle_state_handle(void)
+static void saadc_buffer_process(nrf_saadc_value_t const * p_buffer, uint16_t size)
 {
-    UNUSED_RETURN_VALUE(NRF_LOG_PROCESS());
-    nrf_pwr_mgmt_run();
-}
-
+#if SAADC_USER_CAL_ENABLED
+    nrf_saadc_value_t calibrated[SAADC_SAMPLES_IN_BUFFER];
 
-/**@brief Function for starting advertising.
- */
-static void advertising_start(void)
-{
-    uint32_t err_code = ble_advertising_start(&m_advertising, BLE_ADV_MODE_FAST);
-    APP_ERROR_CHECK(err_code);
-}
+    // Calibration points are captured from the raw samples, every sink gets the corrected samples
+    cal_capture_scan(p_buffer);
+    cal_apply(&m_cal, p_buffer, calibrated, size);
+    p_buffer = calibrated;
+#endif
 
+#if SAADC_STATS_ENABLED
+    UNUSED_RETURN_VALUE(saadc_stats_window_add(&m_stats, p_buffer, size));
+#endif
 
-void timer_handler(nrf_timer_event_t event_type, void* p_context)
-{
+#if NUS_BINARY_STREAM_ENABLED
+    // Accumulate samples in binary frames, sent over BLE via NUS service when full
+    nus_frame_append(p_buffer, size);
+#elif SAADC_COV_FILTER_ENABLED
+    // Send and print only the channels that have changed, and the keep-alive
+    uint32_t mask              = cov_filter_scan(m_cov, SAADC_SAMPLES_IN_BUFFER, p_buffer);
+    uint32_t reports           = 0;
+    uint16_t bytes_to_send     = 0;
+    uint16_t bytes_unfiltered  = 0;
+    uint8_t  nus_string[NUS_TEXT_LEN];
+
+    for (uint32_t ch = 0; ch < SAADC_SAMPLES_IN_BUFFER; ch++)
+    {
+        char     line[16];
+        uint16_t line_len = snprintf(line, sizeof(line), "%sCH%u: %d", (ch > 0) ? "\r\n" : "", ch, p_buffer[ch]);
 
-}
+        bytes_unfiltered += line_len;
+        if (mask & (1UL << ch))
+        {
+            // No separator before the first reported channel
+            uint16_t skip = ((bytes_to_send == 0) && (ch > 0)) ? 2 : 0;
+
+            memcpy(&nus_string[bytes_to_send], &line[skip], line_len - skip);
+            bytes_to_send += line_len - skip;
+            reports++;
+#if !SAADC_STATS_ENABLED
+            printf("CH%u: %d\r\n", ch, p_buffer[ch]);
+#endif
+        }
+    }
 
+    if (bytes_to_send > 0)
+    {
+#if NUS_BENCHMARK_ENABLED
+        UNUSED_RETURN_VALUE(nus_tx_queue_put(nus_string, bytes_to_send, m_nus_benchmark.buffer_ticks, reports));
+#else
+        UNUSED_RETURN_VALUE(nus_tx_queue_put(nus_string, bytes_to_send, 0, 0));
+#endif
+    }
+    cov_filter_stats(reports, bytes_to_send, bytes_unfiltered);
+#else
+    uint16_t bytes_to_send;
 
-void saadc_sampling_event_init(void)
-{
-    ret_code_t err_code;
-    err_code = nrf_drv_ppi_init();
-    APP_ERROR_CHECK(err_code);
-    
-    nrf_drv_timer_config_t timer_config = NRF_DRV_TIMER_DEFAULT_CONFIG;
-    timer_config.frequency = NRF_TIMER_FREQ_31250Hz;
-    err_code = nrf_drv_timer_init(&m_timer, &timer_config, timer_handler);
-    APP_ERROR_CHECK(err_code);
+#if !SAADC_STATS_ENABLED
+    // print samples on hardware UART
+    printf("ADC event number: %d\r\n",(int)m_adc_evt_counter);
+    for (int i = 0; i < size; i++)
+    {
+        int value = p_buffer[i];
+        printf("%d (%d mV)\r\n", value, (int)saadc_convert_value(&m_convert[i % SAADC_SAMPLES_IN_BUFFER], value));
+    }
+#endif
 
-    /* setup m_timer for compare event */
-    uint32_t ticks = nrf_drv_timer_ms_to_ticks(&m_timer,SAADC_SAMPLE_RATE);
-    nrf_drv_timer_extended_compare(&m_timer, NRF_TIMER_CC_CHANNEL0, ticks, NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK, false);
-    nrf_drv_timer_enable(&m_timer);
+     // Send data over BLE via NUS service. Create string from samples and send string with correct length.
+    uint8_t nus_string[NUS_TEXT_LEN];
+    bytes_to_send = 0;
+    for (uint32_t ch = 0; ch < SAADC_SAMPLES_IN_BUFFER; ch++)
+    {
+        bytes_to_send += sprintf((char *)&nus_string[bytes_to_send], "%sCH%u: %d", (ch > 0) ? "\r\n" : "", ch, p_buffer[ch]);
+    }
 
-    uint32_t timer_compare_event_addr = nrf_drv_timer_compare_event_address_get(&m_timer, NRF_TIMER_CC_CHANNEL0);
-    uint32_t saadc_sample_event_addr = nrf_drv_saadc_sample_task_get();
+#if NUS_BENCHMARK_ENABLED
+    UNUSED_RETURN_VALUE(nus_tx_queue_put(nus_string, bytes_to_send, m_nus_benchmark.buffer_ticks, size));
+#else
+    UNUSED_RETURN_VALUE(nus_tx_queue_put(nus_string, bytes_to_send, 0, 0));
+#endif
+#endif
 
-    /* setup ppi channel so that timer compare event is triggering sample task in SAADC */
-    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_channel);
-    APP_ERROR_CHECK(err_code);
-    
-    err_code = nrf_drv_ppi_channel_assign(m_ppi_channel, timer_compare_event_addr, saadc_sample_event_addr);
-    APP_ERROR_CHECK(err_code);
+    m_adc_evt_counter++;
+    if ((m_adc_evt_counter % SAADC_ISR_STATS_INTERVAL) == 0)
+    {
+        NRF_LOG_INFO("SAADC ISR max %d us (%s processing), scheduler overflows %d",
+                     m_saadc_isr_cycles_max / (SystemCoreClock / 1000000),
+                     SAADC_DEFERRED_PROCESSING ? "deferred" : "in-ISR",
+                     m_saadc_sched_overflows);
+    }
 }
 
 
-void saadc_sampling_event_enable(void)
+#if SAADC_DEFERRED_PROCESSING
+/**@brief Function for processing a SAADC buffer copy in main context, called from app_sched_execute().
+ */
+static void saadc_buffer_sched_handler(void * p_event_data, uint16_t event_size)
 {
-    ret_code_t err_code = nrf_drv_ppi_channel_enable(m_ppi_channel);
-    APP_ERROR_CHECK(err_code);
+    saadc_sched_evt_t const * p_evt = p_event_data;
+
+    UNUSED_PARAMETER(event_size);
+#if NUS_BENCHMARK_ENABLED
+    m_nus_benchmark.buffer_ticks = p_evt->ticks;
+#endif
+    saadc_buffer_process(p_evt->samples, SAADC_SAMPLES_IN_BUFFER);
 }
+#endif
 
 
 void saadc_callback(nrf_drv_saadc_evt_t const * p_event)
@@ -751,41 +2325,44 @@ void saadc_callback(nrf_drv_saadc_evt_t const * p_event)
     if (p_event->type == NRF_DRV_SAADC_EVT_DONE)
     {
         ret_code_t err_code;
-        uint16_t adc_value;
-        uint8_t value[SAADC_SAMPLES_IN_BUFFER*2];
-        uint16_t bytes_to_send;
-     
+        uint32_t   start_cycles = DWT->CYCCNT;
+
+#if SAADC_DEFERRED_PROCESSING
+        // Post a copy of the samples to main context, where formatting and transmission is done
+        saadc_sched_evt_t evt;
+#if NUS_BENCHMARK_ENABLED
+        evt.ticks = app_timer_cnt_get();
+#endif
+        memcpy(evt.samples, p_event->data.done.p_buffer, sizeof(evt.samples));
+        err_code = app_sched_event_put(&evt, sizeof(evt), saadc_buffer_sched_handler);
+        if (err_code == NRF_ERROR_NO_MEM)
+        {
+            m_saadc_sched_overflows++;
+        }
+        else
+        {
+            APP_ERROR_CHECK(err_code);
+        }
+
+        // set buffers
+        err_code = nrf_drv_saadc_buffer_convert(p_event->data.done.p_buffer, SAADC_SAMPLES_IN_BUFFER);
+        APP_ERROR_CHECK(err_code);
+#else
         // set buffers
         err_code = nrf_drv_saadc_buffer_convert(p_event->data.done.p_buffer, SAADC_SAMPLES_IN_BUFFER);
         APP_ERROR_CHECK(err_code);
-						
-        // print samples on hardware UART and parse data for BLE transmission
-        printf("ADC event number: %d\r\n",(int)m_adc_evt_counter);
-        for (int i = 0; i < SAADC_SAMPLES_IN_BUFFER; i++)
-        {
-            printf("%d\r\n", p_event->data.done.p_buffer[i]);
-
-            adc_value = p_event->data.done.p_buffer[i];
-            value[i*2] = adc_value;
-            value[(i*2)+1] = adc_value >> 8;
-        }
 
-         // Send data over BLE via NUS service. Create string from samples and send string with correct length.
-        uint8_t nus_string[50];
-        bytes_to_send = sprintf(nus_string, 
-                                "CH0: %d\r\nCH1: %d\r\nCH2: %d\r\nCH3: %d",
-                                p_event->data.done.p_buffer[0],
-                                p_event->data.done.p_buffer[1],
-                                p_event->data.done.p_buffer[2],
-                                p_event->data.done.p_buffer[3]);
+#if NUS_BENCHMARK_ENABLED
+        m_nus_benchmark.buffer_ticks = app_timer_cnt_get();
+#endif
+        saadc_buffer_process(p_event->data.done.p_buffer, p_event->data.done.size);
+#endif
 
-        err_code = ble_nus_data_send(&m_nus, nus_string, &bytes_to_send, m_conn_handle);
-        if ((err_code != NRF_ERROR_INVALID_STATE) && (err_code != NRF_ERROR_NOT_FOUND))
+        uint32_t cycles = DWT->CYCCNT - start_cycles;
+        if (cycles > m_saadc_isr_cycles_max)
         {
-            APP_ERROR_CHECK(err_code);
+            m_saadc_isr_cycles_max = cycles;
         }
-	
-        m_adc_evt_counter++;
     }
 }
 
@@ -795,39 +2372,18 @@ void saadc_init(void)
     ret_code_t err_code;
 	
     nrf_drv_saadc_config_t saadc_config = NRF_DRV_SAADC_DEFAULT_CONFIG;
-    saadc_config.resolution = NRF_SAADC_RESOLUTION_12BIT;
-	
-    nrf_saadc_channel_config_t channel_0_config =
-        NRF_DRV_SAADC_DEFAULT_CHANNEL_CONFIG_SE(NRF_SAADC_INPUT_AIN4);
-    channel_0_config.gain = NRF_SAADC_GAIN1_4;
-    channel_0_config.reference = NRF_SAADC_REFERENCE_VDD4;
-	
-    nrf_saadc_channel_config_t channel_1_config =
-        NRF_DRV_SAADC_DEFAULT_CHANNEL_CONFIG_SE(NRF_SAADC_INPUT_AIN5);
-    channel_1_config.gain = NRF_SAADC_GAIN1_4;
-    channel_1_config.reference = NRF_SAADC_REFERENCE_VDD4;
-	
-    nrf_saadc_channel_config_t channel_2_config =
-        NRF_DRV_SAADC_DEFAULT_CHANNEL_CONFIG_SE(NRF_SAADC_INPUT_AIN6);
-    channel_2_config.gain = NRF_SAADC_GAIN1_4;
-    channel_2_config.reference = NRF_SAADC_REFERENCE_VDD4;
-	
-    nrf_saadc_channel_config_t channel_3_config =
-        NRF_DRV_SAADC_DEFAULT_CHANNEL_CONFIG_SE(NRF_SAADC_INPUT_AIN7);
-    channel_3_config.gain = NRF_SAADC_GAIN1_4;
-    channel_3_config.reference = NRF_SAADC_REFERENCE_VDD4;				
+    saadc_config.resolution = SAADC_RESOLUTION;
 	
     err_code = nrf_drv_saadc_init(&saadc_config, saadc_callback);
     APP_ERROR_CHECK(err_code);
 
-    err_code = nrf_drv_saadc_channel_init(0, &channel_0_config);
-    APP_ERROR_CHECK(err_code);
-    err_code = nrf_drv_saadc_channel_init(1, &channel_1_config);
-    APP_ERROR_CHECK(err_code);
-    err_code = nrf_drv_saadc_channel_init(2, &channel_2_config);
-    APP_ERROR_CHECK(err_code);
-    err_code = nrf_drv_saadc_channel_init(3, &channel_3_config);
-    APP_ERROR_CHECK(err_code);	
+    // The channel configurations are generated from SAADC_CHANNEL_TABLE at build time
+    for (uint8_t ch = 0; ch < SAADC_SAMPLES_IN_BUFFER; ch++)
+    {
+        err_code = nrf_drv_saadc_channel_init(ch, &m_channel_configs[ch]);
+        APP_ERROR_CHECK(err_code);
+        saadc_convert_init(&m_convert[ch], &m_channel_configs[ch], SAADC_RESOLUTION, SAADC_VDD_MV, SAADC_CONVERT_UNIT_MV);
+    }
 
     err_code = nrf_drv_saadc_buffer_convert(m_buffer_pool[0],SAADC_SAMPLES_IN_BUFFER);
     APP_ERROR_CHECK(err_code);   
@@ -845,9 +2401,23 @@ int main(void)
     uart_init();
     log_init();
     timers_init();
+    APP_SCHED_INIT(SCHED_MAX_EVENT_DATA_SIZE, SCHED_QUEUE_SIZE);
+    cycle_counter_init();
+#if SAADC_COV_FILTER_ENABLED
+    cov_filter_init(m_cov, SAADC_SAMPLES_IN_BUFFER);
+#endif
     buttons_leds_init(&erase_bonds);
     power_management_init();
     ble_stack_init();
+#if SAADC_USER_CAL_ENABLED
+    cal_init();
+#if CAL_BENCHMARK_ENABLED
+    cal_benchmark();
+#endif
+#endif
+#if NUS_PACK_BENCHMARK_ENABLED
+    nus_pack_benchmark();
+#endif
     gap_params_init();
     gatt_init();
     services_init();
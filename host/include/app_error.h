@@ -0,0 +1,42 @@
+/**
+ * Host build: error handling. A failed check ends the simulation with the location of the check.
+ */
+#ifndef APP_ERROR_H__
+#define APP_ERROR_H__
+
+#include <stdint.h>
+#include "nrf_host_sim.h"
+#include "sdk_errors.h"
+
+#define APP_ERROR_HANDLER(ERR_CODE) sim_error((ERR_CODE), __LINE__, __FILE__)
+
+#define APP_ERROR_CHECK(ERR_CODE)                           \
+    do                                                      \
+    {                                                       \
+        const uint32_t LOCAL_ERR_CODE = (ERR_CODE);         \
+        if (LOCAL_ERR_CODE != NRF_SUCCESS)                  \
+        {                                                   \
+            APP_ERROR_HANDLER(LOCAL_ERR_CODE);              \
+        }                                                   \
+    } while (0)
+
+#define APP_ERROR_CHECK_BOOL(BOOLEAN_VALUE)                 \
+    do                                                      \
+    {                                                       \
+        if (!(BOOLEAN_VALUE))                               \
+        {                                                   \
+            APP_ERROR_HANDLER(0);                           \
+        }                                                   \
+    } while (0)
+
+static inline void app_error_handler(ret_code_t error_code, uint32_t line_num, const uint8_t * p_file_name)
+{
+    sim_error(error_code, line_num, (char const *)p_file_name);
+}
+
+static inline void app_error_handler_bare(ret_code_t error_code)
+{
+    sim_error(error_code, 0, "(bare)");
+}
+
+#endif // APP_ERROR_H__
@@ -0,0 +1,48 @@
+/**
+ * Host build: event scheduler, the queue of the SDK library with the same error codes.
+ */
+#ifndef APP_SCHEDULER_H__
+#define APP_SCHEDULER_H__
+
+#include <stdint.h>
+#include "app_error.h"
+#include "app_util.h"
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (* app_sched_event_handler_t)(void * p_event_data, uint16_t event_size);
+
+typedef struct
+{
+    app_sched_event_handler_t handler;
+    uint16_t                  event_data_size;
+} app_sched_event_header_t;
+
+#define APP_SCHED_EVENT_HEADER_SIZE sizeof(app_sched_event_header_t)
+
+#define APP_SCHED_BUF_SIZE(EVENT_SIZE, QUEUE_SIZE) \
+    (((EVENT_SIZE) + APP_SCHED_EVENT_HEADER_SIZE) * ((QUEUE_SIZE) + 1))
+
+#define APP_SCHED_INIT(EVENT_SIZE, QUEUE_SIZE)                                                      \
+    do                                                                                              \
+    {                                                                                               \
+        static uint32_t APP_SCHED_BUF[CEIL_DIV(APP_SCHED_BUF_SIZE((EVENT_SIZE), (QUEUE_SIZE)),     \
+                                               sizeof(uint32_t))];                                  \
+        uint32_t ERR_CODE = app_sched_init((EVENT_SIZE), (QUEUE_SIZE), APP_SCHED_BUF);             \
+        APP_ERROR_CHECK(ERR_CODE);                                                                  \
+    } while (0)
+
+uint32_t app_sched_init(uint16_t max_event_size, uint16_t queue_size, void * p_evt_buffer);
+uint32_t app_sched_event_put(void const * p_event_data, uint16_t event_size, app_sched_event_handler_t handler);
+void     app_sched_execute(void);
+uint16_t app_sched_queue_space_get(void);
+uint16_t app_sched_queue_utilization_get(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // APP_SCHEDULER_H__
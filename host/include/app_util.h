@@ -0,0 +1,54 @@
+/**
+ * Host build: utility macros.
+ */
+#ifndef APP_UTIL_H__
+#define APP_UTIL_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf.h"
+
+// STATIC_ASSERT(expr) or STATIC_ASSERT(expr, "message")
+#define STATIC_ASSERT(...)            STATIC_ASSERT_(__VA_ARGS__, "static assertion failed", 0)
+#define STATIC_ASSERT_(EXPR, MSG, ...) _Static_assert(EXPR, MSG)
+
+#define ROUNDED_DIV(A, B) (((A) + ((B) / 2)) / (B))
+#define CEIL_DIV(A, B)    (((A) + (B) - 1) / (B))
+#define ALIGN_NUM(alignment, number) (((number) - 1) + (alignment) - (((number) - 1) % (alignment)))
+#define IS_POWER_OF_TWO(A) (((A) != 0) && ((((A) - 1) & (A)) == 0))
+#define BYTES_TO_WORDS(n_bytes) (((n_bytes) + 3) >> 2)
+
+#define MSEC_TO_UNITS(TIME, RESOLUTION) (((TIME) * 1000) / (RESOLUTION))
+
+enum
+{
+    UNIT_0_625_MS = 625,
+    UNIT_1_25_MS  = 1250,
+    UNIT_10_MS    = 10000
+};
+
+static inline uint8_t uint16_encode(uint16_t value, uint8_t * p_encoded_data)
+{
+    p_encoded_data[0] = (uint8_t) ((value & 0x00FF) >> 0);
+    p_encoded_data[1] = (uint8_t) ((value & 0xFF00) >> 8);
+    return sizeof(uint16_t);
+}
+
+static inline uint16_t uint16_decode(const uint8_t * p_encoded_data)
+{
+    return ((((uint16_t)((uint8_t *)p_encoded_data)[0])) |
+            (((uint16_t)((uint8_t *)p_encoded_data)[1]) << 8 ));
+}
+
+static inline uint8_t uint32_encode(uint32_t value, uint8_t * p_encoded_data)
+{
+    p_encoded_data[0] = (uint8_t) ((value & 0x000000FF) >> 0);
+    p_encoded_data[1] = (uint8_t) ((value & 0x0000FF00) >> 8);
+    p_encoded_data[2] = (uint8_t) ((value & 0x00FF0000) >> 16);
+    p_encoded_data[3] = (uint8_t) ((value & 0xFF000000) >> 24);
+    return sizeof(uint32_t);
+}
+
+#endif // APP_UTIL_H__
@@ -0,0 +1,40 @@
+/**
+ * Host build: interrupt priorities and critical regions.
+ *
+ * A critical region defers the simulated interrupts until it is left, as masking them on the target would.
+ */
+#ifndef APP_UTIL_PLATFORM_H__
+#define APP_UTIL_PLATFORM_H__
+
+#include <stdint.h>
+#include "nrf.h"
+#include "nrf_host_sim.h"
+#include "app_util.h"
+#include "app_error.h"
+
+typedef enum
+{
+    APP_IRQ_PRIORITY_HIGHEST = 0,
+    APP_IRQ_PRIORITY_HIGH    = 2,
+    APP_IRQ_PRIORITY_MID     = 4,
+    APP_IRQ_PRIORITY_LOW     = 6,
+    APP_IRQ_PRIORITY_LOWEST  = 7,
+    APP_IRQ_PRIORITY_THREAD  = 15
+} app_irq_priority_t;
+
+#define CRITICAL_REGION_ENTER() { sim_critical_enter();
+#define CRITICAL_REGION_EXIT()    sim_critical_exit(); }
+
+static inline void app_util_critical_region_enter(uint8_t * p_nested)
+{
+    (void)p_nested;
+    sim_critical_enter();
+}
+
+static inline void app_util_critical_region_exit(uint8_t nested)
+{
+    (void)nested;
+    sim_critical_exit();
+}
+
+#endif // APP_UTIL_PLATFORM_H__
@@ -0,0 +1,225 @@
+/**
+ * Host build: SoftDevice BLE API, the parts of ble.h, ble_gap.h, ble_gatt.h, ble_gattc.h and ble_gatts.h used by the
+ * examples and the library stubs.
+ *
+ * The SoftDevice is replaced by a model of one peripheral link to a virtual central, see sim/softdevice.c. Events are
+ * passed to the NRF_SDH_BLE_OBSERVER observers from the SoftDevice event interrupt, as with NRF_SDH_DISPATCH_MODEL 0.
+ */
+#ifndef BLE_H__
+#define BLE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "nrf_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLE_CONN_HANDLE_INVALID   0xFFFF
+#define BLE_GATT_HANDLE_INVALID   0x0000
+#define BLE_GATT_ATT_MTU_DEFAULT  23
+#define BLE_GATTS_VAR_ATTR_LEN_MAX 512
+
+#define BLE_UUID_TYPE_UNKNOWN      0x00
+#define BLE_UUID_TYPE_BLE          0x01
+#define BLE_UUID_TYPE_VENDOR_BEGIN 0x02
+
+#define BLE_GATT_HVX_NOTIFICATION  0x01
+#define BLE_GATT_HVX_INDICATION    0x02
+
+#define BLE_GAP_ADV_FLAG_LE_LIMITED_DISC_MODE     0x01
+#define BLE_GAP_ADV_FLAG_BR_EDR_NOT_SUPPORTED     0x04
+#define BLE_GAP_ADV_FLAGS_LE_ONLY_LIMITED_DISC_MODE (BLE_GAP_ADV_FLAG_LE_LIMITED_DISC_MODE | \
+                                                     BLE_GAP_ADV_FLAG_BR_EDR_NOT_SUPPORTED)
+
+#define BLE_GAP_PHY_AUTO                      0x00
+#define BLE_GAP_PHY_1MBPS                     0x01
+#define BLE_GAP_PHY_2MBPS                     0x02
+#define BLE_GAP_SEC_STATUS_PAIRING_NOT_SUPP   0x85
+#define BLE_GAP_ADV_SET_HANDLE_NOT_SET        0xFF
+
+enum
+{
+    BLE_GAP_EVT_CONNECTED              = 0x10,
+    BLE_GAP_EVT_DISCONNECTED           = 0x11,
+    BLE_GAP_EVT_CONN_PARAM_UPDATE      = 0x12,
+    BLE_GAP_EVT_SEC_PARAMS_REQUEST     = 0x13,
+    BLE_GAP_EVT_PHY_UPDATE_REQUEST     = 0x21,
+    BLE_GAP_EVT_PHY_UPDATE             = 0x22,
+    BLE_GAP_EVT_ADV_SET_TERMINATED     = 0x26,
+    BLE_GATTC_EVT_EXCHANGE_MTU_RSP     = 0x3A,
+    BLE_GATTC_EVT_TIMEOUT              = 0x3B,
+    BLE_GATTS_EVT_WRITE                = 0x50,
+    BLE_GATTS_EVT_SYS_ATTR_MISSING     = 0x52,
+    BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST = 0x55,
+    BLE_GATTS_EVT_TIMEOUT              = 0x56,
+    BLE_GATTS_EVT_HVN_TX_COMPLETE      = 0x57,
+};
+
+#define BLE_GAP_EVT_ADV_SET_TERMINATED_REASON_TIMEOUT 0x01
+
+typedef struct
+{
+    uint16_t uuid;
+    uint8_t  type;
+} ble_uuid_t;
+
+typedef struct
+{
+    uint8_t uuid128[16];
+} ble_uuid128_t;
+
+typedef struct
+{
+    uint8_t sm : 4;
+    uint8_t lv : 4;
+} ble_gap_conn_sec_mode_t;
+
+#define BLE_GAP_CONN_SEC_MODE_SET_OPEN(ptr) do { (ptr)->sm = 1; (ptr)->lv = 1; } while (0)
+
+typedef struct
+{
+    uint16_t min_conn_interval;     // 1.25 ms units
+    uint16_t max_conn_interval;     // 1.25 ms units
+    uint16_t slave_latency;
+    uint16_t conn_sup_timeout;      // 10 ms units
+} ble_gap_conn_params_t;
+
+typedef struct
+{
+    uint8_t tx_phys;
+    uint8_t rx_phys;
+} ble_gap_phys_t;
+
+typedef struct
+{
+    uint16_t value_handle;
+    uint16_t user_desc_handle;
+    uint16_t cccd_handle;
+    uint16_t sccd_handle;
+} ble_gatts_char_handles_t;
+
+typedef struct
+{
+    uint16_t        handle;
+    uint8_t         type;
+    uint16_t        offset;
+    uint16_t *      p_len;
+    uint8_t const * p_data;
+} ble_gatts_hvx_params_t;
+
+typedef struct
+{
+    ble_gap_conn_params_t conn_params;
+} ble_gap_evt_connected_t;
+
+typedef struct
+{
+    uint8_t reason;
+} ble_gap_evt_disconnected_t;
+
+typedef struct
+{
+    uint8_t reason;
+    uint8_t adv_handle;
+} ble_gap_evt_adv_set_terminated_t;
+
+typedef struct
+{
+    uint16_t conn_handle;
+    union
+    {
+        ble_gap_evt_connected_t          connected;
+        ble_gap_evt_disconnected_t       disconnected;
+        ble_gap_evt_adv_set_terminated_t adv_set_terminated;
+        ble_gap_phys_t                   phy_update_request;
+    } params;
+} ble_gap_evt_t;
+
+typedef struct
+{
+    uint16_t server_rx_mtu;
+} ble_gattc_evt_exchange_mtu_rsp_t;
+
+typedef struct
+{
+    uint16_t conn_handle;
+    uint16_t gatt_status;
+    uint16_t error_handle;
+    union
+    {
+        ble_gattc_evt_exchange_mtu_rsp_t exchange_mtu_rsp;
+    } params;
+} ble_gattc_evt_t;
+
+typedef struct
+{
+    uint16_t   handle;
+    ble_uuid_t uuid;
+    uint8_t    op;
+    uint8_t    auth_required;
+    uint16_t   offset;
+    uint16_t   len;
+    uint8_t    data[BLE_GATTS_VAR_ATTR_LEN_MAX];    // Variable length in the SoftDevice
+} ble_gatts_evt_write_t;
+
+typedef struct
+{
+    uint8_t count;
+} ble_gatts_evt_hvn_tx_complete_t;
+
+typedef struct
+{
+    uint16_t client_rx_mtu;
+} ble_gatts_evt_exchange_mtu_request_t;
+
+typedef struct
+{
+    uint16_t conn_handle;
+    union
+    {
+        ble_gatts_evt_write_t                write;
+        ble_gatts_evt_hvn_tx_complete_t      hvn_tx_complete;
+        ble_gatts_evt_exchange_mtu_request_t exchange_mtu_request;
+    } params;
+} ble_gatts_evt_t;
+
+typedef struct
+{
+    uint16_t evt_id;
+    uint16_t evt_len;
+} ble_evt_hdr_t;
+
+typedef struct
+{
+    ble_evt_hdr_t header;
+    union
+    {
+        ble_gap_evt_t   gap_evt;
+        ble_gattc_evt_t gattc_evt;
+        ble_gatts_evt_t gatts_evt;
+    } evt;
+} ble_evt_t;
+
+uint32_t sd_ble_gap_device_name_set(ble_gap_conn_sec_mode_t const * p_write_perm,
+                                    uint8_t const *                 p_dev_name,
+                                    uint16_t                        len);
+uint32_t sd_ble_gap_ppcp_set(ble_gap_conn_params_t const * p_conn_params);
+uint32_t sd_ble_gap_disconnect(uint16_t conn_handle, uint8_t hci_status_code);
+uint32_t sd_ble_gap_phy_update(uint16_t conn_handle, ble_gap_phys_t const * p_gap_phys);
+uint32_t sd_ble_gap_sec_params_reply(uint16_t     conn_handle,
+                                     uint8_t      sec_status,
+                                     void const * p_sec_params,
+                                     void const * p_sec_keyset);
+uint32_t sd_ble_gatts_sys_attr_set(uint16_t conn_handle, uint8_t const * p_sys_attr_data, uint16_t len, uint32_t flags);
+uint32_t sd_ble_gatts_hvx(uint16_t conn_handle, ble_gatts_hvx_params_t const * p_hvx_params);
+uint32_t sd_ble_gatts_exchange_mtu_reply(uint16_t conn_handle, uint16_t server_rx_mtu);
+uint32_t sd_ble_gattc_exchange_mtu_request(uint16_t conn_handle, uint16_t client_rx_mtu);
+uint32_t sd_ble_uuid_vs_add(ble_uuid128_t const * p_vs_uuid, uint8_t * p_uuid_type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BLE_H__
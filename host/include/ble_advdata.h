@@ -0,0 +1,36 @@
+/**
+ * Host build: advertising data. The data is not encoded, the virtual central connects without scanning.
+ */
+#ifndef BLE_ADVDATA_H__
+#define BLE_ADVDATA_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ble.h"
+
+typedef enum
+{
+    BLE_ADVDATA_NO_NAME,
+    BLE_ADVDATA_SHORT_NAME,
+    BLE_ADVDATA_FULL_NAME,
+} ble_advdata_name_type_t;
+
+typedef struct
+{
+    uint16_t     uuid_cnt;
+    ble_uuid_t * p_uuids;
+} ble_advdata_uuid_list_t;
+
+typedef struct
+{
+    ble_advdata_name_type_t name_type;
+    uint8_t                 short_name_len;
+    bool                    include_appearance;
+    uint8_t                 flags;
+    int8_t *                p_tx_power_level;
+    ble_advdata_uuid_list_t uuids_more_available;
+    ble_advdata_uuid_list_t uuids_complete;
+    ble_advdata_uuid_list_t uuids_solicited;
+} ble_advdata_t;
+
+#endif // BLE_ADVDATA_H__
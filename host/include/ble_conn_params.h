@@ -0,0 +1,46 @@
+/**
+ * Host build: Connection Parameters module. The virtual central uses HOST_SIM_BLE_CONN_INTERVAL_MS and never
+ * rejects it, so no update is negotiated.
+ */
+#ifndef BLE_CONN_PARAMS_H__
+#define BLE_CONN_PARAMS_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ble.h"
+#include "sdk_errors.h"
+
+typedef enum
+{
+    BLE_CONN_PARAMS_EVT_FAILED,
+    BLE_CONN_PARAMS_EVT_SUCCEEDED,
+} ble_conn_params_evt_type_t;
+
+typedef struct
+{
+    ble_conn_params_evt_type_t evt_type;
+    uint16_t                   conn_handle;
+} ble_conn_params_evt_t;
+
+typedef void (* ble_conn_params_evt_handler_t)(ble_conn_params_evt_t * p_evt);
+typedef void (* ble_srv_error_handler_t)(uint32_t nrf_error);
+
+typedef struct
+{
+    ble_gap_conn_params_t *       p_conn_params;
+    uint32_t                      first_conn_params_update_delay;
+    uint32_t                      next_conn_params_update_delay;
+    uint8_t                       max_conn_params_update_count;
+    uint16_t                      start_on_notify_cccd_handle;
+    bool                          disconnect_on_fail;
+    ble_conn_params_evt_handler_t evt_handler;
+    ble_srv_error_handler_t       error_handler;
+} ble_conn_params_init_t;
+
+static inline uint32_t ble_conn_params_init(ble_conn_params_init_t const * p_init)
+{
+    (void)p_init;
+    return NRF_SUCCESS;
+}
+
+#endif // BLE_CONN_PARAMS_H__
@@ -0,0 +1,95 @@
+/**
+ * Host build: Nordic UART Service for one link.
+ *
+ * ble_nus_init() adds the RX and TX characteristics to the GATT table of the SoftDevice model, where the virtual
+ * central enables the TX notifications and writes to RX, see sim/softdevice.c.
+ */
+#ifndef BLE_NUS_H__
+#define BLE_NUS_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ble.h"
+#include "ble_srv_common.h"
+#include "nrf_sdh_ble.h"
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef BLE_NUS_BLE_OBSERVER_PRIO
+#define BLE_NUS_BLE_OBSERVER_PRIO 2
+#endif
+
+#define BLE_UUID_NUS_SERVICE           0x0001
+#define BLE_UUID_NUS_RX_CHARACTERISTIC 0x0002
+#define BLE_UUID_NUS_TX_CHARACTERISTIC 0x0003
+
+#define BLE_NUS_MAX_DATA_LEN (NRF_SDH_BLE_GATT_MAX_MTU_SIZE - OPCODE_LENGTH - HANDLE_LENGTH)
+
+#define BLE_NUS_DEF(_name, _nus_max_clients)                                                    \
+    STATIC_ASSERT((_nus_max_clients) == 1, "The host build models one link");                  \
+    static ble_nus_t _name;                                                                     \
+    NRF_SDH_BLE_OBSERVER(_name ## _obs, BLE_NUS_BLE_OBSERVER_PRIO, ble_nus_on_ble_evt, &_name)
+
+typedef enum
+{
+    BLE_NUS_EVT_RX_DATA,
+    BLE_NUS_EVT_TX_RDY,
+    BLE_NUS_EVT_COMM_STARTED,
+    BLE_NUS_EVT_COMM_STOPPED,
+} ble_nus_evt_type_t;
+
+typedef struct ble_nus_s ble_nus_t;
+
+typedef struct
+{
+    uint8_t const * p_data;
+    uint16_t        length;
+} ble_nus_evt_rx_data_t;
+
+typedef struct
+{
+    bool is_notification_enabled;
+} ble_nus_client_context_t;
+
+typedef struct
+{
+    ble_nus_evt_type_t         type;
+    ble_nus_t                * p_nus;
+    uint16_t                   conn_handle;
+    ble_nus_client_context_t * p_link_ctx;
+    union
+    {
+        ble_nus_evt_rx_data_t rx_data;
+    } params;
+} ble_nus_evt_t;
+
+typedef void (* ble_nus_data_handler_t)(ble_nus_evt_t * p_evt);
+
+typedef struct
+{
+    ble_nus_data_handler_t data_handler;
+} ble_nus_init_t;
+
+struct ble_nus_s
+{
+    uint8_t                  uuid_type;
+    uint16_t                 service_handle;
+    ble_gatts_char_handles_t tx_handles;
+    ble_gatts_char_handles_t rx_handles;
+    uint16_t                 conn_handle;
+    ble_nus_client_context_t link_ctx;
+    ble_nus_data_handler_t   data_handler;
+};
+
+uint32_t ble_nus_init(ble_nus_t * p_nus, ble_nus_init_t const * p_nus_init);
+void     ble_nus_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
+uint32_t ble_nus_data_send(ble_nus_t * p_nus, uint8_t * p_data, uint16_t * p_length, uint16_t conn_handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BLE_NUS_H__
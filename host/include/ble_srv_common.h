@@ -0,0 +1,21 @@
+/**
+ * Host build: common definitions of the BLE services.
+ */
+#ifndef BLE_SRV_COMMON_H__
+#define BLE_SRV_COMMON_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ble.h"
+
+#define OPCODE_LENGTH 1     // Length of the ATT opcode
+#define HANDLE_LENGTH 2     // Length of the attribute handle
+
+#define BLE_GATT_HVX_CCCD_NOTIFICATION 0x0001
+
+static inline bool ble_srv_is_notification_enabled(uint8_t const * p_encoded_data)
+{
+    return ((p_encoded_data[0] | (p_encoded_data[1] << 8)) & BLE_GATT_HVX_CCCD_NOTIFICATION) != 0;
+}
+
+#endif // BLE_SRV_COMMON_H__
@@ -0,0 +1,38 @@
+/**
+ * Host build: PCA10040 board definitions. LEDs are not simulated.
+ */
+#ifndef BOARDS_H__
+#define BOARDS_H__
+
+#include <stdint.h>
+
+#define LEDS_NUMBER    4
+
+#define LED_1          17
+#define LED_2          18
+#define LED_3          19
+#define LED_4          20
+
+#define BSP_LED_0      LED_1
+#define BSP_LED_1      LED_2
+#define BSP_LED_2      LED_3
+#define BSP_LED_3      LED_4
+
+#define BSP_LED_0_MASK (1UL << BSP_LED_0)
+#define BSP_LED_1_MASK (1UL << BSP_LED_1)
+#define BSP_LED_2_MASK (1UL << BSP_LED_2)
+#define BSP_LED_3_MASK (1UL << BSP_LED_3)
+
+#define LEDS_MASK      (BSP_LED_0_MASK | BSP_LED_1_MASK | BSP_LED_2_MASK | BSP_LED_3_MASK)
+
+#define LEDS_CONFIGURE(leds_mask) ((void)(leds_mask))
+#define LEDS_OFF(leds_mask)       ((void)(leds_mask))
+#define LEDS_ON(leds_mask)        ((void)(leds_mask))
+#define LEDS_INVERT(leds_mask)    ((void)(leds_mask))
+
+#define RX_PIN_NUMBER  8
+#define TX_PIN_NUMBER  6
+#define CTS_PIN_NUMBER 7
+#define RTS_PIN_NUMBER 5
+
+#endif // BOARDS_H__
@@ -0,0 +1,77 @@
+/**
+ * Host build: board support package. LEDs and buttons are not simulated, no button events are generated.
+ */
+#ifndef BSP_H__
+#define BSP_H__
+
+#include <stdint.h>
+#include "boards.h"
+#include "sdk_errors.h"
+
+#define BSP_INIT_NONE    0
+#define BSP_INIT_LEDS    (1 << 0)
+#define BSP_INIT_BUTTONS (1 << 1)
+
+typedef enum
+{
+    BSP_EVENT_NOTHING = 0,
+    BSP_EVENT_DEFAULT,
+    BSP_EVENT_CLEAR_BONDING_DATA,
+    BSP_EVENT_CLEAR_ALERT,
+    BSP_EVENT_DISCONNECT,
+    BSP_EVENT_ADVERTISING_START,
+    BSP_EVENT_ADVERTISING_STOP,
+    BSP_EVENT_WHITELIST_OFF,
+    BSP_EVENT_BOND,
+    BSP_EVENT_RESET,
+    BSP_EVENT_SLEEP,
+    BSP_EVENT_WAKEUP,
+    BSP_EVENT_SYSOFF,
+    BSP_EVENT_DFU,
+} bsp_event_t;
+
+typedef enum
+{
+    BSP_INDICATE_FIRST = 0,
+    BSP_INDICATE_IDLE  = BSP_INDICATE_FIRST,
+    BSP_INDICATE_SCANNING,
+    BSP_INDICATE_ADVERTISING,
+    BSP_INDICATE_ADVERTISING_WHITELIST,
+    BSP_INDICATE_ADVERTISING_SLOW,
+    BSP_INDICATE_ADVERTISING_DIRECTED,
+    BSP_INDICATE_BONDING,
+    BSP_INDICATE_CONNECTED,
+    BSP_INDICATE_SENT_OK,
+    BSP_INDICATE_SEND_ERROR,
+    BSP_INDICATE_RCV_OK,
+    BSP_INDICATE_RCV_ERROR,
+    BSP_INDICATE_FATAL_ERROR,
+    BSP_INDICATE_ALERT_0,
+    BSP_INDICATE_ALERT_1,
+    BSP_INDICATE_ALERT_2,
+    BSP_INDICATE_ALERT_3,
+    BSP_INDICATE_ALERT_OFF,
+    BSP_INDICATE_USER_STATE_OFF,
+    BSP_INDICATE_USER_STATE_0,
+    BSP_INDICATE_USER_STATE_1,
+    BSP_INDICATE_USER_STATE_2,
+    BSP_INDICATE_USER_STATE_3,
+    BSP_INDICATE_USER_STATE_ON,
+} bsp_indication_t;
+
+typedef void (* bsp_event_callback_t)(bsp_event_t);
+
+static inline uint32_t bsp_init(uint32_t type, bsp_event_callback_t callback)
+{
+    (void)type;
+    (void)callback;
+    return NRF_SUCCESS;
+}
+
+static inline uint32_t bsp_indication_set(bsp_indication_t indicate)
+{
+    (void)indicate;
+    return NRF_SUCCESS;
+}
+
+#endif // BSP_H__
@@ -0,0 +1,28 @@
+/**
+ * Host build: BLE button handling of the board support package.
+ */
+#ifndef BSP_BTN_BLE_H__
+#define BSP_BTN_BLE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "bsp.h"
+
+typedef void (* bsp_btn_ble_error_handler_t)(uint32_t nrf_error);
+
+static inline uint32_t bsp_btn_ble_init(bsp_btn_ble_error_handler_t error_handler, bsp_event_t * p_startup_bsp_evt)
+{
+    (void)error_handler;
+    if (p_startup_bsp_evt != NULL)
+    {
+        *p_startup_bsp_evt = BSP_EVENT_NOTHING;
+    }
+    return NRF_SUCCESS;
+}
+
+static inline uint32_t bsp_btn_ble_sleep_mode_prepare(void)
+{
+    return NRF_SUCCESS;
+}
+
+#endif // BSP_BTN_BLE_H__
@@ -0,0 +1,147 @@
+/**
+ * Host build: Flash Data Storage.
+ *
+ * Records are kept in RAM with the flash layout of the SDK: FDS_VIRTUAL_PAGES pages of FDS_VIRTUAL_PAGE_SIZE words,
+ * one of them the swap page for garbage collection, and a three word header per record. Updated and deleted records
+ * keep their space until fds_gc(). Operations are queued, FDS_OP_QUEUE_SIZE at most, and complete one after the
+ * other on the SoftDevice flash event, HOST_SIM_FDS_OP_MS each.
+ */
+#ifndef FDS_H__
+#define FDS_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Defaults of pca10040/s132/config/sdk_config.h
+#ifndef FDS_VIRTUAL_PAGES
+#define FDS_VIRTUAL_PAGES 3
+#endif
+#ifndef FDS_VIRTUAL_PAGE_SIZE
+#define FDS_VIRTUAL_PAGE_SIZE 1024
+#endif
+#ifndef FDS_OP_QUEUE_SIZE
+#define FDS_OP_QUEUE_SIZE 4
+#endif
+#ifndef FDS_MAX_USERS
+#define FDS_MAX_USERS 4
+#endif
+
+#define FDS_FILE_ID_INVALID   0xFFFF
+#define FDS_RECORD_KEY_DIRTY  0x0000
+
+#define NRF_ERROR_FDS_ERR_BASE 0x8600
+
+enum
+{
+    FDS_ERR_OPERATION_TIMEOUT = NRF_ERROR_FDS_ERR_BASE,
+    FDS_ERR_NOT_INITIALIZED,
+    FDS_ERR_UNALIGNED_ADDR,
+    FDS_ERR_INVALID_ARG,
+    FDS_ERR_NULL_ARG,
+    FDS_ERR_NO_OPEN_RECORDS,
+    FDS_ERR_NO_SPACE_IN_FLASH,
+    FDS_ERR_NO_SPACE_IN_QUEUES,
+    FDS_ERR_RECORD_TOO_LARGE,
+    FDS_ERR_NOT_FOUND,
+    FDS_ERR_NO_PAGES,
+    FDS_ERR_USER_LIMIT_REACHED,
+    FDS_ERR_CRC_CHECK_FAILED,
+    FDS_ERR_BUSY,
+    FDS_ERR_INTERNAL,
+};
+
+typedef struct
+{
+    uint16_t record_key;
+    uint16_t length_words;
+    uint16_t file_id;
+    uint16_t crc16;
+    uint32_t record_id;
+} fds_header_t;
+
+typedef struct
+{
+    uint32_t             record_id;
+    uint32_t const *     p_record;
+    uint16_t             gc_run_count;
+    bool                 record_is_open;
+} fds_record_desc_t;
+
+typedef struct
+{
+    fds_header_t const * p_header;
+    void const *         p_data;
+} fds_flash_record_t;
+
+typedef struct
+{
+    uint16_t file_id;
+    uint16_t key;
+    struct
+    {
+        void const * p_data;
+        uint32_t     length_words;
+    } data;
+} fds_record_t;
+
+typedef struct
+{
+    uint32_t const * p_addr;
+    uint16_t         page;
+} fds_find_token_t;
+
+typedef enum
+{
+    FDS_EVT_INIT,
+    FDS_EVT_WRITE,
+    FDS_EVT_UPDATE,
+    FDS_EVT_DEL_RECORD,
+    FDS_EVT_DEL_FILE,
+    FDS_EVT_GC,
+} fds_evt_id_t;
+
+typedef struct
+{
+    fds_evt_id_t id;
+    ret_code_t   result;
+    union
+    {
+        struct
+        {
+            uint32_t record_id;
+            uint16_t file_id;
+            uint16_t record_key;
+            bool     is_record_updated;
+        } write;
+        struct
+        {
+            uint32_t record_id;
+            uint16_t file_id;
+            uint16_t record_key;
+        } del;
+    };
+} fds_evt_t;
+
+typedef void (* fds_cb_t)(fds_evt_t const * p_evt);
+
+ret_code_t fds_register(fds_cb_t cb);
+ret_code_t fds_init(void);
+ret_code_t fds_record_write(fds_record_desc_t * p_desc, fds_record_t const * p_record);
+ret_code_t fds_record_update(fds_record_desc_t * p_desc, fds_record_t const * p_record);
+ret_code_t fds_record_delete(fds_record_desc_t * p_desc);
+ret_code_t fds_file_delete(uint16_t file_id);
+ret_code_t fds_gc(void);
+ret_code_t fds_record_find(uint16_t file_id, uint16_t record_key, fds_record_desc_t * p_desc, fds_find_token_t * p_token);
+ret_code_t fds_record_open(fds_record_desc_t * p_desc, fds_flash_record_t * p_flash_record);
+ret_code_t fds_record_close(fds_record_desc_t * p_desc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FDS_H__
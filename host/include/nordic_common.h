@@ -0,0 +1,36 @@
+/**
+ * Host build: common macros.
+ */
+#ifndef NORDIC_COMMON_H__
+#define NORDIC_COMMON_H__
+
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) < (b) ? (b) : (a))
+#endif
+
+#define CONCAT_2(p1, p2)      CONCAT_2_(p1, p2)
+#define CONCAT_2_(p1, p2)     p1##p2
+#define CONCAT_3(p1, p2, p3)  CONCAT_3_(p1, p2, p3)
+#define CONCAT_3_(p1, p2, p3) p1##p2##p3
+
+#define STRINGIFY_(val) #val
+#define STRINGIFY(val)  STRINGIFY_(val)
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+#define UNUSED_VARIABLE(X)     ((void)(X))
+#define UNUSED_PARAMETER(X)    UNUSED_VARIABLE(X)
+#define UNUSED_RETURN_VALUE(X) UNUSED_VARIABLE(X)
+
+#define BIT_0 0x01
+#define BIT_1 0x02
+#define BIT_2 0x04
+#define BIT_3 0x08
+
+#define MSB_16(a) (((a) & 0xFF00) >> 8)
+#define LSB_16(a) ((a) & 0x00FF)
+
+#endif // NORDIC_COMMON_H__
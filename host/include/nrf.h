@@ -0,0 +1,301 @@
+/**
+ * Host build: nRF52832 device header.
+ *
+ * Register blocks use the offsets of the real device, and the peripherals live at their real addresses (the
+ * simulator maps the APB region at startup), so raw register accesses in the examples work unchanged. Only the
+ * registers the examples and the mocked drivers touch are named, the rest is padding.
+ */
+#ifndef NRF_H__
+#define NRF_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NRF52
+#define NRF52832_XXAA
+
+// nRF52832 feature flags, as in nrf52832_peripherals.h
+#define UART_PRESENT
+#define UARTE_PRESENT
+
+#ifndef __IOM
+#define __IOM volatile
+#endif
+#ifndef __IM
+#define __IM  volatile const
+#endif
+#ifndef __OM
+#define __OM  volatile
+#endif
+
+#define __INLINE        inline
+#define __STATIC_INLINE static inline
+#ifndef __ALIGN
+#define __ALIGN(n)      __attribute__((aligned(n)))
+#endif
+#ifndef __WEAK
+#define __WEAK          __attribute__((weak))
+#endif
+
+typedef enum
+{
+    POWER_CLOCK_IRQn = 0,
+    UARTE0_UART0_IRQn = 2,
+    SAADC_IRQn       = 7,
+    TIMER0_IRQn      = 8,
+    TIMER1_IRQn      = 9,
+    TIMER2_IRQn      = 10,
+    RTC0_IRQn        = 11,
+    TEMP_IRQn        = 12,
+    RTC1_IRQn        = 17,
+    SWI0_EGU0_IRQn   = 20,
+    SWI1_EGU1_IRQn   = 21,
+    SWI2_EGU2_IRQn   = 22,
+    TIMER3_IRQn      = 26,
+    TIMER4_IRQn      = 27,
+    RTC2_IRQn        = 36,
+} IRQn_Type;
+
+#define SAADC_CH_NUM 8
+
+typedef struct
+{
+    __IOM uint32_t LIMITH;
+    __IOM uint32_t LIMITL;
+} SAADC_EVENTS_CH_Type;
+
+typedef struct
+{
+    __IOM uint32_t PSELP;
+    __IOM uint32_t PSELN;
+    __IOM uint32_t CONFIG;
+    __IOM uint32_t LIMIT;
+} SAADC_CH_Type;
+
+typedef struct
+{
+    __IOM uint32_t PTR;
+    __IOM uint32_t MAXCNT;
+    __IM  uint32_t AMOUNT;
+} SAADC_RESULT_Type;
+
+typedef struct
+{
+    __OM  uint32_t             TASKS_START;
+    __OM  uint32_t             TASKS_SAMPLE;
+    __OM  uint32_t             TASKS_STOP;
+    __OM  uint32_t             TASKS_CALIBRATEOFFSET;
+    __IM  uint32_t             RESERVED0[60];
+    __IOM uint32_t             EVENTS_STARTED;
+    __IOM uint32_t             EVENTS_END;
+    __IOM uint32_t             EVENTS_DONE;
+    __IOM uint32_t             EVENTS_RESULTDONE;
+    __IOM uint32_t             EVENTS_CALIBRATEDONE;
+    __IOM uint32_t             EVENTS_STOPPED;
+    __IOM SAADC_EVENTS_CH_Type EVENTS_CH[SAADC_CH_NUM];
+    __IM  uint32_t             RESERVED1[106];
+    __IOM uint32_t             INTEN;
+    __IOM uint32_t             INTENSET;
+    __IOM uint32_t             INTENCLR;
+    __IM  uint32_t             RESERVED2[61];
+    __IM  uint32_t             STATUS;
+    __IM  uint32_t             RESERVED3[63];
+    __IOM uint32_t             ENABLE;
+    __IM  uint32_t             RESERVED4[3];
+    __IOM SAADC_CH_Type        CH[SAADC_CH_NUM];
+    __IM  uint32_t             RESERVED5[24];
+    __IOM uint32_t             RESOLUTION;
+    __IOM uint32_t             OVERSAMPLE;
+    __IOM uint32_t             SAMPLERATE;
+    __IM  uint32_t             RESERVED6[12];
+    __IOM SAADC_RESULT_Type    RESULT;
+} NRF_SAADC_Type;
+
+typedef struct
+{
+    __OM  uint32_t TASKS_START;
+    __OM  uint32_t TASKS_STOP;
+    __OM  uint32_t TASKS_COUNT;
+    __OM  uint32_t TASKS_CLEAR;
+    __OM  uint32_t TASKS_SHUTDOWN;
+    __IM  uint32_t RESERVED0[11];
+    __OM  uint32_t TASKS_CAPTURE[6];
+    __IM  uint32_t RESERVED1[58];
+    __IOM uint32_t EVENTS_COMPARE[6];
+    __IM  uint32_t RESERVED2[42];
+    __IOM uint32_t SHORTS;
+    __IM  uint32_t RESERVED3[64];
+    __IOM uint32_t INTENSET;
+    __IOM uint32_t INTENCLR;
+    __IM  uint32_t RESERVED4[126];
+    __IOM uint32_t MODE;
+    __IOM uint32_t BITMODE;
+    __IM  uint32_t RESERVED5;
+    __IOM uint32_t PRESCALER;
+    __IM  uint32_t RESERVED6[11];
+    __IOM uint32_t CC[6];
+} NRF_TIMER_Type;
+
+typedef struct
+{
+    __OM  uint32_t TASKS_START;
+    __OM  uint32_t TASKS_STOP;
+    __OM  uint32_t TASKS_CLEAR;
+    __OM  uint32_t TASKS_TRIGOVRFLW;
+    __IM  uint32_t RESERVED0[60];
+    __IOM uint32_t EVENTS_TICK;
+    __IOM uint32_t EVENTS_OVRFLW;
+    __IM  uint32_t RESERVED1[14];
+    __IOM uint32_t EVENTS_COMPARE[4];
+    __IM  uint32_t RESERVED2[109];
+    __IOM uint32_t INTENSET;
+    __IOM uint32_t INTENCLR;
+    __IM  uint32_t RESERVED3[13];
+    __IOM uint32_t EVTEN;
+    __IOM uint32_t EVTENSET;
+    __IOM uint32_t EVTENCLR;
+    __IM  uint32_t RESERVED4[110];
+    __IM  uint32_t COUNTER;
+    __IOM uint32_t PRESCALER;
+    __IM  uint32_t RESERVED5[13];
+    __IOM uint32_t CC[4];
+} NRF_RTC_Type;
+
+typedef struct
+{
+    __OM  uint32_t TASKS_START;
+    __OM  uint32_t TASKS_STOP;
+    __IM  uint32_t RESERVED0[62];
+    __IOM uint32_t EVENTS_DATARDY;
+    __IM  uint32_t RESERVED1[128];
+    __IOM uint32_t INTENSET;
+    __IOM uint32_t INTENCLR;
+    __IM  uint32_t RESERVED2[127];
+    __IM  int32_t  TEMP;
+} NRF_TEMP_Type;
+
+typedef struct
+{
+    __OM uint32_t EN;
+    __OM uint32_t DIS;
+} PPI_TASKS_CHG_Type;
+
+typedef struct
+{
+    __IOM uint32_t EEP;
+    __IOM uint32_t TEP;
+} PPI_CH_Type;
+
+typedef struct
+{
+    __IOM uint32_t TEP;
+} PPI_FORK_Type;
+
+typedef struct
+{
+    __OM  PPI_TASKS_CHG_Type TASKS_CHG[6];
+    __IM  uint32_t           RESERVED0[308];
+    __IOM uint32_t           CHEN;
+    __IOM uint32_t           CHENSET;
+    __IOM uint32_t           CHENCLR;
+    __IM  uint32_t           RESERVED1;
+    __IOM PPI_CH_Type        CH[20];
+    __IM  uint32_t           RESERVED2[148];
+    __IOM uint32_t           CHG[6];
+    __IM  uint32_t           RESERVED3[62];
+    __IOM PPI_FORK_Type      FORK[32];
+} NRF_PPI_Type;
+
+typedef struct
+{
+    __IM  uint32_t RESERVED0[350];
+    __IOM uint32_t DCDCEN;
+} NRF_POWER_Type;
+
+#define NRF_POWER_BASE 0x40000000UL
+#define NRF_CLOCK_BASE 0x40000000UL
+#define NRF_UARTE0_BASE 0x40002000UL
+#define NRF_SAADC_BASE 0x40007000UL
+#define NRF_TIMER0_BASE 0x40008000UL
+#define NRF_TIMER1_BASE 0x40009000UL
+#define NRF_TIMER2_BASE 0x4000A000UL
+#define NRF_RTC0_BASE  0x4000B000UL
+#define NRF_TEMP_BASE  0x4000C000UL
+#define NRF_RTC1_BASE  0x40011000UL
+#define NRF_TIMER3_BASE 0x4001A000UL
+#define NRF_TIMER4_BASE 0x4001B000UL
+#define NRF_PPI_BASE   0x4001F000UL
+#define NRF_RTC2_BASE  0x40024000UL
+
+#define NRF_POWER  ((NRF_POWER_Type *) NRF_POWER_BASE)
+#define NRF_SAADC  ((NRF_SAADC_Type *) NRF_SAADC_BASE)
+#define NRF_TIMER0 ((NRF_TIMER_Type *) NRF_TIMER0_BASE)
+#define NRF_TIMER1 ((NRF_TIMER_Type *) NRF_TIMER1_BASE)
+#define NRF_TIMER2 ((NRF_TIMER_Type *) NRF_TIMER2_BASE)
+#define NRF_TIMER3 ((NRF_TIMER_Type *) NRF_TIMER3_BASE)
+#define NRF_TIMER4 ((NRF_TIMER_Type *) NRF_TIMER4_BASE)
+#define NRF_RTC0   ((NRF_RTC_Type *) NRF_RTC0_BASE)
+#define NRF_RTC1   ((NRF_RTC_Type *) NRF_RTC1_BASE)
+#define NRF_RTC2   ((NRF_RTC_Type *) NRF_RTC2_BASE)
+#define NRF_PPI    ((NRF_PPI_Type *) NRF_PPI_BASE)
+
+// The TEMP peripheral runs its conversion when the registers are accessed, so busy-wait loops on DATARDY finish
+NRF_TEMP_Type * sim_temp_access(void);
+#define NRF_TEMP   (sim_temp_access())
+
+// Core debug and the cycle counter. CYCCNT counts CPU cycles at SystemCoreClock while the CPU is not sleeping.
+typedef struct
+{
+    __IOM uint32_t CTRL;
+    __IOM uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    __IOM uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Pos     0U
+#define DWT_CTRL_CYCCNTENA_Msk     (1UL << DWT_CTRL_CYCCNTENA_Pos)
+#define CoreDebug_DEMCR_TRCENA_Pos 24U
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << CoreDebug_DEMCR_TRCENA_Pos)
+
+DWT_Type * sim_dwt(void);
+extern CoreDebug_Type sim_core_debug;
+#define DWT       (sim_dwt())
+#define CoreDebug (&sim_core_debug)
+
+extern uint32_t SystemCoreClock;
+
+void sim_wfe(void);
+void sim_sev(void);
+void sim_poll(void);
+
+#define __WFE() sim_wfe()
+#define __WFI() sim_wfe()
+#define __SEV() sim_sev()
+#define __NOP() sim_poll()
+#define __DSB() __sync_synchronize()
+#define __DMB() __sync_synchronize()
+#define __ISB() __sync_synchronize()
+
+#if defined(__ARM_FEATURE_DSP) && __ARM_FEATURE_DSP
+// Portable SMLAD: dual signed 16x16 multiply, both products added to the accumulator
+static inline uint32_t __SMLAD(uint32_t op1, uint32_t op2, uint32_t op3)
+{
+    int32_t lo = (int32_t)(int16_t)(op1 & 0xFFFF) * (int16_t)(op2 & 0xFFFF);
+    int32_t hi = (int32_t)(int16_t)(op1 >> 16) * (int16_t)(op2 >> 16);
+    return (uint32_t)((int32_t)op3 + lo + hi);
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_H__
@@ -0,0 +1,73 @@
+/**
+ * Host build: GATT module for one link. Requests the desired ATT MTU on connection and reports the result.
+ */
+#ifndef NRF_BLE_GATT_H__
+#define NRF_BLE_GATT_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ble.h"
+#include "nrf_sdh_ble.h"
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef NRF_BLE_GATT_BLE_OBSERVER_PRIO
+#define NRF_BLE_GATT_BLE_OBSERVER_PRIO 1
+#endif
+
+#define NRF_BLE_GATT_DEF(_name)                                                                 \
+    static nrf_ble_gatt_t _name;                                                                \
+    NRF_SDH_BLE_OBSERVER(_name ## _obs, NRF_BLE_GATT_BLE_OBSERVER_PRIO, nrf_ble_gatt_on_ble_evt, &_name)
+
+typedef enum
+{
+    NRF_BLE_GATT_EVT_ATT_MTU_UPDATED     = 0xA77,
+    NRF_BLE_GATT_EVT_DATA_LENGTH_UPDATED = 0xDA7A,
+} nrf_ble_gatt_evt_id_t;
+
+typedef struct
+{
+    nrf_ble_gatt_evt_id_t evt_id;
+    uint16_t              conn_handle;
+    union
+    {
+        uint16_t att_mtu_effective;
+        uint8_t  data_length;
+    } params;
+} nrf_ble_gatt_evt_t;
+
+typedef struct nrf_ble_gatt_s nrf_ble_gatt_t;
+
+typedef void (* nrf_ble_gatt_evt_handler_t)(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_t const * p_evt);
+
+typedef struct
+{
+    uint16_t att_mtu_desired;
+    uint16_t att_mtu_effective;
+    bool     att_mtu_exchange_pending;
+    bool     att_mtu_exchange_requested;
+} nrf_ble_gatt_link_t;
+
+struct nrf_ble_gatt_s
+{
+    uint16_t                   att_mtu_desired_periph;
+    uint16_t                   att_mtu_desired_central;
+    uint16_t                   conn_handle;
+    nrf_ble_gatt_link_t        link;
+    nrf_ble_gatt_evt_handler_t evt_handler;
+};
+
+ret_code_t nrf_ble_gatt_init(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_handler_t evt_handler);
+ret_code_t nrf_ble_gatt_att_mtu_periph_set(nrf_ble_gatt_t * p_gatt, uint16_t desired_mtu);
+ret_code_t nrf_ble_gatt_att_mtu_central_set(nrf_ble_gatt_t * p_gatt, uint16_t desired_mtu);
+uint16_t   nrf_ble_gatt_eff_mtu_get(nrf_ble_gatt_t const * p_gatt, uint16_t conn_handle);
+void       nrf_ble_gatt_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_BLE_GATT_H__
@@ -0,0 +1,49 @@
+/**
+ * Host build: Queued Writes module. The virtual central does not use long writes, so it only keeps the connection
+ * handle.
+ */
+#ifndef NRF_BLE_QWR_H__
+#define NRF_BLE_QWR_H__
+
+#include <stdint.h>
+#include "ble.h"
+#include "nrf_sdh_ble.h"
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef NRF_BLE_QWR_BLE_OBSERVER_PRIO
+#define NRF_BLE_QWR_BLE_OBSERVER_PRIO 2
+#endif
+
+#define NRF_BLE_QWR_DEF(_name)                                                                  \
+    static nrf_ble_qwr_t _name;                                                                 \
+    NRF_SDH_BLE_OBSERVER(_name ## _obs, NRF_BLE_QWR_BLE_OBSERVER_PRIO, nrf_ble_qwr_on_ble_evt, &_name)
+
+typedef void (* nrf_ble_qwr_error_handler_t)(uint32_t nrf_error);
+
+typedef struct
+{
+    nrf_ble_qwr_error_handler_t error_handler;
+    uint8_t *                   mem_buffer;
+    uint16_t                    mem_buffer_len;
+} nrf_ble_qwr_init_t;
+
+typedef struct
+{
+    uint8_t                     initialized;
+    uint16_t                    conn_handle;
+    nrf_ble_qwr_error_handler_t error_handler;
+} nrf_ble_qwr_t;
+
+ret_code_t nrf_ble_qwr_init(nrf_ble_qwr_t * p_qwr, nrf_ble_qwr_init_t const * p_qwr_init);
+ret_code_t nrf_ble_qwr_conn_handle_assign(nrf_ble_qwr_t * p_qwr, uint16_t conn_handle);
+void       nrf_ble_qwr_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_BLE_QWR_H__
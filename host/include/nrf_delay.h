@@ -0,0 +1,20 @@
+/**
+ * Host build: busy-wait delays, in virtual time.
+ */
+#ifndef NRF_DELAY_H__
+#define NRF_DELAY_H__
+
+#include <stdint.h>
+#include "nrf_host_sim.h"
+
+static inline void nrf_delay_us(uint32_t us_time)
+{
+    sim_delay_ns((uint64_t)us_time * 1000);
+}
+
+static inline void nrf_delay_ms(uint32_t ms_time)
+{
+    sim_delay_ns((uint64_t)ms_time * 1000000);
+}
+
+#endif // NRF_DELAY_H__
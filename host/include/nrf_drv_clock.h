@@ -0,0 +1,46 @@
+/**
+ * Host build: clock driver. The simulated clocks are always running.
+ */
+#ifndef NRF_DRV_CLOCK_H__
+#define NRF_DRV_CLOCK_H__
+
+#include <stdbool.h>
+#include "sdk_errors.h"
+
+typedef void (* nrf_drv_clock_event_handler_t)(int event);
+
+typedef struct nrf_drv_clock_handler_item_s
+{
+    struct nrf_drv_clock_handler_item_s * p_next;
+    nrf_drv_clock_event_handler_t         event_handler;
+} nrf_drv_clock_handler_item_t;
+
+static inline ret_code_t nrf_drv_clock_init(void)
+{
+    return NRF_SUCCESS;
+}
+
+static inline void nrf_drv_clock_lfclk_request(nrf_drv_clock_handler_item_t * p_handler_item)
+{
+    (void)p_handler_item;
+}
+
+static inline void nrf_drv_clock_lfclk_release(void)
+{
+}
+
+static inline bool nrf_drv_clock_lfclk_is_running(void)
+{
+    return true;
+}
+
+static inline void nrf_drv_clock_hfclk_request(nrf_drv_clock_handler_item_t * p_handler_item)
+{
+    (void)p_handler_item;
+}
+
+static inline void nrf_drv_clock_hfclk_release(void)
+{
+}
+
+#endif // NRF_DRV_CLOCK_H__
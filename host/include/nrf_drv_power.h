@@ -0,0 +1,15 @@
+/**
+ * Host build: power driver.
+ */
+#ifndef NRF_DRV_POWER_H__
+#define NRF_DRV_POWER_H__
+
+#include "sdk_errors.h"
+
+static inline ret_code_t nrf_drv_power_init(void const * p_config)
+{
+    (void)p_config;
+    return NRF_SUCCESS;
+}
+
+#endif // NRF_DRV_POWER_H__
@@ -0,0 +1,20 @@
+/**
+ * Host build: legacy PPI driver names.
+ */
+#ifndef NRF_DRV_PPI_H__
+#define NRF_DRV_PPI_H__
+
+#include "nrfx_ppi.h"
+#include "sdk_errors.h"
+
+ret_code_t nrf_drv_ppi_init(void);
+ret_code_t nrf_drv_ppi_uninit(void);
+
+#define nrf_drv_ppi_channel_alloc       nrfx_ppi_channel_alloc
+#define nrf_drv_ppi_channel_free        nrfx_ppi_channel_free
+#define nrf_drv_ppi_channel_assign      nrfx_ppi_channel_assign
+#define nrf_drv_ppi_channel_fork_assign nrfx_ppi_channel_fork_assign
+#define nrf_drv_ppi_channel_enable      nrfx_ppi_channel_enable
+#define nrf_drv_ppi_channel_disable     nrfx_ppi_channel_disable
+
+#endif // NRF_DRV_PPI_H__
@@ -0,0 +1,95 @@
+/**
+ * Host build: legacy SAADC driver (nrf_drv_saadc, nrfx API v1).
+ */
+#ifndef NRF_DRV_SAADC_H__
+#define NRF_DRV_SAADC_H__
+
+#include "nrfx.h"
+#include "nrf_saadc.h"
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NRF_DRV_SAADC_LIMITH_DISABLED NRF_SAADC_LIMITH_DISABLED
+#define NRF_DRV_SAADC_LIMITL_DISABLED NRF_SAADC_LIMITL_DISABLED
+
+#define NRF_DRV_SAADC_DEFAULT_CONFIG                        \
+{                                                           \
+    .resolution         = NRF_SAADC_RESOLUTION_10BIT,       \
+    .oversample         = NRF_SAADC_OVERSAMPLE_DISABLED,    \
+    .interrupt_priority = 6,                                \
+    .low_power_mode     = false,                            \
+}
+
+#define NRF_DRV_SAADC_DEFAULT_CHANNEL_CONFIG_SE(PIN_P)      \
+{                                                           \
+    .resistor_p = NRF_SAADC_RESISTOR_DISABLED,              \
+    .resistor_n = NRF_SAADC_RESISTOR_DISABLED,              \
+    .gain       = NRF_SAADC_GAIN1_6,                        \
+    .reference  = NRF_SAADC_REFERENCE_INTERNAL,             \
+    .acq_time   = NRF_SAADC_ACQTIME_10US,                   \
+    .mode       = NRF_SAADC_MODE_SINGLE_ENDED,              \
+    .burst      = NRF_SAADC_BURST_DISABLED,                 \
+    .pin_p      = (nrf_saadc_input_t)(PIN_P),               \
+    .pin_n      = NRF_SAADC_INPUT_DISABLED                  \
+}
+
+typedef struct
+{
+    nrf_saadc_resolution_t resolution;
+    nrf_saadc_oversample_t oversample;
+    uint8_t                interrupt_priority;
+    bool                   low_power_mode;
+} nrf_drv_saadc_config_t;
+
+typedef enum
+{
+    NRF_DRV_SAADC_EVT_DONE,
+    NRF_DRV_SAADC_EVT_LIMIT,
+    NRF_DRV_SAADC_EVT_CALIBRATEDONE
+} nrf_drv_saadc_evt_type_t;
+
+typedef struct
+{
+    nrf_saadc_value_t * p_buffer;
+    uint16_t            size;
+} nrf_drv_saadc_done_evt_t;
+
+typedef struct
+{
+    uint8_t           channel;
+    nrf_saadc_limit_t limit_type;
+} nrf_drv_saadc_limit_evt_t;
+
+typedef struct
+{
+    nrf_drv_saadc_evt_type_t type;
+    union
+    {
+        nrf_drv_saadc_done_evt_t  done;
+        nrf_drv_saadc_limit_evt_t limit;
+    } data;
+} nrf_drv_saadc_evt_t;
+
+typedef void (* nrf_drv_saadc_event_handler_t)(nrf_drv_saadc_evt_t const * p_event);
+
+ret_code_t nrf_drv_saadc_init(nrf_drv_saadc_config_t const * p_config, nrf_drv_saadc_event_handler_t event_handler);
+void       nrf_drv_saadc_uninit(void);
+ret_code_t nrf_drv_saadc_channel_init(uint8_t channel, nrf_saadc_channel_config_t const * const p_config);
+ret_code_t nrf_drv_saadc_channel_uninit(uint8_t channel);
+ret_code_t nrf_drv_saadc_sample_convert(uint8_t channel, nrf_saadc_value_t * p_value);
+ret_code_t nrf_drv_saadc_buffer_convert(nrf_saadc_value_t * buffer, uint16_t size);
+ret_code_t nrf_drv_saadc_sample(void);
+ret_code_t nrf_drv_saadc_calibrate_offset(void);
+bool       nrf_drv_saadc_is_busy(void);
+void       nrf_drv_saadc_abort(void);
+void       nrf_drv_saadc_limits_set(uint8_t channel, int16_t limit_low, int16_t limit_high);
+uint32_t   nrf_drv_saadc_sample_task_get(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_DRV_SAADC_H__
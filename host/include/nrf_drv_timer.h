@@ -0,0 +1,34 @@
+/**
+ * Host build: legacy TIMER driver names.
+ */
+#ifndef NRF_DRV_TIMER_H__
+#define NRF_DRV_TIMER_H__
+
+#include "nrfx_timer.h"
+
+typedef nrfx_timer_t               nrf_drv_timer_t;
+typedef nrfx_timer_config_t        nrf_drv_timer_config_t;
+typedef nrfx_timer_event_handler_t nrf_timer_event_handler_t;
+
+#define NRF_DRV_TIMER_INSTANCE         NRFX_TIMER_INSTANCE
+#define NRF_DRV_TIMER_DEFAULT_CONFIG   NRFX_TIMER_DEFAULT_CONFIG
+
+#define nrf_drv_timer_init             nrfx_timer_init
+#define nrf_drv_timer_uninit           nrfx_timer_uninit
+#define nrf_drv_timer_enable           nrfx_timer_enable
+#define nrf_drv_timer_disable          nrfx_timer_disable
+#define nrf_drv_timer_is_enabled       nrfx_timer_is_enabled
+#define nrf_drv_timer_pause            nrfx_timer_pause
+#define nrf_drv_timer_resume           nrfx_timer_resume
+#define nrf_drv_timer_clear            nrfx_timer_clear
+#define nrf_drv_timer_capture          nrfx_timer_capture
+#define nrf_drv_timer_capture_get      nrfx_timer_capture_get
+#define nrf_drv_timer_compare          nrfx_timer_compare
+#define nrf_drv_timer_extended_compare nrfx_timer_extended_compare
+#define nrf_drv_timer_task_address_get nrfx_timer_task_address_get
+#define nrf_drv_timer_event_address_get nrfx_timer_event_address_get
+#define nrf_drv_timer_compare_event_address_get nrfx_timer_compare_event_address_get
+#define nrf_drv_timer_us_to_ticks      nrfx_timer_us_to_ticks
+#define nrf_drv_timer_ms_to_ticks      nrfx_timer_ms_to_ticks
+
+#endif // NRF_DRV_TIMER_H__
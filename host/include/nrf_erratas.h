@@ -0,0 +1,11 @@
+/**
+ * Host build: errata checks. Errata 212 applies when HOST_SIM_ERRATA_212=1 is set in the environment.
+ */
+#ifndef NRF_ERRATAS_H__
+#define NRF_ERRATAS_H__
+
+#include <stdbool.h>
+
+bool nrf52_errata_212(void);
+
+#endif // NRF_ERRATAS_H__
@@ -0,0 +1,42 @@
+/**
+ * Host build: simulator hooks used by the mocked SDK headers.
+ *
+ * The simulator is single threaded. Interrupt handlers run when the application code calls into a mocked driver,
+ * HAL or CMSIS function (an interruption point), and virtual time advances by the host time spent in application
+ * code since the previous interruption point. See host/README.md.
+ */
+#ifndef NRF_HOST_SIM_H__
+#define NRF_HOST_SIM_H__
+
+#include <stdint.h>
+#include "nrf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Virtual time in nanoseconds since reset
+uint64_t sim_time_ns(void);
+
+// Busy waits in application code, e.g. nrf_delay_us()
+void sim_delay_ns(uint64_t ns);
+
+// Triggers the task at the given peripheral address, as a write to the task register or a PPI channel would
+void sim_task_trigger(uint32_t address);
+
+// EasyDMA pointers are 32 bit, the host build links the executables without PIE so static buffers fit
+uint32_t sim_dma_address(void const * p_buffer);
+
+void sim_critical_enter(void);
+void sim_critical_exit(void);
+
+void sim_log(char level, char const * p_fmt, ...) __attribute__((format(printf, 2, 3)));
+void sim_log_hexdump(char level, void const * p_data, uint32_t length);
+
+void sim_error(uint32_t error_code, uint32_t line, char const * p_file) __attribute__((noreturn));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_HOST_SIM_H__
@@ -0,0 +1,27 @@
+/**
+ * Host build: logger. Messages are printed right away with the virtual time stamp.
+ */
+#ifndef NRF_LOG_H__
+#define NRF_LOG_H__
+
+#include <stdint.h>
+#include "nrf_host_sim.h"
+
+#define NRF_LOG_ERROR(...)   sim_log('E', __VA_ARGS__)
+#define NRF_LOG_WARNING(...) sim_log('W', __VA_ARGS__)
+#define NRF_LOG_INFO(...)    sim_log('I', __VA_ARGS__)
+#define NRF_LOG_DEBUG(...)   sim_log('D', __VA_ARGS__)
+#define NRF_LOG_RAW_INFO(...) sim_log('R', __VA_ARGS__)
+
+#define NRF_LOG_HEXDUMP_INFO(p_data, len)  sim_log_hexdump('I', (p_data), (len))
+#define NRF_LOG_HEXDUMP_DEBUG(p_data, len) sim_log_hexdump('D', (p_data), (len))
+
+#define NRF_LOG_FLOAT_MARKER "%s%d.%02d"
+#define NRF_LOG_FLOAT(val) (((val) < 0 && (val) > -1.0) ? "-" : ""),             \
+                           (int32_t)(val),                                       \
+                           (int32_t)((((val) > 0) ? (val) - (int32_t)(val)       \
+                                                  : (int32_t)(val) - (val)) * 100)
+
+#define NRF_LOG_PUSH(_str) (_str)
+
+#endif // NRF_LOG_H__
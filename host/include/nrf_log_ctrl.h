@@ -0,0 +1,21 @@
+/**
+ * Host build: logger control. The host logger is not deferred, NRF_LOG_PROCESS() only lets pending interrupts run.
+ */
+#ifndef NRF_LOG_CTRL_H__
+#define NRF_LOG_CTRL_H__
+
+#include <stdbool.h>
+#include "nrf_host_sim.h"
+#include "sdk_errors.h"
+
+static inline bool sim_log_process(void)
+{
+    sim_poll();
+    return false;
+}
+
+#define NRF_LOG_INIT(timestamp_func, ...) (((void)(timestamp_func)), NRF_SUCCESS)
+#define NRF_LOG_PROCESS()                 sim_log_process()
+#define NRF_LOG_FLUSH()                   ((void)0)
+
+#endif // NRF_LOG_CTRL_H__
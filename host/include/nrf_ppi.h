@@ -0,0 +1,42 @@
+/**
+ * Host build: PPI HAL.
+ */
+#ifndef NRF_PPI_H__
+#define NRF_PPI_H__
+
+#include <stdint.h>
+#include "nrf.h"
+
+typedef enum
+{
+    NRF_PPI_CHANNEL0 = 0, NRF_PPI_CHANNEL1, NRF_PPI_CHANNEL2, NRF_PPI_CHANNEL3,
+    NRF_PPI_CHANNEL4, NRF_PPI_CHANNEL5, NRF_PPI_CHANNEL6, NRF_PPI_CHANNEL7,
+    NRF_PPI_CHANNEL8, NRF_PPI_CHANNEL9, NRF_PPI_CHANNEL10, NRF_PPI_CHANNEL11,
+    NRF_PPI_CHANNEL12, NRF_PPI_CHANNEL13, NRF_PPI_CHANNEL14, NRF_PPI_CHANNEL15,
+    NRF_PPI_CHANNEL16, NRF_PPI_CHANNEL17, NRF_PPI_CHANNEL18, NRF_PPI_CHANNEL19,
+} nrf_ppi_channel_t;
+
+#define PPI_CH_NUM 20
+
+static inline void nrf_ppi_channel_endpoint_setup(nrf_ppi_channel_t channel, uint32_t eep, uint32_t tep)
+{
+    NRF_PPI->CH[channel].EEP = eep;
+    NRF_PPI->CH[channel].TEP = tep;
+}
+
+static inline void nrf_ppi_fork_endpoint_setup(nrf_ppi_channel_t channel, uint32_t fork_tep)
+{
+    NRF_PPI->FORK[channel].TEP = fork_tep;
+}
+
+static inline void nrf_ppi_channel_enable(nrf_ppi_channel_t channel)
+{
+    NRF_PPI->CHEN |= 1UL << channel;
+}
+
+static inline void nrf_ppi_channel_disable(nrf_ppi_channel_t channel)
+{
+    NRF_PPI->CHEN &= ~(1UL << channel);
+}
+
+#endif // NRF_PPI_H__
@@ -0,0 +1,23 @@
+/**
+ * Host build: power management. nrf_pwr_mgmt_run() sleeps as the SDK does without a SoftDevice.
+ */
+#ifndef NRF_PWR_MGMT_H__
+#define NRF_PWR_MGMT_H__
+
+#include "nrf.h"
+#include "sdk_errors.h"
+
+static inline ret_code_t nrf_pwr_mgmt_init(void)
+{
+    return NRF_SUCCESS;
+}
+
+static inline void nrf_pwr_mgmt_run(void)
+{
+    // Wait for an event, then clear the event register
+    __WFE();
+    __SEV();
+    __WFE();
+}
+
+#endif // NRF_PWR_MGMT_H__
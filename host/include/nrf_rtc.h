@@ -0,0 +1,134 @@
+/**
+ * Host build: RTC HAL.
+ */
+#ifndef NRF_RTC_H__
+#define NRF_RTC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "nrf.h"
+#include "nrf_host_sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RTC_INPUT_FREQ 32768
+#define RTC_FREQ_TO_PRESCALER(FREQ) (uint16_t)(((RTC_INPUT_FREQ) / (FREQ)) - 1)
+#define RTC_COUNTER_COUNTER_Msk 0xFFFFFFUL
+#define NRF_RTC_CC_CHANNEL_COUNT(id) (((id) == 0) ? 3 : 4)
+
+#define RTC_CHANNEL_INT_MASK(ch)   ((uint32_t)(NRF_RTC_INT_COMPARE0_MASK) << (ch))
+#define RTC_CHANNEL_EVENT_ADDR(ch) (nrf_rtc_event_t)((NRF_RTC_EVENT_COMPARE_0) + (ch) * sizeof(uint32_t))
+
+typedef enum
+{
+    NRF_RTC_TASK_START            = offsetof(NRF_RTC_Type, TASKS_START),
+    NRF_RTC_TASK_STOP             = offsetof(NRF_RTC_Type, TASKS_STOP),
+    NRF_RTC_TASK_CLEAR            = offsetof(NRF_RTC_Type, TASKS_CLEAR),
+    NRF_RTC_TASK_TRIGGER_OVERFLOW = offsetof(NRF_RTC_Type, TASKS_TRIGOVRFLW),
+} nrf_rtc_task_t;
+
+typedef enum
+{
+    NRF_RTC_EVENT_TICK      = offsetof(NRF_RTC_Type, EVENTS_TICK),
+    NRF_RTC_EVENT_OVERFLOW  = offsetof(NRF_RTC_Type, EVENTS_OVRFLW),
+    NRF_RTC_EVENT_COMPARE_0 = offsetof(NRF_RTC_Type, EVENTS_COMPARE[0]),
+    NRF_RTC_EVENT_COMPARE_1 = offsetof(NRF_RTC_Type, EVENTS_COMPARE[1]),
+    NRF_RTC_EVENT_COMPARE_2 = offsetof(NRF_RTC_Type, EVENTS_COMPARE[2]),
+    NRF_RTC_EVENT_COMPARE_3 = offsetof(NRF_RTC_Type, EVENTS_COMPARE[3]),
+} nrf_rtc_event_t;
+
+typedef enum
+{
+    NRF_RTC_INT_TICK_MASK     = (1UL << 0),
+    NRF_RTC_INT_OVERFLOW_MASK = (1UL << 1),
+    NRF_RTC_INT_COMPARE0_MASK = (1UL << 16),
+    NRF_RTC_INT_COMPARE1_MASK = (1UL << 17),
+    NRF_RTC_INT_COMPARE2_MASK = (1UL << 18),
+    NRF_RTC_INT_COMPARE3_MASK = (1UL << 19),
+} nrf_rtc_int_t;
+
+// Reschedules the compare events after the registers were changed
+void     sim_rtc_update(NRF_RTC_Type * p_reg);
+uint32_t sim_rtc_counter(NRF_RTC_Type * p_reg);
+
+static inline void nrf_rtc_cc_set(NRF_RTC_Type * p_reg, uint32_t ch, uint32_t cc_val)
+{
+    p_reg->CC[ch] = cc_val & RTC_COUNTER_COUNTER_Msk;
+    sim_rtc_update(p_reg);
+}
+
+static inline uint32_t nrf_rtc_cc_get(NRF_RTC_Type * p_reg, uint32_t ch)
+{
+    return p_reg->CC[ch];
+}
+
+static inline void nrf_rtc_int_enable(NRF_RTC_Type * p_reg, uint32_t mask)
+{
+    p_reg->INTENSET |= mask;
+    sim_rtc_update(p_reg);
+}
+
+static inline void nrf_rtc_int_disable(NRF_RTC_Type * p_reg, uint32_t mask)
+{
+    p_reg->INTENSET &= ~mask;
+}
+
+static inline uint32_t nrf_rtc_int_is_enabled(NRF_RTC_Type * p_reg, uint32_t mask)
+{
+    return p_reg->INTENSET & mask;
+}
+
+static inline void nrf_rtc_event_enable(NRF_RTC_Type * p_reg, uint32_t mask)
+{
+    p_reg->EVTEN |= mask;
+    sim_rtc_update(p_reg);
+}
+
+static inline void nrf_rtc_event_disable(NRF_RTC_Type * p_reg, uint32_t mask)
+{
+    p_reg->EVTEN &= ~mask;
+}
+
+static inline uint32_t nrf_rtc_event_pending(NRF_RTC_Type * p_reg, nrf_rtc_event_t event)
+{
+    return *(volatile uint32_t *)((uint8_t *)p_reg + (uint32_t)event);
+}
+
+static inline void nrf_rtc_event_clear(NRF_RTC_Type * p_reg, nrf_rtc_event_t event)
+{
+    *(volatile uint32_t *)((uint8_t *)p_reg + (uint32_t)event) = 0;
+}
+
+static inline uint32_t nrf_rtc_counter_get(NRF_RTC_Type * p_reg)
+{
+    return sim_rtc_counter(p_reg);
+}
+
+static inline void nrf_rtc_prescaler_set(NRF_RTC_Type * p_reg, uint32_t val)
+{
+    p_reg->PRESCALER = val;
+    sim_rtc_update(p_reg);
+}
+
+static inline uint32_t nrf_rtc_event_address_get(NRF_RTC_Type * p_reg, nrf_rtc_event_t event)
+{
+    return (uint32_t)(uintptr_t)p_reg + (uint32_t)event;
+}
+
+static inline uint32_t nrf_rtc_task_address_get(NRF_RTC_Type * p_reg, nrf_rtc_task_t task)
+{
+    return (uint32_t)(uintptr_t)p_reg + (uint32_t)task;
+}
+
+static inline void nrf_rtc_task_trigger(NRF_RTC_Type * p_reg, nrf_rtc_task_t task)
+{
+    sim_task_trigger((uint32_t)(uintptr_t)p_reg + (uint32_t)task);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_RTC_H__
@@ -0,0 +1,347 @@
+/**
+ * Host build: SAADC HAL.
+ *
+ * Register accesses go to the simulated SAADC at its real address. Task triggers are routed through the simulator.
+ */
+#ifndef NRF_SAADC_H__
+#define NRF_SAADC_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "nrf.h"
+#include "nrf_host_sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NRF_SAADC_CHANNEL_COUNT 8
+
+#define NRF_SAADC_LIMITH_DISABLED (2047)
+#define NRF_SAADC_LIMITL_DISABLED (-2048)
+
+// CONFIG register fields
+#define SAADC_CH_CONFIG_RESP_Pos   (0UL)
+#define SAADC_CH_CONFIG_RESN_Pos   (4UL)
+#define SAADC_CH_CONFIG_GAIN_Pos   (8UL)
+#define SAADC_CH_CONFIG_REFSEL_Pos (12UL)
+#define SAADC_CH_CONFIG_TACQ_Pos   (16UL)
+#define SAADC_CH_CONFIG_MODE_Pos   (20UL)
+#define SAADC_CH_CONFIG_BURST_Pos  (24UL)
+
+#define SAADC_SAMPLERATE_CC_Pos          (0UL)
+#define SAADC_SAMPLERATE_CC_Msk          (0x7FFUL << SAADC_SAMPLERATE_CC_Pos)
+#define SAADC_SAMPLERATE_MODE_Pos        (12UL)
+#define SAADC_SAMPLERATE_MODE_Task       (0UL)
+#define SAADC_SAMPLERATE_MODE_Timers     (1UL)
+
+#define SAADC_ENABLE_ENABLE_Disabled     (0UL)
+#define SAADC_ENABLE_ENABLE_Enabled      (1UL)
+
+typedef int16_t nrf_saadc_value_t;
+
+typedef enum
+{
+    NRF_SAADC_RESOLUTION_8BIT  = 0,
+    NRF_SAADC_RESOLUTION_10BIT = 1,
+    NRF_SAADC_RESOLUTION_12BIT = 2,
+    NRF_SAADC_RESOLUTION_14BIT = 3
+} nrf_saadc_resolution_t;
+
+typedef enum
+{
+    NRF_SAADC_INPUT_DISABLED = 0,
+    NRF_SAADC_INPUT_AIN0     = 1,
+    NRF_SAADC_INPUT_AIN1     = 2,
+    NRF_SAADC_INPUT_AIN2     = 3,
+    NRF_SAADC_INPUT_AIN3     = 4,
+    NRF_SAADC_INPUT_AIN4     = 5,
+    NRF_SAADC_INPUT_AIN5     = 6,
+    NRF_SAADC_INPUT_AIN6     = 7,
+    NRF_SAADC_INPUT_AIN7     = 8,
+    NRF_SAADC_INPUT_VDD      = 9
+} nrf_saadc_input_t;
+
+typedef enum
+{
+    NRF_SAADC_OVERSAMPLE_DISABLED = 0,
+    NRF_SAADC_OVERSAMPLE_2X       = 1,
+    NRF_SAADC_OVERSAMPLE_4X       = 2,
+    NRF_SAADC_OVERSAMPLE_8X       = 3,
+    NRF_SAADC_OVERSAMPLE_16X      = 4,
+    NRF_SAADC_OVERSAMPLE_32X      = 5,
+    NRF_SAADC_OVERSAMPLE_64X      = 6,
+    NRF_SAADC_OVERSAMPLE_128X     = 7,
+    NRF_SAADC_OVERSAMPLE_256X     = 8
+} nrf_saadc_oversample_t;
+
+typedef enum
+{
+    NRF_SAADC_RESISTOR_DISABLED = 0,
+    NRF_SAADC_RESISTOR_PULLDOWN = 1,
+    NRF_SAADC_RESISTOR_PULLUP   = 2,
+    NRF_SAADC_RESISTOR_VDD1_2   = 3
+} nrf_saadc_resistor_t;
+
+typedef enum
+{
+    NRF_SAADC_GAIN1_6 = 0,
+    NRF_SAADC_GAIN1_5 = 1,
+    NRF_SAADC_GAIN1_4 = 2,
+    NRF_SAADC_GAIN1_3 = 3,
+    NRF_SAADC_GAIN1_2 = 4,
+    NRF_SAADC_GAIN1   = 5,
+    NRF_SAADC_GAIN2   = 6,
+    NRF_SAADC_GAIN4   = 7
+} nrf_saadc_gain_t;
+
+typedef enum
+{
+    NRF_SAADC_REFERENCE_INTERNAL = 0,
+    NRF_SAADC_REFERENCE_VDD4     = 1
+} nrf_saadc_reference_t;
+
+typedef enum
+{
+    NRF_SAADC_ACQTIME_3US  = 0,
+    NRF_SAADC_ACQTIME_5US  = 1,
+    NRF_SAADC_ACQTIME_10US = 2,
+    NRF_SAADC_ACQTIME_15US = 3,
+    NRF_SAADC_ACQTIME_20US = 4,
+    NRF_SAADC_ACQTIME_40US = 5
+} nrf_saadc_acqtime_t;
+
+typedef enum
+{
+    NRF_SAADC_MODE_SINGLE_ENDED = 0,
+    NRF_SAADC_MODE_DIFFERENTIAL = 1
+} nrf_saadc_mode_t;
+
+typedef enum
+{
+    NRF_SAADC_BURST_DISABLED = 0,
+    NRF_SAADC_BURST_ENABLED  = 1
+} nrf_saadc_burst_t;
+
+typedef enum
+{
+    NRF_SAADC_TASK_START           = offsetof(NRF_SAADC_Type, TASKS_START),
+    NRF_SAADC_TASK_SAMPLE          = offsetof(NRF_SAADC_Type, TASKS_SAMPLE),
+    NRF_SAADC_TASK_STOP            = offsetof(NRF_SAADC_Type, TASKS_STOP),
+    NRF_SAADC_TASK_CALIBRATEOFFSET = offsetof(NRF_SAADC_Type, TASKS_CALIBRATEOFFSET),
+} nrf_saadc_task_t;
+
+typedef enum
+{
+    NRF_SAADC_EVENT_STARTED       = offsetof(NRF_SAADC_Type, EVENTS_STARTED),
+    NRF_SAADC_EVENT_END           = offsetof(NRF_SAADC_Type, EVENTS_END),
+    NRF_SAADC_EVENT_DONE          = offsetof(NRF_SAADC_Type, EVENTS_DONE),
+    NRF_SAADC_EVENT_RESULTDONE    = offsetof(NRF_SAADC_Type, EVENTS_RESULTDONE),
+    NRF_SAADC_EVENT_CALIBRATEDONE = offsetof(NRF_SAADC_Type, EVENTS_CALIBRATEDONE),
+    NRF_SAADC_EVENT_STOPPED       = offsetof(NRF_SAADC_Type, EVENTS_STOPPED),
+    NRF_SAADC_EVENT_CH0_LIMITH    = offsetof(NRF_SAADC_Type, EVENTS_CH[0].LIMITH),
+    NRF_SAADC_EVENT_CH0_LIMITL    = offsetof(NRF_SAADC_Type, EVENTS_CH[0].LIMITL),
+    NRF_SAADC_EVENT_CH7_LIMITL    = offsetof(NRF_SAADC_Type, EVENTS_CH[7].LIMITL),
+} nrf_saadc_event_t;
+
+typedef enum
+{
+    NRF_SAADC_INT_STARTED       = (1UL << 0),
+    NRF_SAADC_INT_END           = (1UL << 1),
+    NRF_SAADC_INT_DONE          = (1UL << 2),
+    NRF_SAADC_INT_RESULTDONE    = (1UL << 3),
+    NRF_SAADC_INT_CALIBRATEDONE = (1UL << 4),
+    NRF_SAADC_INT_STOPPED       = (1UL << 5),
+    NRF_SAADC_INT_CH0LIMITH     = (1UL << 6),
+    NRF_SAADC_INT_CH0LIMITL     = (1UL << 7),
+    NRF_SAADC_INT_ALL           = 0x7FFFFFFFUL
+} nrf_saadc_int_mask_t;
+
+typedef enum
+{
+    NRF_SAADC_LIMIT_LOW  = 0,
+    NRF_SAADC_LIMIT_HIGH = 1
+} nrf_saadc_limit_t;
+
+typedef struct
+{
+    nrf_saadc_resistor_t  resistor_p;
+    nrf_saadc_resistor_t  resistor_n;
+    nrf_saadc_gain_t      gain;
+    nrf_saadc_reference_t reference;
+    nrf_saadc_acqtime_t   acq_time;
+    nrf_saadc_mode_t      mode;
+    nrf_saadc_burst_t     burst;
+    nrf_saadc_input_t     pin_p;
+    nrf_saadc_input_t     pin_n;
+} nrf_saadc_channel_config_t;
+
+// Raises the SAADC interrupt when an enabled event is already pending
+void sim_saadc_irq_update(void);
+
+static inline void nrf_saadc_task_trigger(nrf_saadc_task_t task)
+{
+    sim_task_trigger((uint32_t)(NRF_SAADC_BASE + (uint32_t)task));
+}
+
+static inline uint32_t nrf_saadc_task_address_get(nrf_saadc_task_t task)
+{
+    return (uint32_t)(NRF_SAADC_BASE + (uint32_t)task);
+}
+
+static inline bool nrf_saadc_event_check(nrf_saadc_event_t event)
+{
+    return (bool)*(volatile uint32_t *)((uint8_t *)NRF_SAADC + (uint32_t)event);
+}
+
+static inline void nrf_saadc_event_clear(nrf_saadc_event_t event)
+{
+    *(volatile uint32_t *)((uint8_t *)NRF_SAADC + (uint32_t)event) = 0;
+}
+
+static inline uint32_t nrf_saadc_event_address_get(nrf_saadc_event_t event)
+{
+    return (uint32_t)(NRF_SAADC_BASE + (uint32_t)event);
+}
+
+static inline nrf_saadc_event_t nrf_saadc_event_limit_get(uint8_t channel, nrf_saadc_limit_t limit_type)
+{
+    return (nrf_saadc_event_t)offsetof(NRF_SAADC_Type, EVENTS_CH[channel].LIMITH) +
+           ((limit_type == NRF_SAADC_LIMIT_LOW) ? 4 : 0);
+}
+
+static inline uint32_t nrf_saadc_limit_int_get(uint8_t channel, nrf_saadc_limit_t limit_type)
+{
+    uint32_t bit = (limit_type == NRF_SAADC_LIMIT_LOW) ? 7 : 6;
+    return 1UL << (bit + 2 * channel);
+}
+
+static inline void nrf_saadc_int_enable(uint32_t saadc_int_mask)
+{
+    NRF_SAADC->INTEN |= saadc_int_mask;
+    sim_saadc_irq_update();
+}
+
+static inline bool nrf_saadc_int_enable_check(uint32_t saadc_int_mask)
+{
+    return (bool)(NRF_SAADC->INTEN & saadc_int_mask);
+}
+
+static inline void nrf_saadc_int_disable(uint32_t saadc_int_mask)
+{
+    NRF_SAADC->INTEN &= ~saadc_int_mask;
+}
+
+static inline bool nrf_saadc_busy_check(void)
+{
+    return NRF_SAADC->STATUS != 0;
+}
+
+static inline void nrf_saadc_enable(void)
+{
+    NRF_SAADC->ENABLE = SAADC_ENABLE_ENABLE_Enabled;
+}
+
+static inline void nrf_saadc_disable(void)
+{
+    NRF_SAADC->ENABLE = SAADC_ENABLE_ENABLE_Disabled;
+}
+
+static inline bool nrf_saadc_enable_check(void)
+{
+    return NRF_SAADC->ENABLE != 0;
+}
+
+static inline void nrf_saadc_channel_limits_set(uint8_t channel, int16_t low, int16_t high)
+{
+    NRF_SAADC->CH[channel].LIMIT = ((uint32_t)(uint16_t)high << 16) | (uint16_t)low;
+}
+
+static inline void nrf_saadc_resolution_set(nrf_saadc_resolution_t resolution)
+{
+    NRF_SAADC->RESOLUTION = resolution;
+}
+
+static inline nrf_saadc_resolution_t nrf_saadc_resolution_get(void)
+{
+    return (nrf_saadc_resolution_t)NRF_SAADC->RESOLUTION;
+}
+
+static inline void nrf_saadc_oversample_set(nrf_saadc_oversample_t oversample)
+{
+    NRF_SAADC->OVERSAMPLE = oversample;
+}
+
+static inline nrf_saadc_oversample_t nrf_saadc_oversample_get(void)
+{
+    return (nrf_saadc_oversample_t)NRF_SAADC->OVERSAMPLE;
+}
+
+static inline uint32_t nrf_saadc_oversample_sample_count_get(nrf_saadc_oversample_t oversample)
+{
+    return (1UL << (uint32_t)oversample);
+}
+
+static inline void nrf_saadc_buffer_init(nrf_saadc_value_t * p_buffer, uint32_t num)
+{
+    NRF_SAADC->RESULT.PTR    = sim_dma_address(p_buffer);
+    NRF_SAADC->RESULT.MAXCNT = num;
+}
+
+static inline uint32_t nrf_saadc_amount_get(void)
+{
+    return NRF_SAADC->RESULT.AMOUNT;
+}
+
+static inline void nrf_saadc_continuous_mode_enable(uint16_t cc)
+{
+    NRF_SAADC->SAMPLERATE = (SAADC_SAMPLERATE_MODE_Timers << SAADC_SAMPLERATE_MODE_Pos) |
+                            ((uint32_t)cc << SAADC_SAMPLERATE_CC_Pos);
+}
+
+static inline void nrf_saadc_continuous_mode_disable(void)
+{
+    NRF_SAADC->SAMPLERATE = 0;
+}
+
+static inline bool nrf_saadc_continuous_mode_enable_check(void)
+{
+    return (NRF_SAADC->SAMPLERATE >> SAADC_SAMPLERATE_MODE_Pos) & 1UL;
+}
+
+static inline void nrf_saadc_channel_input_set(uint8_t channel, nrf_saadc_input_t pselp, nrf_saadc_input_t pseln)
+{
+    NRF_SAADC->CH[channel].PSELN = pseln;
+    NRF_SAADC->CH[channel].PSELP = pselp;
+}
+
+static inline void nrf_saadc_channel_pos_input_set(uint8_t channel, nrf_saadc_input_t pselp)
+{
+    NRF_SAADC->CH[channel].PSELP = pselp;
+}
+
+static inline void nrf_saadc_burst_set(uint8_t channel, nrf_saadc_burst_t burst)
+{
+    NRF_SAADC->CH[channel].CONFIG = (NRF_SAADC->CH[channel].CONFIG & ~(1UL << SAADC_CH_CONFIG_BURST_Pos)) |
+                                    ((uint32_t)burst << SAADC_CH_CONFIG_BURST_Pos);
+}
+
+static inline void nrf_saadc_channel_init(uint8_t channel, nrf_saadc_channel_config_t const * const config)
+{
+    NRF_SAADC->CH[channel].CONFIG =
+            (((uint32_t)config->resistor_p << SAADC_CH_CONFIG_RESP_Pos)   & (0x3UL << SAADC_CH_CONFIG_RESP_Pos))
+          | (((uint32_t)config->resistor_n << SAADC_CH_CONFIG_RESN_Pos)   & (0x3UL << SAADC_CH_CONFIG_RESN_Pos))
+          | (((uint32_t)config->gain       << SAADC_CH_CONFIG_GAIN_Pos)   & (0x7UL << SAADC_CH_CONFIG_GAIN_Pos))
+          | (((uint32_t)config->reference  << SAADC_CH_CONFIG_REFSEL_Pos) & (0x1UL << SAADC_CH_CONFIG_REFSEL_Pos))
+          | (((uint32_t)config->acq_time   << SAADC_CH_CONFIG_TACQ_Pos)   & (0x7UL << SAADC_CH_CONFIG_TACQ_Pos))
+          | (((uint32_t)config->mode       << SAADC_CH_CONFIG_MODE_Pos)   & (0x1UL << SAADC_CH_CONFIG_MODE_Pos))
+          | (((uint32_t)config->burst      << SAADC_CH_CONFIG_BURST_Pos)  & (0x1UL << SAADC_CH_CONFIG_BURST_Pos));
+    nrf_saadc_channel_input_set(channel, config->pin_p, config->pin_n);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_SAADC_H__
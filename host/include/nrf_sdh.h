@@ -0,0 +1,24 @@
+/**
+ * Host build: SoftDevice handler.
+ *
+ * nrf_sdh_enable_request() starts the SoftDevice model. Events are dispatched from the SoftDevice event interrupt,
+ * named SD_EVT in the report, as with NRF_SDH_DISPATCH_MODEL 0.
+ */
+#ifndef NRF_SDH_H__
+#define NRF_SDH_H__
+
+#include <stdbool.h>
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+ret_code_t nrf_sdh_enable_request(void);
+bool       nrf_sdh_is_enabled(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_SDH_H__
@@ -0,0 +1,63 @@
+/**
+ * Host build: BLE part of the SoftDevice handler.
+ *
+ * Observers are placed in the sdh_ble_observers section, as the SDK does with its section variables, and are called
+ * in priority order, lowest level first.
+ */
+#ifndef NRF_SDH_BLE_H__
+#define NRF_SDH_BLE_H__
+
+#include <stdint.h>
+#include "app_util.h"
+#include "ble.h"
+#include "nrf_sdh.h"
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Defaults of pca10040/s132/config/sdk_config.h
+#ifndef NRF_SDH_BLE_TOTAL_LINK_COUNT
+#define NRF_SDH_BLE_TOTAL_LINK_COUNT 1
+#endif
+#ifndef NRF_SDH_BLE_PERIPHERAL_LINK_COUNT
+#define NRF_SDH_BLE_PERIPHERAL_LINK_COUNT 1
+#endif
+#ifndef NRF_SDH_BLE_GATT_MAX_MTU_SIZE
+#define NRF_SDH_BLE_GATT_MAX_MTU_SIZE 247
+#endif
+#ifndef NRF_SDH_BLE_GAP_EVENT_LENGTH
+#define NRF_SDH_BLE_GAP_EVENT_LENGTH 6
+#endif
+#ifndef NRF_SDH_BLE_OBSERVER_PRIO_LEVELS
+#define NRF_SDH_BLE_OBSERVER_PRIO_LEVELS 4
+#endif
+
+typedef void (* nrf_sdh_ble_evt_handler_t)(ble_evt_t const * p_ble_evt, void * p_context);
+
+typedef struct
+{
+    nrf_sdh_ble_evt_handler_t handler;
+    void *                    p_context;
+    uint8_t                   prio;
+} nrf_sdh_ble_evt_observer_t;
+
+#define NRF_SDH_BLE_OBSERVER(_name, _prio, _handler, _context)                                  \
+    STATIC_ASSERT(_prio < NRF_SDH_BLE_OBSERVER_PRIO_LEVELS, "Priority level unavailable.");    \
+    __attribute__((section("sdh_ble_observers"), used, aligned(8)))                             \
+    static nrf_sdh_ble_evt_observer_t const _name =                                             \
+    {                                                                                           \
+        .handler   = _handler,                                                                  \
+        .p_context = _context,                                                                  \
+        .prio      = _prio,                                                                     \
+    }
+
+ret_code_t nrf_sdh_ble_default_cfg_set(uint8_t conn_cfg_tag, uint32_t * p_ram_start);
+ret_code_t nrf_sdh_ble_enable(uint32_t * p_app_ram_start);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_SDH_BLE_H__
@@ -0,0 +1,42 @@
+/**
+ * Host build: SoC part of the SoftDevice handler. Observers are placed in the sdh_soc_observers section.
+ */
+#ifndef NRF_SDH_SOC_H__
+#define NRF_SDH_SOC_H__
+
+#include <stdint.h>
+#include "app_util.h"
+#include "nrf_soc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef NRF_SDH_SOC_OBSERVER_PRIO_LEVELS
+#define NRF_SDH_SOC_OBSERVER_PRIO_LEVELS 2
+#endif
+
+typedef void (* nrf_sdh_soc_evt_handler_t)(uint32_t evt_id, void * p_context);
+
+typedef struct
+{
+    nrf_sdh_soc_evt_handler_t handler;
+    void *                    p_context;
+    uint8_t                   prio;
+} nrf_sdh_soc_evt_observer_t;
+
+#define NRF_SDH_SOC_OBSERVER(_name, _prio, _handler, _context)                                  \
+    STATIC_ASSERT(_prio < NRF_SDH_SOC_OBSERVER_PRIO_LEVELS, "Priority level unavailable.");    \
+    __attribute__((section("sdh_soc_observers"), used, aligned(8)))                             \
+    static nrf_sdh_soc_evt_observer_t const _name =                                             \
+    {                                                                                           \
+        .handler   = _handler,                                                                  \
+        .p_context = _context,                                                                  \
+        .prio      = _prio,                                                                     \
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_SDH_SOC_H__
@@ -0,0 +1,19 @@
+/**
+ * Host build: SoftDevice SoC API.
+ */
+#ifndef NRF_SOC_H__
+#define NRF_SOC_H__
+
+#include <stdint.h>
+#include "nrf_error.h"
+
+typedef enum
+{
+    NRF_EVT_FLASH_OPERATION_SUCCESS = 2,
+    NRF_EVT_FLASH_OPERATION_ERROR   = 3,
+} nrf_soc_evts_t;
+
+// Ends the simulation, system OFF is only left through a reset
+uint32_t sd_power_system_off(void);
+
+#endif // NRF_SOC_H__
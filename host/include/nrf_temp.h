@@ -0,0 +1,32 @@
+/**
+ * Host build: TEMP HAL, nrf_temp_init() and nrf_temp_read() as in the SDK.
+ */
+#ifndef NRF_TEMP_H__
+#define NRF_TEMP_H__
+
+#include <stdint.h>
+#include "nrf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MASK_SIGN           (0x00000200UL)
+#define MASK_SIGN_EXTENSION (0xFFFFFC00UL)
+
+// The SDK loads the temperature offset for the anomaly 31 workaround. The model has no offset register
+static inline void nrf_temp_init(void)
+{
+}
+
+// Result of the last measurement in 0.25 degC steps, sign extended from the 10-bit result
+static inline int32_t nrf_temp_read(void)
+{
+    return ((NRF_TEMP->TEMP & MASK_SIGN) != 0) ? (int32_t)(NRF_TEMP->TEMP | MASK_SIGN_EXTENSION) : (NRF_TEMP->TEMP);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_TEMP_H__
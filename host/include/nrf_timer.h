@@ -0,0 +1,209 @@
+/**
+ * Host build: TIMER HAL.
+ */
+#ifndef NRF_TIMER_H__
+#define NRF_TIMER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "nrf.h"
+#include "nrf_host_sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NRF_TIMER_CC_CHANNEL_COUNT(id) (((id) < 3) ? 4 : 6)
+
+typedef enum
+{
+    NRF_TIMER_TASK_START    = offsetof(NRF_TIMER_Type, TASKS_START),
+    NRF_TIMER_TASK_STOP     = offsetof(NRF_TIMER_Type, TASKS_STOP),
+    NRF_TIMER_TASK_COUNT    = offsetof(NRF_TIMER_Type, TASKS_COUNT),
+    NRF_TIMER_TASK_CLEAR    = offsetof(NRF_TIMER_Type, TASKS_CLEAR),
+    NRF_TIMER_TASK_SHUTDOWN = offsetof(NRF_TIMER_Type, TASKS_SHUTDOWN),
+    NRF_TIMER_TASK_CAPTURE0 = offsetof(NRF_TIMER_Type, TASKS_CAPTURE[0]),
+    NRF_TIMER_TASK_CAPTURE1 = offsetof(NRF_TIMER_Type, TASKS_CAPTURE[1]),
+    NRF_TIMER_TASK_CAPTURE2 = offsetof(NRF_TIMER_Type, TASKS_CAPTURE[2]),
+    NRF_TIMER_TASK_CAPTURE3 = offsetof(NRF_TIMER_Type, TASKS_CAPTURE[3]),
+} nrf_timer_task_t;
+
+typedef enum
+{
+    NRF_TIMER_EVENT_COMPARE0 = offsetof(NRF_TIMER_Type, EVENTS_COMPARE[0]),
+    NRF_TIMER_EVENT_COMPARE1 = offsetof(NRF_TIMER_Type, EVENTS_COMPARE[1]),
+    NRF_TIMER_EVENT_COMPARE2 = offsetof(NRF_TIMER_Type, EVENTS_COMPARE[2]),
+    NRF_TIMER_EVENT_COMPARE3 = offsetof(NRF_TIMER_Type, EVENTS_COMPARE[3]),
+} nrf_timer_event_t;
+
+typedef enum
+{
+    NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK = (1UL << 0),
+    NRF_TIMER_SHORT_COMPARE1_CLEAR_MASK = (1UL << 1),
+    NRF_TIMER_SHORT_COMPARE2_CLEAR_MASK = (1UL << 2),
+    NRF_TIMER_SHORT_COMPARE3_CLEAR_MASK = (1UL << 3),
+    NRF_TIMER_SHORT_COMPARE0_STOP_MASK  = (1UL << 8),
+    NRF_TIMER_SHORT_COMPARE1_STOP_MASK  = (1UL << 9),
+    NRF_TIMER_SHORT_COMPARE2_STOP_MASK  = (1UL << 10),
+    NRF_TIMER_SHORT_COMPARE3_STOP_MASK  = (1UL << 11),
+} nrf_timer_short_mask_t;
+
+typedef enum
+{
+    NRF_TIMER_MODE_TIMER             = 0,
+    NRF_TIMER_MODE_COUNTER           = 1,
+    NRF_TIMER_MODE_LOW_POWER_COUNTER = 2,
+} nrf_timer_mode_t;
+
+typedef enum
+{
+    NRF_TIMER_BIT_WIDTH_8  = 1,
+    NRF_TIMER_BIT_WIDTH_16 = 0,
+    NRF_TIMER_BIT_WIDTH_24 = 2,
+    NRF_TIMER_BIT_WIDTH_32 = 3
+} nrf_timer_bit_width_t;
+
+typedef enum
+{
+    NRF_TIMER_FREQ_16MHz = 0,
+    NRF_TIMER_FREQ_8MHz,
+    NRF_TIMER_FREQ_4MHz,
+    NRF_TIMER_FREQ_2MHz,
+    NRF_TIMER_FREQ_1MHz,
+    NRF_TIMER_FREQ_500kHz,
+    NRF_TIMER_FREQ_250kHz,
+    NRF_TIMER_FREQ_125kHz,
+    NRF_TIMER_FREQ_62500Hz,
+    NRF_TIMER_FREQ_31250Hz
+} nrf_timer_frequency_t;
+
+typedef enum
+{
+    NRF_TIMER_CC_CHANNEL0 = 0,
+    NRF_TIMER_CC_CHANNEL1,
+    NRF_TIMER_CC_CHANNEL2,
+    NRF_TIMER_CC_CHANNEL3,
+    NRF_TIMER_CC_CHANNEL4,
+    NRF_TIMER_CC_CHANNEL5,
+} nrf_timer_cc_channel_t;
+
+#define NRF_TIMER_INT_COMPARE0_MASK (1UL << 16)
+
+// Reschedules the compare events after the registers were changed
+void     sim_timer_update(NRF_TIMER_Type * p_reg);
+uint32_t sim_timer_counter(NRF_TIMER_Type * p_reg);
+
+static inline void nrf_timer_task_trigger(NRF_TIMER_Type * p_reg, nrf_timer_task_t task)
+{
+    sim_task_trigger((uint32_t)(uintptr_t)p_reg + (uint32_t)task);
+}
+
+static inline uint32_t nrf_timer_task_address_get(NRF_TIMER_Type * p_reg, nrf_timer_task_t task)
+{
+    return (uint32_t)(uintptr_t)p_reg + (uint32_t)task;
+}
+
+static inline uint32_t nrf_timer_event_address_get(NRF_TIMER_Type * p_reg, nrf_timer_event_t event)
+{
+    return (uint32_t)(uintptr_t)p_reg + (uint32_t)event;
+}
+
+static inline void nrf_timer_event_clear(NRF_TIMER_Type * p_reg, nrf_timer_event_t event)
+{
+    *(volatile uint32_t *)((uint8_t *)p_reg + (uint32_t)event) = 0;
+}
+
+static inline bool nrf_timer_event_check(NRF_TIMER_Type * p_reg, nrf_timer_event_t event)
+{
+    return (bool)*(volatile uint32_t *)((uint8_t *)p_reg + (uint32_t)event);
+}
+
+static inline void nrf_timer_shorts_enable(NRF_TIMER_Type * p_reg, uint32_t timer_shorts_mask)
+{
+    p_reg->SHORTS |= timer_shorts_mask;
+}
+
+static inline void nrf_timer_shorts_disable(NRF_TIMER_Type * p_reg, uint32_t timer_shorts_mask)
+{
+    p_reg->SHORTS &= ~(timer_shorts_mask);
+}
+
+static inline void nrf_timer_int_enable(NRF_TIMER_Type * p_reg, uint32_t timer_int_mask)
+{
+    p_reg->INTENSET |= timer_int_mask;
+}
+
+static inline void nrf_timer_int_disable(NRF_TIMER_Type * p_reg, uint32_t timer_int_mask)
+{
+    p_reg->INTENSET &= ~timer_int_mask;
+}
+
+static inline bool nrf_timer_int_enable_check(NRF_TIMER_Type * p_reg, uint32_t timer_int)
+{
+    return (bool)(p_reg->INTENSET & timer_int);
+}
+
+static inline void nrf_timer_mode_set(NRF_TIMER_Type * p_reg, nrf_timer_mode_t mode)
+{
+    p_reg->MODE = mode;
+    sim_timer_update(p_reg);
+}
+
+static inline void nrf_timer_bit_width_set(NRF_TIMER_Type * p_reg, nrf_timer_bit_width_t bit_width)
+{
+    p_reg->BITMODE = bit_width;
+    sim_timer_update(p_reg);
+}
+
+static inline void nrf_timer_frequency_set(NRF_TIMER_Type * p_reg, nrf_timer_frequency_t frequency)
+{
+    p_reg->PRESCALER = frequency;
+    sim_timer_update(p_reg);
+}
+
+static inline nrf_timer_frequency_t nrf_timer_frequency_get(NRF_TIMER_Type * p_reg)
+{
+    return (nrf_timer_frequency_t)p_reg->PRESCALER;
+}
+
+static inline void nrf_timer_cc_write(NRF_TIMER_Type * p_reg, nrf_timer_cc_channel_t cc_channel, uint32_t cc_value)
+{
+    p_reg->CC[cc_channel] = cc_value;
+    sim_timer_update(p_reg);
+}
+
+static inline uint32_t nrf_timer_cc_read(NRF_TIMER_Type * p_reg, nrf_timer_cc_channel_t cc_channel)
+{
+    return p_reg->CC[cc_channel];
+}
+
+static inline nrf_timer_event_t nrf_timer_compare_event_get(uint32_t channel)
+{
+    return (nrf_timer_event_t)offsetof(NRF_TIMER_Type, EVENTS_COMPARE[channel]);
+}
+
+static inline nrf_timer_task_t nrf_timer_capture_task_get(uint32_t channel)
+{
+    return (nrf_timer_task_t)offsetof(NRF_TIMER_Type, TASKS_CAPTURE[channel]);
+}
+
+static inline uint32_t nrf_timer_compare_int_get(uint32_t channel)
+{
+    return NRF_TIMER_INT_COMPARE0_MASK << channel;
+}
+
+static inline uint32_t nrf_timer_us_to_ticks(uint32_t time_us, nrf_timer_frequency_t frequency)
+{
+    return (uint32_t)(((uint64_t)time_us * 16ULL) >> frequency);
+}
+
+static inline uint32_t nrf_timer_ms_to_ticks(uint32_t time_ms, nrf_timer_frequency_t frequency)
+{
+    return (uint32_t)(((uint64_t)time_ms * 16000ULL) >> frequency);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_TIMER_H__
@@ -0,0 +1,14 @@
+/**
+ * Host build: UART HAL, baud rates only. The UART is replaced by app_uart on stdout.
+ */
+#ifndef NRF_UART_H__
+#define NRF_UART_H__
+
+typedef enum
+{
+    NRF_UART_BAUDRATE_9600    = 0x00275000,
+    NRF_UART_BAUDRATE_115200  = 0x01D7E000,
+    NRF_UART_BAUDRATE_1000000 = 0x10000000,
+} nrf_uart_baudrate_t;
+
+#endif // NRF_UART_H__
@@ -0,0 +1,14 @@
+/**
+ * Host build: UARTE HAL, baud rates only. The UART is replaced by app_uart on stdout.
+ */
+#ifndef NRF_UARTE_H__
+#define NRF_UARTE_H__
+
+typedef enum
+{
+    NRF_UARTE_BAUDRATE_9600    = 0x00275000,
+    NRF_UARTE_BAUDRATE_115200  = 0x01D60000,
+    NRF_UARTE_BAUDRATE_1000000 = 0x10000000,
+} nrf_uarte_baudrate_t;
+
+#endif // NRF_UARTE_H__
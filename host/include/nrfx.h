@@ -0,0 +1,49 @@
+/**
+ * Host build: nrfx glue.
+ */
+#ifndef NRFX_H__
+#define NRFX_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "nrf.h"
+#include "nrf_host_sim.h"
+#include "app_util_platform.h"
+
+#define NRFX_CONCAT_2(p1, p2)      NRFX_CONCAT_2_(p1, p2)
+#define NRFX_CONCAT_2_(p1, p2)     p1##p2
+#define NRFX_CONCAT_3(p1, p2, p3)  NRFX_CONCAT_3_(p1, p2, p3)
+#define NRFX_CONCAT_3_(p1, p2, p3) p1##p2##p3
+
+#define NRFX_ASSERT(expression)      ((void)0)
+#define NRFX_STATIC_ASSERT(expression) _Static_assert(expression, #expression)
+
+#define NRFX_ERROR_BASE_NUM         0x0BAD0000
+#define NRFX_ERROR_DRIVERS_BASE_NUM (NRFX_ERROR_BASE_NUM + 0x10000)
+
+typedef enum
+{
+    NRFX_SUCCESS                    = 0,
+    NRFX_ERROR_INTERNAL             = (NRFX_ERROR_BASE_NUM + 0),
+    NRFX_ERROR_NO_MEM               = (NRFX_ERROR_BASE_NUM + 1),
+    NRFX_ERROR_NOT_SUPPORTED        = (NRFX_ERROR_BASE_NUM + 2),
+    NRFX_ERROR_INVALID_PARAM        = (NRFX_ERROR_BASE_NUM + 3),
+    NRFX_ERROR_INVALID_STATE        = (NRFX_ERROR_BASE_NUM + 4),
+    NRFX_ERROR_INVALID_LENGTH       = (NRFX_ERROR_BASE_NUM + 5),
+    NRFX_ERROR_TIMEOUT              = (NRFX_ERROR_BASE_NUM + 6),
+    NRFX_ERROR_FORBIDDEN            = (NRFX_ERROR_BASE_NUM + 7),
+    NRFX_ERROR_NULL                 = (NRFX_ERROR_BASE_NUM + 8),
+    NRFX_ERROR_INVALID_ADDR         = (NRFX_ERROR_BASE_NUM + 9),
+    NRFX_ERROR_BUSY                 = (NRFX_ERROR_BASE_NUM + 10),
+    NRFX_ERROR_ALREADY_INITIALIZED  = (NRFX_ERROR_BASE_NUM + 11),
+} nrfx_err_t;
+
+typedef enum
+{
+    NRFX_DRV_STATE_UNINITIALIZED,
+    NRFX_DRV_STATE_INITIALIZED,
+    NRFX_DRV_STATE_POWERED_ON,
+} nrfx_drv_state_t;
+
+#endif // NRFX_H__
@@ -0,0 +1,26 @@
+/**
+ * Host build: PPI allocator.
+ */
+#ifndef NRFX_PPI_H__
+#define NRFX_PPI_H__
+
+#include "nrfx.h"
+#include "nrf_ppi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+nrfx_err_t nrfx_ppi_channel_alloc(nrf_ppi_channel_t * p_channel);
+nrfx_err_t nrfx_ppi_channel_free(nrf_ppi_channel_t channel);
+nrfx_err_t nrfx_ppi_channel_assign(nrf_ppi_channel_t channel, uint32_t eep, uint32_t tep);
+nrfx_err_t nrfx_ppi_channel_fork_assign(nrf_ppi_channel_t channel, uint32_t fork_tep);
+nrfx_err_t nrfx_ppi_channel_enable(nrf_ppi_channel_t channel);
+nrfx_err_t nrfx_ppi_channel_disable(nrf_ppi_channel_t channel);
+void       nrfx_ppi_free_all(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRFX_PPI_H__
@@ -0,0 +1,122 @@
+/**
+ * Host build: RTC driver.
+ */
+#ifndef NRFX_RTC_H__
+#define NRFX_RTC_H__
+
+#include "nrfx.h"
+#include "nrf_rtc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NRFX_RTC_US_TO_TICKS(us, freq) (((us) * (freq)) / 1000000U)
+
+enum
+{
+    NRFX_RTC0_INST_IDX,
+    NRFX_RTC1_INST_IDX,
+    NRFX_RTC2_INST_IDX,
+    NRFX_RTC_ENABLED_COUNT
+};
+
+typedef enum
+{
+    NRFX_RTC_INT_COMPARE0 = 0,
+    NRFX_RTC_INT_COMPARE1 = 1,
+    NRFX_RTC_INT_COMPARE2 = 2,
+    NRFX_RTC_INT_COMPARE3 = 3,
+    NRFX_RTC_INT_TICK     = 4,
+    NRFX_RTC_INT_OVERFLOW = 5
+} nrfx_rtc_int_type_t;
+
+typedef struct
+{
+    NRF_RTC_Type * p_reg;
+    IRQn_Type      irq;
+    uint8_t        instance_id;
+    uint8_t        cc_channel_count;
+} nrfx_rtc_t;
+
+#define NRFX_RTC_INSTANCE(id)                                   \
+{                                                               \
+    .p_reg            = NRFX_CONCAT_2(NRF_RTC, id),             \
+    .irq              = NRFX_CONCAT_3(RTC, id, _IRQn),          \
+    .instance_id      = NRFX_CONCAT_3(NRFX_RTC, id, _INST_IDX), \
+    .cc_channel_count = NRF_RTC_CC_CHANNEL_COUNT(id),           \
+}
+
+typedef struct
+{
+    uint16_t prescaler;
+    uint8_t  interrupt_priority;
+    uint8_t  tick_latency;
+    bool     reliable;
+} nrfx_rtc_config_t;
+
+#define NRFX_RTC_DEFAULT_CONFIG                                 \
+{                                                               \
+    .prescaler          = RTC_FREQ_TO_PRESCALER(32768),         \
+    .interrupt_priority = 6,                                    \
+    .tick_latency       = 0,                                    \
+    .reliable           = false,                                \
+}
+
+typedef void (* nrfx_rtc_handler_t)(nrfx_rtc_int_type_t int_type);
+
+nrfx_err_t nrfx_rtc_init(nrfx_rtc_t const * const  p_instance,
+                         nrfx_rtc_config_t const * p_config,
+                         nrfx_rtc_handler_t        handler);
+void       nrfx_rtc_uninit(nrfx_rtc_t const * const p_instance);
+void       nrfx_rtc_enable(nrfx_rtc_t const * const p_instance);
+void       nrfx_rtc_disable(nrfx_rtc_t const * const p_instance);
+nrfx_err_t nrfx_rtc_cc_set(nrfx_rtc_t const * const p_instance, uint32_t channel, uint32_t val, bool enable_irq);
+nrfx_err_t nrfx_rtc_cc_disable(nrfx_rtc_t const * const p_instance, uint32_t channel);
+void       nrfx_rtc_tick_enable(nrfx_rtc_t const * const p_instance, bool enable_irq);
+void       nrfx_rtc_tick_disable(nrfx_rtc_t const * const p_instance);
+void       nrfx_rtc_overflow_enable(nrfx_rtc_t const * const p_instance, bool enable_irq);
+void       nrfx_rtc_overflow_disable(nrfx_rtc_t const * const p_instance);
+
+static inline uint32_t nrfx_rtc_counter_get(nrfx_rtc_t const * const p_instance)
+{
+    return nrf_rtc_counter_get(p_instance->p_reg);
+}
+
+static inline void nrfx_rtc_counter_clear(nrfx_rtc_t const * const p_instance)
+{
+    nrf_rtc_task_trigger(p_instance->p_reg, NRF_RTC_TASK_CLEAR);
+}
+
+static inline void nrfx_rtc_int_enable(nrfx_rtc_t const * const p_instance, uint32_t mask)
+{
+    nrf_rtc_int_enable(p_instance->p_reg, mask);
+}
+
+static inline void nrfx_rtc_int_disable(nrfx_rtc_t const * const p_instance, uint32_t * p_mask)
+{
+    *p_mask = nrf_rtc_int_is_enabled(p_instance->p_reg, 0xFFFFFFFF);
+    nrf_rtc_int_disable(p_instance->p_reg, 0xFFFFFFFF);
+}
+
+static inline uint32_t nrfx_rtc_max_ticks_get(nrfx_rtc_t const * const p_instance)
+{
+    (void)p_instance;
+    return RTC_COUNTER_COUNTER_Msk;
+}
+
+static inline uint32_t nrfx_rtc_task_address_get(nrfx_rtc_t const * const p_instance, nrf_rtc_task_t task)
+{
+    return nrf_rtc_task_address_get(p_instance->p_reg, task);
+}
+
+static inline uint32_t nrfx_rtc_event_address_get(nrfx_rtc_t const * const p_instance, nrf_rtc_event_t event)
+{
+    return nrf_rtc_event_address_get(p_instance->p_reg, event);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRFX_RTC_H__
@@ -0,0 +1,116 @@
+/**
+ * Host build: SAADC driver, nrfx API v2 (NRFX_SAADC_API_V2).
+ */
+#ifndef NRFX_SAADC_H__
+#define NRFX_SAADC_H__
+
+#include "nrfx.h"
+#include "nrf_saadc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef NRFX_SAADC_CONFIG_IRQ_PRIORITY
+#define NRFX_SAADC_CONFIG_IRQ_PRIORITY 6
+#endif
+
+#define NRFX_SAADC_DEFAULT_CHANNEL_SE(_pin_p, _index)       \
+{                                                           \
+    .channel_config =                                       \
+    {                                                       \
+        .resistor_p = NRF_SAADC_RESISTOR_DISABLED,          \
+        .resistor_n = NRF_SAADC_RESISTOR_DISABLED,          \
+        .gain       = NRF_SAADC_GAIN1_6,                    \
+        .reference  = NRF_SAADC_REFERENCE_INTERNAL,         \
+        .acq_time   = NRF_SAADC_ACQTIME_10US,               \
+        .mode       = NRF_SAADC_MODE_SINGLE_ENDED,          \
+        .burst      = NRF_SAADC_BURST_DISABLED,             \
+    },                                                      \
+    .pin_p         = (nrf_saadc_input_t)_pin_p,             \
+    .pin_n         = NRF_SAADC_INPUT_DISABLED,              \
+    .channel_index = _index,                                \
+}
+
+#define NRFX_SAADC_DEFAULT_ADV_CONFIG                       \
+{                                                           \
+    .oversampling      = NRF_SAADC_OVERSAMPLE_DISABLED,     \
+    .burst             = NRF_SAADC_BURST_DISABLED,          \
+    .internal_timer_cc = 0,                                 \
+    .start_on_end      = true,                              \
+}
+
+typedef struct
+{
+    nrf_saadc_channel_config_t channel_config;
+    nrf_saadc_input_t          pin_p;
+    nrf_saadc_input_t          pin_n;
+    uint8_t                    channel_index;
+} nrfx_saadc_channel_t;
+
+typedef struct
+{
+    nrf_saadc_oversample_t oversampling;
+    nrf_saadc_burst_t      burst;
+    uint16_t               internal_timer_cc;
+    bool                   start_on_end;
+} nrfx_saadc_adv_config_t;
+
+typedef enum
+{
+    NRFX_SAADC_EVT_DONE,
+    NRFX_SAADC_EVT_LIMIT,
+    NRFX_SAADC_EVT_CALIBRATEDONE,
+    NRFX_SAADC_EVT_BUF_REQ,
+    NRFX_SAADC_EVT_READY,
+    NRFX_SAADC_EVT_FINISHED,
+} nrfx_saadc_evt_type_t;
+
+typedef struct
+{
+    nrf_saadc_value_t * p_buffer;
+    uint16_t            size;
+} nrfx_saadc_done_evt_t;
+
+typedef struct
+{
+    uint8_t           channel;
+    nrf_saadc_limit_t limit_type;
+} nrfx_saadc_limit_evt_t;
+
+typedef struct
+{
+    nrfx_saadc_evt_type_t type;
+    union
+    {
+        nrfx_saadc_done_evt_t  done;
+        nrfx_saadc_limit_evt_t limit;
+    } data;
+} nrfx_saadc_evt_t;
+
+typedef void (* nrfx_saadc_event_handler_t)(nrfx_saadc_evt_t const * p_event);
+
+nrfx_err_t nrfx_saadc_init(uint8_t interrupt_priority);
+void       nrfx_saadc_uninit(void);
+nrfx_err_t nrfx_saadc_channels_config(nrfx_saadc_channel_t const * p_channels, uint32_t channel_count);
+nrfx_err_t nrfx_saadc_channel_config(nrfx_saadc_channel_t const * p_channel);
+uint32_t   nrfx_saadc_channels_configured_get(void);
+nrfx_err_t nrfx_saadc_simple_mode_set(uint32_t                   channel_mask,
+                                      nrf_saadc_resolution_t     resolution,
+                                      nrf_saadc_oversample_t     oversampling,
+                                      nrfx_saadc_event_handler_t event_handler);
+nrfx_err_t nrfx_saadc_advanced_mode_set(uint32_t                        channel_mask,
+                                        nrf_saadc_resolution_t          resolution,
+                                        nrfx_saadc_adv_config_t const * p_config,
+                                        nrfx_saadc_event_handler_t      event_handler);
+nrfx_err_t nrfx_saadc_buffer_set(nrf_saadc_value_t * p_buffer, uint16_t size);
+nrfx_err_t nrfx_saadc_mode_trigger(void);
+void       nrfx_saadc_abort(void);
+nrfx_err_t nrfx_saadc_limits_set(uint8_t channel, int16_t limit_low, int16_t limit_high);
+nrfx_err_t nrfx_saadc_offset_calibrate(nrfx_saadc_event_handler_t calib_event_handler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRFX_SAADC_H__
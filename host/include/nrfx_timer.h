@@ -0,0 +1,116 @@
+/**
+ * Host build: TIMER driver.
+ */
+#ifndef NRFX_TIMER_H__
+#define NRFX_TIMER_H__
+
+#include "nrfx.h"
+#include "nrf_timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum
+{
+    NRFX_TIMER0_INST_IDX,
+    NRFX_TIMER1_INST_IDX,
+    NRFX_TIMER2_INST_IDX,
+    NRFX_TIMER3_INST_IDX,
+    NRFX_TIMER4_INST_IDX,
+    NRFX_TIMER_ENABLED_COUNT
+};
+
+typedef struct
+{
+    NRF_TIMER_Type * p_reg;
+    uint8_t          instance_id;
+    uint8_t          cc_channel_count;
+} nrfx_timer_t;
+
+#define NRFX_TIMER_INSTANCE(id)                                   \
+{                                                                 \
+    .p_reg            = NRFX_CONCAT_2(NRF_TIMER, id),             \
+    .instance_id      = NRFX_CONCAT_3(NRFX_TIMER, id, _INST_IDX), \
+    .cc_channel_count = NRF_TIMER_CC_CHANNEL_COUNT(id),           \
+}
+
+typedef struct
+{
+    nrf_timer_frequency_t frequency;
+    nrf_timer_mode_t      mode;
+    nrf_timer_bit_width_t bit_width;
+    uint8_t               interrupt_priority;
+    void *                p_context;
+} nrfx_timer_config_t;
+
+#define NRFX_TIMER_DEFAULT_CONFIG                           \
+{                                                           \
+    .frequency          = NRF_TIMER_FREQ_16MHz,             \
+    .mode               = NRF_TIMER_MODE_TIMER,             \
+    .bit_width          = NRF_TIMER_BIT_WIDTH_16,           \
+    .interrupt_priority = 6,                                \
+    .p_context          = NULL                              \
+}
+
+typedef void (* nrfx_timer_event_handler_t)(nrf_timer_event_t event_type, void * p_context);
+
+nrfx_err_t nrfx_timer_init(nrfx_timer_t const * const  p_instance,
+                           nrfx_timer_config_t const * p_config,
+                           nrfx_timer_event_handler_t  timer_event_handler);
+void       nrfx_timer_uninit(nrfx_timer_t const * const p_instance);
+void       nrfx_timer_enable(nrfx_timer_t const * const p_instance);
+void       nrfx_timer_disable(nrfx_timer_t const * const p_instance);
+bool       nrfx_timer_is_enabled(nrfx_timer_t const * const p_instance);
+void       nrfx_timer_resume(nrfx_timer_t const * const p_instance);
+void       nrfx_timer_pause(nrfx_timer_t const * const p_instance);
+void       nrfx_timer_clear(nrfx_timer_t const * const p_instance);
+uint32_t   nrfx_timer_capture(nrfx_timer_t const * const p_instance, nrf_timer_cc_channel_t cc_channel);
+void       nrfx_timer_compare(nrfx_timer_t const * const p_instance,
+                              nrf_timer_cc_channel_t     cc_channel,
+                              uint32_t                   cc_value,
+                              bool                       enable_int);
+void       nrfx_timer_extended_compare(nrfx_timer_t const * const p_instance,
+                                       nrf_timer_cc_channel_t     cc_channel,
+                                       uint32_t                   cc_value,
+                                       nrf_timer_short_mask_t     timer_short_mask,
+                                       bool                       enable_int);
+void       nrfx_timer_compare_int_enable(nrfx_timer_t const * const p_instance, uint32_t channel);
+void       nrfx_timer_compare_int_disable(nrfx_timer_t const * const p_instance, uint32_t channel);
+
+static inline uint32_t nrfx_timer_task_address_get(nrfx_timer_t const * const p_instance, nrf_timer_task_t timer_task)
+{
+    return nrf_timer_task_address_get(p_instance->p_reg, timer_task);
+}
+
+static inline uint32_t nrfx_timer_event_address_get(nrfx_timer_t const * const p_instance,
+                                                    nrf_timer_event_t          timer_event)
+{
+    return nrf_timer_event_address_get(p_instance->p_reg, timer_event);
+}
+
+static inline uint32_t nrfx_timer_compare_event_address_get(nrfx_timer_t const * const p_instance, uint32_t channel)
+{
+    return nrf_timer_event_address_get(p_instance->p_reg, nrf_timer_compare_event_get(channel));
+}
+
+static inline uint32_t nrfx_timer_us_to_ticks(nrfx_timer_t const * const p_instance, uint32_t time_us)
+{
+    return nrf_timer_us_to_ticks(time_us, nrf_timer_frequency_get(p_instance->p_reg));
+}
+
+static inline uint32_t nrfx_timer_ms_to_ticks(nrfx_timer_t const * const p_instance, uint32_t time_ms)
+{
+    return nrf_timer_ms_to_ticks(time_ms, nrf_timer_frequency_get(p_instance->p_reg));
+}
+
+static inline uint32_t nrfx_timer_capture_get(nrfx_timer_t const * const p_instance, nrf_timer_cc_channel_t cc_channel)
+{
+    return nrf_timer_cc_read(p_instance->p_reg, cc_channel);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRFX_TIMER_H__
@@ -0,0 +1,15 @@
+/**
+ * Host build: SDK error codes.
+ */
+#ifndef SDK_ERRORS_H__
+#define SDK_ERRORS_H__
+
+#include <stdint.h>
+#include "nrf_error.h"
+
+typedef uint32_t ret_code_t;
+
+#define NRF_ERROR_SDK_COMMON_ERROR_BASE         (NRF_ERROR_BASE_NUM + 0x0080)
+#define NRF_ERROR_MODULE_ALREADY_INITIALIZED    (NRF_ERROR_SDK_COMMON_ERROR_BASE + 0x0005)
+
+#endif // SDK_ERRORS_H__
@@ -0,0 +1,138 @@
+/**
+ * Host build: app_scheduler.
+ *
+ * The queue has queue_size + 1 slots of max_event_size bytes after the headers, as in the SDK library, one slot stays
+ * free to tell a full queue from an empty one. Events are put in a critical region and run in app_sched_execute(),
+ * with the event data still in the queue.
+ */
+#include <stddef.h>
+#include <string.h>
+#include "sim_internal.h"
+#include "app_scheduler.h"
+#include "app_util_platform.h"
+
+static struct
+{
+    app_sched_event_header_t * p_headers;
+    uint8_t *                  p_data;
+    uint16_t                   max_event_size;
+    uint16_t                   queue_size;      // Slots, one more than the usable size
+    volatile uint16_t          start;
+    volatile uint16_t          end;
+    uint16_t                   max_utilization;
+
+    // Statistics
+    uint64_t                   puts;
+    uint64_t                   full;
+} m_sched;
+
+
+static uint16_t next_index(uint16_t index)
+{
+    return (index < m_sched.queue_size - 1) ? (index + 1) : 0;
+}
+
+
+static uint16_t queue_length(void)
+{
+    return (m_sched.end >= m_sched.start) ? (m_sched.end - m_sched.start) :
+                                            (m_sched.end + m_sched.queue_size - m_sched.start);
+}
+
+
+static void sched_report(FILE * p_out, double seconds)
+{
+    (void)seconds;
+    fprintf(p_out, "Scheduler: %llu events, max %u of %u queued, queue full %llu times\n",
+            (unsigned long long)m_sched.puts, m_sched.max_utilization, m_sched.queue_size - 1,
+            (unsigned long long)m_sched.full);
+}
+
+
+uint32_t app_sched_init(uint16_t max_event_size, uint16_t queue_size, void * p_evt_buffer)
+{
+    if (p_evt_buffer == NULL || ((uintptr_t)p_evt_buffer & 3) != 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    bool first = (m_sched.p_headers == NULL);
+
+    memset(&m_sched, 0, sizeof(m_sched));
+    m_sched.p_headers      = p_evt_buffer;
+    m_sched.p_data         = (uint8_t *)p_evt_buffer + (queue_size + 1) * APP_SCHED_EVENT_HEADER_SIZE;
+    m_sched.max_event_size = max_event_size;
+    m_sched.queue_size     = queue_size + 1;
+    if (first)
+    {
+        sim_report_register(sched_report);
+    }
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_sched_event_put(void const * p_event_data, uint16_t event_size, app_sched_event_handler_t handler)
+{
+    if (event_size > m_sched.max_event_size)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    uint16_t index = 0xFFFF;
+
+    CRITICAL_REGION_ENTER();
+    if (next_index(m_sched.end) != m_sched.start)
+    {
+        index       = m_sched.end;
+        m_sched.end = next_index(m_sched.end);
+        m_sched.max_utilization = MAX(m_sched.max_utilization, queue_length());
+    }
+    CRITICAL_REGION_EXIT();
+
+    if (index == 0xFFFF)
+    {
+        m_sched.full++;
+        return NRF_ERROR_NO_MEM;
+    }
+
+    m_sched.p_headers[index].handler         = handler;
+    m_sched.p_headers[index].event_data_size = (p_event_data != NULL) ? event_size : 0;
+    if (p_event_data != NULL && event_size > 0)
+    {
+        memcpy(&m_sched.p_data[index * m_sched.max_event_size], p_event_data, event_size);
+    }
+    m_sched.puts++;
+    return NRF_SUCCESS;
+}
+
+
+void app_sched_execute(void)
+{
+    while (m_sched.start != m_sched.end)
+    {
+        uint16_t                         index    = m_sched.start;
+        app_sched_event_header_t const * p_header = &m_sched.p_headers[index];
+        void *                           p_data   = (p_header->event_data_size > 0) ?
+                                                    &m_sched.p_data[index * m_sched.max_event_size] : NULL;
+
+        p_header->handler(p_data, p_header->event_data_size);
+        m_sched.start = next_index(index);
+    }
+}
+
+
+uint16_t app_sched_queue_space_get(void)
+{
+    uint16_t length;
+
+    CRITICAL_REGION_ENTER();
+    length = queue_length();
+    CRITICAL_REGION_EXIT();
+    return m_sched.queue_size - 1 - length;
+}
+
+
+uint16_t app_sched_queue_utilization_get(void)
+{
+    return m_sched.max_utilization;
+}
@@ -0,0 +1,183 @@
+/**
+ * Host build: app_timer on RTC1.
+ *
+ * RTC1 runs from app_timer_init() with the prescaler set by APP_TIMER_CONFIG_RTC_FREQUENCY. Timers are kept in a list
+ * sorted by their 64-bit expiry tick, and CC[0] is set to the first one so the timeout handlers run in the RTC1
+ * interrupt, as in the SDK library.
+ */
+#include <stddef.h>
+#include "sim_internal.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "nrf_rtc.h"
+
+static app_timer_t * mp_head;
+static bool          m_initialized;
+static uint64_t      m_start_ns;
+
+
+static uint64_t ticks_now(void)
+{
+    return ((sim_now() - m_start_ns) * APP_TIMER_CLOCK_FREQ) /
+           (1000000000ULL * (APP_TIMER_CONFIG_RTC_FREQUENCY + 1));
+}
+
+
+static void list_remove(app_timer_t * p_timer)
+{
+    for (app_timer_t ** pp = &mp_head; *pp != NULL; pp = &(*pp)->p_next)
+    {
+        if (*pp == p_timer)
+        {
+            *pp = p_timer->p_next;
+            break;
+        }
+    }
+    p_timer->p_next = NULL;
+    p_timer->active = false;
+}
+
+
+static void list_insert(app_timer_t * p_timer)
+{
+    app_timer_t ** pp = &mp_head;
+    while (*pp != NULL && (*pp)->end_tick <= p_timer->end_tick)
+    {
+        pp = &(*pp)->p_next;
+    }
+    p_timer->p_next = *pp;
+    *pp             = p_timer;
+    p_timer->active = true;
+}
+
+
+static void compare_update(void)
+{
+    if (mp_head == NULL)
+    {
+        nrf_rtc_int_disable(NRF_RTC1, NRF_RTC_INT_COMPARE0_MASK);
+        return;
+    }
+    // Expiries further out than the counter range match early, the handler then finds nothing expired
+    nrf_rtc_cc_set(NRF_RTC1, 0, (uint32_t)mp_head->end_tick);
+    nrf_rtc_int_enable(NRF_RTC1, NRF_RTC_INT_COMPARE0_MASK);
+}
+
+
+static void rtc1_irq_handler(void)
+{
+    nrf_rtc_event_clear(NRF_RTC1, NRF_RTC_EVENT_COMPARE_0);
+
+    uint64_t now = ticks_now();
+    while (mp_head != NULL && mp_head->end_tick <= now)
+    {
+        app_timer_t * p_timer = mp_head;
+        list_remove(p_timer);
+        if (p_timer->mode == APP_TIMER_MODE_REPEATED)
+        {
+            p_timer->end_tick += p_timer->repeat_period;
+            list_insert(p_timer);
+        }
+        p_timer->p_timeout_handler(p_timer->p_context);
+    }
+    compare_update();
+}
+
+
+ret_code_t app_timer_init(void)
+{
+    if (m_initialized)
+    {
+        return NRF_SUCCESS;
+    }
+    nrf_rtc_prescaler_set(NRF_RTC1, APP_TIMER_CONFIG_RTC_FREQUENCY);
+    sim_irq_connect(RTC1_IRQn, "RTC1", rtc1_irq_handler);
+    m_start_ns = sim_now();
+    nrf_rtc_task_trigger(NRF_RTC1, NRF_RTC_TASK_START);
+    m_initialized = true;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t app_timer_create(app_timer_id_t const *      p_timer_id,
+                            app_timer_mode_t            mode,
+                            app_timer_timeout_handler_t timeout_handler)
+{
+    if (timeout_handler == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    app_timer_t * p_timer = *p_timer_id;
+    if (p_timer->active)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    p_timer->mode              = mode;
+    p_timer->p_timeout_handler = timeout_handler;
+    p_timer->p_next            = NULL;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context)
+{
+    if (!m_initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (timeout_ticks < APP_TIMER_MIN_TIMEOUT_TICKS || timer_id->p_timeout_handler == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    CRITICAL_REGION_ENTER();
+    if (timer_id->active)
+    {
+        list_remove(timer_id);
+    }
+    timer_id->p_context     = p_context;
+    timer_id->repeat_period = (timer_id->mode == APP_TIMER_MODE_REPEATED) ? timeout_ticks : 0;
+    timer_id->end_tick      = ticks_now() + timeout_ticks;
+    list_insert(timer_id);
+    compare_update();
+    CRITICAL_REGION_EXIT();
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t app_timer_stop(app_timer_id_t timer_id)
+{
+    CRITICAL_REGION_ENTER();
+    if (timer_id->active)
+    {
+        list_remove(timer_id);
+        compare_update();
+    }
+    CRITICAL_REGION_EXIT();
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t app_timer_stop_all(void)
+{
+    CRITICAL_REGION_ENTER();
+    while (mp_head != NULL)
+    {
+        list_remove(mp_head);
+    }
+    compare_update();
+    CRITICAL_REGION_EXIT();
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_cnt_get(void)
+{
+    return nrf_rtc_counter_get(NRF_RTC1);
+}
+
+
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from)
+{
+    return (ticks_to - ticks_from) & APP_TIMER_MAX_CNT_VAL;
+}
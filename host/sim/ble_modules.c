@@ -0,0 +1,397 @@
+/**
+ * Host build: Nordic UART Service, GATT, Queued Writes and Advertising modules on top of the SoftDevice model.
+ *
+ * The modules handle the same events as the SDK libraries for one peripheral link. Features the virtual central does
+ * not use, e.g. directed or slow advertising, whitelists and long writes, are not implemented.
+ */
+#include <string.h>
+#include "sim_internal.h"
+#include "sim_ble.h"
+#include "app_error.h"
+#include "nordic_common.h"
+#include "ble_advertising.h"
+#include "ble_nus.h"
+#include "nrf_ble_gatt.h"
+#include "nrf_ble_qwr.h"
+
+
+/* Nordic UART Service */
+
+uint32_t ble_nus_init(ble_nus_t * p_nus, ble_nus_init_t const * p_nus_init)
+{
+    if (p_nus == NULL || p_nus_init == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    memset(p_nus, 0, sizeof(*p_nus));
+    p_nus->data_handler = p_nus_init->data_handler;
+    p_nus->conn_handle  = BLE_CONN_HANDLE_INVALID;
+    p_nus->uuid_type    = BLE_UUID_TYPE_VENDOR_BEGIN;
+
+    sim_sd_char_add(BLE_UUID_NUS_RX_CHARACTERISTIC, false, &p_nus->rx_handles);
+    sim_sd_char_add(BLE_UUID_NUS_TX_CHARACTERISTIC, true, &p_nus->tx_handles);
+    return NRF_SUCCESS;
+}
+
+
+static void nus_evt_send(ble_nus_t * p_nus, ble_nus_evt_type_t type, uint8_t const * p_data, uint16_t length)
+{
+    ble_nus_evt_t evt;
+
+    if (p_nus->data_handler == NULL)
+    {
+        return;
+    }
+    memset(&evt, 0, sizeof(evt));
+    evt.type                  = type;
+    evt.p_nus                 = p_nus;
+    evt.conn_handle           = p_nus->conn_handle;
+    evt.p_link_ctx            = &p_nus->link_ctx;
+    evt.params.rx_data.p_data = p_data;
+    evt.params.rx_data.length = length;
+    p_nus->data_handler(&evt);
+}
+
+
+void ble_nus_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    ble_nus_t * p_nus = (ble_nus_t *)p_context;
+
+    switch (p_ble_evt->header.evt_id)
+    {
+        case BLE_GAP_EVT_CONNECTED:
+            p_nus->conn_handle                      = p_ble_evt->evt.gap_evt.conn_handle;
+            p_nus->link_ctx.is_notification_enabled = false;
+            break;
+
+        case BLE_GAP_EVT_DISCONNECTED:
+            p_nus->conn_handle                      = BLE_CONN_HANDLE_INVALID;
+            p_nus->link_ctx.is_notification_enabled = false;
+            break;
+
+        case BLE_GATTS_EVT_WRITE:
+        {
+            ble_gatts_evt_write_t const * p_write = &p_ble_evt->evt.gatts_evt.params.write;
+
+            if (p_write->handle == p_nus->tx_handles.cccd_handle && p_write->len == 2)
+            {
+                p_nus->link_ctx.is_notification_enabled = ble_srv_is_notification_enabled(p_write->data);
+                nus_evt_send(p_nus,
+                             p_nus->link_ctx.is_notification_enabled ? BLE_NUS_EVT_COMM_STARTED :
+                                                                       BLE_NUS_EVT_COMM_STOPPED,
+                             NULL, 0);
+            }
+            else if (p_write->handle == p_nus->rx_handles.value_handle)
+            {
+                nus_evt_send(p_nus, BLE_NUS_EVT_RX_DATA, p_write->data, p_write->len);
+            }
+        } break;
+
+        case BLE_GATTS_EVT_HVN_TX_COMPLETE:
+            if (p_nus->link_ctx.is_notification_enabled)
+            {
+                nus_evt_send(p_nus, BLE_NUS_EVT_TX_RDY, NULL, 0);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+uint32_t ble_nus_data_send(ble_nus_t * p_nus, uint8_t * p_data, uint16_t * p_length, uint16_t conn_handle)
+{
+    ble_gatts_hvx_params_t hvx_params;
+
+    if (p_nus == NULL || p_data == NULL || p_length == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (conn_handle == BLE_CONN_HANDLE_INVALID || conn_handle != p_nus->conn_handle)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    if (!p_nus->link_ctx.is_notification_enabled)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (*p_length > BLE_NUS_MAX_DATA_LEN)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    memset(&hvx_params, 0, sizeof(hvx_params));
+    hvx_params.handle = p_nus->tx_handles.value_handle;
+    hvx_params.p_data = p_data;
+    hvx_params.p_len  = p_length;
+    hvx_params.type   = BLE_GATT_HVX_NOTIFICATION;
+    return sd_ble_gatts_hvx(conn_handle, &hvx_params);
+}
+
+
+/* GATT */
+
+ret_code_t nrf_ble_gatt_init(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_handler_t evt_handler)
+{
+    if (p_gatt == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    memset(p_gatt, 0, sizeof(*p_gatt));
+    p_gatt->evt_handler             = evt_handler;
+    p_gatt->att_mtu_desired_periph  = NRF_SDH_BLE_GATT_MAX_MTU_SIZE;
+    p_gatt->att_mtu_desired_central = NRF_SDH_BLE_GATT_MAX_MTU_SIZE;
+    p_gatt->conn_handle             = BLE_CONN_HANDLE_INVALID;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_ble_gatt_att_mtu_periph_set(nrf_ble_gatt_t * p_gatt, uint16_t desired_mtu)
+{
+    if (p_gatt == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (desired_mtu < BLE_GATT_ATT_MTU_DEFAULT || desired_mtu > NRF_SDH_BLE_GATT_MAX_MTU_SIZE)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    p_gatt->att_mtu_desired_periph = desired_mtu;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_ble_gatt_att_mtu_central_set(nrf_ble_gatt_t * p_gatt, uint16_t desired_mtu)
+{
+    if (p_gatt == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (desired_mtu < BLE_GATT_ATT_MTU_DEFAULT || desired_mtu > NRF_SDH_BLE_GATT_MAX_MTU_SIZE)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    p_gatt->att_mtu_desired_central = desired_mtu;
+    return NRF_SUCCESS;
+}
+
+
+uint16_t nrf_ble_gatt_eff_mtu_get(nrf_ble_gatt_t const * p_gatt, uint16_t conn_handle)
+{
+    if (p_gatt == NULL || conn_handle != p_gatt->conn_handle)
+    {
+        return 0;
+    }
+    return p_gatt->link.att_mtu_effective;
+}
+
+
+void nrf_ble_gatt_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    nrf_ble_gatt_t * p_gatt = (nrf_ble_gatt_t *)p_context;
+
+    switch (p_ble_evt->header.evt_id)
+    {
+        case BLE_GAP_EVT_CONNECTED:
+            p_gatt->conn_handle                    = p_ble_evt->evt.gap_evt.conn_handle;
+            p_gatt->link.att_mtu_desired           = p_gatt->att_mtu_desired_periph;
+            p_gatt->link.att_mtu_effective         = BLE_GATT_ATT_MTU_DEFAULT;
+            p_gatt->link.att_mtu_exchange_pending  = false;
+            p_gatt->link.att_mtu_exchange_requested = false;
+            if (p_gatt->link.att_mtu_desired > BLE_GATT_ATT_MTU_DEFAULT)
+            {
+                ret_code_t err_code = sd_ble_gattc_exchange_mtu_request(p_gatt->conn_handle,
+                                                                        p_gatt->link.att_mtu_desired);
+                p_gatt->link.att_mtu_exchange_requested = (err_code == NRF_SUCCESS);
+                p_gatt->link.att_mtu_exchange_pending   = (err_code == NRF_ERROR_BUSY);
+            }
+            break;
+
+        case BLE_GAP_EVT_DISCONNECTED:
+            p_gatt->conn_handle = BLE_CONN_HANDLE_INVALID;
+            memset(&p_gatt->link, 0, sizeof(p_gatt->link));
+            break;
+
+        case BLE_GATTC_EVT_EXCHANGE_MTU_RSP:
+        {
+            uint16_t server_rx_mtu = p_ble_evt->evt.gattc_evt.params.exchange_mtu_rsp.server_rx_mtu;
+
+            p_gatt->link.att_mtu_effective = MAX(MIN(server_rx_mtu, p_gatt->link.att_mtu_desired),
+                                                 BLE_GATT_ATT_MTU_DEFAULT);
+            if (p_gatt->evt_handler != NULL)
+            {
+                nrf_ble_gatt_evt_t evt =
+                {
+                    .evt_id                   = NRF_BLE_GATT_EVT_ATT_MTU_UPDATED,
+                    .conn_handle              = p_gatt->conn_handle,
+                    .params.att_mtu_effective = p_gatt->link.att_mtu_effective,
+                };
+                p_gatt->evt_handler(p_gatt, &evt);
+            }
+        } break;
+
+        case BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST:
+            APP_ERROR_CHECK(sd_ble_gatts_exchange_mtu_reply(p_ble_evt->evt.gatts_evt.conn_handle,
+                                                            p_gatt->att_mtu_desired_periph));
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+/* Queued Writes */
+
+ret_code_t nrf_ble_qwr_init(nrf_ble_qwr_t * p_qwr, nrf_ble_qwr_init_t const * p_qwr_init)
+{
+    if (p_qwr == NULL || p_qwr_init == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (p_qwr->initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    p_qwr->error_handler = p_qwr_init->error_handler;
+    p_qwr->conn_handle   = BLE_CONN_HANDLE_INVALID;
+    p_qwr->initialized   = 1;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_ble_qwr_conn_handle_assign(nrf_ble_qwr_t * p_qwr, uint16_t conn_handle)
+{
+    if (p_qwr == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (!p_qwr->initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    p_qwr->conn_handle = conn_handle;
+    return NRF_SUCCESS;
+}
+
+
+void nrf_ble_qwr_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    nrf_ble_qwr_t * p_qwr = (nrf_ble_qwr_t *)p_context;
+
+    if (p_ble_evt->header.evt_id == BLE_GAP_EVT_DISCONNECTED)
+    {
+        p_qwr->conn_handle = BLE_CONN_HANDLE_INVALID;
+    }
+}
+
+
+/* Advertising */
+
+uint32_t ble_advertising_init(ble_advertising_t * const p_advertising, ble_advertising_init_t const * const p_init)
+{
+    if (p_advertising == NULL || p_init == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (!p_init->config.ble_adv_fast_enabled)
+    {
+        return NRF_ERROR_NOT_SUPPORTED;
+    }
+
+    memset(p_advertising, 0, sizeof(*p_advertising));
+    p_advertising->adv_mode_current               = BLE_ADV_MODE_IDLE;
+    p_advertising->adv_modes_config               = p_init->config;
+    p_advertising->adv_handle                     = BLE_GAP_ADV_SET_HANDLE_NOT_SET;
+    p_advertising->current_slave_link_conn_handle = BLE_CONN_HANDLE_INVALID;
+    p_advertising->evt_handler                    = p_init->evt_handler;
+    p_advertising->error_handler                  = p_init->error_handler;
+    p_advertising->initialized                    = true;
+    return NRF_SUCCESS;
+}
+
+
+void ble_advertising_conn_cfg_tag_set(ble_advertising_t * const p_advertising, uint8_t ble_cfg_tag)
+{
+    p_advertising->conn_cfg_tag = ble_cfg_tag;
+}
+
+
+uint32_t ble_advertising_start(ble_advertising_t * const p_advertising, ble_adv_mode_t advertising_mode)
+{
+    if (!p_advertising->initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (advertising_mode != BLE_ADV_MODE_FAST)
+    {
+        return NRF_ERROR_NOT_SUPPORTED;
+    }
+
+    uint32_t err_code = sim_sd_adv_start(p_advertising->adv_modes_config.ble_adv_fast_timeout * 10);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    p_advertising->adv_mode_current = BLE_ADV_MODE_FAST;
+    p_advertising->adv_handle       = 0;
+    if (p_advertising->evt_handler != NULL)
+    {
+        p_advertising->evt_handler(BLE_ADV_EVT_FAST);
+    }
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_advertising_restart_without_whitelist(ble_advertising_t * const p_advertising)
+{
+    // Whitelists are not modelled, advertising is never restricted
+    (void)p_advertising;
+    return NRF_SUCCESS;
+}
+
+
+void ble_advertising_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    ble_advertising_t * p_advertising = (ble_advertising_t *)p_context;
+
+    switch (p_ble_evt->header.evt_id)
+    {
+        case BLE_GAP_EVT_CONNECTED:
+            p_advertising->current_slave_link_conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+            p_advertising->adv_mode_current               = BLE_ADV_MODE_IDLE;
+            break;
+
+        case BLE_GAP_EVT_DISCONNECTED:
+            if (p_ble_evt->evt.gap_evt.conn_handle == p_advertising->current_slave_link_conn_handle)
+            {
+                p_advertising->current_slave_link_conn_handle = BLE_CONN_HANDLE_INVALID;
+                if (!p_advertising->adv_modes_config.ble_adv_on_disconnect_disabled)
+                {
+                    uint32_t err_code = ble_advertising_start(p_advertising, BLE_ADV_MODE_FAST);
+                    if (err_code != NRF_SUCCESS && p_advertising->error_handler != NULL)
+                    {
+                        p_advertising->error_handler(err_code);
+                    }
+                }
+            }
+            break;
+
+        case BLE_GAP_EVT_ADV_SET_TERMINATED:
+            if (p_ble_evt->evt.gap_evt.params.adv_set_terminated.reason ==
+                BLE_GAP_EVT_ADV_SET_TERMINATED_REASON_TIMEOUT)
+            {
+                p_advertising->adv_mode_current = BLE_ADV_MODE_IDLE;
+                if (p_advertising->evt_handler != NULL)
+                {
+                    p_advertising->evt_handler(BLE_ADV_EVT_IDLE);
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,409 @@
+/**
+ * Host build: legacy nrf_drv_saadc driver (nrfx API v1).
+ *
+ * Follows the buffer handling of the nrfx 1.x driver. In normal mode buffer_convert() starts the first buffer and
+ * latches the second one, and END hands the buffer over with DONE and restarts on the next one. In low power mode
+ * every nrf_drv_saadc_sample() triggers START for one scan, STARTED triggers SAMPLE, and DONE is sent once the
+ * whole buffer is filled.
+ */
+#include <string.h>
+#include "sim_internal.h"
+#include "nrf_drv_saadc.h"
+
+typedef enum
+{
+    STATE_UNINITIALIZED,
+    STATE_IDLE,
+    STATE_BUSY,
+    STATE_CALIBRATION
+} saadc_state_t;
+
+static struct
+{
+    saadc_state_t                 state;
+    nrf_drv_saadc_event_handler_t handler;
+    bool                          low_power_mode;
+    nrf_saadc_value_t *           p_buffer;
+    uint16_t                      buffer_size;
+    uint16_t                      buffer_pos;      // Low power mode, next scan in the buffer
+    nrf_saadc_value_t *           p_secondary;
+    uint16_t                      secondary_size;
+    uint8_t                       active_channels;
+    uint32_t                      channels;
+    uint32_t                      limits_enabled;
+} m_cb;
+
+
+static void done_send(nrf_saadc_value_t * p_buffer, uint16_t size)
+{
+    nrf_drv_saadc_evt_t evt;
+    evt.type               = NRF_DRV_SAADC_EVT_DONE;
+    evt.data.done.p_buffer = p_buffer;
+    evt.data.done.size     = size;
+    m_cb.handler(&evt);
+}
+
+
+static void buffer_next(void)
+{
+    if (m_cb.p_secondary == NULL)
+    {
+        m_cb.p_buffer = NULL;
+        m_cb.state    = STATE_IDLE;
+        return;
+    }
+    m_cb.p_buffer       = m_cb.p_secondary;
+    m_cb.buffer_size    = m_cb.secondary_size;
+    m_cb.buffer_pos     = 0;
+    m_cb.p_secondary    = NULL;
+    m_cb.secondary_size = 0;
+}
+
+
+static void saadc_irq_handler(void)
+{
+    if (nrf_saadc_event_check(NRF_SAADC_EVENT_END))
+    {
+        nrf_saadc_event_clear(NRF_SAADC_EVENT_END);
+
+        if (m_cb.low_power_mode)
+        {
+            m_cb.buffer_pos += m_cb.active_channels;
+            if (m_cb.buffer_pos >= m_cb.buffer_size)
+            {
+                nrf_saadc_value_t * p_done = m_cb.p_buffer;
+                uint16_t            size   = m_cb.buffer_size;
+                buffer_next();
+                if (m_cb.p_buffer != NULL)
+                {
+                    nrf_saadc_buffer_init(m_cb.p_buffer, m_cb.active_channels);
+                }
+                done_send(p_done, size);
+            }
+            else
+            {
+                nrf_saadc_buffer_init(&m_cb.p_buffer[m_cb.buffer_pos], m_cb.active_channels);
+            }
+        }
+        else
+        {
+            nrf_saadc_value_t * p_done = m_cb.p_buffer;
+            uint16_t            size   = m_cb.buffer_size;
+            buffer_next();
+            if (m_cb.p_buffer != NULL)
+            {
+                nrf_saadc_task_trigger(NRF_SAADC_TASK_START);
+            }
+            done_send(p_done, size);
+        }
+    }
+
+    if (m_cb.low_power_mode && nrf_saadc_event_check(NRF_SAADC_EVENT_STARTED))
+    {
+        nrf_saadc_event_clear(NRF_SAADC_EVENT_STARTED);
+        nrf_saadc_task_trigger(NRF_SAADC_TASK_SAMPLE);
+    }
+
+    if (nrf_saadc_event_check(NRF_SAADC_EVENT_CALIBRATEDONE))
+    {
+        nrf_saadc_event_clear(NRF_SAADC_EVENT_CALIBRATEDONE);
+        m_cb.state = STATE_IDLE;
+
+        nrf_drv_saadc_evt_t evt;
+        evt.type = NRF_DRV_SAADC_EVT_CALIBRATEDONE;
+        m_cb.handler(&evt);
+    }
+
+    if (nrf_saadc_event_check(NRF_SAADC_EVENT_STOPPED))
+    {
+        nrf_saadc_event_clear(NRF_SAADC_EVENT_STOPPED);
+        m_cb.state = STATE_IDLE;
+    }
+
+    for (uint8_t ch = 0; ch < SAADC_CH_NUM; ch++)
+    {
+        for (nrf_saadc_limit_t limit = NRF_SAADC_LIMIT_LOW; limit <= NRF_SAADC_LIMIT_HIGH; limit++)
+        {
+            nrf_saadc_event_t event = nrf_saadc_event_limit_get(ch, limit);
+            if ((m_cb.limits_enabled & nrf_saadc_limit_int_get(ch, limit)) && nrf_saadc_event_check(event))
+            {
+                nrf_saadc_event_clear(event);
+
+                nrf_drv_saadc_evt_t evt;
+                evt.type                  = NRF_DRV_SAADC_EVT_LIMIT;
+                evt.data.limit.channel    = ch;
+                evt.data.limit.limit_type = limit;
+                m_cb.handler(&evt);
+            }
+        }
+    }
+}
+
+
+ret_code_t nrf_drv_saadc_init(nrf_drv_saadc_config_t const * p_config, nrf_drv_saadc_event_handler_t event_handler)
+{
+    sim_poll();
+    if (m_cb.state != STATE_UNINITIALIZED)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (event_handler == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    memset(&m_cb, 0, sizeof(m_cb));
+    m_cb.handler        = event_handler;
+    m_cb.low_power_mode = p_config->low_power_mode;
+
+    nrf_saadc_resolution_set(p_config->resolution);
+    nrf_saadc_oversample_set(p_config->oversample);
+    for (uint8_t ch = 0; ch < SAADC_CH_NUM; ch++)
+    {
+        nrf_saadc_channel_input_set(ch, NRF_SAADC_INPUT_DISABLED, NRF_SAADC_INPUT_DISABLED);
+        nrf_saadc_channel_limits_set(ch, NRF_SAADC_LIMITL_DISABLED, NRF_SAADC_LIMITH_DISABLED);
+    }
+    nrf_saadc_int_disable(NRF_SAADC_INT_ALL);
+    nrf_saadc_event_clear(NRF_SAADC_EVENT_END);
+    nrf_saadc_event_clear(NRF_SAADC_EVENT_STARTED);
+    nrf_saadc_int_enable(NRF_SAADC_INT_END);
+    if (m_cb.low_power_mode)
+    {
+        nrf_saadc_int_enable(NRF_SAADC_INT_STARTED);
+    }
+    sim_irq_connect(SAADC_IRQn, "SAADC", saadc_irq_handler);
+    nrf_saadc_enable();
+
+    m_cb.state = STATE_IDLE;
+    return NRF_SUCCESS;
+}
+
+
+void nrf_drv_saadc_uninit(void)
+{
+    nrf_saadc_int_disable(NRF_SAADC_INT_ALL);
+    nrf_drv_saadc_abort();
+    nrf_saadc_disable();
+    m_cb.state = STATE_UNINITIALIZED;
+}
+
+
+ret_code_t nrf_drv_saadc_channel_init(uint8_t channel, nrf_saadc_channel_config_t const * const p_config)
+{
+    if (channel >= SAADC_CH_NUM)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (m_cb.state == STATE_BUSY)
+    {
+        return NRF_ERROR_BUSY;
+    }
+    // Oversampling in scan mode needs burst
+    if (nrf_saadc_oversample_get() != NRF_SAADC_OVERSAMPLE_DISABLED && m_cb.active_channels > 0 &&
+        p_config->burst != NRF_SAADC_BURST_ENABLED)
+    {
+        return NRF_ERROR_NOT_SUPPORTED;
+    }
+
+    if (!(m_cb.channels & (1UL << channel)) && p_config->pin_p != NRF_SAADC_INPUT_DISABLED)
+    {
+        m_cb.channels |= 1UL << channel;
+        m_cb.active_channels++;
+    }
+    nrf_saadc_channel_init(channel, p_config);
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_drv_saadc_channel_uninit(uint8_t channel)
+{
+    if (m_cb.state == STATE_BUSY)
+    {
+        return NRF_ERROR_BUSY;
+    }
+    if (m_cb.channels & (1UL << channel))
+    {
+        m_cb.channels &= ~(1UL << channel);
+        m_cb.active_channels--;
+    }
+    nrf_saadc_channel_input_set(channel, NRF_SAADC_INPUT_DISABLED, NRF_SAADC_INPUT_DISABLED);
+    nrf_drv_saadc_limits_set(channel, NRF_SAADC_LIMITL_DISABLED, NRF_SAADC_LIMITH_DISABLED);
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_drv_saadc_sample_convert(uint8_t channel, nrf_saadc_value_t * p_value)
+{
+    if (m_cb.state != STATE_IDLE)
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    // Converts the given channel only, blocking
+    uint32_t pselp[SAADC_CH_NUM];
+    for (uint8_t ch = 0; ch < SAADC_CH_NUM; ch++)
+    {
+        pselp[ch] = NRF_SAADC->CH[ch].PSELP;
+        if (ch != channel)
+        {
+            NRF_SAADC->CH[ch].PSELP = NRF_SAADC_INPUT_DISABLED;
+        }
+    }
+    m_cb.state = STATE_BUSY;
+    nrf_saadc_int_disable(NRF_SAADC_INT_STARTED | NRF_SAADC_INT_END);
+    nrf_saadc_buffer_init(p_value, 1);
+    nrf_saadc_task_trigger(NRF_SAADC_TASK_START);
+    nrf_saadc_task_trigger(NRF_SAADC_TASK_SAMPLE);
+    while (!nrf_saadc_event_check(NRF_SAADC_EVENT_END))
+    {
+        sim_poll();
+    }
+    nrf_saadc_event_clear(NRF_SAADC_EVENT_STARTED);
+    nrf_saadc_event_clear(NRF_SAADC_EVENT_END);
+    for (uint8_t ch = 0; ch < SAADC_CH_NUM; ch++)
+    {
+        NRF_SAADC->CH[ch].PSELP = pselp[ch];
+    }
+    nrf_saadc_int_enable(NRF_SAADC_INT_END | (m_cb.low_power_mode ? NRF_SAADC_INT_STARTED : 0));
+    m_cb.state = STATE_IDLE;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_drv_saadc_buffer_convert(nrf_saadc_value_t * p_buffer, uint16_t size)
+{
+    sim_poll();
+    if (m_cb.active_channels == 0 || (size % m_cb.active_channels) != 0)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    uint32_t result = NRF_SUCCESS;
+    CRITICAL_REGION_ENTER();
+    if (m_cb.state == STATE_BUSY)
+    {
+        if (m_cb.p_secondary != NULL)
+        {
+            result = NRF_ERROR_BUSY;
+        }
+        else
+        {
+            m_cb.p_secondary    = p_buffer;
+            m_cb.secondary_size = size;
+            if (!m_cb.low_power_mode)
+            {
+                // The current buffer has been latched at STARTED, the next START takes this one
+                nrf_saadc_event_clear(NRF_SAADC_EVENT_STARTED);
+                nrf_saadc_buffer_init(p_buffer, size);
+            }
+        }
+    }
+    else if (m_cb.state == STATE_CALIBRATION)
+    {
+        result = NRF_ERROR_BUSY;
+    }
+    else
+    {
+        m_cb.state       = STATE_BUSY;
+        m_cb.p_buffer    = p_buffer;
+        m_cb.buffer_size = size;
+        m_cb.buffer_pos  = 0;
+        m_cb.p_secondary = NULL;
+        nrf_saadc_event_clear(NRF_SAADC_EVENT_STARTED);
+        nrf_saadc_event_clear(NRF_SAADC_EVENT_END);
+        if (m_cb.low_power_mode)
+        {
+            nrf_saadc_buffer_init(p_buffer, m_cb.active_channels);
+        }
+        else
+        {
+            nrf_saadc_buffer_init(p_buffer, size);
+            nrf_saadc_task_trigger(NRF_SAADC_TASK_START);
+        }
+    }
+    CRITICAL_REGION_EXIT();
+    return result;
+}
+
+
+ret_code_t nrf_drv_saadc_sample(void)
+{
+    sim_poll();
+    if (m_cb.state != STATE_BUSY)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    nrf_saadc_task_trigger(m_cb.low_power_mode ? NRF_SAADC_TASK_START : NRF_SAADC_TASK_SAMPLE);
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_drv_saadc_calibrate_offset(void)
+{
+    sim_poll();
+    if (m_cb.state != STATE_IDLE)
+    {
+        return NRF_ERROR_BUSY;
+    }
+    m_cb.state = STATE_CALIBRATION;
+    nrf_saadc_event_clear(NRF_SAADC_EVENT_CALIBRATEDONE);
+    nrf_saadc_int_enable(NRF_SAADC_INT_CALIBRATEDONE);
+    nrf_saadc_task_trigger(NRF_SAADC_TASK_CALIBRATEOFFSET);
+    return NRF_SUCCESS;
+}
+
+
+bool nrf_drv_saadc_is_busy(void)
+{
+    return m_cb.state != STATE_IDLE;
+}
+
+
+void nrf_drv_saadc_abort(void)
+{
+    sim_poll();
+    if (m_cb.state == STATE_IDLE || m_cb.state == STATE_UNINITIALIZED)
+    {
+        return;
+    }
+
+    nrf_saadc_int_enable(NRF_SAADC_INT_STOPPED);
+    nrf_saadc_task_trigger(NRF_SAADC_TASK_STOP);
+
+    // Wait for the STOPPED interrupt, unless this is the SAADC interrupt itself
+    while (m_cb.state != STATE_IDLE && !nrf_saadc_event_check(NRF_SAADC_EVENT_STOPPED))
+    {
+        sim_poll();
+    }
+    nrf_saadc_event_clear(NRF_SAADC_EVENT_STOPPED);
+    nrf_saadc_int_disable(NRF_SAADC_INT_STOPPED);
+    m_cb.state       = STATE_IDLE;
+    m_cb.p_buffer    = NULL;
+    m_cb.p_secondary = NULL;
+}
+
+
+void nrf_drv_saadc_limits_set(uint8_t channel, int16_t limit_low, int16_t limit_high)
+{
+    nrf_saadc_channel_limits_set(channel, limit_low, limit_high);
+
+    uint32_t low  = nrf_saadc_limit_int_get(channel, NRF_SAADC_LIMIT_LOW);
+    uint32_t high = nrf_saadc_limit_int_get(channel, NRF_SAADC_LIMIT_HIGH);
+    m_cb.limits_enabled &= ~(low | high);
+    if (limit_low != NRF_DRV_SAADC_LIMITL_DISABLED)
+    {
+        m_cb.limits_enabled |= low;
+    }
+    if (limit_high != NRF_DRV_SAADC_LIMITH_DISABLED)
+    {
+        m_cb.limits_enabled |= high;
+    }
+    nrf_saadc_int_disable(low | high);
+    nrf_saadc_int_enable(m_cb.limits_enabled & (low | high));
+}
+
+
+uint32_t nrf_drv_saadc_sample_task_get(void)
+{
+    return nrf_saadc_task_address_get(m_cb.low_power_mode ? NRF_SAADC_TASK_START : NRF_SAADC_TASK_SAMPLE);
+}
@@ -0,0 +1,549 @@
+/**
+ * Host build: nrfx_saadc driver, API v2.
+ *
+ * Follows the buffer handling of the nrfx 2.x driver: in advanced mode STARTED latches the secondary buffer, or asks
+ * for one with BUF_REQ, and END hands the primary buffer over with DONE and restarts on the secondary when
+ * start_on_end is set. FINISHED follows the last buffer. In simple mode a NULL handler makes the call blocking.
+ */
+#include <string.h>
+#include "sim_internal.h"
+#include "nrfx_saadc.h"
+
+typedef enum
+{
+    STATE_UNINITIALIZED,
+    STATE_IDLE,
+    STATE_SIMPLE,
+    STATE_SIMPLE_SAMPLING,
+    STATE_ADVANCED,
+    STATE_ADVANCED_SAMPLING,
+    STATE_ADVANCED_STARTED,
+    STATE_CALIBRATION
+} saadc_state_t;
+
+static struct
+{
+    saadc_state_t              state;
+    saadc_state_t              state_before_calibration;
+    nrfx_saadc_event_handler_t handler;
+    nrfx_saadc_event_handler_t calib_handler;
+    nrf_saadc_value_t *        p_primary;
+    uint16_t                   primary_size;
+    nrf_saadc_value_t *        p_secondary;
+    uint16_t                   secondary_size;
+    nrf_saadc_input_t          pselp[SAADC_CH_NUM];
+    nrf_saadc_input_t          pseln[SAADC_CH_NUM];
+    uint32_t                   configured;
+    uint32_t                   activated;
+    uint8_t                    active_count;
+    uint32_t                   limits_enabled;
+    nrfx_saadc_adv_config_t    adv;
+} m_cb;
+
+
+static void event_send(nrfx_saadc_evt_t const * p_event)
+{
+    if (m_cb.handler != NULL)
+    {
+        m_cb.handler(p_event);
+    }
+}
+
+
+static void saadc_irq_handler(void)
+{
+    nrfx_saadc_evt_t evt;
+
+    if (nrf_saadc_event_check(NRF_SAADC_EVENT_CALIBRATEDONE))
+    {
+        nrf_saadc_event_clear(NRF_SAADC_EVENT_CALIBRATEDONE);
+        nrf_saadc_int_disable(NRF_SAADC_INT_CALIBRATEDONE);
+        m_cb.state = m_cb.state_before_calibration;
+        evt.type   = NRFX_SAADC_EVT_CALIBRATEDONE;
+        if (m_cb.calib_handler != NULL)
+        {
+            m_cb.calib_handler(&evt);
+        }
+    }
+
+    if (nrf_saadc_event_check(NRF_SAADC_EVENT_STOPPED))
+    {
+        nrf_saadc_event_clear(NRF_SAADC_EVENT_STOPPED);
+    }
+
+    if (nrf_saadc_event_check(NRF_SAADC_EVENT_STARTED))
+    {
+        nrf_saadc_event_clear(NRF_SAADC_EVENT_STARTED);
+        if (m_cb.state == STATE_ADVANCED_SAMPLING)
+        {
+            m_cb.state = STATE_ADVANCED_STARTED;
+            if (m_cb.adv.internal_timer_cc != 0)
+            {
+                nrf_saadc_task_trigger(NRF_SAADC_TASK_SAMPLE);
+            }
+            evt.type = NRFX_SAADC_EVT_READY;
+            event_send(&evt);
+        }
+        if (m_cb.state == STATE_ADVANCED_STARTED)
+        {
+            if (m_cb.p_secondary != NULL)
+            {
+                nrf_saadc_buffer_init(m_cb.p_secondary, m_cb.secondary_size);
+            }
+            else
+            {
+                evt.type = NRFX_SAADC_EVT_BUF_REQ;
+                event_send(&evt);
+            }
+        }
+    }
+
+    if (nrf_saadc_event_check(NRF_SAADC_EVENT_END))
+    {
+        nrf_saadc_event_clear(NRF_SAADC_EVENT_END);
+        if (m_cb.state == STATE_SIMPLE_SAMPLING)
+        {
+            m_cb.state              = STATE_SIMPLE;
+            evt.type                = NRFX_SAADC_EVT_DONE;
+            evt.data.done.p_buffer  = m_cb.p_primary;
+            evt.data.done.size      = m_cb.primary_size;
+            m_cb.p_primary          = NULL;
+            event_send(&evt);
+            evt.type = NRFX_SAADC_EVT_FINISHED;
+            event_send(&evt);
+        }
+        else if (m_cb.state == STATE_ADVANCED_STARTED)
+        {
+            evt.type               = NRFX_SAADC_EVT_DONE;
+            evt.data.done.p_buffer = m_cb.p_primary;
+            evt.data.done.size     = m_cb.primary_size;
+
+            m_cb.p_primary      = m_cb.p_secondary;
+            m_cb.primary_size   = m_cb.secondary_size;
+            m_cb.p_secondary    = NULL;
+            m_cb.secondary_size = 0;
+            if (m_cb.p_primary != NULL && m_cb.adv.start_on_end)
+            {
+                nrf_saadc_task_trigger(NRF_SAADC_TASK_START);
+            }
+            event_send(&evt);
+
+            if (m_cb.p_primary == NULL)
+            {
+                m_cb.state = STATE_ADVANCED;
+                nrf_saadc_task_trigger(NRF_SAADC_TASK_STOP);
+                evt.type = NRFX_SAADC_EVT_FINISHED;
+                event_send(&evt);
+            }
+        }
+    }
+
+    for (uint8_t ch = 0; ch < SAADC_CH_NUM; ch++)
+    {
+        for (nrf_saadc_limit_t limit = NRF_SAADC_LIMIT_LOW; limit <= NRF_SAADC_LIMIT_HIGH; limit++)
+        {
+            nrf_saadc_event_t event = nrf_saadc_event_limit_get(ch, limit);
+            if ((m_cb.limits_enabled & nrf_saadc_limit_int_get(ch, limit)) && nrf_saadc_event_check(event))
+            {
+                nrf_saadc_event_clear(event);
+                evt.type                  = NRFX_SAADC_EVT_LIMIT;
+                evt.data.limit.channel    = ch;
+                evt.data.limit.limit_type = limit;
+                event_send(&evt);
+            }
+        }
+    }
+}
+
+
+static bool is_busy(void)
+{
+    return (m_cb.state == STATE_SIMPLE_SAMPLING) || (m_cb.state == STATE_ADVANCED_SAMPLING) ||
+           (m_cb.state == STATE_ADVANCED_STARTED) || (m_cb.state == STATE_CALIBRATION);
+}
+
+
+nrfx_err_t nrfx_saadc_init(uint8_t interrupt_priority)
+{
+    (void)interrupt_priority;
+    sim_poll();
+    if (m_cb.state != STATE_UNINITIALIZED)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    memset(&m_cb, 0, sizeof(m_cb));
+    for (uint8_t ch = 0; ch < SAADC_CH_NUM; ch++)
+    {
+        nrf_saadc_channel_input_set(ch, NRF_SAADC_INPUT_DISABLED, NRF_SAADC_INPUT_DISABLED);
+        nrf_saadc_channel_limits_set(ch, NRF_SAADC_LIMITL_DISABLED, NRF_SAADC_LIMITH_DISABLED);
+    }
+    nrf_saadc_int_disable(NRF_SAADC_INT_ALL);
+    sim_irq_connect(SAADC_IRQn, "SAADC", saadc_irq_handler);
+    m_cb.state = STATE_IDLE;
+    return NRFX_SUCCESS;
+}
+
+
+void nrfx_saadc_uninit(void)
+{
+    nrfx_saadc_abort();
+    nrf_saadc_int_disable(NRF_SAADC_INT_ALL);
+    nrf_saadc_disable();
+    m_cb.state = STATE_UNINITIALIZED;
+}
+
+
+nrfx_err_t nrfx_saadc_channel_config(nrfx_saadc_channel_t const * p_channel)
+{
+    if (is_busy())
+    {
+        return NRFX_ERROR_BUSY;
+    }
+    if (p_channel->channel_index >= SAADC_CH_NUM)
+    {
+        return NRFX_ERROR_INVALID_PARAM;
+    }
+
+    uint8_t ch = p_channel->channel_index;
+    nrf_saadc_channel_init(ch, &p_channel->channel_config);
+    // Inputs are connected when the channel is activated by a mode setting
+    nrf_saadc_channel_input_set(ch, NRF_SAADC_INPUT_DISABLED, NRF_SAADC_INPUT_DISABLED);
+    m_cb.pselp[ch]   = p_channel->pin_p;
+    m_cb.pseln[ch]   = p_channel->pin_n;
+    m_cb.configured |= 1UL << ch;
+    return NRFX_SUCCESS;
+}
+
+
+nrfx_err_t nrfx_saadc_channels_config(nrfx_saadc_channel_t const * p_channels, uint32_t channel_count)
+{
+    if (is_busy())
+    {
+        return NRFX_ERROR_BUSY;
+    }
+
+    m_cb.configured = 0;
+    for (uint32_t i = 0; i < channel_count; i++)
+    {
+        nrfx_err_t err = nrfx_saadc_channel_config(&p_channels[i]);
+        if (err != NRFX_SUCCESS)
+        {
+            return err;
+        }
+    }
+    return NRFX_SUCCESS;
+}
+
+
+uint32_t nrfx_saadc_channels_configured_get(void)
+{
+    return m_cb.configured;
+}
+
+
+static nrfx_err_t mode_set(uint32_t               channel_mask,
+                           nrf_saadc_resolution_t resolution,
+                           nrf_saadc_oversample_t oversampling,
+                           nrf_saadc_burst_t      burst)
+{
+    if (m_cb.state == STATE_UNINITIALIZED)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    if (is_busy())
+    {
+        return NRFX_ERROR_BUSY;
+    }
+    if (channel_mask == 0 || (channel_mask & ~m_cb.configured))
+    {
+        return NRFX_ERROR_INVALID_PARAM;
+    }
+
+    m_cb.activated    = channel_mask;
+    m_cb.active_count = 0;
+    for (uint8_t ch = 0; ch < SAADC_CH_NUM; ch++)
+    {
+        if (channel_mask & (1UL << ch))
+        {
+            nrf_saadc_channel_input_set(ch, m_cb.pselp[ch], m_cb.pseln[ch]);
+            nrf_saadc_burst_set(ch, burst);
+            m_cb.active_count++;
+        }
+        else
+        {
+            nrf_saadc_channel_input_set(ch, NRF_SAADC_INPUT_DISABLED, NRF_SAADC_INPUT_DISABLED);
+        }
+    }
+    nrf_saadc_resolution_set(resolution);
+    nrf_saadc_oversample_set(oversampling);
+    m_cb.p_primary   = NULL;
+    m_cb.p_secondary = NULL;
+    return NRFX_SUCCESS;
+}
+
+
+nrfx_err_t nrfx_saadc_simple_mode_set(uint32_t                   channel_mask,
+                                      nrf_saadc_resolution_t     resolution,
+                                      nrf_saadc_oversample_t     oversampling,
+                                      nrfx_saadc_event_handler_t event_handler)
+{
+    // Oversampling in scan mode needs burst, the driver always enables it with oversampling
+    nrf_saadc_burst_t burst = (oversampling != NRF_SAADC_OVERSAMPLE_DISABLED) ? NRF_SAADC_BURST_ENABLED
+                                                                              : NRF_SAADC_BURST_DISABLED;
+    nrfx_err_t err = mode_set(channel_mask, resolution, oversampling, burst);
+    if (err != NRFX_SUCCESS)
+    {
+        return err;
+    }
+
+    nrf_saadc_continuous_mode_disable();
+    memset(&m_cb.adv, 0, sizeof(m_cb.adv));
+    m_cb.handler = event_handler;
+    m_cb.state   = STATE_SIMPLE;
+    return NRFX_SUCCESS;
+}
+
+
+nrfx_err_t nrfx_saadc_advanced_mode_set(uint32_t                        channel_mask,
+                                        nrf_saadc_resolution_t          resolution,
+                                        nrfx_saadc_adv_config_t const * p_config,
+                                        nrfx_saadc_event_handler_t      event_handler)
+{
+    if (event_handler == NULL)
+    {
+        return NRFX_ERROR_INVALID_PARAM;
+    }
+    // The internal timer only works with a single channel and without burst
+    if (p_config->internal_timer_cc != 0 &&
+        ((channel_mask & (channel_mask - 1)) != 0 || p_config->burst == NRF_SAADC_BURST_ENABLED ||
+         p_config->internal_timer_cc < 80 || p_config->internal_timer_cc > 2047))
+    {
+        return NRFX_ERROR_INVALID_PARAM;
+    }
+
+    nrfx_err_t err = mode_set(channel_mask, resolution, p_config->oversampling, p_config->burst);
+    if (err != NRFX_SUCCESS)
+    {
+        return err;
+    }
+
+    if (p_config->internal_timer_cc != 0)
+    {
+        nrf_saadc_continuous_mode_enable(p_config->internal_timer_cc);
+    }
+    else
+    {
+        nrf_saadc_continuous_mode_disable();
+    }
+    m_cb.adv     = *p_config;
+    m_cb.handler = event_handler;
+    m_cb.state   = STATE_ADVANCED;
+    return NRFX_SUCCESS;
+}
+
+
+nrfx_err_t nrfx_saadc_buffer_set(nrf_saadc_value_t * p_buffer, uint16_t size)
+{
+    if (m_cb.p_secondary != NULL)
+    {
+        return NRFX_ERROR_ALREADY_INITIALIZED;
+    }
+    if (p_buffer == NULL || size == 0 || m_cb.active_count == 0 || (size % m_cb.active_count) != 0)
+    {
+        return NRFX_ERROR_INVALID_PARAM;
+    }
+
+    switch (m_cb.state)
+    {
+        case STATE_SIMPLE:
+            if (m_cb.p_primary != NULL)
+            {
+                return NRFX_ERROR_ALREADY_INITIALIZED;
+            }
+            if (size != m_cb.active_count)
+            {
+                return NRFX_ERROR_INVALID_PARAM;
+            }
+            m_cb.p_primary    = p_buffer;
+            m_cb.primary_size = size;
+            break;
+
+        case STATE_ADVANCED_STARTED:
+            m_cb.p_secondary    = p_buffer;
+            m_cb.secondary_size = size;
+            nrf_saadc_buffer_init(p_buffer, size);
+            break;
+
+        case STATE_ADVANCED:
+        case STATE_ADVANCED_SAMPLING:
+            if (m_cb.p_primary == NULL)
+            {
+                m_cb.p_primary    = p_buffer;
+                m_cb.primary_size = size;
+            }
+            else
+            {
+                m_cb.p_secondary    = p_buffer;
+                m_cb.secondary_size = size;
+            }
+            break;
+
+        case STATE_CALIBRATION:
+        case STATE_SIMPLE_SAMPLING:
+            return NRFX_ERROR_BUSY;
+
+        default:
+            return NRFX_ERROR_INVALID_STATE;
+    }
+    return NRFX_SUCCESS;
+}
+
+
+nrfx_err_t nrfx_saadc_mode_trigger(void)
+{
+    sim_poll();
+    switch (m_cb.state)
+    {
+        case STATE_SIMPLE:
+            if (m_cb.p_primary == NULL)
+            {
+                return NRFX_ERROR_INVALID_STATE;
+            }
+            m_cb.state = STATE_SIMPLE_SAMPLING;
+            nrf_saadc_enable();
+            nrf_saadc_buffer_init(m_cb.p_primary, m_cb.primary_size);
+            nrf_saadc_event_clear(NRF_SAADC_EVENT_STARTED);
+            nrf_saadc_event_clear(NRF_SAADC_EVENT_END);
+            if (m_cb.handler == NULL)
+            {
+                // Blocking mode
+                nrf_saadc_int_disable(NRF_SAADC_INT_ALL);
+                nrf_saadc_task_trigger(NRF_SAADC_TASK_START);
+                nrf_saadc_task_trigger(NRF_SAADC_TASK_SAMPLE);
+                while (!nrf_saadc_event_check(NRF_SAADC_EVENT_END))
+                {
+                    sim_poll();
+                }
+                nrf_saadc_event_clear(NRF_SAADC_EVENT_END);
+                m_cb.p_primary = NULL;
+                m_cb.state     = STATE_SIMPLE;
+                return NRFX_SUCCESS;
+            }
+            nrf_saadc_int_enable(NRF_SAADC_INT_END);
+            nrf_saadc_task_trigger(NRF_SAADC_TASK_START);
+            nrf_saadc_task_trigger(NRF_SAADC_TASK_SAMPLE);
+            return NRFX_SUCCESS;
+
+        case STATE_ADVANCED:
+            if (m_cb.p_primary == NULL)
+            {
+                return NRFX_ERROR_INVALID_STATE;
+            }
+            m_cb.state = STATE_ADVANCED_SAMPLING;
+            nrf_saadc_enable();
+            nrf_saadc_buffer_init(m_cb.p_primary, m_cb.primary_size);
+            nrf_saadc_event_clear(NRF_SAADC_EVENT_STARTED);
+            nrf_saadc_event_clear(NRF_SAADC_EVENT_END);
+            nrf_saadc_int_enable(NRF_SAADC_INT_STARTED | NRF_SAADC_INT_END | NRF_SAADC_INT_STOPPED);
+            nrf_saadc_task_trigger(NRF_SAADC_TASK_START);
+            return NRFX_SUCCESS;
+
+        case STATE_UNINITIALIZED:
+        case STATE_IDLE:
+            return NRFX_ERROR_INVALID_STATE;
+
+        default:
+            return NRFX_ERROR_BUSY;
+    }
+}
+
+
+void nrfx_saadc_abort(void)
+{
+    if (!is_busy())
+    {
+        return;
+    }
+
+    // The model stops right away, STOPPED is handled in the interrupt
+    nrf_saadc_task_trigger(NRF_SAADC_TASK_STOP);
+
+    nrfx_saadc_evt_t evt = { .type = NRFX_SAADC_EVT_FINISHED };
+    saadc_state_t    was = m_cb.state;
+
+    m_cb.p_primary   = NULL;
+    m_cb.p_secondary = NULL;
+    if (was == STATE_CALIBRATION)
+    {
+        m_cb.state = m_cb.state_before_calibration;
+        return;
+    }
+    m_cb.state = (was == STATE_SIMPLE_SAMPLING) ? STATE_SIMPLE : STATE_ADVANCED;
+    event_send(&evt);
+}
+
+
+nrfx_err_t nrfx_saadc_limits_set(uint8_t channel, int16_t limit_low, int16_t limit_high)
+{
+    if (m_cb.state == STATE_UNINITIALIZED || channel >= SAADC_CH_NUM)
+    {
+        return NRFX_ERROR_INVALID_PARAM;
+    }
+    if (m_cb.handler == NULL)
+    {
+        return NRFX_ERROR_FORBIDDEN;
+    }
+
+    nrf_saadc_channel_limits_set(channel, limit_low, limit_high);
+
+    uint32_t low  = nrf_saadc_limit_int_get(channel, NRF_SAADC_LIMIT_LOW);
+    uint32_t high = nrf_saadc_limit_int_get(channel, NRF_SAADC_LIMIT_HIGH);
+    m_cb.limits_enabled &= ~(low | high);
+    if (limit_low != NRF_SAADC_LIMITL_DISABLED)
+    {
+        m_cb.limits_enabled |= low;
+    }
+    if (limit_high != NRF_SAADC_LIMITH_DISABLED)
+    {
+        m_cb.limits_enabled |= high;
+    }
+    nrf_saadc_int_disable(low | high);
+    nrf_saadc_int_enable(m_cb.limits_enabled & (low | high));
+    return NRFX_SUCCESS;
+}
+
+
+nrfx_err_t nrfx_saadc_offset_calibrate(nrfx_saadc_event_handler_t calib_event_handler)
+{
+    sim_poll();
+    if (m_cb.state == STATE_UNINITIALIZED)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    if (is_busy())
+    {
+        return NRFX_ERROR_BUSY;
+    }
+
+    m_cb.state_before_calibration = m_cb.state;
+    m_cb.state                    = STATE_CALIBRATION;
+    m_cb.calib_handler            = calib_event_handler;
+    nrf_saadc_enable();
+    nrf_saadc_event_clear(NRF_SAADC_EVENT_CALIBRATEDONE);
+    if (calib_event_handler == NULL)
+    {
+        nrf_saadc_int_disable(NRF_SAADC_INT_CALIBRATEDONE);
+        nrf_saadc_task_trigger(NRF_SAADC_TASK_CALIBRATEOFFSET);
+        while (!nrf_saadc_event_check(NRF_SAADC_EVENT_CALIBRATEDONE))
+        {
+            sim_poll();
+        }
+        nrf_saadc_event_clear(NRF_SAADC_EVENT_CALIBRATEDONE);
+        m_cb.state = m_cb.state_before_calibration;
+        return NRFX_SUCCESS;
+    }
+    nrf_saadc_int_enable(NRF_SAADC_INT_CALIBRATEDONE);
+    nrf_saadc_task_trigger(NRF_SAADC_TASK_CALIBRATEOFFSET);
+    return NRFX_SUCCESS;
+}
@@ -0,0 +1,486 @@
+/**
+ * Host build: nrfx TIMER, RTC and PPI drivers.
+ *
+ * Register handling follows the nrfx 2.x drivers, including the RTC driver disabling the compare event and interrupt
+ * on a match before it calls the handler.
+ */
+#include "sim_internal.h"
+#include "nrfx_ppi.h"
+#include "nrfx_rtc.h"
+#include "nrfx_timer.h"
+#include "nrf_drv_ppi.h"
+
+static struct
+{
+    nrfx_timer_event_handler_t handler;
+    void *                     p_context;
+    uint8_t                    cc_channel_count;
+    bool                       initialized;
+} m_timer_cb[NRFX_TIMER_ENABLED_COUNT];
+
+static struct
+{
+    nrfx_rtc_handler_t handler;
+    uint8_t            cc_channel_count;
+    bool               initialized;
+} m_rtc_cb[NRFX_RTC_ENABLED_COUNT];
+
+static NRF_TIMER_Type * const m_timer_regs[NRFX_TIMER_ENABLED_COUNT] =
+    { NRF_TIMER0, NRF_TIMER1, NRF_TIMER2, NRF_TIMER3, NRF_TIMER4 };
+static NRF_RTC_Type * const   m_rtc_regs[NRFX_RTC_ENABLED_COUNT]     = { NRF_RTC0, NRF_RTC1, NRF_RTC2 };
+
+static uint32_t m_ppi_allocated;
+
+
+/* TIMER */
+
+static void timer_irq_handler(uint32_t instance)
+{
+    NRF_TIMER_Type * p_reg = m_timer_regs[instance];
+
+    for (uint32_t ch = 0; ch < m_timer_cb[instance].cc_channel_count; ch++)
+    {
+        nrf_timer_event_t event = nrf_timer_compare_event_get(ch);
+        if (nrf_timer_event_check(p_reg, event) && nrf_timer_int_enable_check(p_reg, nrf_timer_compare_int_get(ch)))
+        {
+            nrf_timer_event_clear(p_reg, event);
+            m_timer_cb[instance].handler(event, m_timer_cb[instance].p_context);
+        }
+    }
+}
+
+
+static void timer0_irq_handler(void)
+{
+    timer_irq_handler(0);
+}
+
+
+static void timer1_irq_handler(void)
+{
+    timer_irq_handler(1);
+}
+
+
+static void timer2_irq_handler(void)
+{
+    timer_irq_handler(2);
+}
+
+
+static void timer3_irq_handler(void)
+{
+    timer_irq_handler(3);
+}
+
+
+static void timer4_irq_handler(void)
+{
+    timer_irq_handler(4);
+}
+
+
+nrfx_err_t nrfx_timer_init(nrfx_timer_t const * const  p_instance,
+                           nrfx_timer_config_t const * p_config,
+                           nrfx_timer_event_handler_t  timer_event_handler)
+{
+    static const sim_irq_handler_t irq_handlers[NRFX_TIMER_ENABLED_COUNT] =
+        { timer0_irq_handler, timer1_irq_handler, timer2_irq_handler, timer3_irq_handler, timer4_irq_handler };
+    static const IRQn_Type irq_numbers[NRFX_TIMER_ENABLED_COUNT] =
+        { TIMER0_IRQn, TIMER1_IRQn, TIMER2_IRQn, TIMER3_IRQn, TIMER4_IRQn };
+    static char const * const irq_names[NRFX_TIMER_ENABLED_COUNT] =
+        { "TIMER0", "TIMER1", "TIMER2", "TIMER3", "TIMER4" };
+
+    uint8_t id = p_instance->instance_id;
+
+    if (m_timer_cb[id].initialized)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    if (timer_event_handler == NULL)
+    {
+        return NRFX_ERROR_INVALID_PARAM;
+    }
+
+    m_timer_cb[id].handler          = timer_event_handler;
+    m_timer_cb[id].p_context        = p_config->p_context;
+    m_timer_cb[id].cc_channel_count = p_instance->cc_channel_count;
+
+    for (uint32_t ch = 0; ch < p_instance->cc_channel_count; ch++)
+    {
+        nrf_timer_event_clear(p_instance->p_reg, nrf_timer_compare_event_get(ch));
+    }
+    nrf_timer_int_disable(p_instance->p_reg, 0xFFFFFFFF);
+    nrf_timer_mode_set(p_instance->p_reg, p_config->mode);
+    nrf_timer_bit_width_set(p_instance->p_reg, p_config->bit_width);
+    nrf_timer_frequency_set(p_instance->p_reg, p_config->frequency);
+    sim_irq_connect(irq_numbers[id], irq_names[id], irq_handlers[id]);
+
+    m_timer_cb[id].initialized = true;
+    return NRFX_SUCCESS;
+}
+
+
+void nrfx_timer_uninit(nrfx_timer_t const * const p_instance)
+{
+    nrf_timer_int_disable(p_instance->p_reg, 0xFFFFFFFF);
+    nrf_timer_shorts_disable(p_instance->p_reg, 0xFFFFFFFF);
+    nrfx_timer_disable(p_instance);
+    m_timer_cb[p_instance->instance_id].initialized = false;
+}
+
+
+void nrfx_timer_enable(nrfx_timer_t const * const p_instance)
+{
+    nrf_timer_task_trigger(p_instance->p_reg, NRF_TIMER_TASK_START);
+}
+
+
+void nrfx_timer_disable(nrfx_timer_t const * const p_instance)
+{
+    nrf_timer_task_trigger(p_instance->p_reg, NRF_TIMER_TASK_SHUTDOWN);
+}
+
+
+bool nrfx_timer_is_enabled(nrfx_timer_t const * const p_instance)
+{
+    return m_timer_cb[p_instance->instance_id].initialized;
+}
+
+
+void nrfx_timer_resume(nrfx_timer_t const * const p_instance)
+{
+    nrf_timer_task_trigger(p_instance->p_reg, NRF_TIMER_TASK_START);
+}
+
+
+void nrfx_timer_pause(nrfx_timer_t const * const p_instance)
+{
+    nrf_timer_task_trigger(p_instance->p_reg, NRF_TIMER_TASK_STOP);
+}
+
+
+void nrfx_timer_clear(nrfx_timer_t const * const p_instance)
+{
+    nrf_timer_task_trigger(p_instance->p_reg, NRF_TIMER_TASK_CLEAR);
+}
+
+
+uint32_t nrfx_timer_capture(nrfx_timer_t const * const p_instance, nrf_timer_cc_channel_t cc_channel)
+{
+    nrf_timer_task_trigger(p_instance->p_reg, nrf_timer_capture_task_get(cc_channel));
+    return nrf_timer_cc_read(p_instance->p_reg, cc_channel);
+}
+
+
+void nrfx_timer_compare(nrfx_timer_t const * const p_instance,
+                        nrf_timer_cc_channel_t     cc_channel,
+                        uint32_t                   cc_value,
+                        bool                       enable_int)
+{
+    nrf_timer_int_disable(p_instance->p_reg, nrf_timer_compare_int_get(cc_channel));
+    nrf_timer_cc_write(p_instance->p_reg, cc_channel, cc_value);
+    if (enable_int)
+    {
+        nrfx_timer_compare_int_enable(p_instance, cc_channel);
+    }
+}
+
+
+void nrfx_timer_extended_compare(nrfx_timer_t const * const p_instance,
+                                 nrf_timer_cc_channel_t     cc_channel,
+                                 uint32_t                   cc_value,
+                                 nrf_timer_short_mask_t     timer_short_mask,
+                                 bool                       enable_int)
+{
+    nrf_timer_shorts_disable(p_instance->p_reg,
+                             (NRF_TIMER_SHORT_COMPARE0_STOP_MASK | NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK) << cc_channel);
+    nrf_timer_shorts_enable(p_instance->p_reg, timer_short_mask);
+    nrfx_timer_compare(p_instance, cc_channel, cc_value, enable_int);
+}
+
+
+void nrfx_timer_compare_int_enable(nrfx_timer_t const * const p_instance, uint32_t channel)
+{
+    nrf_timer_event_clear(p_instance->p_reg, nrf_timer_compare_event_get(channel));
+    nrf_timer_int_enable(p_instance->p_reg, nrf_timer_compare_int_get(channel));
+}
+
+
+void nrfx_timer_compare_int_disable(nrfx_timer_t const * const p_instance, uint32_t channel)
+{
+    nrf_timer_int_disable(p_instance->p_reg, nrf_timer_compare_int_get(channel));
+}
+
+
+/* RTC */
+
+static void rtc_irq_handler(uint32_t instance)
+{
+    NRF_RTC_Type * p_reg = m_rtc_regs[instance];
+
+    for (uint32_t ch = 0; ch < m_rtc_cb[instance].cc_channel_count; ch++)
+    {
+        uint32_t        int_mask = RTC_CHANNEL_INT_MASK(ch);
+        nrf_rtc_event_t event    = RTC_CHANNEL_EVENT_ADDR(ch);
+        if (nrf_rtc_int_is_enabled(p_reg, int_mask) && nrf_rtc_event_pending(p_reg, event))
+        {
+            nrf_rtc_event_disable(p_reg, int_mask);
+            nrf_rtc_int_disable(p_reg, int_mask);
+            nrf_rtc_event_clear(p_reg, event);
+            m_rtc_cb[instance].handler((nrfx_rtc_int_type_t)ch);
+        }
+    }
+
+    if (nrf_rtc_int_is_enabled(p_reg, NRF_RTC_INT_TICK_MASK) && nrf_rtc_event_pending(p_reg, NRF_RTC_EVENT_TICK))
+    {
+        nrf_rtc_event_clear(p_reg, NRF_RTC_EVENT_TICK);
+        m_rtc_cb[instance].handler(NRFX_RTC_INT_TICK);
+    }
+
+    if (nrf_rtc_int_is_enabled(p_reg, NRF_RTC_INT_OVERFLOW_MASK) &&
+        nrf_rtc_event_pending(p_reg, NRF_RTC_EVENT_OVERFLOW))
+    {
+        nrf_rtc_event_clear(p_reg, NRF_RTC_EVENT_OVERFLOW);
+        m_rtc_cb[instance].handler(NRFX_RTC_INT_OVERFLOW);
+    }
+}
+
+
+static void rtc0_irq_handler(void)
+{
+    rtc_irq_handler(0);
+}
+
+
+static void rtc1_irq_handler(void)
+{
+    rtc_irq_handler(1);
+}
+
+
+static void rtc2_irq_handler(void)
+{
+    rtc_irq_handler(2);
+}
+
+
+nrfx_err_t nrfx_rtc_init(nrfx_rtc_t const * const  p_instance,
+                         nrfx_rtc_config_t const * p_config,
+                         nrfx_rtc_handler_t        handler)
+{
+    static const sim_irq_handler_t irq_handlers[NRFX_RTC_ENABLED_COUNT] =
+        { rtc0_irq_handler, rtc1_irq_handler, rtc2_irq_handler };
+    static char const * const irq_names[NRFX_RTC_ENABLED_COUNT] = { "RTC0", "RTC1", "RTC2" };
+
+    uint8_t id = p_instance->instance_id;
+
+    if (handler == NULL)
+    {
+        return NRFX_ERROR_INVALID_PARAM;
+    }
+    if (m_rtc_cb[id].initialized)
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+
+    m_rtc_cb[id].handler          = handler;
+    m_rtc_cb[id].cc_channel_count = p_instance->cc_channel_count;
+
+    nrf_rtc_prescaler_set(p_instance->p_reg, p_config->prescaler);
+    sim_irq_connect(p_instance->irq, irq_names[id], irq_handlers[id]);
+
+    m_rtc_cb[id].initialized = true;
+    return NRFX_SUCCESS;
+}
+
+
+void nrfx_rtc_uninit(nrfx_rtc_t const * const p_instance)
+{
+    nrf_rtc_int_disable(p_instance->p_reg, 0xFFFFFFFF);
+    nrf_rtc_event_disable(p_instance->p_reg, 0xFFFFFFFF);
+    nrf_rtc_task_trigger(p_instance->p_reg, NRF_RTC_TASK_STOP);
+    m_rtc_cb[p_instance->instance_id].initialized = false;
+}
+
+
+void nrfx_rtc_enable(nrfx_rtc_t const * const p_instance)
+{
+    nrf_rtc_task_trigger(p_instance->p_reg, NRF_RTC_TASK_START);
+}
+
+
+void nrfx_rtc_disable(nrfx_rtc_t const * const p_instance)
+{
+    nrf_rtc_task_trigger(p_instance->p_reg, NRF_RTC_TASK_STOP);
+}
+
+
+nrfx_err_t nrfx_rtc_cc_set(nrfx_rtc_t const * const p_instance, uint32_t channel, uint32_t val, bool enable_irq)
+{
+    if (channel >= p_instance->cc_channel_count)
+    {
+        return NRFX_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t        int_mask = RTC_CHANNEL_INT_MASK(channel);
+    nrf_rtc_event_t event    = RTC_CHANNEL_EVENT_ADDR(channel);
+
+    nrf_rtc_event_disable(p_instance->p_reg, int_mask);
+    nrf_rtc_int_disable(p_instance->p_reg, int_mask);
+    nrf_rtc_cc_set(p_instance->p_reg, channel, val);
+    nrf_rtc_event_clear(p_instance->p_reg, event);
+    if (enable_irq)
+    {
+        nrf_rtc_int_enable(p_instance->p_reg, int_mask);
+    }
+    nrf_rtc_event_enable(p_instance->p_reg, int_mask);
+    return NRFX_SUCCESS;
+}
+
+
+nrfx_err_t nrfx_rtc_cc_disable(nrfx_rtc_t const * const p_instance, uint32_t channel)
+{
+    if (channel >= p_instance->cc_channel_count)
+    {
+        return NRFX_ERROR_INVALID_PARAM;
+    }
+
+    uint32_t int_mask = RTC_CHANNEL_INT_MASK(channel);
+    nrf_rtc_event_disable(p_instance->p_reg, int_mask);
+    nrf_rtc_int_disable(p_instance->p_reg, int_mask);
+    nrf_rtc_event_clear(p_instance->p_reg, RTC_CHANNEL_EVENT_ADDR(channel));
+    return NRFX_SUCCESS;
+}
+
+
+void nrfx_rtc_tick_enable(nrfx_rtc_t const * const p_instance, bool enable_irq)
+{
+    nrf_rtc_event_enable(p_instance->p_reg, NRF_RTC_INT_TICK_MASK);
+    if (enable_irq)
+    {
+        nrf_rtc_int_enable(p_instance->p_reg, NRF_RTC_INT_TICK_MASK);
+    }
+}
+
+
+void nrfx_rtc_tick_disable(nrfx_rtc_t const * const p_instance)
+{
+    nrf_rtc_event_disable(p_instance->p_reg, NRF_RTC_INT_TICK_MASK);
+    nrf_rtc_int_disable(p_instance->p_reg, NRF_RTC_INT_TICK_MASK);
+}
+
+
+void nrfx_rtc_overflow_enable(nrfx_rtc_t const * const p_instance, bool enable_irq)
+{
+    nrf_rtc_event_enable(p_instance->p_reg, NRF_RTC_INT_OVERFLOW_MASK);
+    if (enable_irq)
+    {
+        nrf_rtc_int_enable(p_instance->p_reg, NRF_RTC_INT_OVERFLOW_MASK);
+    }
+}
+
+
+void nrfx_rtc_overflow_disable(nrfx_rtc_t const * const p_instance)
+{
+    nrf_rtc_event_disable(p_instance->p_reg, NRF_RTC_INT_OVERFLOW_MASK);
+    nrf_rtc_int_disable(p_instance->p_reg, NRF_RTC_INT_OVERFLOW_MASK);
+}
+
+
+/* PPI */
+
+nrfx_err_t nrfx_ppi_channel_alloc(nrf_ppi_channel_t * p_channel)
+{
+    nrfx_err_t err_code = NRFX_ERROR_NO_MEM;
+
+    CRITICAL_REGION_ENTER();
+    for (uint32_t ch = 0; ch < PPI_CH_NUM; ch++)
+    {
+        if (!(m_ppi_allocated & (1UL << ch)))
+        {
+            m_ppi_allocated |= 1UL << ch;
+            *p_channel       = (nrf_ppi_channel_t)ch;
+            err_code         = NRFX_SUCCESS;
+            break;
+        }
+    }
+    CRITICAL_REGION_EXIT();
+    return err_code;
+}
+
+
+nrfx_err_t nrfx_ppi_channel_free(nrf_ppi_channel_t channel)
+{
+    if (!(m_ppi_allocated & (1UL << channel)))
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    nrf_ppi_channel_disable(channel);
+    m_ppi_allocated &= ~(1UL << channel);
+    return NRFX_SUCCESS;
+}
+
+
+nrfx_err_t nrfx_ppi_channel_assign(nrf_ppi_channel_t channel, uint32_t eep, uint32_t tep)
+{
+    if (!(m_ppi_allocated & (1UL << channel)))
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    nrf_ppi_channel_endpoint_setup(channel, eep, tep);
+    return NRFX_SUCCESS;
+}
+
+
+nrfx_err_t nrfx_ppi_channel_fork_assign(nrf_ppi_channel_t channel, uint32_t fork_tep)
+{
+    if (!(m_ppi_allocated & (1UL << channel)))
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    nrf_ppi_fork_endpoint_setup(channel, fork_tep);
+    return NRFX_SUCCESS;
+}
+
+
+nrfx_err_t nrfx_ppi_channel_enable(nrf_ppi_channel_t channel)
+{
+    if (!(m_ppi_allocated & (1UL << channel)))
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    nrf_ppi_channel_enable(channel);
+    return NRFX_SUCCESS;
+}
+
+
+nrfx_err_t nrfx_ppi_channel_disable(nrf_ppi_channel_t channel)
+{
+    if (!(m_ppi_allocated & (1UL << channel)))
+    {
+        return NRFX_ERROR_INVALID_STATE;
+    }
+    nrf_ppi_channel_disable(channel);
+    return NRFX_SUCCESS;
+}
+
+
+void nrfx_ppi_free_all(void)
+{
+    NRF_PPI->CHEN   = 0;
+    m_ppi_allocated = 0;
+}
+
+
+ret_code_t nrf_drv_ppi_init(void)
+{
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_drv_ppi_uninit(void)
+{
+    nrfx_ppi_free_all();
+    return NRF_SUCCESS;
+}
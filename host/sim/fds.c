@@ -0,0 +1,525 @@
+/**
+ * Host build: Flash Data Storage in RAM.
+ *
+ * The data pages are one array of words, records are appended with a three word header and marked dirty when they are
+ * updated or deleted. fds_gc() moves the valid records to the front, which frees the dirty space. Writes reserve their
+ * space when they are queued, as in the SDK, so FDS_ERR_NO_SPACE_IN_FLASH is returned by the call, not the event.
+ *
+ * Operations complete one after the other, each HOST_SIM_FDS_OP_MS after the previous one, with a SoftDevice flash
+ * event. The record data is copied when the operation runs, so it must stay valid until then.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "sim_internal.h"
+#include "sim_ble.h"
+#include "app_util_platform.h"
+#include "fds.h"
+#include "nrf_sdh.h"
+#include "nrf_sdh_soc.h"
+
+#define FDS_PAGE_TAG_WORDS    2
+#define FDS_HEADER_WORDS      BYTES_TO_WORDS(sizeof(fds_header_t))
+#define FDS_DATA_WORDS        ((FDS_VIRTUAL_PAGES - 1) * (FDS_VIRTUAL_PAGE_SIZE - FDS_PAGE_TAG_WORDS))
+#define FDS_RECORD_MAX_WORDS  (FDS_VIRTUAL_PAGE_SIZE - FDS_PAGE_TAG_WORDS - FDS_HEADER_WORDS)
+
+typedef enum
+{
+    FDS_OP_INIT,
+    FDS_OP_WRITE,
+    FDS_OP_UPDATE,
+    FDS_OP_DEL_RECORD,
+    FDS_OP_DEL_FILE,
+    FDS_OP_GC,
+} fds_op_type_t;
+
+typedef struct
+{
+    fds_op_type_t type;
+    fds_record_t  record;
+    uint32_t      record_id;        // Of the new record for writes, of the record to delete otherwise
+    uint32_t      old_record_id;    // Record replaced by an update
+} fds_op_t;
+
+static void fds_soc_evt_handler(uint32_t evt_id, void * p_context);
+
+NRF_SDH_SOC_OBSERVER(m_fds_soc_obs, 0, fds_soc_evt_handler, NULL);
+
+static struct
+{
+    bool      initialized;
+    bool      init_queued;
+    uint32_t  data[FDS_DATA_WORDS];
+    uint32_t  write_offset;         // Words written, valid and dirty
+    uint32_t  reserved;             // Words reserved by queued writes
+    uint32_t  dirty;
+    uint32_t  next_record_id;
+    uint16_t  gc_run_count;
+
+    fds_cb_t  users[FDS_MAX_USERS];
+    uint32_t  user_count;
+
+    fds_op_t  ops[FDS_OP_QUEUE_SIZE];
+    uint32_t  op_head;
+    uint32_t  op_count;
+
+    double    op_ms;
+
+    // Statistics
+    uint64_t  writes;
+    uint64_t  updates;
+    uint64_t  deletes;
+    uint64_t  gcs;
+    uint64_t  queue_full;
+} m_fds;
+
+
+static void fds_report(FILE * p_out, double seconds)
+{
+    (void)seconds;
+    fprintf(p_out, "FDS: %llu writes, %llu updates, %llu deletes, %llu garbage collections, queue full %llu times\n",
+            (unsigned long long)m_fds.writes, (unsigned long long)m_fds.updates,
+            (unsigned long long)m_fds.deletes, (unsigned long long)m_fds.gcs,
+            (unsigned long long)m_fds.queue_full);
+    fprintf(p_out, "FDS: %u of %u words used, %u dirty\n",
+            (unsigned)m_fds.write_offset, (unsigned)FDS_DATA_WORDS, (unsigned)m_fds.dirty);
+}
+
+
+static fds_header_t * header_at(uint32_t offset)
+{
+    return (fds_header_t *)&m_fds.data[offset];
+}
+
+
+static uint32_t record_words(fds_header_t const * p_header)
+{
+    return FDS_HEADER_WORDS + p_header->length_words;
+}
+
+
+static bool record_is_valid(fds_header_t const * p_header)
+{
+    return p_header->record_key != FDS_RECORD_KEY_DIRTY;
+}
+
+
+// Offset of the valid record with the given ID, or FDS_DATA_WORDS
+static uint32_t record_find_by_id(uint32_t record_id)
+{
+    for (uint32_t offset = 0; offset < m_fds.write_offset; offset += record_words(header_at(offset)))
+    {
+        if (record_is_valid(header_at(offset)) && header_at(offset)->record_id == record_id)
+        {
+            return offset;
+        }
+    }
+    return FDS_DATA_WORDS;
+}
+
+
+static void record_mark_dirty(uint32_t offset)
+{
+    header_at(offset)->record_key = FDS_RECORD_KEY_DIRTY;
+    m_fds.dirty += record_words(header_at(offset));
+}
+
+
+static void evt_send(fds_evt_t const * p_evt)
+{
+    for (uint32_t i = 0; i < m_fds.user_count; i++)
+    {
+        m_fds.users[i](p_evt);
+    }
+}
+
+
+static void op_start(void)
+{
+    sim_schedule(sim_now() + (uint64_t)(m_fds.op_ms * 1e6), sim_sd_soc_evt_put,
+                 NRF_EVT_FLASH_OPERATION_SUCCESS);
+}
+
+
+static ret_code_t op_queue(fds_op_t const * p_op)
+{
+    ret_code_t err_code = NRF_SUCCESS;
+
+    CRITICAL_REGION_ENTER();
+    if (m_fds.op_count == FDS_OP_QUEUE_SIZE)
+    {
+        m_fds.queue_full++;
+        err_code = FDS_ERR_NO_SPACE_IN_QUEUES;
+    }
+    else
+    {
+        m_fds.ops[(m_fds.op_head + m_fds.op_count) % FDS_OP_QUEUE_SIZE] = *p_op;
+        if (m_fds.op_count++ == 0)
+        {
+            op_start();
+        }
+    }
+    CRITICAL_REGION_EXIT();
+    return err_code;
+}
+
+
+static void op_write_execute(fds_op_t const * p_op, fds_evt_t * p_evt)
+{
+    fds_header_t * p_header = header_at(m_fds.write_offset);
+    uint32_t       words    = FDS_HEADER_WORDS + p_op->record.data.length_words;
+
+    p_header->record_key   = p_op->record.key;
+    p_header->length_words = (uint16_t)p_op->record.data.length_words;
+    p_header->file_id      = p_op->record.file_id;
+    p_header->crc16        = 0;
+    p_header->record_id    = p_op->record_id;
+    memcpy(&m_fds.data[m_fds.write_offset + FDS_HEADER_WORDS], p_op->record.data.p_data,
+           p_op->record.data.length_words * sizeof(uint32_t));
+    m_fds.write_offset += words;
+    m_fds.reserved     -= words;
+
+    p_evt->write.record_id  = p_op->record_id;
+    p_evt->write.file_id    = p_op->record.file_id;
+    p_evt->write.record_key = p_op->record.key;
+}
+
+
+static void op_execute(fds_op_t const * p_op)
+{
+    fds_evt_t evt;
+
+    memset(&evt, 0, sizeof(evt));
+    evt.result = NRF_SUCCESS;
+
+    switch (p_op->type)
+    {
+        case FDS_OP_INIT:
+            m_fds.initialized = true;
+            evt.id            = FDS_EVT_INIT;
+            break;
+
+        case FDS_OP_WRITE:
+            op_write_execute(p_op, &evt);
+            evt.id = FDS_EVT_WRITE;
+            m_fds.writes++;
+            break;
+
+        case FDS_OP_UPDATE:
+        {
+            uint32_t old_offset = record_find_by_id(p_op->old_record_id);
+
+            op_write_execute(p_op, &evt);
+            if (old_offset != FDS_DATA_WORDS)
+            {
+                record_mark_dirty(old_offset);
+            }
+            evt.id                      = FDS_EVT_UPDATE;
+            evt.write.is_record_updated = (old_offset != FDS_DATA_WORDS);
+            m_fds.updates++;
+        } break;
+
+        case FDS_OP_DEL_RECORD:
+        {
+            uint32_t offset = record_find_by_id(p_op->record_id);
+
+            evt.id            = FDS_EVT_DEL_RECORD;
+            evt.del.record_id = p_op->record_id;
+            if (offset == FDS_DATA_WORDS)
+            {
+                evt.result = FDS_ERR_NOT_FOUND;
+                break;
+            }
+            evt.del.file_id    = header_at(offset)->file_id;
+            evt.del.record_key = header_at(offset)->record_key;
+            record_mark_dirty(offset);
+            m_fds.deletes++;
+        } break;
+
+        case FDS_OP_DEL_FILE:
+            evt.id          = FDS_EVT_DEL_FILE;
+            evt.del.file_id = p_op->record.file_id;
+            for (uint32_t offset = 0; offset < m_fds.write_offset; offset += record_words(header_at(offset)))
+            {
+                if (record_is_valid(header_at(offset)) && header_at(offset)->file_id == p_op->record.file_id)
+                {
+                    record_mark_dirty(offset);
+                }
+            }
+            m_fds.deletes++;
+            break;
+
+        case FDS_OP_GC:
+        {
+            uint32_t to = 0;
+
+            for (uint32_t from = 0; from < m_fds.write_offset; )
+            {
+                uint32_t words = record_words(header_at(from));
+                if (record_is_valid(header_at(from)))
+                {
+                    memmove(&m_fds.data[to], &m_fds.data[from], words * sizeof(uint32_t));
+                    to += words;
+                }
+                from += words;
+            }
+            m_fds.write_offset = to;
+            m_fds.dirty        = 0;
+            m_fds.gc_run_count++;
+            evt.id = FDS_EVT_GC;
+            m_fds.gcs++;
+        } break;
+    }
+
+    evt_send(&evt);
+}
+
+
+static void fds_soc_evt_handler(uint32_t evt_id, void * p_context)
+{
+    fds_op_t op;
+
+    (void)p_context;
+    if ((evt_id != NRF_EVT_FLASH_OPERATION_SUCCESS && evt_id != NRF_EVT_FLASH_OPERATION_ERROR) || m_fds.op_count == 0)
+    {
+        return;
+    }
+
+    // Removed first, the users may queue the next operation from the event
+    CRITICAL_REGION_ENTER();
+    op = m_fds.ops[m_fds.op_head];
+    m_fds.op_head = (m_fds.op_head + 1) % FDS_OP_QUEUE_SIZE;
+    m_fds.op_count--;
+    if (m_fds.op_count > 0)
+    {
+        op_start();
+    }
+    CRITICAL_REGION_EXIT();
+
+    op_execute(&op);
+}
+
+
+ret_code_t fds_register(fds_cb_t cb)
+{
+    if (m_fds.user_count == FDS_MAX_USERS)
+    {
+        return FDS_ERR_USER_LIMIT_REACHED;
+    }
+    m_fds.users[m_fds.user_count++] = cb;
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t fds_init(void)
+{
+    fds_op_t op = { .type = FDS_OP_INIT };
+
+    if (m_fds.initialized || m_fds.init_queued)
+    {
+        return NRF_SUCCESS;
+    }
+    if (!nrf_sdh_is_enabled())
+    {
+        return FDS_ERR_NO_PAGES;
+    }
+
+    m_fds.op_ms          = sim_env_double("HOST_SIM_FDS_OP_MS", 20.0);
+    m_fds.next_record_id = 1;
+    sim_report_register(fds_report);
+
+    ret_code_t err_code = op_queue(&op);
+    m_fds.init_queued   = (err_code == NRF_SUCCESS);
+    return err_code;
+}
+
+
+static ret_code_t write_queue(fds_op_type_t type, fds_record_desc_t * p_desc, fds_record_t const * p_record)
+{
+    if (!m_fds.initialized)
+    {
+        return FDS_ERR_NOT_INITIALIZED;
+    }
+    if (p_record == NULL || (p_record->data.length_words > 0 && p_record->data.p_data == NULL))
+    {
+        return FDS_ERR_NULL_ARG;
+    }
+    if (p_record->file_id == FDS_FILE_ID_INVALID || p_record->key == FDS_RECORD_KEY_DIRTY)
+    {
+        return FDS_ERR_INVALID_ARG;
+    }
+    if (((uintptr_t)p_record->data.p_data & 3) != 0)
+    {
+        return FDS_ERR_UNALIGNED_ADDR;
+    }
+    if (p_record->data.length_words > FDS_RECORD_MAX_WORDS)
+    {
+        return FDS_ERR_RECORD_TOO_LARGE;
+    }
+
+    uint32_t words = FDS_HEADER_WORDS + p_record->data.length_words;
+    if (m_fds.write_offset + m_fds.reserved + words > FDS_DATA_WORDS)
+    {
+        return FDS_ERR_NO_SPACE_IN_FLASH;
+    }
+
+    fds_op_t op =
+    {
+        .type          = type,
+        .record        = *p_record,
+        .record_id     = m_fds.next_record_id,
+        .old_record_id = (p_desc != NULL) ? p_desc->record_id : 0,
+    };
+    ret_code_t err_code = op_queue(&op);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    m_fds.reserved += words;
+    m_fds.next_record_id++;
+    if (p_desc != NULL)
+    {
+        p_desc->record_id      = op.record_id;
+        p_desc->p_record       = NULL;
+        p_desc->record_is_open = false;
+    }
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t fds_record_write(fds_record_desc_t * p_desc, fds_record_t const * p_record)
+{
+    return write_queue(FDS_OP_WRITE, p_desc, p_record);
+}
+
+
+ret_code_t fds_record_update(fds_record_desc_t * p_desc, fds_record_t const * p_record)
+{
+    if (p_desc == NULL)
+    {
+        return FDS_ERR_NULL_ARG;
+    }
+    return write_queue(FDS_OP_UPDATE, p_desc, p_record);
+}
+
+
+ret_code_t fds_record_delete(fds_record_desc_t * p_desc)
+{
+    if (!m_fds.initialized)
+    {
+        return FDS_ERR_NOT_INITIALIZED;
+    }
+    if (p_desc == NULL)
+    {
+        return FDS_ERR_NULL_ARG;
+    }
+
+    fds_op_t op = { .type = FDS_OP_DEL_RECORD, .record_id = p_desc->record_id };
+    return op_queue(&op);
+}
+
+
+ret_code_t fds_file_delete(uint16_t file_id)
+{
+    if (!m_fds.initialized)
+    {
+        return FDS_ERR_NOT_INITIALIZED;
+    }
+    if (file_id == FDS_FILE_ID_INVALID)
+    {
+        return FDS_ERR_INVALID_ARG;
+    }
+
+    fds_op_t op = { .type = FDS_OP_DEL_FILE, .record.file_id = file_id };
+    return op_queue(&op);
+}
+
+
+ret_code_t fds_gc(void)
+{
+    if (!m_fds.initialized)
+    {
+        return FDS_ERR_NOT_INITIALIZED;
+    }
+
+    fds_op_t op = { .type = FDS_OP_GC };
+    return op_queue(&op);
+}
+
+
+ret_code_t fds_record_find(uint16_t file_id, uint16_t record_key, fds_record_desc_t * p_desc, fds_find_token_t * p_token)
+{
+    if (!m_fds.initialized)
+    {
+        return FDS_ERR_NOT_INITIALIZED;
+    }
+    if (p_desc == NULL || p_token == NULL)
+    {
+        return FDS_ERR_NULL_ARG;
+    }
+
+    // The token holds the record found last, the search continues after it
+    uint32_t offset = 0;
+    if (p_token->p_addr != NULL)
+    {
+        if (p_token->page != m_fds.gc_run_count)
+        {
+            return FDS_ERR_NOT_FOUND;
+        }
+        offset = (uint32_t)(p_token->p_addr - m_fds.data);
+        offset += record_words(header_at(offset));
+    }
+
+    for (; offset < m_fds.write_offset; offset += record_words(header_at(offset)))
+    {
+        fds_header_t const * p_header = header_at(offset);
+        if (record_is_valid(p_header) && p_header->file_id == file_id && p_header->record_key == record_key)
+        {
+            p_token->p_addr        = &m_fds.data[offset];
+            p_token->page          = m_fds.gc_run_count;
+            p_desc->record_id      = p_header->record_id;
+            p_desc->p_record       = &m_fds.data[offset];
+            p_desc->gc_run_count   = m_fds.gc_run_count;
+            p_desc->record_is_open = false;
+            return NRF_SUCCESS;
+        }
+    }
+    return FDS_ERR_NOT_FOUND;
+}
+
+
+ret_code_t fds_record_open(fds_record_desc_t * p_desc, fds_flash_record_t * p_flash_record)
+{
+    if (p_desc == NULL || p_flash_record == NULL)
+    {
+        return FDS_ERR_NULL_ARG;
+    }
+
+    uint32_t offset = record_find_by_id(p_desc->record_id);
+    if (offset == FDS_DATA_WORDS)
+    {
+        return FDS_ERR_NOT_FOUND;
+    }
+
+    p_desc->p_record         = &m_fds.data[offset];
+    p_desc->gc_run_count     = m_fds.gc_run_count;
+    p_desc->record_is_open   = true;
+    p_flash_record->p_header = header_at(offset);
+    p_flash_record->p_data   = &m_fds.data[offset + FDS_HEADER_WORDS];
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t fds_record_close(fds_record_desc_t * p_desc)
+{
+    if (p_desc == NULL)
+    {
+        return FDS_ERR_NULL_ARG;
+    }
+    if (!p_desc->record_is_open)
+    {
+        return FDS_ERR_NO_OPEN_RECORDS;
+    }
+    p_desc->record_is_open = false;
+    return NRF_SUCCESS;
+}
@@ -0,0 +1,651 @@
+/**
+ * Host build: simulator core.
+ *
+ * Virtual time advances by a fixed cost per interruption point, so a run depends on the simulated events alone and
+ * gives the same result however busy the host is. With HOST_SIM_CPU_SCALE set, the host time spent in application
+ * code between two interruption points, times the scale, is added, for benchmarks of handler and cycle counts. In an
+ * interrupt handler that host time is capped at HOST_SIM_CPU_IRQ_MAX_US, so a host thread switch in the middle of a
+ * handler is not taken for a handler that misses its deadline.
+ * Peripheral events are kept in a time ordered queue.
+ * At an interruption point the queued events up to the new time are run in order, and pending interrupts are handled
+ * at the time of the event that raised them, so an interrupt preempts the application code exactly where the target
+ * would have been interrupted, give or take the distance between two interruption points.
+ *
+ * Interrupt handlers run on the same thread, so the code under test never sees a race the target could not have.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include "sim_internal.h"
+
+// APB peripherals, mapped at their real addresses
+#define SIM_PERIPH_BASE 0x40000000UL
+#define SIM_PERIPH_SIZE 0x00025000UL
+
+// Cost of an interruption point and of interrupt entry and exit, in CPU cycles
+#define SIM_POLL_CYCLES 2
+#define SIM_IRQ_CYCLES  24
+
+#define SIM_REPORT_MAX  8
+
+typedef struct
+{
+    uint64_t       time;
+    uint64_t       seq;
+    sim_event_fn_t fn;
+    uint32_t       arg;
+} sim_event_t;
+
+typedef struct
+{
+    sim_irq_handler_t handler;
+    char const *      p_name;
+    bool              pending;
+    uint64_t          pend_time;
+    uint64_t          count;
+    uint64_t          latency_max;
+    uint64_t          latency_sum;
+    uint64_t          duration_max;
+    uint64_t          duration_sum;
+} sim_irq_t;
+
+uint32_t       SystemCoreClock = SIM_CPU_MHZ * 1000000UL;
+CoreDebug_Type sim_core_debug;
+
+static struct
+{
+    uint64_t        now;               // Virtual time, ns
+    uint64_t        end;               // End of the run, ns
+    uint64_t        sleep_total;       // Time spent sleeping in WFE, ns
+    uint64_t        sleeps;
+    uint64_t        sleeps_left_powered;
+    uint64_t        left_powered_ns;
+    uint32_t        critical;          // Critical region nesting
+    bool            in_irq;
+    bool            event_register;    // Cortex-M event register, set by interrupts and SEV
+    bool            finishing;
+    bool            log_enabled;
+    double          cpu_scale;
+    uint64_t        host_mark;         // Host time when control was last handed to application code
+    uint64_t        irq_host_max;      // Host time charged at most per interval in a handler, ns
+    uint64_t        irq_host_capped;   // Intervals in a handler capped at irq_host_max
+    sim_event_t *   p_heap;
+    size_t          heap_len;
+    size_t          heap_cap;
+    uint64_t        seq;
+    sim_irq_t       irq[SIM_IRQ_COUNT];
+    DWT_Type        dwt;
+    uint32_t        dwt_published;
+    uint64_t        dwt_offset;
+    uint64_t        rng;
+    sim_report_fn_t reports[SIM_REPORT_MAX];
+    uint32_t        report_count;
+} sim;
+
+
+static uint64_t host_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+static uint64_t cycles_to_ns(uint64_t cycles)
+{
+    return (cycles * 1000) / SIM_CPU_MHZ;
+}
+
+
+// Time spent in application code since control was last handed to it
+static uint64_t sim_enter(void)
+{
+    uint64_t spent = 0;
+    if (sim.cpu_scale > 0.0)
+    {
+        uint64_t host  = host_ns();
+        uint64_t delta = host - sim.host_mark;
+        if (sim.in_irq && delta > sim.irq_host_max)
+        {
+            delta = sim.irq_host_max;
+            sim.irq_host_capped++;
+        }
+        spent = (uint64_t)((double)delta * sim.cpu_scale);
+        sim.host_mark = host;
+    }
+    return spent + cycles_to_ns(SIM_POLL_CYCLES);
+}
+
+
+// Hands control back to application code
+static void sim_leave(void)
+{
+    sim.host_mark = host_ns();
+}
+
+
+double sim_env_double(char const * p_name, double default_value)
+{
+    char const * p_value = getenv(p_name);
+    if (p_value == NULL || *p_value == '\0')
+    {
+        return default_value;
+    }
+    return strtod(p_value, NULL);
+}
+
+
+char const * sim_env_string(char const * p_name)
+{
+    char const * p_value = getenv(p_name);
+    return (p_value != NULL && *p_value != '\0') ? p_value : NULL;
+}
+
+
+double sim_random_gaussian(void)
+{
+    // xorshift64*, Box-Muller
+    double u[2];
+    for (int i = 0; i < 2; i++)
+    {
+        sim.rng ^= sim.rng >> 12;
+        sim.rng ^= sim.rng << 25;
+        sim.rng ^= sim.rng >> 27;
+        u[i] = (double)((sim.rng * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+    }
+    if (u[0] < 1e-300)
+    {
+        u[0] = 1e-300;
+    }
+    return sqrt(-2.0 * log(u[0])) * cos(2.0 * M_PI * u[1]);
+}
+
+
+uint64_t sim_now(void)
+{
+    return sim.now;
+}
+
+
+uint64_t sim_time_ns(void)
+{
+    return sim.now;
+}
+
+
+/* Event queue, a binary min-heap ordered by time and insertion order */
+
+static bool heap_less(sim_event_t const * p_a, sim_event_t const * p_b)
+{
+    return (p_a->time < p_b->time) || ((p_a->time == p_b->time) && (p_a->seq < p_b->seq));
+}
+
+
+void sim_schedule(uint64_t time_ns, sim_event_fn_t fn, uint32_t arg)
+{
+    if (sim.heap_len == sim.heap_cap)
+    {
+        sim.heap_cap = (sim.heap_cap == 0) ? 256 : sim.heap_cap * 2;
+        sim.p_heap   = realloc(sim.p_heap, sim.heap_cap * sizeof(sim_event_t));
+        if (sim.p_heap == NULL)
+        {
+            abort();
+        }
+    }
+
+    size_t i = sim.heap_len++;
+    sim.p_heap[i] = (sim_event_t){ .time = (time_ns < sim.now) ? sim.now : time_ns,
+                                   .seq  = sim.seq++,
+                                   .fn   = fn,
+                                   .arg  = arg };
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (!heap_less(&sim.p_heap[i], &sim.p_heap[parent]))
+        {
+            break;
+        }
+        sim_event_t tmp      = sim.p_heap[parent];
+        sim.p_heap[parent]   = sim.p_heap[i];
+        sim.p_heap[i]        = tmp;
+        i = parent;
+    }
+}
+
+
+static sim_event_t heap_pop(void)
+{
+    sim_event_t top = sim.p_heap[0];
+    sim.p_heap[0] = sim.p_heap[--sim.heap_len];
+
+    size_t i = 0;
+    for (;;)
+    {
+        size_t l = 2 * i + 1;
+        size_t r = l + 1;
+        size_t m = i;
+        if (l < sim.heap_len && heap_less(&sim.p_heap[l], &sim.p_heap[m]))
+        {
+            m = l;
+        }
+        if (r < sim.heap_len && heap_less(&sim.p_heap[r], &sim.p_heap[m]))
+        {
+            m = r;
+        }
+        if (m == i)
+        {
+            break;
+        }
+        sim_event_t tmp = sim.p_heap[m];
+        sim.p_heap[m]   = sim.p_heap[i];
+        sim.p_heap[i]   = tmp;
+        i = m;
+    }
+    return top;
+}
+
+
+/* Report */
+
+void sim_report_register(sim_report_fn_t fn)
+{
+    if (sim.report_count < SIM_REPORT_MAX)
+    {
+        sim.reports[sim.report_count++] = fn;
+    }
+}
+
+
+static void sim_report(FILE * p_out)
+{
+    double seconds = (double)sim.now / 1e9;
+    double active  = (double)(sim.now - sim.sleep_total) / 1e9;
+
+    fprintf(p_out, "\n==== host simulation report ====\n");
+    fprintf(p_out, "Simulated time: %.3f s (CPU scale %.2f)\n", seconds, sim.cpu_scale);
+    if (sim.irq_host_capped > 0)
+    {
+        fprintf(p_out, "Handler host time capped at %.1f us %llu times\n",
+                (double)sim.irq_host_max / 1e3, (unsigned long long)sim.irq_host_capped);
+    }
+    for (uint32_t i = 0; i < sim.report_count; i++)
+    {
+        sim.reports[i](p_out, seconds);
+    }
+    fprintf(p_out, "%-8s %10s %22s %22s\n", "IRQ", "calls", "latency max/avg [us]", "handler max/avg [us]");
+    for (uint32_t i = 0; i < SIM_IRQ_COUNT; i++)
+    {
+        sim_irq_t const * p_irq = &sim.irq[i];
+        if (p_irq->handler == NULL)
+        {
+            continue;
+        }
+        double n = (p_irq->count > 0) ? (double)p_irq->count : 1.0;
+        fprintf(p_out, "%-8s %10llu %11.2f / %-8.2f %11.2f / %-8.2f\n",
+                p_irq->p_name, (unsigned long long)p_irq->count,
+                (double)p_irq->latency_max / 1e3, (double)p_irq->latency_sum / n / 1e3,
+                (double)p_irq->duration_max / 1e3, (double)p_irq->duration_sum / n / 1e3);
+    }
+    fprintf(p_out, "CPU: %llu wakeups (%.0f/h), active %.3f ms (%.2f %%)\n",
+            (unsigned long long)sim.sleeps, (seconds > 0) ? (double)sim.sleeps * 3600.0 / seconds : 0.0,
+            active * 1e3, (seconds > 0) ? 100.0 * active / seconds : 0.0);
+    fprintf(p_out, "Sleeps with the SAADC left powered: %llu, %.3f s\n",
+            (unsigned long long)sim.sleeps_left_powered, (double)sim.left_powered_ns / 1e9);
+}
+
+
+void sim_finish(char const * p_reason)
+{
+    if (sim.finishing)
+    {
+        return;
+    }
+    sim.finishing = true;
+    fflush(stdout);
+    if (p_reason != NULL)
+    {
+        printf("host sim: %s\n", p_reason);
+    }
+    sim_report(stdout);
+    fflush(stdout);
+    exit(EXIT_SUCCESS);
+}
+
+
+/* Interrupts */
+
+void sim_irq_connect(IRQn_Type irqn, char const * p_name, sim_irq_handler_t handler)
+{
+    sim.irq[irqn].handler = handler;
+    sim.irq[irqn].p_name  = p_name;
+    sim.irq[irqn].pending = false;
+}
+
+
+void sim_irq_pend(IRQn_Type irqn)
+{
+    sim_irq_t * p_irq = &sim.irq[irqn];
+    if (p_irq->handler == NULL || p_irq->pending)
+    {
+        return;
+    }
+    p_irq->pending   = true;
+    p_irq->pend_time = sim.now;
+}
+
+
+static void sim_run(uint64_t delta);
+
+
+static void sim_irq_run(sim_irq_t * p_irq)
+{
+    uint64_t start = sim.now;
+
+    p_irq->pending = false;
+    uint64_t latency = start - p_irq->pend_time;
+
+    sim.in_irq         = true;
+    sim.event_register = true;
+    sim_leave();
+    p_irq->handler();
+    sim_run(sim_enter() + cycles_to_ns(SIM_IRQ_CYCLES));
+    sim.in_irq = false;
+
+    uint64_t duration = sim.now - start;
+    p_irq->count++;
+    p_irq->latency_sum  += latency;
+    p_irq->duration_sum += duration;
+    if (latency > p_irq->latency_max)
+    {
+        p_irq->latency_max = latency;
+    }
+    if (duration > p_irq->duration_max)
+    {
+        p_irq->duration_max = duration;
+    }
+}
+
+
+// Runs the pending interrupts, lowest number first. Returns the time spent in the handlers.
+static uint64_t sim_irq_dispatch(void)
+{
+    if (sim.in_irq || sim.critical > 0)
+    {
+        return 0;
+    }
+
+    uint64_t start = sim.now;
+    for (;;)
+    {
+        sim_irq_t * p_next = NULL;
+        for (uint32_t i = 0; i < SIM_IRQ_COUNT; i++)
+        {
+            if (sim.irq[i].pending)
+            {
+                p_next = &sim.irq[i];
+                break;
+            }
+        }
+        if (p_next == NULL)
+        {
+            break;
+        }
+        sim_irq_run(p_next);
+    }
+    return sim.now - start;
+}
+
+
+static void sim_check_end(void)
+{
+    if (sim.now >= sim.end)
+    {
+        sim.now = sim.end;
+        sim_finish(NULL);
+    }
+}
+
+
+// Advances the current context by delta, running the events that fall inside it and the interrupts they raise
+static void sim_run(uint64_t delta)
+{
+    uint64_t target = sim.now + delta;
+
+    target += sim_irq_dispatch();
+    while (sim.heap_len > 0 && sim.p_heap[0].time <= target)
+    {
+        sim_event_t event = heap_pop();
+        if (event.time > sim.now)
+        {
+            sim.now = event.time;
+            sim_check_end();
+        }
+        event.fn(event.arg);
+        target += sim_irq_dispatch();
+    }
+    if (target > sim.now)
+    {
+        sim.now = target;
+    }
+    sim_check_end();
+}
+
+
+void sim_event_raise(uint32_t address, bool irq, IRQn_Type irqn)
+{
+    *(volatile uint32_t *)(uintptr_t)address = 1;
+    sim_ppi_route(address);
+    if (irq)
+    {
+        sim_irq_pend(irqn);
+    }
+}
+
+
+/* Hooks for the mocked SDK headers */
+
+void sim_poll(void)
+{
+    sim_run(sim_enter());
+    sim_leave();
+}
+
+
+void sim_delay_ns(uint64_t ns)
+{
+    sim_run(sim_enter() + ns);
+    sim_leave();
+}
+
+
+void sim_critical_enter(void)
+{
+    sim.critical++;
+}
+
+
+void sim_critical_exit(void)
+{
+    if (sim.critical > 0 && --sim.critical == 0)
+    {
+        sim_poll();
+    }
+}
+
+
+void sim_sev(void)
+{
+    sim.event_register = true;
+}
+
+
+void sim_wfe(void)
+{
+    sim_run(sim_enter());
+    if (sim.event_register)
+    {
+        sim.event_register = false;
+        sim_leave();
+        return;
+    }
+
+    // Sleep until an interrupt has run
+    bool left_powered = sim_saadc_left_powered();
+    sim.sleeps++;
+    if (left_powered)
+    {
+        sim.sleeps_left_powered++;
+    }
+    while (!sim.event_register)
+    {
+        if (sim.heap_len == 0)
+        {
+            sim_finish("CPU sleeps with nothing scheduled");
+        }
+        uint64_t wake = sim.p_heap[0].time;
+        if (wake > sim.end)
+        {
+            wake = sim.end;
+        }
+        if (wake > sim.now)
+        {
+            sim.sleep_total += wake - sim.now;
+            if (left_powered)
+            {
+                sim.left_powered_ns += wake - sim.now;
+            }
+        }
+        sim_run((wake > sim.now) ? wake - sim.now : 0);
+    }
+    sim.event_register = false;
+    sim_leave();
+}
+
+
+uint32_t sim_dma_address(void const * p_buffer)
+{
+    uintptr_t address = (uintptr_t)p_buffer;
+    if (address > UINT32_MAX)
+    {
+        fprintf(stderr, "host sim: EasyDMA buffer %p is above 4 GiB, buffers must be static and the executable "
+                        "linked without PIE\n", p_buffer);
+        exit(EXIT_FAILURE);
+    }
+    return (uint32_t)address;
+}
+
+
+DWT_Type * sim_dwt(void)
+{
+    sim_run(sim_enter());
+
+    uint64_t cycles = ((sim.now - sim.sleep_total) * SIM_CPU_MHZ) / 1000;
+    bool     enabled = (sim_core_debug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) &&
+                       (sim.dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk);
+
+    if (sim.dwt.CYCCNT != sim.dwt_published || !enabled)
+    {
+        // Written by the application, or stopped
+        sim.dwt_offset = cycles - sim.dwt.CYCCNT;
+    }
+    sim.dwt.CYCCNT     = (uint32_t)(cycles - sim.dwt_offset);
+    sim.dwt_published  = sim.dwt.CYCCNT;
+
+    sim_leave();
+    return &sim.dwt;
+}
+
+
+void sim_log(char level, char const * p_fmt, ...)
+{
+    uint64_t spent = sim_enter();
+
+    if (sim.log_enabled && (level != 'D' || sim_env_string("HOST_SIM_LOG_DEBUG") != NULL))
+    {
+        char    line[512];
+        va_list args;
+        va_start(args, p_fmt);
+        vsnprintf(line, sizeof(line), p_fmt, args);
+        va_end(args);
+
+        size_t len = strlen(line);
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+        {
+            line[--len] = '\0';
+        }
+
+        if (level == 'R')
+        {
+            printf("%s\n", line);
+        }
+        else
+        {
+            char const * p_level = (level == 'E') ? "error" :
+                                   (level == 'W') ? "warning" :
+                                   (level == 'D') ? "debug" : "info";
+            printf("[%11.6f] <%s> app: %s\n", (double)sim.now / 1e9, p_level, line);
+        }
+    }
+
+    // The logger runs deferred on the target, only the call is charged
+    sim.host_mark = host_ns();
+    sim_run(spent);
+    sim_leave();
+}
+
+
+void sim_log_hexdump(char level, void const * p_data, uint32_t length)
+{
+    uint8_t const * p_bytes = p_data;
+    char            line[3 * 16 + 1];
+
+    for (uint32_t i = 0; i < length; i += 16)
+    {
+        uint32_t n = 0;
+        for (uint32_t j = i; j < length && j < i + 16; j++)
+        {
+            n += (uint32_t)snprintf(&line[n], sizeof(line) - n, "%02X ", p_bytes[j]);
+        }
+        sim_log(level, "%s", line);
+    }
+}
+
+
+void sim_error(uint32_t error_code, uint32_t line, char const * p_file)
+{
+    fflush(stdout);
+    fprintf(stderr, "host sim: error 0x%08X at %s:%u, t = %.6f s\n",
+            (unsigned)error_code, p_file, (unsigned)line, (double)sim.now / 1e9);
+    exit(EXIT_FAILURE);
+}
+
+
+__attribute__((constructor))
+static void sim_init(void)
+{
+    void * p_map = mmap((void *)SIM_PERIPH_BASE, SIM_PERIPH_SIZE, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (p_map != (void *)SIM_PERIPH_BASE)
+    {
+        fprintf(stderr, "host sim: cannot map the peripherals at 0x%08lX: %s\n", SIM_PERIPH_BASE, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    sim.end          = (uint64_t)(sim_env_double("HOST_SIM_SECONDS", 10.0) * 1e9);
+    sim.cpu_scale    = sim_env_double("HOST_SIM_CPU_SCALE", 0.0);
+    sim.irq_host_max = (uint64_t)(sim_env_double("HOST_SIM_CPU_IRQ_MAX_US", 8.0) * 1e3);
+    sim.log_enabled  = sim_env_double("HOST_SIM_LOG", 1.0) != 0.0;
+    sim.rng          = 0x9E3779B97F4A7C15ULL ^ (uint64_t)sim_env_double("HOST_SIM_SEED", 1.0);
+
+    // Line buffered, so the log interleaves with the report when piped
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    sim_saadc_init();
+    sim_periph_init();
+    sim.host_mark = host_ns();
+}
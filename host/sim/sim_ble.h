@@ -0,0 +1,23 @@
+/**
+ * Host build: interface between the SoftDevice model and the library stubs that sit on top of it.
+ */
+#ifndef SIM_BLE_H__
+#define SIM_BLE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ble.h"
+
+// Queues an event for the SoftDevice event interrupt, which passes it to the observers
+void sim_sd_ble_evt_put(ble_evt_t const * p_evt);
+void sim_sd_soc_evt_put(uint32_t evt_id);
+
+// Adds a characteristic to the GATT table. The virtual central enables notifications on every characteristic with
+// a CCCD, and writes HOST_SIM_NUS_RX to the one with the NUS RX UUID.
+void sim_sd_char_add(uint16_t uuid, bool cccd, ble_gatts_char_handles_t * p_handles);
+
+// Starts connectable advertising. BLE_GAP_EVT_ADV_SET_TERMINATED follows after timeout_ms unless the virtual central
+// connects first, 0 advertises until it does.
+uint32_t sim_sd_adv_start(uint32_t timeout_ms);
+
+#endif // SIM_BLE_H__
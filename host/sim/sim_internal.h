@@ -0,0 +1,58 @@
+/**
+ * Host build: simulator internals shared by the peripheral models and the driver mocks.
+ */
+#ifndef SIM_INTERNAL_H__
+#define SIM_INTERNAL_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "nrf.h"
+#include "nrf_host_sim.h"
+
+#define SIM_IRQ_COUNT 48
+
+// Virtual CPU clock, matches SystemCoreClock
+#define SIM_CPU_MHZ   64
+
+typedef void (* sim_event_fn_t)(uint32_t arg);
+typedef void (* sim_irq_handler_t)(void);
+typedef void (* sim_report_fn_t)(FILE * p_out, double seconds);
+
+// Schedules fn(arg) at the given virtual time. Events cannot be cancelled, models drop stale ones with a generation
+// count in arg.
+void sim_schedule(uint64_t time_ns, sim_event_fn_t fn, uint32_t arg);
+
+uint64_t sim_now(void);
+
+// Sets the event register, routes the event through PPI and pends the interrupt when irq is set
+void sim_event_raise(uint32_t address, bool irq, IRQn_Type irqn);
+
+void sim_irq_connect(IRQn_Type irqn, char const * p_name, sim_irq_handler_t handler);
+void sim_irq_pend(IRQn_Type irqn);
+
+// Peripheral sections of the report printed at the end of the run
+void sim_report_register(sim_report_fn_t fn);
+
+// Ends the run with the reason and the report, e.g. on system OFF
+void sim_finish(char const * p_reason);
+
+// Environment settings
+double   sim_env_double(char const * p_name, double default_value);
+char const * sim_env_string(char const * p_name);
+
+// Deterministic noise source
+double sim_random_gaussian(void);
+
+// Peripheral models
+void sim_saadc_init(void);
+void sim_saadc_task(uint32_t offset);
+void sim_timer_task(uint32_t instance, uint32_t offset);
+void sim_rtc_task(uint32_t instance, uint32_t offset);
+void sim_periph_init(void);
+void sim_ppi_route(uint32_t event_address);
+
+// True when the SAADC is idle but still drawing its active current, i.e. Errata 212 left it powered
+bool sim_saadc_left_powered(void);
+
+#endif // SIM_INTERNAL_H__
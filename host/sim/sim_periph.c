@@ -0,0 +1,518 @@
+/**
+ * Host build: TIMER, RTC, TEMP and PPI models, and task dispatch.
+ *
+ * TIMER and RTC counters are computed from the virtual time since they were last started or cleared, and a compare
+ * event is scheduled for the tick at which the counter reaches each CC register. A TIMER in counter mode only counts
+ * COUNT tasks, its compare events are not modelled. TIMER shorts, RTC EVTEN and PPI channels with forks are modelled.
+ * The TEMP measurement takes 36 us and reads a temperature profile set with
+ *     HOST_SIM_TEMP="start_c,slope_c_per_minute,amplitude_c,period_s"
+ */
+#include <math.h>
+#include <stdlib.h>
+#include "sim_internal.h"
+#include "nrf_rtc.h"
+#include "nrf_timer.h"
+
+#define SIM_TIMER_COUNT    5
+#define SIM_TIMER_CC_COUNT 6
+#define SIM_RTC_COUNT      3
+#define SIM_RTC_CC_COUNT   4
+#define SIM_PPI_CH_COUNT   20
+
+#define TEMP_MEASUREMENT_NS 36000
+
+typedef struct
+{
+    bool     running;
+    uint64_t t0;         // Virtual time of the last START or CLEAR
+    uint64_t base;       // Counter value at t0
+    uint32_t generation[SIM_TIMER_CC_COUNT];
+} sim_counter_t;
+
+static NRF_TIMER_Type * const m_timer_regs[SIM_TIMER_COUNT] = { NRF_TIMER0, NRF_TIMER1, NRF_TIMER2, NRF_TIMER3, NRF_TIMER4 };
+static NRF_RTC_Type * const   m_rtc_regs[SIM_RTC_COUNT]     = { NRF_RTC0, NRF_RTC1, NRF_RTC2 };
+static const IRQn_Type        m_timer_irqn[SIM_TIMER_COUNT] = { TIMER0_IRQn, TIMER1_IRQn, TIMER2_IRQn, TIMER3_IRQn,
+                                                                TIMER4_IRQn };
+static const uint8_t          m_timer_cc_count[SIM_TIMER_COUNT] = { 4, 4, 4, 6, 6 };
+static const IRQn_Type        m_rtc_irqn[SIM_RTC_COUNT]     = { RTC0_IRQn, RTC1_IRQn, RTC2_IRQn };
+
+static sim_counter_t m_timer[SIM_TIMER_COUNT];
+static sim_counter_t m_rtc[SIM_RTC_COUNT];
+
+static struct
+{
+    bool     busy;
+    double   start_c;
+    double   slope_c_per_min;
+    double   amplitude_c;
+    double   period_s;
+    uint64_t measurements;
+} m_temp;
+
+
+/* TIMER */
+
+// Nanoseconds per tick, times 16
+static uint64_t timer_tick_ns16(uint32_t instance)
+{
+    return 1000ULL << (m_timer_regs[instance]->PRESCALER & 0xF);
+}
+
+
+static uint64_t timer_mask(uint32_t instance)
+{
+    static const uint32_t bits[4] = { 16, 8, 24, 32 };
+    return (1ULL << bits[m_timer_regs[instance]->BITMODE & 3]) - 1;
+}
+
+
+static bool timer_counter_mode(uint32_t instance)
+{
+    return m_timer_regs[instance]->MODE != NRF_TIMER_MODE_TIMER;
+}
+
+
+static uint64_t timer_ticks(uint32_t instance)
+{
+    sim_counter_t const * p_timer = &m_timer[instance];
+    if (timer_counter_mode(instance))
+    {
+        return 0;
+    }
+    return ((unsigned __int128)(sim_now() - p_timer->t0) * 16) / timer_tick_ns16(instance);
+}
+
+
+static uint64_t timer_counter(uint32_t instance)
+{
+    sim_counter_t const * p_timer = &m_timer[instance];
+    uint64_t              ticks   = p_timer->running ? timer_ticks(instance) : 0;
+    return (p_timer->base + ticks) & timer_mask(instance);
+}
+
+
+static void timer_compare(uint32_t arg);
+
+
+static void timer_schedule(uint32_t instance, uint32_t ch)
+{
+    sim_counter_t * p_timer = &m_timer[instance];
+    uint32_t        gen     = ++p_timer->generation[ch];
+
+    if (!p_timer->running || timer_counter_mode(instance))
+    {
+        return;
+    }
+
+    uint64_t mask  = timer_mask(instance);
+    uint64_t ticks = timer_ticks(instance);
+    uint64_t delta = (m_timer_regs[instance]->CC[ch] - (p_timer->base + ticks)) & mask;
+    if (delta == 0)
+    {
+        delta = mask + 1;
+    }
+    uint64_t time = p_timer->t0 +
+                    (uint64_t)(((unsigned __int128)(ticks + delta) * timer_tick_ns16(instance) + 15) / 16);
+    sim_schedule(time, timer_compare, instance | (ch << 4) | (gen << 8));
+}
+
+
+static void timer_schedule_all(uint32_t instance)
+{
+    for (uint32_t ch = 0; ch < m_timer_cc_count[instance]; ch++)
+    {
+        timer_schedule(instance, ch);
+    }
+}
+
+
+static void timer_compare(uint32_t arg)
+{
+    uint32_t         instance = arg & 0xF;
+    uint32_t         ch       = (arg >> 4) & 0xF;
+    NRF_TIMER_Type * p_reg    = m_timer_regs[instance];
+
+    if ((arg >> 8) != (m_timer[instance].generation[ch] & 0xFFFFFF))
+    {
+        return;
+    }
+
+    sim_event_raise((uint32_t)(uintptr_t)&p_reg->EVENTS_COMPARE[ch],
+                    (p_reg->INTENSET & (NRF_TIMER_INT_COMPARE0_MASK << ch)) != 0,
+                    m_timer_irqn[instance]);
+
+    if (p_reg->SHORTS & (1UL << (8 + ch)))
+    {
+        sim_timer_task(instance, NRF_TIMER_TASK_STOP);
+    }
+    if (p_reg->SHORTS & (1UL << ch))
+    {
+        sim_timer_task(instance, NRF_TIMER_TASK_CLEAR);
+    }
+    else
+    {
+        timer_schedule(instance, ch);
+    }
+}
+
+
+void sim_timer_task(uint32_t instance, uint32_t offset)
+{
+    sim_counter_t *  p_timer = &m_timer[instance];
+    NRF_TIMER_Type * p_reg   = m_timer_regs[instance];
+
+    switch (offset)
+    {
+        case NRF_TIMER_TASK_START:
+            if (!p_timer->running)
+            {
+                p_timer->running = true;
+                p_timer->t0      = sim_now();
+            }
+            break;
+
+        case NRF_TIMER_TASK_STOP:
+            p_timer->base    = timer_counter(instance);
+            p_timer->running = false;
+            break;
+
+        case NRF_TIMER_TASK_SHUTDOWN:
+            p_timer->base    = 0;
+            p_timer->running = false;
+            break;
+
+        case NRF_TIMER_TASK_CLEAR:
+            p_timer->base = 0;
+            p_timer->t0   = sim_now();
+            break;
+
+        case NRF_TIMER_TASK_COUNT:
+            if (p_timer->running && timer_counter_mode(instance))
+            {
+                p_timer->base = (p_timer->base + 1) & timer_mask(instance);
+            }
+            break;
+
+        default:
+            if (offset >= NRF_TIMER_TASK_CAPTURE0 && offset < NRF_TIMER_TASK_CAPTURE0 + 4 * m_timer_cc_count[instance])
+            {
+                p_reg->CC[(offset - NRF_TIMER_TASK_CAPTURE0) / 4] = (uint32_t)timer_counter(instance);
+            }
+            break;
+    }
+    timer_schedule_all(instance);
+}
+
+
+static uint32_t timer_instance(NRF_TIMER_Type const * p_reg)
+{
+    for (uint32_t i = 0; i < SIM_TIMER_COUNT; i++)
+    {
+        if (m_timer_regs[i] == p_reg)
+        {
+            return i;
+        }
+    }
+    abort();
+}
+
+
+void sim_timer_update(NRF_TIMER_Type * p_reg)
+{
+    timer_schedule_all(timer_instance(p_reg));
+}
+
+
+uint32_t sim_timer_counter(NRF_TIMER_Type * p_reg)
+{
+    sim_poll();
+    return (uint32_t)timer_counter(timer_instance(p_reg));
+}
+
+
+/* RTC */
+
+// Nanoseconds per tick, times 32768
+static uint64_t rtc_tick_ns32768(uint32_t instance)
+{
+    return ((m_rtc_regs[instance]->PRESCALER & 0xFFF) + 1) * 1000000000ULL;
+}
+
+
+static uint64_t rtc_ticks(uint32_t instance)
+{
+    sim_counter_t const * p_rtc = &m_rtc[instance];
+    return ((unsigned __int128)(sim_now() - p_rtc->t0) * 32768) / rtc_tick_ns32768(instance);
+}
+
+
+static uint64_t rtc_counter(uint32_t instance)
+{
+    sim_counter_t const * p_rtc = &m_rtc[instance];
+    uint64_t              ticks = p_rtc->running ? rtc_ticks(instance) : 0;
+    return (p_rtc->base + ticks) & RTC_COUNTER_COUNTER_Msk;
+}
+
+
+static void rtc_compare(uint32_t arg);
+
+
+static void rtc_schedule(uint32_t instance, uint32_t ch)
+{
+    sim_counter_t * p_rtc = &m_rtc[instance];
+    uint32_t        gen   = ++p_rtc->generation[ch];
+
+    if (!p_rtc->running)
+    {
+        return;
+    }
+
+    uint64_t ticks = rtc_ticks(instance);
+    uint64_t delta = (m_rtc_regs[instance]->CC[ch] - (p_rtc->base + ticks)) & RTC_COUNTER_COUNTER_Msk;
+    if (delta == 0)
+    {
+        delta = RTC_COUNTER_COUNTER_Msk + 1;
+    }
+    uint64_t time = p_rtc->t0 +
+                    (uint64_t)(((unsigned __int128)(ticks + delta) * rtc_tick_ns32768(instance) + 32767) / 32768);
+    sim_schedule(time, rtc_compare, instance | (ch << 4) | (gen << 8));
+}
+
+
+static void rtc_schedule_all(uint32_t instance)
+{
+    for (uint32_t ch = 0; ch < SIM_RTC_CC_COUNT; ch++)
+    {
+        rtc_schedule(instance, ch);
+    }
+}
+
+
+static void rtc_compare(uint32_t arg)
+{
+    uint32_t       instance = arg & 0xF;
+    uint32_t       ch       = (arg >> 4) & 0xF;
+    NRF_RTC_Type * p_reg    = m_rtc_regs[instance];
+    uint32_t       mask     = NRF_RTC_INT_COMPARE0_MASK << ch;
+    uint32_t       address  = (uint32_t)(uintptr_t)&p_reg->EVENTS_COMPARE[ch];
+
+    if ((arg >> 8) != (m_rtc[instance].generation[ch] & 0xFFFFFF))
+    {
+        return;
+    }
+
+    // The event is only generated when it is routed to PPI or enabled as an interrupt
+    bool irq = (p_reg->INTENSET & mask) != 0;
+    if (p_reg->EVTEN & mask)
+    {
+        sim_event_raise(address, irq, m_rtc_irqn[instance]);
+    }
+    else if (irq)
+    {
+        p_reg->EVENTS_COMPARE[ch] = 1;
+        sim_irq_pend(m_rtc_irqn[instance]);
+    }
+    rtc_schedule(instance, ch);
+}
+
+
+void sim_rtc_task(uint32_t instance, uint32_t offset)
+{
+    sim_counter_t * p_rtc = &m_rtc[instance];
+
+    switch (offset)
+    {
+        case NRF_RTC_TASK_START:
+            if (!p_rtc->running)
+            {
+                p_rtc->running = true;
+                p_rtc->t0      = sim_now();
+            }
+            break;
+
+        case NRF_RTC_TASK_STOP:
+            p_rtc->base    = rtc_counter(instance);
+            p_rtc->running = false;
+            break;
+
+        case NRF_RTC_TASK_CLEAR:
+            p_rtc->base = 0;
+            p_rtc->t0   = sim_now();
+            break;
+
+        case NRF_RTC_TASK_TRIGGER_OVERFLOW:
+            p_rtc->base = 0xFFFFF0;
+            p_rtc->t0   = sim_now();
+            break;
+
+        default:
+            break;
+    }
+    rtc_schedule_all(instance);
+}
+
+
+static uint32_t rtc_instance(NRF_RTC_Type const * p_reg)
+{
+    for (uint32_t i = 0; i < SIM_RTC_COUNT; i++)
+    {
+        if (m_rtc_regs[i] == p_reg)
+        {
+            return i;
+        }
+    }
+    abort();
+}
+
+
+void sim_rtc_update(NRF_RTC_Type * p_reg)
+{
+    rtc_schedule_all(rtc_instance(p_reg));
+}
+
+
+uint32_t sim_rtc_counter(NRF_RTC_Type * p_reg)
+{
+    sim_poll();
+    return (uint32_t)rtc_counter(rtc_instance(p_reg));
+}
+
+
+/* TEMP */
+
+static void temp_done(uint32_t arg)
+{
+    NRF_TEMP_Type * p_reg = (NRF_TEMP_Type *)NRF_TEMP_BASE;
+    double          t     = (double)sim_now() / 1e9;
+    double          temp  = m_temp.start_c + m_temp.slope_c_per_min * t / 60.0;
+
+    (void)arg;
+    if (m_temp.period_s > 0)
+    {
+        temp += m_temp.amplitude_c * sin(2.0 * M_PI * t / m_temp.period_s);
+    }
+    *(volatile int32_t *)&p_reg->TEMP = (int32_t)lround(temp * 4.0);  // 0.25 degC steps
+    p_reg->EVENTS_DATARDY = 1;
+    m_temp.busy = false;
+    m_temp.measurements++;
+}
+
+
+NRF_TEMP_Type * sim_temp_access(void)
+{
+    NRF_TEMP_Type * p_reg = (NRF_TEMP_Type *)NRF_TEMP_BASE;
+
+    sim_poll();
+    if (p_reg->TASKS_START != 0)
+    {
+        p_reg->TASKS_START = 0;
+        if (!m_temp.busy)
+        {
+            m_temp.busy = true;
+            sim_schedule(sim_now() + TEMP_MEASUREMENT_NS, temp_done, 0);
+        }
+    }
+    p_reg->TASKS_STOP = 0;
+    return p_reg;
+}
+
+
+static void temp_report(FILE * p_out, double seconds)
+{
+    (void)seconds;
+    if (m_temp.measurements > 0)
+    {
+        fprintf(p_out, "TEMP: %llu measurements, busy %.3f ms\n", (unsigned long long)m_temp.measurements,
+                m_temp.measurements * TEMP_MEASUREMENT_NS / 1e6);
+    }
+}
+
+
+/* PPI and task dispatch */
+
+static void sim_task_exec(uint32_t address)
+{
+    uint32_t base   = address & ~0xFFFUL;
+    uint32_t offset = address & 0xFFFUL;
+
+    switch (base)
+    {
+        case NRF_SAADC_BASE:
+            sim_saadc_task(offset);
+            return;
+        case NRF_TIMER0_BASE:
+            sim_timer_task(0, offset);
+            return;
+        case NRF_TIMER1_BASE:
+            sim_timer_task(1, offset);
+            return;
+        case NRF_TIMER2_BASE:
+            sim_timer_task(2, offset);
+            return;
+        case NRF_TIMER3_BASE:
+            sim_timer_task(3, offset);
+            return;
+        case NRF_TIMER4_BASE:
+            sim_timer_task(4, offset);
+            return;
+        case NRF_RTC0_BASE:
+            sim_rtc_task(0, offset);
+            return;
+        case NRF_RTC1_BASE:
+            sim_rtc_task(1, offset);
+            return;
+        case NRF_RTC2_BASE:
+            sim_rtc_task(2, offset);
+            return;
+        default:
+            fprintf(stderr, "host sim: task at 0x%08X is not simulated\n", (unsigned)address);
+            exit(EXIT_FAILURE);
+    }
+}
+
+
+void sim_ppi_route(uint32_t event_address)
+{
+    uint32_t chen = NRF_PPI->CHEN;
+
+    for (uint32_t ch = 0; chen != 0 && ch < SIM_PPI_CH_COUNT; ch++)
+    {
+        if ((chen & (1UL << ch)) && NRF_PPI->CH[ch].EEP == event_address)
+        {
+            uint32_t tep      = NRF_PPI->CH[ch].TEP;
+            uint32_t fork_tep = NRF_PPI->FORK[ch].TEP;
+            if (tep != 0)
+            {
+                sim_task_exec(tep);
+            }
+            if (fork_tep != 0)
+            {
+                sim_task_exec(fork_tep);
+            }
+        }
+    }
+}
+
+
+void sim_task_trigger(uint32_t address)
+{
+    sim_poll();
+    sim_task_exec(address);
+    sim_poll();
+}
+
+
+void sim_periph_init(void)
+{
+    double v[4] = { 25.0, 0.0, 0.0, 0.0 };
+    char const * p_value = sim_env_string("HOST_SIM_TEMP");
+    if (p_value != NULL)
+    {
+        sscanf(p_value, "%lf,%lf,%lf,%lf", &v[0], &v[1], &v[2], &v[3]);
+    }
+    m_temp.start_c         = v[0];
+    m_temp.slope_c_per_min = v[1];
+    m_temp.amplitude_c     = v[2];
+    m_temp.period_s        = v[3];
+    sim_report_register(temp_report);
+}
@@ -0,0 +1,562 @@
+/**
+ * Host build: SAADC model.
+ *
+ * START latches RESULT.PTR and RESULT.MAXCNT and arms EasyDMA. SAMPLE converts all channels with PSELP set, one
+ * after the other, each taking the acquisition time plus the 2 us conversion time, times the oversampling ratio in
+ * burst mode. A SAMPLE while a conversion is running, or while no buffer is armed, loses the samples. END is raised
+ * when RESULT.MAXCNT results have been written, and disarms EasyDMA until the next START. The internal timer
+ * (SAMPLERATE in Timers mode) triggers SAMPLE every CC / 16 MHz after the first SAMPLE, until STOP.
+ *
+ * Analog inputs are a DC level plus a sine and Gaussian noise, set per input in the environment:
+ *     HOST_SIM_AIN<n>="offset_mv,amplitude_mv,frequency_hz,noise_mv"
+ * or a recorded trace, one value in mV per line, played back at HOST_SIM_TRACE_RATE Hz:
+ *     HOST_SIM_AIN<n>_TRACE=path
+ *
+ * With HOST_SIM_SAADC_DUMP set, the results written to RAM are also written to that file, one line per conversion of
+ * all channels, to check what the application sends against what it sampled.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim_internal.h"
+#include "nrf_saadc.h"
+#include "nrf_erratas.h"
+
+// STATUS is read-only to the application
+#define SAADC_STATUS (*(volatile uint32_t *)&NRF_SAADC->STATUS)
+
+// Conversion time after the acquisition time
+#define SAADC_TCONV_NS       2000
+// Offset calibration time, a model value
+#define SAADC_TCAL_NS        100000
+
+#define SAADC_INPUT_COUNT    9
+
+typedef struct
+{
+    double   offset_mv;
+    double   amplitude_mv;
+    double   frequency_hz;
+    double   noise_mv;
+    float *  p_trace;
+    uint32_t trace_length;
+} sim_ain_t;
+
+static struct
+{
+    sim_ain_t ain[SAADC_INPUT_COUNT];
+    double    vdd_mv;
+    double    trace_rate;
+    bool      started;       // EasyDMA armed by START
+    uint64_t  started_at;
+    uint32_t  ptr;           // Latched RESULT.PTR
+    uint32_t  maxcnt;        // Latched RESULT.MAXCNT
+    uint32_t  amount;
+    bool      converting;
+    bool      calibrating;
+    bool      timer_running; // Internal timer
+    uint32_t  generation;    // Drops conversions and timer ticks that were stopped
+    uint32_t  oversampled;   // Conversions accumulated without burst
+    double    accumulator[SAADC_CH_NUM];
+    bool      errata_212;
+    FILE *    p_dump;
+    bool      powered;       // Left powered after a conversion until the Errata 212 workaround runs
+    uint64_t  errata_212_checks;
+    // Statistics
+    uint64_t  samples;
+    uint64_t  buffers;
+    uint64_t  lost;
+    uint64_t  gaps;
+    bool      in_gap;
+    uint64_t  calibrations;
+    uint64_t  limit_events;
+    uint64_t  starts;
+    uint64_t  sample_tasks;
+    uint64_t  sample_ignored;  // SAMPLE tasks while a conversion or calibration was running
+    uint64_t  converting_ns;
+    uint64_t  calibrating_ns;
+    uint64_t  started_ns;      // EasyDMA armed, START to END or STOP
+} m_saadc;
+
+
+static void started_clear(void)
+{
+    if (m_saadc.started)
+    {
+        m_saadc.started     = false;
+        m_saadc.started_ns += sim_now() - m_saadc.started_at;
+    }
+}
+
+
+static void ain_parse(uint32_t input)
+{
+    char         name[32];
+    char const * p_value;
+    sim_ain_t *  p_ain = &m_saadc.ain[input];
+
+    // Defaults: mid-scale of the 3.6 V range with a small sine, a different frequency on each input
+    p_ain->offset_mv    = 1650.0;
+    p_ain->amplitude_mv = 500.0;
+    p_ain->frequency_hz = 50.0 * (input + 1);
+    p_ain->noise_mv     = 1.0;
+
+    snprintf(name, sizeof(name), "HOST_SIM_AIN%u", (unsigned)input);
+    p_value = sim_env_string(name);
+    if (p_value != NULL)
+    {
+        double v[4] = { p_ain->offset_mv, 0.0, 0.0, 0.0 };
+        sscanf(p_value, "%lf,%lf,%lf,%lf", &v[0], &v[1], &v[2], &v[3]);
+        p_ain->offset_mv    = v[0];
+        p_ain->amplitude_mv = v[1];
+        p_ain->frequency_hz = v[2];
+        p_ain->noise_mv     = v[3];
+    }
+
+    snprintf(name, sizeof(name), "HOST_SIM_AIN%u_TRACE", (unsigned)input);
+    p_value = sim_env_string(name);
+    if (p_value != NULL)
+    {
+        FILE * p_file = fopen(p_value, "r");
+        if (p_file == NULL)
+        {
+            fprintf(stderr, "host sim: cannot open trace %s\n", p_value);
+            exit(EXIT_FAILURE);
+        }
+        uint32_t capacity = 1024;
+        char     line[128];
+        p_ain->p_trace = malloc(capacity * sizeof(float));
+        while (p_ain->p_trace != NULL && fgets(line, sizeof(line), p_file) != NULL)
+        {
+            char * p_end;
+            double mv = strtod(line, &p_end);
+            if (p_end == line)
+            {
+                continue;  // Header or comment
+            }
+            if (p_ain->trace_length == capacity)
+            {
+                capacity *= 2;
+                p_ain->p_trace = realloc(p_ain->p_trace, capacity * sizeof(float));
+            }
+            p_ain->p_trace[p_ain->trace_length++] = (float)mv;
+        }
+        fclose(p_file);
+        if (p_ain->p_trace == NULL || p_ain->trace_length == 0)
+        {
+            fprintf(stderr, "host sim: trace %s is empty\n", p_value);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+static double ain_mv(uint32_t psel)
+{
+    if (psel == NRF_SAADC_INPUT_VDD)
+    {
+        return m_saadc.vdd_mv;
+    }
+    if (psel == NRF_SAADC_INPUT_DISABLED || psel > NRF_SAADC_INPUT_VDD)
+    {
+        return 0.0;
+    }
+
+    sim_ain_t const * p_ain = &m_saadc.ain[psel - NRF_SAADC_INPUT_AIN0];
+    double            t     = (double)sim_now() / 1e9;
+
+    if (p_ain->p_trace != NULL)
+    {
+        uint64_t i = (uint64_t)(t * m_saadc.trace_rate);
+        return p_ain->p_trace[i % p_ain->trace_length];
+    }
+    return p_ain->offset_mv + p_ain->amplitude_mv * sin(2.0 * M_PI * p_ain->frequency_hz * t)
+         + p_ain->noise_mv * sim_random_gaussian();
+}
+
+
+static double channel_code(uint32_t ch)
+{
+    static const double gain[8] = { 1.0 / 6, 1.0 / 5, 1.0 / 4, 1.0 / 3, 1.0 / 2, 1.0, 2.0, 4.0 };
+
+    uint32_t config  = NRF_SAADC->CH[ch].CONFIG;
+    bool     diff    = (config >> SAADC_CH_CONFIG_MODE_Pos) & 1;
+    double   ref_mv  = ((config >> SAADC_CH_CONFIG_REFSEL_Pos) & 1) ? m_saadc.vdd_mv / 4.0 : 600.0;
+    double   vin     = ain_mv(NRF_SAADC->CH[ch].PSELP) - (diff ? ain_mv(NRF_SAADC->CH[ch].PSELN) : 0.0);
+    uint32_t bits    = 8 + 2 * (NRF_SAADC->RESOLUTION & 3) - (diff ? 1 : 0);
+
+    return vin * gain[(config >> SAADC_CH_CONFIG_GAIN_Pos) & 7] / ref_mv * (double)(1UL << bits);
+}
+
+
+static int16_t code_clamp(double code)
+{
+    uint32_t bits = 8 + 2 * (NRF_SAADC->RESOLUTION & 3);
+    double   max  = (double)((1L << bits) - 1);
+    double   min  = -(double)(1L << bits);
+
+    code = round(code);
+    return (int16_t)((code > max) ? max : (code < min) ? min : code);
+}
+
+
+static uint64_t conversion_ns(void)
+{
+    static const uint32_t tacq_ns[8] = { 3000, 5000, 10000, 15000, 20000, 40000, 40000, 40000 };
+    uint64_t              total      = 0;
+
+    for (uint32_t ch = 0; ch < SAADC_CH_NUM; ch++)
+    {
+        uint32_t config = NRF_SAADC->CH[ch].CONFIG;
+        if (NRF_SAADC->CH[ch].PSELP == NRF_SAADC_INPUT_DISABLED)
+        {
+            continue;
+        }
+        uint64_t t = tacq_ns[(config >> SAADC_CH_CONFIG_TACQ_Pos) & 7] + SAADC_TCONV_NS;
+        if ((config >> SAADC_CH_CONFIG_BURST_Pos) & 1)
+        {
+            t <<= NRF_SAADC->OVERSAMPLE;
+        }
+        total += t;
+    }
+    return total;
+}
+
+
+static bool int_enabled(uint32_t mask)
+{
+    return (NRF_SAADC->INTEN & mask) != 0;
+}
+
+
+static void saadc_raise(nrf_saadc_event_t event, uint32_t int_mask)
+{
+    sim_event_raise(NRF_SAADC_BASE + (uint32_t)event, int_enabled(int_mask), SAADC_IRQn);
+}
+
+
+void sim_saadc_irq_update(void)
+{
+    static const nrf_saadc_event_t events[] = {
+        NRF_SAADC_EVENT_STARTED, NRF_SAADC_EVENT_END, NRF_SAADC_EVENT_DONE,
+        NRF_SAADC_EVENT_RESULTDONE, NRF_SAADC_EVENT_CALIBRATEDONE, NRF_SAADC_EVENT_STOPPED };
+
+    for (uint32_t i = 0; i < sizeof(events) / sizeof(events[0]); i++)
+    {
+        if (nrf_saadc_event_check(events[i]) && int_enabled(1UL << i))
+        {
+            sim_irq_pend(SAADC_IRQn);
+        }
+    }
+}
+
+
+static void lost_samples(uint32_t count)
+{
+    m_saadc.lost += count;
+    if (!m_saadc.in_gap)
+    {
+        m_saadc.in_gap = true;
+        m_saadc.gaps++;
+    }
+}
+
+
+static void limit_raise(uint32_t ch, nrf_saadc_limit_t limit)
+{
+    uint32_t mask = nrf_saadc_limit_int_get(ch, limit);
+    if (int_enabled(mask))
+    {
+        m_saadc.limit_events++;
+    }
+    saadc_raise(nrf_saadc_event_limit_get(ch, limit), mask);
+}
+
+
+static void conversion_done(uint32_t generation)
+{
+    if (generation != m_saadc.generation || !m_saadc.converting)
+    {
+        return;
+    }
+    m_saadc.converting = false;
+    SAADC_STATUS  = 0;
+
+    uint32_t ratio = 1UL << NRF_SAADC->OVERSAMPLE;
+    bool     burst = false;
+    bool     dumped = false;
+    for (uint32_t ch = 0; ch < SAADC_CH_NUM; ch++)
+    {
+        if (NRF_SAADC->CH[ch].PSELP != NRF_SAADC_INPUT_DISABLED &&
+            ((NRF_SAADC->CH[ch].CONFIG >> SAADC_CH_CONFIG_BURST_Pos) & 1))
+        {
+            burst = true;
+        }
+    }
+
+    // Without burst, each SAMPLE task takes one of the oversampled conversions
+    if (!burst && ratio > 1)
+    {
+        for (uint32_t ch = 0; ch < SAADC_CH_NUM; ch++)
+        {
+            if (NRF_SAADC->CH[ch].PSELP != NRF_SAADC_INPUT_DISABLED)
+            {
+                m_saadc.accumulator[ch] += channel_code(ch);
+            }
+        }
+        saadc_raise(NRF_SAADC_EVENT_DONE, NRF_SAADC_INT_DONE);
+        if (++m_saadc.oversampled < ratio)
+        {
+            return;
+        }
+        m_saadc.oversampled = 0;
+    }
+
+    for (uint32_t ch = 0; ch < SAADC_CH_NUM; ch++)
+    {
+        if (NRF_SAADC->CH[ch].PSELP == NRF_SAADC_INPUT_DISABLED)
+        {
+            continue;
+        }
+
+        double code = 0.0;
+        if (ratio > 1 && !burst)
+        {
+            code = m_saadc.accumulator[ch] / ratio;
+            m_saadc.accumulator[ch] = 0.0;
+        }
+        else
+        {
+            for (uint32_t i = 0; i < ratio; i++)
+            {
+                code += channel_code(ch);
+            }
+            code /= ratio;
+        }
+        int16_t value = code_clamp(code);
+
+        if (m_saadc.started && m_saadc.amount < m_saadc.maxcnt)
+        {
+            ((nrf_saadc_value_t *)(uintptr_t)m_saadc.ptr)[m_saadc.amount++] = value;
+            m_saadc.samples++;
+            m_saadc.in_gap = false;
+            if (m_saadc.p_dump != NULL)
+            {
+                fprintf(m_saadc.p_dump, dumped ? " %d" : "%d", value);
+                dumped = true;
+            }
+        }
+        else
+        {
+            lost_samples(1);
+        }
+
+        if (burst || ratio == 1)
+        {
+            saadc_raise(NRF_SAADC_EVENT_DONE, NRF_SAADC_INT_DONE);
+        }
+        saadc_raise(NRF_SAADC_EVENT_RESULTDONE, NRF_SAADC_INT_RESULTDONE);
+
+        int16_t low  = (int16_t)(NRF_SAADC->CH[ch].LIMIT & 0xFFFF);
+        int16_t high = (int16_t)(NRF_SAADC->CH[ch].LIMIT >> 16);
+        if (value > high)
+        {
+            limit_raise(ch, NRF_SAADC_LIMIT_HIGH);
+        }
+        if (value < low)
+        {
+            limit_raise(ch, NRF_SAADC_LIMIT_LOW);
+        }
+    }
+
+    if (dumped)
+    {
+        fputc('\n', m_saadc.p_dump);
+    }
+
+    *(volatile uint32_t *)&NRF_SAADC->RESULT.AMOUNT = m_saadc.amount;
+    if (m_saadc.started && m_saadc.amount >= m_saadc.maxcnt)
+    {
+        started_clear();
+        m_saadc.buffers++;
+        saadc_raise(NRF_SAADC_EVENT_END, NRF_SAADC_INT_END);
+    }
+}
+
+
+static void sample(void)
+{
+    m_saadc.sample_tasks++;
+    if (m_saadc.converting || m_saadc.calibrating)
+    {
+        // Sample period shorter than TACQ + TCONV, or sampled during calibration
+        m_saadc.sample_ignored++;
+        return;
+    }
+    uint64_t duration = conversion_ns();
+    m_saadc.converting     = true;
+    m_saadc.powered        = true;
+    m_saadc.converting_ns += duration;
+    SAADC_STATUS  = 1;
+    sim_schedule(sim_now() + duration, conversion_done, m_saadc.generation);
+}
+
+
+static void timer_tick(uint32_t generation)
+{
+    uint32_t samplerate = NRF_SAADC->SAMPLERATE;
+    if (generation != m_saadc.generation || !((samplerate >> SAADC_SAMPLERATE_MODE_Pos) & 1))
+    {
+        m_saadc.timer_running = false;
+        return;
+    }
+    sample();
+    uint32_t cc = samplerate & SAADC_SAMPLERATE_CC_Msk;
+    sim_schedule(sim_now() + (uint64_t)cc * 1000 / 16, timer_tick, m_saadc.generation);
+}
+
+
+static void calibration_done(uint32_t generation)
+{
+    if (generation != m_saadc.generation || !m_saadc.calibrating)
+    {
+        return;
+    }
+    m_saadc.calibrating = false;
+    SAADC_STATUS   = 0;
+    m_saadc.calibrations++;
+    saadc_raise(NRF_SAADC_EVENT_CALIBRATEDONE, NRF_SAADC_INT_CALIBRATEDONE);
+}
+
+
+void sim_saadc_task(uint32_t offset)
+{
+    if (NRF_SAADC->ENABLE == 0)
+    {
+        return;
+    }
+
+    switch (offset)
+    {
+        case NRF_SAADC_TASK_START:
+            m_saadc.ptr     = NRF_SAADC->RESULT.PTR;
+            m_saadc.maxcnt  = NRF_SAADC->RESULT.MAXCNT;
+            m_saadc.amount  = 0;
+            if (!m_saadc.started)
+            {
+                m_saadc.started    = true;
+                m_saadc.started_at = sim_now();
+            }
+            m_saadc.starts++;
+            *(volatile uint32_t *)&NRF_SAADC->RESULT.AMOUNT = 0;
+            saadc_raise(NRF_SAADC_EVENT_STARTED, NRF_SAADC_INT_STARTED);
+            break;
+
+        case NRF_SAADC_TASK_SAMPLE:
+            if (((NRF_SAADC->SAMPLERATE >> SAADC_SAMPLERATE_MODE_Pos) & 1) && !m_saadc.timer_running)
+            {
+                m_saadc.timer_running = true;
+                timer_tick(m_saadc.generation);
+            }
+            else
+            {
+                sample();
+            }
+            break;
+
+        case NRF_SAADC_TASK_STOP:
+            m_saadc.generation++;
+            started_clear();
+            m_saadc.converting    = false;
+            m_saadc.calibrating   = false;
+            m_saadc.timer_running = false;
+            m_saadc.oversampled   = 0;
+            memset(m_saadc.accumulator, 0, sizeof(m_saadc.accumulator));
+            SAADC_STATUS     = 0;
+            saadc_raise(NRF_SAADC_EVENT_STOPPED, NRF_SAADC_INT_STOPPED);
+            break;
+
+        case NRF_SAADC_TASK_CALIBRATEOFFSET:
+            if (!m_saadc.calibrating)
+            {
+                m_saadc.calibrating     = true;
+                m_saadc.powered         = true;
+                m_saadc.calibrating_ns += SAADC_TCAL_NS;
+                SAADC_STATUS   = 1;
+                sim_schedule(sim_now() + SAADC_TCAL_NS, calibration_done, m_saadc.generation);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+// The workaround checks the errata right before it power cycles the SAADC
+bool nrf52_errata_212(void)
+{
+    m_saadc.errata_212_checks++;
+    if (m_saadc.errata_212)
+    {
+        m_saadc.powered = false;
+    }
+    return m_saadc.errata_212;
+}
+
+
+bool sim_saadc_left_powered(void)
+{
+    return m_saadc.errata_212 && m_saadc.powered && !m_saadc.converting && !m_saadc.calibrating;
+}
+
+
+static void saadc_report(FILE * p_out, double seconds)
+{
+    fprintf(p_out, "SAADC: %llu samples, %.1f samples/s, %llu buffers, %llu SAMPLE tasks, %llu STARTs\n",
+            (unsigned long long)m_saadc.samples, (seconds > 0) ? (double)m_saadc.samples / seconds : 0.0,
+            (unsigned long long)m_saadc.buffers, (unsigned long long)m_saadc.sample_tasks,
+            (unsigned long long)m_saadc.starts);
+    if (m_saadc.sample_ignored > 0)
+    {
+        fprintf(p_out, "SAADC: %llu SAMPLE tasks ignored, conversion or calibration still running\n",
+                (unsigned long long)m_saadc.sample_ignored);
+    }
+    fprintf(p_out, "SAADC: dropped buffers %llu (%llu samples lost), %llu calibrations, %llu limit events\n",
+            (unsigned long long)m_saadc.gaps, (unsigned long long)m_saadc.lost,
+            (unsigned long long)m_saadc.calibrations, (unsigned long long)m_saadc.limit_events);
+    fprintf(p_out, "SAADC: Errata 212 %s, %llu workaround checks\n", m_saadc.errata_212 ? "present" : "absent",
+            (unsigned long long)m_saadc.errata_212_checks);
+    fprintf(p_out, "SAADC: busy %.3f ms converting, %.3f ms calibrating\n",
+            m_saadc.converting_ns / 1e6, m_saadc.calibrating_ns / 1e6);
+
+    uint64_t started_ns = m_saadc.started_ns + (m_saadc.started ? sim_now() - m_saadc.started_at : 0);
+    fprintf(p_out, "SAADC: started (EasyDMA armed) %.3f s, %.1f %%\n",
+            started_ns / 1e9, (seconds > 0) ? started_ns / 1e7 / seconds : 0.0);
+}
+
+
+void sim_saadc_init(void)
+{
+    m_saadc.vdd_mv     = sim_env_double("HOST_SIM_VDD_MV", 3000.0);
+    m_saadc.trace_rate = sim_env_double("HOST_SIM_TRACE_RATE", 1000.0);
+    m_saadc.errata_212 = sim_env_double("HOST_SIM_ERRATA_212", 0.0) != 0.0;
+    if (sim_env_string("HOST_SIM_SAADC_DUMP") != NULL)
+    {
+        m_saadc.p_dump = fopen(sim_env_string("HOST_SIM_SAADC_DUMP"), "w");
+        if (m_saadc.p_dump == NULL)
+        {
+            fprintf(stderr, "host sim: cannot write %s\n", sim_env_string("HOST_SIM_SAADC_DUMP"));
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (uint32_t i = 0; i < SAADC_INPUT_COUNT - 1; i++)
+    {
+        ain_parse(i);
+    }
+    for (uint32_t ch = 0; ch < SAADC_CH_NUM; ch++)
+    {
+        NRF_SAADC->CH[ch].LIMIT = 0x7FFF8000UL;
+    }
+    sim_report_register(saadc_report);
+}
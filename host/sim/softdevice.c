@@ -0,0 +1,695 @@
+/**
+ * Host build: SoftDevice model with one peripheral link to a virtual central.
+ *
+ * The central connects HOST_SIM_BLE_CONNECT_MS after advertising starts, answers the ATT MTU request with
+ * HOST_SIM_BLE_MTU and enables notifications on every characteristic with a CCCD. While connected, a connection
+ * event runs every HOST_SIM_BLE_CONN_INTERVAL_MS. It sends queued notifications until the NRF_SDH_BLE_GAP_EVENT_LENGTH
+ * is used up, on the 1M PHY with the ATT MTU as data length, and reports them with BLE_GATTS_EVT_HVN_TX_COMPLETE.
+ * sd_ble_gatts_hvx() queues at most HOST_SIM_BLE_HVN_QUEUE notifications.
+ *
+ * HOST_SIM_NUS_RX is written to the NUS RX characteristic, split at '|' into writes HOST_SIM_NUS_RX_INTERVAL_MS
+ * apart, the first HOST_SIM_NUS_RX_MS after the connection. With HOST_SIM_NUS_DUMP set, every notification accepted by
+ * sd_ble_gatts_hvx() is written to that file in hex, one per line, e.g. for tools/nus_decode.py.
+ *
+ * Events are queued for the SoftDevice event interrupt, SWI2, which passes them to the observers in priority order as
+ * nrf_sdh does with NRF_SDH_DISPATCH_MODEL 0. Only the radio events that produce a SoftDevice event wake the CPU, so
+ * the wakeups in the report are those of the application.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "sim_internal.h"
+#include "sim_ble.h"
+#include "app_util.h"
+#include "ble.h"
+#include "ble_hci.h"
+#include "ble_nus.h"
+#include "nrf_sdh.h"
+#include "nrf_sdh_ble.h"
+#include "nrf_sdh_soc.h"
+#include "nrf_soc.h"
+
+#define SD_EVT_IRQn          SWI2_EGU2_IRQn
+#define SD_BLE_EVT_QUEUE     32
+#define SD_SOC_EVT_QUEUE     8
+#define SD_CHAR_MAX          8
+#define SD_HANDLE_FIRST      0x000C
+#define SD_HVN_QUEUE_MAX     32
+
+#define SD_CONN_HANDLE       0
+
+// 1M PHY: preamble, access address, header and CRC around each PDU, and the L2CAP and ATT headers of a notification
+#define SD_LL_OVERHEAD_BYTES 10
+#define SD_L2CAP_ATT_BYTES   7
+#define SD_US_PER_BYTE       8
+#define SD_T_IFS_US          150
+#define SD_EMPTY_PDU_US      80
+
+extern nrf_sdh_ble_evt_observer_t const __start_sdh_ble_observers[] __attribute__((weak));
+extern nrf_sdh_ble_evt_observer_t const __stop_sdh_ble_observers[] __attribute__((weak));
+extern nrf_sdh_soc_evt_observer_t const __start_sdh_soc_observers[] __attribute__((weak));
+extern nrf_sdh_soc_evt_observer_t const __stop_sdh_soc_observers[] __attribute__((weak));
+
+typedef struct
+{
+    uint16_t uuid;
+    uint16_t value_handle;
+    uint16_t cccd_handle;
+    uint16_t cccd;
+} sd_char_t;
+
+static struct
+{
+    bool       enabled;
+    bool       advertising;
+    bool       connected;
+    bool       mtu_exchange_pending;
+    bool       cccd_written;
+    bool       disconnect_pending;
+    uint8_t    disconnect_reason;
+    uint32_t   generation;              // Drops the scheduled events of an earlier advertising set or connection
+    uint16_t   att_mtu;
+    uint64_t   connected_at;
+
+    ble_evt_t  ble_evt[SD_BLE_EVT_QUEUE];
+    uint32_t   ble_evt_head;
+    uint32_t   ble_evt_count;
+    uint32_t   soc_evt[SD_SOC_EVT_QUEUE];
+    uint32_t   soc_evt_head;
+    uint32_t   soc_evt_count;
+
+    sd_char_t  chars[SD_CHAR_MAX];
+    uint32_t   char_count;
+    uint16_t   next_handle;
+
+    uint16_t   hvn_len[SD_HVN_QUEUE_MAX];
+    uint32_t   hvn_head;
+    uint32_t   hvn_count;
+
+    char *     p_nus_rx;                // Remaining writes of HOST_SIM_NUS_RX
+    FILE *     p_nus_dump;
+    uint64_t   nus_rx_time;
+
+    // Settings
+    double     connect_ms;
+    double     disconnect_s;
+    uint32_t   interval_us;
+    uint16_t   central_mtu;
+    uint32_t   hvn_queue_size;
+    double     nus_rx_ms;
+    double     nus_rx_interval_ms;
+
+    // Statistics
+    uint64_t   connections;
+    uint64_t   conn_events;
+    uint64_t   notifications;
+    uint64_t   notification_bytes;
+    uint64_t   hvx_resources;
+    uint32_t   per_event_max;
+    uint64_t   connected_ns;
+} m_sd;
+
+
+/* Event dispatch */
+
+static void sd_evt_irq_handler(void)
+{
+    while (m_sd.soc_evt_count > 0)
+    {
+        uint32_t evt_id = m_sd.soc_evt[m_sd.soc_evt_head];
+        m_sd.soc_evt_head = (m_sd.soc_evt_head + 1) % SD_SOC_EVT_QUEUE;
+        m_sd.soc_evt_count--;
+
+        for (uint8_t prio = 0; prio < NRF_SDH_SOC_OBSERVER_PRIO_LEVELS; prio++)
+        {
+            for (nrf_sdh_soc_evt_observer_t const * p_obs = __start_sdh_soc_observers;
+                 p_obs < __stop_sdh_soc_observers; p_obs++)
+            {
+                if (p_obs->prio == prio)
+                {
+                    p_obs->handler(evt_id, p_obs->p_context);
+                }
+            }
+        }
+    }
+
+    while (m_sd.ble_evt_count > 0)
+    {
+        // Copied out, the observers may queue new events
+        ble_evt_t evt = m_sd.ble_evt[m_sd.ble_evt_head];
+        m_sd.ble_evt_head = (m_sd.ble_evt_head + 1) % SD_BLE_EVT_QUEUE;
+        m_sd.ble_evt_count--;
+
+        for (uint8_t prio = 0; prio < NRF_SDH_BLE_OBSERVER_PRIO_LEVELS; prio++)
+        {
+            for (nrf_sdh_ble_evt_observer_t const * p_obs = __start_sdh_ble_observers;
+                 p_obs < __stop_sdh_ble_observers; p_obs++)
+            {
+                if (p_obs->prio == prio)
+                {
+                    p_obs->handler(&evt, p_obs->p_context);
+                }
+            }
+        }
+    }
+}
+
+
+void sim_sd_ble_evt_put(ble_evt_t const * p_evt)
+{
+    if (m_sd.ble_evt_count == SD_BLE_EVT_QUEUE)
+    {
+        fprintf(stderr, "host sim: SoftDevice event queue overflow, the SD_EVT interrupt is blocked\n");
+        exit(EXIT_FAILURE);
+    }
+    m_sd.ble_evt[(m_sd.ble_evt_head + m_sd.ble_evt_count) % SD_BLE_EVT_QUEUE] = *p_evt;
+    m_sd.ble_evt_count++;
+    sim_irq_pend(SD_EVT_IRQn);
+}
+
+
+void sim_sd_soc_evt_put(uint32_t evt_id)
+{
+    if (m_sd.soc_evt_count == SD_SOC_EVT_QUEUE)
+    {
+        fprintf(stderr, "host sim: SoftDevice SoC event queue overflow\n");
+        exit(EXIT_FAILURE);
+    }
+    m_sd.soc_evt[(m_sd.soc_evt_head + m_sd.soc_evt_count) % SD_SOC_EVT_QUEUE] = evt_id;
+    m_sd.soc_evt_count++;
+    sim_irq_pend(SD_EVT_IRQn);
+}
+
+
+static void sd_evt_put(uint16_t evt_id, ble_evt_t * p_evt)
+{
+    p_evt->header.evt_id  = evt_id;
+    p_evt->header.evt_len = sizeof(*p_evt);
+    sim_sd_ble_evt_put(p_evt);
+}
+
+
+/* GATT table */
+
+void sim_sd_char_add(uint16_t uuid, bool cccd, ble_gatts_char_handles_t * p_handles)
+{
+    if (m_sd.char_count == SD_CHAR_MAX)
+    {
+        fprintf(stderr, "host sim: GATT table full\n");
+        exit(EXIT_FAILURE);
+    }
+    if (m_sd.next_handle == 0)
+    {
+        m_sd.next_handle = SD_HANDLE_FIRST;
+    }
+
+    sd_char_t * p_char = &m_sd.chars[m_sd.char_count++];
+    memset(p_char, 0, sizeof(*p_char));
+    memset(p_handles, 0, sizeof(*p_handles));
+
+    m_sd.next_handle++;                                 // Characteristic declaration
+    p_char->uuid         = uuid;
+    p_char->value_handle = m_sd.next_handle++;
+    if (cccd)
+    {
+        p_char->cccd_handle = m_sd.next_handle++;
+    }
+    p_handles->value_handle = p_char->value_handle;
+    p_handles->cccd_handle  = p_char->cccd_handle;
+}
+
+
+static sd_char_t * sd_char_find(uint16_t handle)
+{
+    for (uint32_t i = 0; i < m_sd.char_count; i++)
+    {
+        if (m_sd.chars[i].value_handle == handle)
+        {
+            return &m_sd.chars[i];
+        }
+    }
+    return NULL;
+}
+
+
+static void sd_central_write(uint16_t handle, uint8_t const * p_data, uint16_t len)
+{
+    ble_evt_t evt;
+
+    memset(&evt, 0, sizeof(evt));
+    evt.evt.gatts_evt.conn_handle  = SD_CONN_HANDLE;
+    evt.evt.gatts_evt.params.write.handle = handle;
+    evt.evt.gatts_evt.params.write.len    = MIN(len, (uint16_t)(m_sd.att_mtu - 3));
+    memcpy(evt.evt.gatts_evt.params.write.data, p_data, evt.evt.gatts_evt.params.write.len);
+    sd_evt_put(BLE_GATTS_EVT_WRITE, &evt);
+}
+
+
+/* Link */
+
+static void sd_conn_event(uint32_t generation);
+
+
+static void sd_disconnected(uint8_t reason)
+{
+    ble_evt_t evt;
+
+    m_sd.connected     = false;
+    m_sd.connected_ns += sim_now() - m_sd.connected_at;
+    m_sd.hvn_count     = 0;
+    m_sd.generation++;
+    for (uint32_t i = 0; i < m_sd.char_count; i++)
+    {
+        m_sd.chars[i].cccd = 0;
+    }
+
+    memset(&evt, 0, sizeof(evt));
+    evt.evt.gap_evt.conn_handle                = SD_CONN_HANDLE;
+    evt.evt.gap_evt.params.disconnected.reason = reason;
+    sd_evt_put(BLE_GAP_EVT_DISCONNECTED, &evt);
+}
+
+
+static void sd_connect(uint32_t generation)
+{
+    ble_evt_t evt;
+
+    if (generation != m_sd.generation || !m_sd.advertising)
+    {
+        return;
+    }
+
+    m_sd.advertising          = false;
+    m_sd.connected            = true;
+    m_sd.connected_at         = sim_now();
+    m_sd.att_mtu              = BLE_GATT_ATT_MTU_DEFAULT;
+    m_sd.mtu_exchange_pending = false;
+    m_sd.cccd_written         = false;
+    m_sd.disconnect_pending   = false;
+    m_sd.hvn_count            = 0;
+    m_sd.generation++;
+    m_sd.connections++;
+
+    free(m_sd.p_nus_rx);
+    m_sd.p_nus_rx    = (sim_env_string("HOST_SIM_NUS_RX") != NULL) ? strdup(sim_env_string("HOST_SIM_NUS_RX")) : NULL;
+    m_sd.nus_rx_time = sim_now() + (uint64_t)(m_sd.nus_rx_ms * 1e6);
+
+    memset(&evt, 0, sizeof(evt));
+    evt.evt.gap_evt.conn_handle                                  = SD_CONN_HANDLE;
+    evt.evt.gap_evt.params.connected.conn_params.min_conn_interval = (uint16_t)(m_sd.interval_us / 1250);
+    evt.evt.gap_evt.params.connected.conn_params.max_conn_interval = (uint16_t)(m_sd.interval_us / 1250);
+    evt.evt.gap_evt.params.connected.conn_params.conn_sup_timeout  = 400;
+    sd_evt_put(BLE_GAP_EVT_CONNECTED, &evt);
+
+    sim_schedule(sim_now() + m_sd.interval_us * 1000ULL, sd_conn_event, m_sd.generation);
+}
+
+
+static void sd_adv_timeout(uint32_t generation)
+{
+    ble_evt_t evt;
+
+    if (generation != m_sd.generation || !m_sd.advertising)
+    {
+        return;
+    }
+    m_sd.advertising = false;
+
+    memset(&evt, 0, sizeof(evt));
+    evt.evt.gap_evt.conn_handle                      = BLE_CONN_HANDLE_INVALID;
+    evt.evt.gap_evt.params.adv_set_terminated.reason = BLE_GAP_EVT_ADV_SET_TERMINATED_REASON_TIMEOUT;
+    sd_evt_put(BLE_GAP_EVT_ADV_SET_TERMINATED, &evt);
+}
+
+
+// Airtime of one notification and its empty acknowledgement
+static uint32_t sd_notification_us(uint16_t len)
+{
+    return (len + SD_L2CAP_ATT_BYTES + SD_LL_OVERHEAD_BYTES) * SD_US_PER_BYTE + SD_T_IFS_US + SD_EMPTY_PDU_US +
+           SD_T_IFS_US;
+}
+
+
+// Sends the next HOST_SIM_NUS_RX write, up to the next '|'
+static void sd_nus_rx_write(void)
+{
+    sd_char_t * p_rx = NULL;
+
+    for (uint32_t i = 0; i < m_sd.char_count; i++)
+    {
+        if (m_sd.chars[i].uuid == BLE_UUID_NUS_RX_CHARACTERISTIC)
+        {
+            p_rx = &m_sd.chars[i];
+        }
+    }
+    if (p_rx == NULL)
+    {
+        return;
+    }
+
+    char * p_next = strchr(m_sd.p_nus_rx, '|');
+    if (p_next != NULL)
+    {
+        *p_next++ = '\0';
+    }
+    sd_central_write(p_rx->value_handle, (uint8_t const *)m_sd.p_nus_rx, (uint16_t)strlen(m_sd.p_nus_rx));
+
+    if (p_next != NULL && *p_next != '\0')
+    {
+        memmove(m_sd.p_nus_rx, p_next, strlen(p_next) + 1);
+        m_sd.nus_rx_time += (uint64_t)(m_sd.nus_rx_interval_ms * 1e6);
+    }
+    else
+    {
+        free(m_sd.p_nus_rx);
+        m_sd.p_nus_rx = NULL;
+    }
+}
+
+
+static void sd_conn_event(uint32_t generation)
+{
+    ble_evt_t evt;
+
+    if (generation != m_sd.generation || !m_sd.connected)
+    {
+        return;
+    }
+    m_sd.conn_events++;
+
+    if (m_sd.disconnect_pending)
+    {
+        sd_disconnected(m_sd.disconnect_reason);
+        return;
+    }
+    if (m_sd.disconnect_s > 0 && sim_now() - m_sd.connected_at >= (uint64_t)(m_sd.disconnect_s * 1e9))
+    {
+        sd_disconnected(BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION);
+        return;
+    }
+
+    // Central requests, one per connection event
+    if (m_sd.mtu_exchange_pending)
+    {
+        m_sd.mtu_exchange_pending = false;
+        memset(&evt, 0, sizeof(evt));
+        evt.evt.gattc_evt.conn_handle                    = SD_CONN_HANDLE;
+        evt.evt.gattc_evt.params.exchange_mtu_rsp.server_rx_mtu = m_sd.central_mtu;
+        sd_evt_put(BLE_GATTC_EVT_EXCHANGE_MTU_RSP, &evt);
+    }
+    else if (!m_sd.cccd_written)
+    {
+        uint8_t const enable[2] = { BLE_GATT_HVX_NOTIFICATION, 0 };
+
+        m_sd.cccd_written = true;
+        for (uint32_t i = 0; i < m_sd.char_count; i++)
+        {
+            if (m_sd.chars[i].cccd_handle != 0)
+            {
+                m_sd.chars[i].cccd = BLE_GATT_HVX_NOTIFICATION;
+                sd_central_write(m_sd.chars[i].cccd_handle, enable, sizeof(enable));
+            }
+        }
+    }
+    else if (m_sd.p_nus_rx != NULL && sim_now() >= m_sd.nus_rx_time)
+    {
+        sd_nus_rx_write();
+    }
+
+    // Notifications, as many as fit in the event length
+    uint32_t budget_us = MIN(NRF_SDH_BLE_GAP_EVENT_LENGTH * 1250UL, m_sd.interval_us);
+    uint32_t used_us   = 0;
+    uint8_t  sent      = 0;
+    while (m_sd.hvn_count > 0)
+    {
+        uint16_t len = m_sd.hvn_len[m_sd.hvn_head];
+        uint32_t us  = sd_notification_us(len);
+        if (sent > 0 && used_us + us > budget_us)
+        {
+            break;
+        }
+        used_us += us;
+        sent++;
+        m_sd.notification_bytes += len;
+        m_sd.hvn_head = (m_sd.hvn_head + 1) % SD_HVN_QUEUE_MAX;
+        m_sd.hvn_count--;
+    }
+    if (sent > 0)
+    {
+        m_sd.notifications += sent;
+        m_sd.per_event_max  = MAX(m_sd.per_event_max, sent);
+
+        memset(&evt, 0, sizeof(evt));
+        evt.evt.gatts_evt.conn_handle                  = SD_CONN_HANDLE;
+        evt.evt.gatts_evt.params.hvn_tx_complete.count = sent;
+        sd_evt_put(BLE_GATTS_EVT_HVN_TX_COMPLETE, &evt);
+    }
+
+    sim_schedule(sim_now() + m_sd.interval_us * 1000ULL, sd_conn_event, generation);
+}
+
+
+uint32_t sim_sd_adv_start(uint32_t timeout_ms)
+{
+    if (!m_sd.enabled)
+    {
+        return NRF_ERROR_SOFTDEVICE_NOT_ENABLED;
+    }
+    if (m_sd.advertising || m_sd.connected)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    m_sd.advertising = true;
+    m_sd.generation++;
+    if (m_sd.connect_ms >= 0)
+    {
+        sim_schedule(sim_now() + (uint64_t)(m_sd.connect_ms * 1e6), sd_connect, m_sd.generation);
+    }
+    if (timeout_ms > 0)
+    {
+        sim_schedule(sim_now() + timeout_ms * 1000000ULL, sd_adv_timeout, m_sd.generation);
+    }
+    return NRF_SUCCESS;
+}
+
+
+/* SoftDevice API */
+
+uint32_t sd_ble_gap_device_name_set(ble_gap_conn_sec_mode_t const * p_write_perm,
+                                    uint8_t const *                 p_dev_name,
+                                    uint16_t                        len)
+{
+    (void)p_write_perm;
+    (void)len;
+    return (p_dev_name == NULL) ? NRF_ERROR_INVALID_ADDR : NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gap_ppcp_set(ble_gap_conn_params_t const * p_conn_params)
+{
+    return (p_conn_params == NULL) ? NRF_ERROR_INVALID_ADDR : NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gap_disconnect(uint16_t conn_handle, uint8_t hci_status_code)
+{
+    if (!m_sd.connected || conn_handle != SD_CONN_HANDLE || m_sd.disconnect_pending)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_sd.disconnect_pending = true;
+    m_sd.disconnect_reason  = hci_status_code;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gap_phy_update(uint16_t conn_handle, ble_gap_phys_t const * p_gap_phys)
+{
+    (void)p_gap_phys;
+    return (m_sd.connected && conn_handle == SD_CONN_HANDLE) ? NRF_SUCCESS : NRF_ERROR_INVALID_STATE;
+}
+
+
+uint32_t sd_ble_gap_sec_params_reply(uint16_t     conn_handle,
+                                     uint8_t      sec_status,
+                                     void const * p_sec_params,
+                                     void const * p_sec_keyset)
+{
+    (void)sec_status;
+    (void)p_sec_params;
+    (void)p_sec_keyset;
+    return (m_sd.connected && conn_handle == SD_CONN_HANDLE) ? NRF_SUCCESS : NRF_ERROR_INVALID_STATE;
+}
+
+
+uint32_t sd_ble_gatts_sys_attr_set(uint16_t conn_handle, uint8_t const * p_sys_attr_data, uint16_t len, uint32_t flags)
+{
+    (void)p_sys_attr_data;
+    (void)len;
+    (void)flags;
+    return (m_sd.connected && conn_handle == SD_CONN_HANDLE) ? NRF_SUCCESS : NRF_ERROR_INVALID_STATE;
+}
+
+
+uint32_t sd_ble_gatts_hvx(uint16_t conn_handle, ble_gatts_hvx_params_t const * p_hvx_params)
+{
+    if (p_hvx_params == NULL || p_hvx_params->p_len == NULL)
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+    if (!m_sd.connected || conn_handle != SD_CONN_HANDLE)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    sd_char_t const * p_char = sd_char_find(p_hvx_params->handle);
+    if (p_char == NULL || p_char->cccd_handle == 0 || p_hvx_params->type != BLE_GATT_HVX_NOTIFICATION)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if ((p_char->cccd & BLE_GATT_HVX_NOTIFICATION) == 0)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (*p_hvx_params->p_len > m_sd.att_mtu - OPCODE_LENGTH - HANDLE_LENGTH)
+    {
+        return NRF_ERROR_DATA_SIZE;
+    }
+    if (m_sd.hvn_count >= m_sd.hvn_queue_size)
+    {
+        m_sd.hvx_resources++;
+        return NRF_ERROR_RESOURCES;
+    }
+
+    m_sd.hvn_len[(m_sd.hvn_head + m_sd.hvn_count) % SD_HVN_QUEUE_MAX] = *p_hvx_params->p_len;
+    m_sd.hvn_count++;
+    if (m_sd.p_nus_dump != NULL)
+    {
+        for (uint16_t i = 0; i < *p_hvx_params->p_len; i++)
+        {
+            fprintf(m_sd.p_nus_dump, "%02X", p_hvx_params->p_data[i]);
+        }
+        fputc('\n', m_sd.p_nus_dump);
+    }
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gatts_exchange_mtu_reply(uint16_t conn_handle, uint16_t server_rx_mtu)
+{
+    if (!m_sd.connected || conn_handle != SD_CONN_HANDLE)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_sd.att_mtu = MAX(BLE_GATT_ATT_MTU_DEFAULT, MIN(server_rx_mtu, m_sd.central_mtu));
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_gattc_exchange_mtu_request(uint16_t conn_handle, uint16_t client_rx_mtu)
+{
+    if (!m_sd.connected || conn_handle != SD_CONN_HANDLE)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (client_rx_mtu < BLE_GATT_ATT_MTU_DEFAULT || client_rx_mtu > NRF_SDH_BLE_GATT_MAX_MTU_SIZE)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    m_sd.att_mtu              = MAX(BLE_GATT_ATT_MTU_DEFAULT, MIN(client_rx_mtu, m_sd.central_mtu));
+    m_sd.mtu_exchange_pending = true;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_ble_uuid_vs_add(ble_uuid128_t const * p_vs_uuid, uint8_t * p_uuid_type)
+{
+    (void)p_vs_uuid;
+    *p_uuid_type = BLE_UUID_TYPE_VENDOR_BEGIN;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t sd_power_system_off(void)
+{
+    sim_finish("system OFF");
+    return NRF_SUCCESS;
+}
+
+
+/* SoftDevice handler */
+
+static void sd_report(FILE * p_out, double seconds)
+{
+    double connected_s = (double)(m_sd.connected_ns + (m_sd.connected ? sim_now() - m_sd.connected_at : 0)) / 1e9;
+
+    (void)seconds;
+    fprintf(p_out, "BLE: %llu connections, %.3f s connected, ATT MTU %u, interval %.2f ms, %llu connection events\n",
+            (unsigned long long)m_sd.connections, connected_s, m_sd.att_mtu, m_sd.interval_us / 1000.0,
+            (unsigned long long)m_sd.conn_events);
+    fprintf(p_out, "BLE: %llu notifications, %llu bytes, %.0f bytes/s connected, max %u per connection event, "
+                   "HVN queue full %llu times\n",
+            (unsigned long long)m_sd.notifications, (unsigned long long)m_sd.notification_bytes,
+            (connected_s > 0) ? (double)m_sd.notification_bytes / connected_s : 0.0,
+            m_sd.per_event_max, (unsigned long long)m_sd.hvx_resources);
+}
+
+
+ret_code_t nrf_sdh_enable_request(void)
+{
+    if (m_sd.enabled)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    m_sd.connect_ms         = sim_env_double("HOST_SIM_BLE_CONNECT_MS", 500.0);
+    m_sd.disconnect_s       = sim_env_double("HOST_SIM_BLE_DISCONNECT_S", 0.0);
+    m_sd.interval_us        = (uint32_t)(sim_env_double("HOST_SIM_BLE_CONN_INTERVAL_MS", 30.0) * 1000.0);
+    m_sd.central_mtu        = (uint16_t)sim_env_double("HOST_SIM_BLE_MTU", 247.0);
+    m_sd.hvn_queue_size     = (uint32_t)sim_env_double("HOST_SIM_BLE_HVN_QUEUE", 4.0);
+    m_sd.nus_rx_ms          = sim_env_double("HOST_SIM_NUS_RX_MS", 1000.0);
+    m_sd.nus_rx_interval_ms = sim_env_double("HOST_SIM_NUS_RX_INTERVAL_MS", 1000.0);
+    m_sd.interval_us        = MAX(m_sd.interval_us, 7500U);
+    m_sd.central_mtu        = MAX(m_sd.central_mtu, BLE_GATT_ATT_MTU_DEFAULT);
+    m_sd.hvn_queue_size     = MIN(MAX(m_sd.hvn_queue_size, 1U), SD_HVN_QUEUE_MAX);
+    m_sd.att_mtu            = BLE_GATT_ATT_MTU_DEFAULT;
+    if (sim_env_string("HOST_SIM_NUS_DUMP") != NULL)
+    {
+        m_sd.p_nus_dump = fopen(sim_env_string("HOST_SIM_NUS_DUMP"), "w");
+        if (m_sd.p_nus_dump == NULL)
+        {
+            fprintf(stderr, "host sim: cannot write %s\n", sim_env_string("HOST_SIM_NUS_DUMP"));
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    sim_irq_connect(SD_EVT_IRQn, "SD_EVT", sd_evt_irq_handler);
+    sim_report_register(sd_report);
+    m_sd.enabled = true;
+    return NRF_SUCCESS;
+}
+
+
+bool nrf_sdh_is_enabled(void)
+{
+    return m_sd.enabled;
+}
+
+
+ret_code_t nrf_sdh_ble_default_cfg_set(uint8_t conn_cfg_tag, uint32_t * p_ram_start)
+{
+    (void)conn_cfg_tag;
+    if (!m_sd.enabled)
+    {
+        return NRF_ERROR_SOFTDEVICE_NOT_ENABLED;
+    }
+    *p_ram_start = 0x20002AE8;                          // Application RAM start of S132 v6 with this configuration
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t nrf_sdh_ble_enable(uint32_t * p_app_ram_start)
+{
+    (void)p_app_ram_start;
+    return m_sd.enabled ? NRF_SUCCESS : NRF_ERROR_SOFTDEVICE_NOT_ENABLED;
+}
@@ -0,0 +1,142 @@
+/**
+ * Host test: the fixed-point spectrum of nrfx_saadc_continuous_sampling/spectrum.h against a double precision DFT.
+ *
+ * For each block size and resolution, a test signal of two tones, one on a bin and one between two bins, is analyzed
+ * with spectrum_analyze(). Every bin is compared with the DFT of the same mean-free, Hann windowed signal in double
+ * precision, scaled like spectrum_split(), and the two strongest peaks must be found at the tones. The host time per
+ * block is measured over many repetitions. Exits with an error if a bin is more than SPECTRUM_TEST_ERROR_MAX off.
+ */
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "spectrum.h"
+
+#define SPECTRUM_TEST_ERROR_MAX     1           // Largest accepted error of a bin, Q15
+#define SPECTRUM_TEST_SAMPLES       (1 << 22)   // Samples analyzed for the timing of each block size
+
+static int16_t m_signal[SPECTRUM_SIZE_MAX];
+static int32_t m_work[SPECTRUM_SIZE_MAX];
+static double  m_windowed[SPECTRUM_SIZE_MAX];
+static double  m_cos[SPECTRUM_SIZE_MAX];
+static double  m_sin[SPECTRUM_SIZE_MAX];
+
+
+static double seconds_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+
+// DC at half scale, a tone of 0.3 full scale on bin size / 16 and one of 0.02 full scale between two bins
+static void signal_make(uint32_t size, uint32_t bits, double * p_tone_bins)
+{
+    double full_scale = (double)(1 << bits);
+
+    p_tone_bins[0] = size / 16;
+    p_tone_bins[1] = size / 5 + 0.5;
+    for (uint32_t n = 0; n < size; n++)
+    {
+        double phase = 2.0 * M_PI * n / size;
+        m_signal[n] = (int16_t)lround(full_scale * (0.5 + 0.3 * sin(phase * p_tone_bins[0])
+                                                        + 0.02 * sin(phase * p_tone_bins[1])));
+    }
+}
+
+
+// Magnitude of bin k of the DFT, Q15 like spectrum_analyze(). The same integer mean is removed
+static int32_t reference_bin(uint32_t size, uint32_t k)
+{
+    double re = 0.0;
+    double im = 0.0;
+
+    for (uint32_t n = 0; n < size; n++)
+    {
+        uint32_t i = (uint32_t)(((uint64_t)k * n) % size);
+        re += m_windowed[n] * m_cos[i];
+        im -= m_windowed[n] * m_sin[i];
+    }
+    return (int32_t)lround(sqrt(re * re + im * im) * 2.0 / size * 32768.0);
+}
+
+
+static bool spectrum_test(uint32_t size, uint32_t bits)
+{
+    double  tone_bins[2];
+    int32_t sum = 0;
+
+    signal_make(size, bits, tone_bins);
+    for (uint32_t n = 0; n < size; n++)
+    {
+        sum     += m_signal[n];
+        m_cos[n] = cos(2.0 * M_PI * n / size);
+        m_sin[n] = sin(2.0 * M_PI * n / size);
+    }
+    int32_t mean = sum / (int32_t)size;
+    for (uint32_t n = 0; n < size; n++)
+    {
+        m_windowed[n] = (m_signal[n] - mean) / (double)(1 << bits) * 0.5 * (0.5 - 0.5 * m_cos[n]);
+    }
+
+    int32_t const * p_magnitude = spectrum_analyze(m_signal, m_work, size, bits);
+    int32_t         error_max   = 0;
+    uint32_t        error_bin   = 0;
+
+    for (uint32_t k = 0; k <= size / 2; k++)
+    {
+        int32_t error = p_magnitude[k] - reference_bin(size, k);
+        if (abs(error) > abs(error_max))
+        {
+            error_max = error;
+            error_bin = k;
+        }
+    }
+
+    spectrum_peak_t peaks[2];
+    uint32_t        count    = spectrum_peaks_find(p_magnitude, size / 2, 16, peaks, 2);
+    double          peak_0   = (count > 0) ? peaks[0].bin + peaks[0].frac / 256.0 : 0.0;
+    double          peak_1   = (count > 1) ? peaks[1].bin + peaks[1].frac / 256.0 : 0.0;
+    bool            peaks_ok = (count == 2) && (fabs(peak_0 - tone_bins[0]) < 0.5) && (fabs(peak_1 - tone_bins[1]) < 0.5);
+
+    // Host time, the block is analyzed again from the same input every time
+    uint32_t repeats = SPECTRUM_TEST_SAMPLES / size;
+    double   start   = seconds_now();
+    for (uint32_t i = 0; i < repeats; i++)
+    {
+        p_magnitude = spectrum_analyze(m_signal, m_work, size, bits);
+    }
+    double block_us = (seconds_now() - start) * 1e6 / repeats;
+
+    printf("Spectrum %4u samples, %2u bit: max error %d (Q15) at bin %u of %u, peaks at %.2f and %.2f "
+           "(tones at %.2f and %.2f), %.2f us per block on the host\n",
+           size, bits, error_max, error_bin, size / 2 + 1, peak_0, peak_1, tone_bins[0], tone_bins[1], block_us);
+
+    return (abs(error_max) <= SPECTRUM_TEST_ERROR_MAX) && peaks_ok;
+}
+
+
+int main(void)
+{
+    static const uint32_t sizes[] = { 16, 64, 256, 1024 };
+    static const uint32_t bits[]  = { 10, 12, 14 };
+    bool                  ok      = true;
+
+    for (uint32_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        for (uint32_t b = 0; b < sizeof(bits) / sizeof(bits[0]); b++)
+        {
+            ok &= spectrum_test(sizes[s], bits[b]);
+        }
+    }
+
+    if (!ok)
+    {
+        printf("Spectrum test FAILED\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
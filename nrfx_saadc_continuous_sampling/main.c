@@ -45,83 +45,820 @@
  * This example uses the internal timer feature of the SAADC to trigger sampling at a fixed sample rate, 
  * as set by the SAADC_SAMPLE_FREQUENCY define. 
  *
- * Please note that this feature only supports a limited range of sampling frequencies, and for sampling at frequencies
- * below 8kHz it is necessary to use a dedicated timer as shown in some of the other examples. 
+ * The internal timer only supports sample rates from 7.8 kHz to 200 kHz. sample_rate_set() selects the trigger from the
+ * sample rate: the internal timer where it is legal, TIMER1 through PPI below that, and RTC2 through PPI for rates up to
+ * SAADC_RTC_TRIGGER_MAX_FREQUENCY, so the HFCLK can stay off between samples. The rate can be changed while sampling.
  *
  * The example samples on a single input pin, AIN0, which maps to physical pin P0.02 on the nRF52832/nRF52840 ICs.
+ *
+ * Filled buffers are passed from the SAADC event handler to the main loop through a lock-free queue, and are only
+ * given back to the SAADC after the main loop has released them. The pool size is set by SAADC_BUF_COUNT.
  */
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include <nrfx_saadc.h>
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "nrfx_timer.h"
+#include "nrfx_rtc.h"
+#include "nrfx_ppi.h"
 #include "nrf_delay.h"
 #include "nrf_drv_clock.h"
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 #include "nrf_log_default_backends.h"
+#include "saadc_stats.h"
+#include "spectrum.h"
  
 #define SAADC_BUF_SIZE         1024
-#define SAADC_BUF_COUNT        2
-#define SAADC_SAMPLE_FREQUENCY 8000
+#define SAADC_BUF_COUNT        4            // Number of buffers in the pool. Must be a power of two, and at least 2 to keep double buffering
+#define SAADC_SAMPLE_FREQUENCY 8000         // Initial sample rate in Hz, 1 to 200000. Can be changed at runtime with sample_rate_set()
+#define SAADC_RTC_TRIGGER_MAX_FREQUENCY 64  // Sample rates up to this are triggered from the RTC, so the HFCLK can stay off between samples
+#define SAADC_BENCHMARK_ENABLED 0           // Set to 1 to report samples/s, dropped buffers and handler time. Keeps the CPU awake, as DWT->CYCCNT is used as time base.
+#define SAADC_BENCHMARK_REPORT_INTERVAL_MS 1000
+#define SAADC_QUEUE_STATS_INTERVAL 64       // Log buffer queue statistics every n processed buffers
+#define SAADC_RESOLUTION       NRF_SAADC_RESOLUTION_10BIT
+#define SAADC_RESOLUTION_BITS  10
+
+#define SAADC_STATS_ENABLED    1            // Set to 1 to log min/max/mean/RMS/variance of the samples instead of individual values
+#define SAADC_STATS_WINDOW     8            // Number of buffers summarized in each statistics log entry
+
+#define DECIMATION_ENABLED     1            // Set to 1 to run the CIC + FIR decimation filter on every buffer in the main loop
+#define DECIMATION_FACTOR      16           // Total decimation, 4 to 64 and even. The CIC decimates by DECIMATION_FACTOR / 2, the FIR by 2
+#define DECIMATION_USE_DSP     1            // Set to 1 to use the Cortex-M4 dual 16-bit MAC (SMLAD) in the FIR, or 0 for the portable C implementation
+
+#define SPECTRUM_ENABLED       1            // Set to 1 to run a fixed-point real FFT on every SPECTRUM_INTERVAL-th buffer in the main loop, and log its peaks
+#define SPECTRUM_INTERVAL      8            // One buffer in n is analyzed and logged
+#define SPECTRUM_PEAKS         3            // Number of peaks logged, strongest first
+#define SPECTRUM_PEAK_MIN      16           // Smallest logged peak magnitude, Q15. 16 is a sine of 2 codes amplitude at 10 bit resolution
+#define SPECTRUM_BANDS         0            // Set to n > 0 to also log the spectrum decimated to n bands, as the largest magnitude in each band
+
+STATIC_ASSERT(SAADC_BUF_COUNT >= 2 && (SAADC_BUF_COUNT & (SAADC_BUF_COUNT - 1)) == 0);
+STATIC_ASSERT(SAADC_STATS_WINDOW * SAADC_BUF_SIZE <= 65536);      // Keeps the int32_t sum of the statistics from overflowing
+// The FIR compensates the sinc^3 droop of a CIC decimating by 2 or more, at DECIMATION_FACTOR 2 the CIC would be a pass-through
+STATIC_ASSERT(DECIMATION_FACTOR >= 4 && DECIMATION_FACTOR <= 64 && (DECIMATION_FACTOR % 2) == 0);
+STATIC_ASSERT(SAADC_BUF_SIZE >= 16 && (SAADC_BUF_SIZE & (SAADC_BUF_SIZE - 1)) == 0);   // The FFT size is SAADC_BUF_SIZE
+STATIC_ASSERT(!SPECTRUM_ENABLED || SAADC_BUF_SIZE <= SPECTRUM_SIZE_MAX);
+STATIC_ASSERT(SPECTRUM_BANDS == 0 || ((SAADC_BUF_SIZE / 2) % SPECTRUM_BANDS) == 0);
 
 static nrf_saadc_value_t samples[SAADC_BUF_COUNT][SAADC_BUF_SIZE];
+static nrf_saadc_value_t scratch[SAADC_BUF_SIZE];   // Given to the SAADC when no buffer has been released by the main loop. Its content is discarded.
 static nrfx_saadc_channel_t channel_config = NRFX_SAADC_DEFAULT_CHANNEL_SE(NRF_SAADC_INPUT_AIN0, 0);
 
+// Source of the SAMPLE task, selected by sample_rate_set() from the sample rate
+typedef enum
+{
+    SAMPLE_TRIGGER_NONE,
+    SAMPLE_TRIGGER_INTERNAL,                // SAADC internal timer, 16 MHz / 80..2047, i.e. 7.8 kHz to 200 kHz
+    SAMPLE_TRIGGER_TIMER,                   // TIMER1 COMPARE0 -> SAMPLE through PPI, for rates below the internal timer range
+    SAMPLE_TRIGGER_RTC,                     // RTC2 COMPARE0 -> SAMPLE and RTC2 CLEAR through PPI, for rates up to SAADC_RTC_TRIGGER_MAX_FREQUENCY
+} sample_trigger_t;
+
+#define SAADC_INTERNAL_TIMER_CC_MIN 80
+#define SAADC_INTERNAL_TIMER_CC_MAX 2047
+
+static const nrfx_timer_t m_sample_timer = NRFX_TIMER_INSTANCE(1);
+static const nrfx_rtc_t   m_sample_rtc   = NRFX_RTC_INSTANCE(2);
+static nrf_ppi_channel_t  m_sample_ppi_channel;
+static sample_trigger_t   m_sample_trigger = SAMPLE_TRIGGER_NONE;
+static uint32_t           m_sample_frequency;
+
+#if SAADC_BENCHMARK_ENABLED
+typedef struct
+{
+    bool     running;               // Set after the first DONE event, enables gap detection
+    uint32_t done_count;            // Number of NRFX_SAADC_EVT_DONE events since last report
+    uint32_t sample_count;          // Number of samples delivered since last report
+    uint32_t dropped_buffers;       // Total number of buffer periods without a DONE event
+    uint32_t handler_cycles_max;    // Longest time spent in event_handler since last report
+    uint32_t handler_cycles_sum;    // Total time spent in event_handler since last report
+    uint32_t last_done_cycles;      // Timestamp of the previous DONE event
+} saadc_benchmark_t;
+
+static saadc_benchmark_t m_benchmark;
+
+// Expected time between two DONE events in CPU cycles, rounded. The triggers divide their clock by an integer, so the
+// sample period is taken from the divider in Q.8 cycles instead of from m_sample_frequency, which it only approximates
+static uint32_t benchmark_buf_period_cycles(void)
+{
+    uint64_t sample_period_q8;
+
+    if (m_sample_trigger == SAMPLE_TRIGGER_RTC)
+    {
+        sample_period_q8 = ((uint64_t)ROUNDED_DIV(32768, m_sample_frequency) * SystemCoreClock << 8) / 32768;
+    }
+    else
+    {
+        sample_period_q8 = ((uint64_t)(16000000 / m_sample_frequency) * SystemCoreClock << 8) / 16000000;
+    }
+    return (uint32_t)((sample_period_q8 * SAADC_BUF_SIZE + (1 << 7)) >> 8);
+}
+
+
+// Called on every DONE event. A gap of more than 1.5 buffer periods since the previous DONE means buffers were lost
+static void benchmark_done(uint32_t start_cycles, uint32_t size)
+{
+    if (m_benchmark.running)
+    {
+        uint32_t period   = benchmark_buf_period_cycles();
+        uint32_t interval = start_cycles - m_benchmark.last_done_cycles;
+        if (interval > period + period / 2)
+        {
+            m_benchmark.dropped_buffers += (interval + period / 2) / period - 1;
+        }
+    }
+    m_benchmark.running = true;
+    m_benchmark.last_done_cycles = start_cycles;
+    m_benchmark.done_count++;
+    m_benchmark.sample_count += size;
+}
+
+
+static void benchmark_handler_exit(uint32_t start_cycles)
+{
+    uint32_t cycles = DWT->CYCCNT - start_cycles;
+    m_benchmark.handler_cycles_sum += cycles;
+    if (cycles > m_benchmark.handler_cycles_max)
+    {
+        m_benchmark.handler_cycles_max = cycles;
+    }
+}
+
+
+// Called from main context. Prints a summary every SAADC_BENCHMARK_REPORT_INTERVAL_MS and restarts the measurement
+static void benchmark_report(void)
+{
+    static uint32_t last_report_cycles;
+    uint32_t now = DWT->CYCCNT;
+    uint32_t elapsed = now - last_report_cycles;
+
+    if (elapsed < (SystemCoreClock / 1000) * SAADC_BENCHMARK_REPORT_INTERVAL_MS)
+    {
+        return;
+    }
+    last_report_cycles = now;
+
+    saadc_benchmark_t snapshot;
+    CRITICAL_REGION_ENTER();
+    snapshot = m_benchmark;
+    m_benchmark.done_count         = 0;
+    m_benchmark.sample_count       = 0;
+    m_benchmark.handler_cycles_max = 0;
+    m_benchmark.handler_cycles_sum = 0;
+    CRITICAL_REGION_EXIT();
+
+    uint32_t cycles_per_us = SystemCoreClock / 1000000;
+    NRF_LOG_INFO("Samples/s: %u, dropped buffers: %u, handler time max/avg: %u/%u us",
+                 (uint32_t)(((uint64_t)snapshot.sample_count * SystemCoreClock) / elapsed),
+                 snapshot.dropped_buffers,
+                 snapshot.handler_cycles_max / cycles_per_us,
+                 (snapshot.done_count > 0) ? snapshot.handler_cycles_sum / snapshot.done_count / cycles_per_us : 0);
+}
+#endif // SAADC_BENCHMARK_ENABLED
+
+
+// Single-producer/single-consumer queue of buffer indices. One queue passes filled buffers from
+// event_handler to the main loop, the other passes processed buffers back. Each index is written by
+// one context only, so no critical regions are needed.
+typedef struct
+{
+    uint8_t           items[SAADC_BUF_COUNT];
+    volatile uint32_t head;                         // Written by the producer only
+    volatile uint32_t tail;                         // Written by the consumer only
+} buf_queue_t;
+
+typedef struct
+{
+    uint32_t overruns;                              // BUF_REQ events with no released buffer available
+    uint32_t dropped_buffers;                       // Buffers sampled into the scratch buffer and discarded
+    uint32_t high_water;                            // Highest number of filled buffers waiting for the main loop
+    uint32_t latency_max;                           // Longest time from DONE until the main loop picked up the buffer, in CPU cycles
+} buf_queue_stats_t;
+
+static buf_queue_t       m_free_queue;              // Released buffers, main loop -> event_handler
+static buf_queue_t       m_filled_queue;            // Filled buffers, event_handler -> main loop
+static buf_queue_stats_t m_queue_stats;
+static uint32_t          m_done_cycles[SAADC_BUF_COUNT];
+
+
+static void cycle_counter_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+
+static bool buf_queue_put(buf_queue_t * p_queue, uint8_t index)
+{
+    uint32_t head = p_queue->head;
+    if (head - p_queue->tail >= SAADC_BUF_COUNT)
+    {
+        return false;
+    }
+    p_queue->items[head & (SAADC_BUF_COUNT - 1)] = index;
+    __DMB();                                        // Make the item visible before publishing it
+    p_queue->head = head + 1;
+    return true;
+}
+
+
+static bool buf_queue_get(buf_queue_t * p_queue, uint8_t * p_index)
+{
+    uint32_t tail = p_queue->tail;
+    if (p_queue->head == tail)
+    {
+        return false;
+    }
+    __DMB();
+    *p_index = p_queue->items[tail & (SAADC_BUF_COUNT - 1)];
+    __DMB();                                        // Read the item before handing the slot back
+    p_queue->tail = tail + 1;
+    return true;
+}
+
+
+static uint32_t buf_queue_count(buf_queue_t const * p_queue)
+{
+    return p_queue->head - p_queue->tail;
+}
+
+
+// Provides the next buffer released by the main loop. Falls back to the scratch buffer if the main loop
+// has not kept up, so that the SAADC never writes into a buffer that is still being processed.
+static nrf_saadc_value_t * buffer_next_free(void)
+{
+    uint8_t index;
+    if (buf_queue_get(&m_free_queue, &index))
+    {
+        return samples[index];
+    }
+    m_queue_stats.overruns++;
+    return scratch;
+}
+
+
+static void buffer_filled(nrf_saadc_value_t * p_buffer)
+{
+    if (p_buffer == scratch)
+    {
+        m_queue_stats.dropped_buffers++;
+        return;
+    }
+
+    uint8_t index = (p_buffer - &samples[0][0]) / SAADC_BUF_SIZE;
+    m_done_cycles[index] = DWT->CYCCNT;
+
+    // Cannot fail, as the queue has room for every buffer in the pool
+    UNUSED_RETURN_VALUE(buf_queue_put(&m_filled_queue, index));
+
+    uint32_t count = buf_queue_count(&m_filled_queue);
+    if (count > m_queue_stats.high_water)
+    {
+        m_queue_stats.high_water = count;
+    }
+}
+
+
+static void buffer_release(nrf_saadc_value_t * p_buffer)
+{
+    uint8_t index = (p_buffer - &samples[0][0]) / SAADC_BUF_SIZE;
+    UNUSED_RETURN_VALUE(buf_queue_put(&m_free_queue, index));
+}
+
+
+// Returns the oldest filled buffer, or NULL if none is pending. Must be handed back with buffer_release()
+static nrf_saadc_value_t * buffer_get_filled(void)
+{
+    uint8_t index;
+    if (!buf_queue_get(&m_filled_queue, &index))
+    {
+        return NULL;
+    }
+
+    uint32_t latency = DWT->CYCCNT - m_done_cycles[index];
+    if (latency > m_queue_stats.latency_max)
+    {
+        m_queue_stats.latency_max = latency;
+    }
+    return samples[index];
+}
+
+
+static void buffer_pool_init(void)
+{
+    for (uint8_t i = 0; i < SAADC_BUF_COUNT; i++)
+    {
+        UNUSED_RETURN_VALUE(buf_queue_put(&m_free_queue, i));
+    }
+}
+
+
+#if DECIMATION_ENABLED
+// Streaming decimator: a 3rd order CIC filter decimating by R = DECIMATION_FACTOR / 2, followed by a 32 tap
+// FIR filter that compensates the CIC passband droop and decimates by 2. The filter state is kept in
+// decimator_t, so consecutive buffers are filtered as one continuous stream.
+//
+// Output is Q15, where full scale of the SAADC maps to 1.0. The passband is flat (+-0.01 dB) up to 0.18 * fs / R,
+// and components above 0.32 * fs / R are attenuated by more than 75 dB, i.e. no aliasing into the output band.
+#define CIC_ORDER              3            // The FIR compensation coefficients are designed for this order
+#define CIC_DECIMATION         (DECIMATION_FACTOR / 2)
+#define CIC_GAIN               (CIC_DECIMATION * CIC_DECIMATION * CIC_DECIMATION)
+#define CIC_NORM               (((int64_t)1 << (31 + 15 - SAADC_RESOLUTION_BITS)) / CIC_GAIN) // Removes the CIC gain and scales to Q15, Q31 multiplier
+#define FIR_TAPS               32
+
+STATIC_ASSERT(CIC_ORDER == 3);
+
+// Symmetric, Q15, sum is 1.0. Least squares design for 1/sinc^3 in the passband
+static const int16_t m_fir_coeffs[FIR_TAPS] __ALIGN(4) =
+{
+      -14,   -10,    60,    49,  -164,  -149,   364,   364,  -711,  -788,  1289,  1646, -2313, -3795,  4616, 15940,
+    15940,  4616, -3795, -2313,  1646,  1289,  -788,  -711,   364,   364,  -149,  -164,    49,    60,   -10,   -14
+};
+
+typedef struct
+{
+    uint32_t integrators[CIC_ORDER];        // Unsigned, so the modulo 2^32 wrap-around the CIC relies on is well defined
+    uint32_t combs[CIC_ORDER];
+    uint32_t cic_phase;
+    int16_t  fir_delay[2 * FIR_TAPS] __ALIGN(4); // Each sample is written twice, so the last FIR_TAPS samples are always contiguous
+    uint32_t fir_index;
+    bool     use_dsp;
+} decimator_t;
+
+static decimator_t m_decimator = { .use_dsp = DECIMATION_USE_DSP };
+static int16_t     m_decimated[SAADC_BUF_SIZE / DECIMATION_FACTOR + 1];
+
+
+static int16_t q15_saturate(int32_t value)
+{
+    if (value > INT16_MAX)
+    {
+        return INT16_MAX;
+    }
+    if (value < INT16_MIN)
+    {
+        return INT16_MIN;
+    }
+    return (int16_t)value;
+}
+
+
+// Portable reference implementation
+static int32_t fir_dot_c(int16_t const * p_window)
+{
+    int32_t acc = 0;
+    for (uint32_t i = 0; i < FIR_TAPS; i++)
+    {
+        acc += (int32_t)p_window[i] * m_fir_coeffs[i];
+    }
+    return acc;
+}
+
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+// Two multiply-accumulates per SMLAD instruction. p_window must be 4 byte aligned
+static int32_t fir_dot_dsp(int16_t const * p_window)
+{
+    uint32_t const * p_x = (uint32_t const *)p_window;
+    uint32_t const * p_h = (uint32_t const *)m_fir_coeffs;
+    int32_t acc = 0;
+    for (uint32_t i = 0; i < FIR_TAPS / 2; i += 4)
+    {
+        acc = __SMLAD(p_x[i],     p_h[i],     acc);
+        acc = __SMLAD(p_x[i + 1], p_h[i + 1], acc);
+        acc = __SMLAD(p_x[i + 2], p_h[i + 2], acc);
+        acc = __SMLAD(p_x[i + 3], p_h[i + 3], acc);
+    }
+    return acc;
+}
+#endif
+
+
+// Filters size input samples and writes the decimated output to p_out. Returns the number of output samples
+static uint32_t decimator_process(decimator_t * p_dec, nrf_saadc_value_t const * p_in, uint32_t size, int16_t * p_out)
+{
+    uint32_t count = 0;
+
+    for (uint32_t n = 0; n < size; n++)
+    {
+        // Integrators, at the input rate
+        uint32_t value = (uint32_t)(int32_t)p_in[n];
+        for (uint32_t k = 0; k < CIC_ORDER; k++)
+        {
+            p_dec->integrators[k] += value;
+            value = p_dec->integrators[k];
+        }
+
+        if (++p_dec->cic_phase < CIC_DECIMATION)
+        {
+            continue;
+        }
+        p_dec->cic_phase = 0;
+
+        // Combs, at the CIC output rate
+        for (uint32_t k = 0; k < CIC_ORDER; k++)
+        {
+            uint32_t delayed = p_dec->combs[k];
+            p_dec->combs[k]  = value;
+            value           -= delayed;
+        }
+        int16_t cic_out = q15_saturate((int32_t)(((int64_t)(int32_t)value * CIC_NORM) >> 31));
+
+        // FIR, one output for every second CIC output. The output is computed when the window starts on an even index
+        uint32_t i = p_dec->fir_index;
+        p_dec->fir_delay[i]            = cic_out;
+        p_dec->fir_delay[i + FIR_TAPS] = cic_out;
+        p_dec->fir_index = (i + 1) % FIR_TAPS;
 
-// Simple function to provide an index to the next input buffer
-// Will simply alernate between 0 and 1 when SAADC_BUF_COUNT is 2
-static uint32_t next_free_buf_index(void)
+        if ((i & 1) == 0)
+        {
+            continue;
+        }
+
+        int16_t const * p_window = &p_dec->fir_delay[i + 1];
+        int32_t acc;
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+        acc = p_dec->use_dsp ? fir_dot_dsp(p_window) : fir_dot_c(p_window);
+#else
+        acc = fir_dot_c(p_window);
+#endif
+        p_out[count++] = q15_saturate((acc + (1 << 14)) >> 15);
+    }
+
+    return count;
+}
+
+
+#if SAADC_BENCHMARK_ENABLED
+static decimator_t m_decimator_ref;         // Runs the portable implementation on the same input, for comparison
+static int16_t     m_decimated_ref[SAADC_BUF_SIZE / DECIMATION_FACTOR + 1];
+static uint32_t    m_decimator_cycles[2];   // Total cycles spent in the DSP and portable path
+static uint32_t    m_decimator_samples;
+
+
+// Runs the DSP and the portable decimator on the same buffer, and logs the cycles of both every report interval
+static void decimator_benchmark(nrf_saadc_value_t const * p_buffer)
 {
-    static uint32_t buffer_index = -1;
-    buffer_index = (buffer_index + 1) % SAADC_BUF_COUNT;
-    return buffer_index;
+    uint32_t start = DWT->CYCCNT;
+    uint32_t count = decimator_process(&m_decimator, p_buffer, SAADC_BUF_SIZE, m_decimated);
+    m_decimator_cycles[0] += DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    uint32_t count_ref = decimator_process(&m_decimator_ref, p_buffer, SAADC_BUF_SIZE, m_decimated_ref);
+    m_decimator_cycles[1] += DWT->CYCCNT - start;
+
+    // Both paths compute the same integer sums, so the outputs must be identical
+    if ((count != count_ref) || (memcmp(m_decimated, m_decimated_ref, count * sizeof(m_decimated[0])) != 0))
+    {
+        NRF_LOG_ERROR("Decimation: SMLAD and C outputs differ");
+    }
+
+    m_decimator_samples += SAADC_BUF_SIZE;
+    if (m_decimator_samples >= ((uint64_t)m_sample_frequency * SAADC_BENCHMARK_REPORT_INTERVAL_MS) / 1000)
+    {
+        NRF_LOG_INFO("Decimation by %u, cycles per input sample x100: %s %u, C %u",
+                     DECIMATION_FACTOR,
+                     m_decimator.use_dsp ? "SMLAD" : "C",
+                     (uint32_t)(((uint64_t)m_decimator_cycles[0] * 100) / m_decimator_samples),
+                     (uint32_t)(((uint64_t)m_decimator_cycles[1] * 100) / m_decimator_samples));
+        m_decimator_cycles[0] = 0;
+        m_decimator_cycles[1] = 0;
+        m_decimator_samples   = 0;
+    }
+}
+#endif
+#endif // DECIMATION_ENABLED
+
+
+#if SAADC_STATS_ENABLED && !SAADC_BENCHMARK_ENABLED   // The benchmark replaces the statistics log
+SAADC_STATS_WINDOW_DEF(m_stats, 1, SAADC_STATS_WINDOW);
+#endif
+
+
+#if SPECTRUM_ENABLED
+// Spectrum of one buffer of N = SAADC_BUF_SIZE samples, see spectrum.h
+#define SPECTRUM_FFT_SIZE      SAADC_BUF_SIZE
+#define SPECTRUM_BINS          (SPECTRUM_FFT_SIZE / 2)                      // Bins 0 to SPECTRUM_BINS are produced
+
+static int32_t  m_spectrum[SPECTRUM_FFT_SIZE];              // FFT work buffer. Magnitudes after spectrum_analyze()
+static uint32_t m_spectrum_buffers;
+
+
+// Frequency of bin + frac / 256, in 1/100 Hz
+static uint32_t spectrum_frequency_x100(uint32_t bin, int32_t frac)
+{
+    return (uint32_t)((((int64_t)bin * 256 + frac) * m_sample_frequency * 100) / (SPECTRUM_FFT_SIZE * 256));
+}
+
+
+static void spectrum_log(int32_t const * p_magnitude, uint32_t cycles)
+{
+    spectrum_peak_t peaks[SPECTRUM_PEAKS];
+    uint32_t        count = spectrum_peaks_find(p_magnitude, SPECTRUM_BINS, SPECTRUM_PEAK_MIN, peaks, SPECTRUM_PEAKS);
+
+    NRF_LOG_INFO("Spectrum of %u samples, %u bins, %u cycles (%u us):",
+                 SPECTRUM_FFT_SIZE, SPECTRUM_BINS + 1, cycles, cycles / (SystemCoreClock / 1000000));
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t frequency = spectrum_frequency_x100(peaks[i].bin, peaks[i].frac);
+        NRF_LOG_INFO("Peak %u: %u.%02u Hz, magnitude %u (Q15), amplitude %u codes",
+                     i, frequency / 100, frequency % 100, peaks[i].magnitude,
+                     ((uint32_t)peaks[i].magnitude << SAADC_RESOLUTION_BITS) >> 13);
+    }
+
+#if SPECTRUM_BANDS > 0
+    // Decimated spectrum, the largest bin of each band
+    for (uint32_t band = 0; band < SPECTRUM_BANDS; band++)
+    {
+        uint32_t first = band * (SPECTRUM_BINS / SPECTRUM_BANDS);
+        int32_t  max   = 0;
+        for (uint32_t k = first; k < first + SPECTRUM_BINS / SPECTRUM_BANDS; k++)
+        {
+            max = MAX(max, p_magnitude[k]);
+        }
+        NRF_LOG_INFO("Band %u-%u Hz: %u",
+                     spectrum_frequency_x100(first, 0) / 100,
+                     spectrum_frequency_x100(first + SPECTRUM_BINS / SPECTRUM_BANDS, 0) / 100,
+                     max);
+    }
+#endif
+}
+
+
+// Analyzes and logs one buffer in SPECTRUM_INTERVAL
+static void spectrum_buffer(nrf_saadc_value_t const * p_buffer)
+{
+    if (++m_spectrum_buffers < SPECTRUM_INTERVAL)
+    {
+        return;
+    }
+    m_spectrum_buffers = 0;
+
+    uint32_t        start       = DWT->CYCCNT;
+    int32_t const * p_magnitude = spectrum_analyze(p_buffer, m_spectrum, SPECTRUM_FFT_SIZE, SAADC_RESOLUTION_BITS);
+    spectrum_log(p_magnitude, DWT->CYCCNT - start);
+}
+
+
+#endif // SPECTRUM_ENABLED
+
+
+// Processing of a filled buffer in main context
+static void process_buffer(nrf_saadc_value_t const * p_buffer)
+{
+#if DECIMATION_ENABLED && SAADC_BENCHMARK_ENABLED
+    decimator_benchmark(p_buffer);
+#elif DECIMATION_ENABLED && SAADC_STATS_ENABLED
+    uint32_t count = decimator_process(&m_decimator, p_buffer, SAADC_BUF_SIZE, m_decimated);
+    if (saadc_stats_window_add(&m_stats, p_buffer, SAADC_BUF_SIZE))
+    {
+        NRF_LOG_INFO("Decimated by %u: %u samples per buffer, [0] = %i (Q15)", DECIMATION_FACTOR, count, m_decimated[0]);
+    }
+#elif DECIMATION_ENABLED
+    uint32_t count = decimator_process(&m_decimator, p_buffer, SAADC_BUF_SIZE, m_decimated);
+    NRF_LOG_INFO("DONE. Sample[0] = %i, %u decimated samples, [0] = %i (Q15)", p_buffer[0], count, m_decimated[0]);
+#elif SAADC_BENCHMARK_ENABLED
+    UNUSED_PARAMETER(p_buffer);
+#elif SAADC_STATS_ENABLED
+    UNUSED_RETURN_VALUE(saadc_stats_window_add(&m_stats, p_buffer, SAADC_BUF_SIZE));
+#else
+    NRF_LOG_INFO("DONE. Sample[0] = %i", p_buffer[0]);
+#endif
+
+#if SPECTRUM_ENABLED
+    spectrum_buffer(p_buffer);
+#endif
+}
+
+
+static void queue_stats_log(void)
+{
+    static uint32_t processed;
+    if (++processed % SAADC_QUEUE_STATS_INTERVAL == 0)
+    {
+        NRF_LOG_INFO("Buffer queue: overruns %u, dropped %u, high-water %u/%u, max latency %u us",
+                     m_queue_stats.overruns,
+                     m_queue_stats.dropped_buffers,
+                     m_queue_stats.high_water,
+                     SAADC_BUF_COUNT,
+                     m_queue_stats.latency_max / (SystemCoreClock / 1000000));
+    }
 }
  
 
 static void event_handler(nrfx_saadc_evt_t const * p_event)
 {
     ret_code_t err_code;
+#if SAADC_BENCHMARK_ENABLED
+    uint32_t start_cycles = DWT->CYCCNT;
+#endif
+
     switch (p_event->type)
     {
         case NRFX_SAADC_EVT_DONE:
-            NRF_LOG_INFO("DONE. Sample[0] = %i", p_event->data.done.p_buffer[0]);
-
-            // Add code here to process the input
-            // If the processing is time consuming execution should be deferred to the main context
+#if SAADC_BENCHMARK_ENABLED
+            benchmark_done(start_cycles, p_event->data.done.size);
+#endif
+            // Processing is deferred to the main context, the buffer is passed on without copying
+            buffer_filled(p_event->data.done.p_buffer);
             break;
 
         case NRFX_SAADC_EVT_BUF_REQ:
-            // Set up the next available buffer
-            err_code = nrfx_saadc_buffer_set(&samples[next_free_buf_index()][0], SAADC_BUF_SIZE);
+            // Set up the next buffer released by the main loop
+            err_code = nrfx_saadc_buffer_set(buffer_next_free(), SAADC_BUF_SIZE);
+            APP_ERROR_CHECK(err_code);
+            break;
+
+        default:
+            break;
+    }
+
+#if SAADC_BENCHMARK_ENABLED
+    benchmark_handler_exit(start_cycles);
+#endif
+}
+
+
+static void sample_timer_handler(nrf_timer_event_t event_type, void * p_context)
+{
+}
+
+
+static void sample_rtc_handler(nrfx_rtc_int_type_t int_type)
+{
+}
+
+
+// Sets up TIMER1, RTC2 and a PPI channel for the external triggers. They are only started when selected
+static void sample_trigger_init(void)
+{
+    nrfx_err_t err_code;
+
+    // The RTC runs from the LFCLK
+    err_code = nrf_drv_clock_init();
+    APP_ERROR_CHECK(err_code);
+    nrf_drv_clock_lfclk_request(NULL);
+
+    nrfx_timer_config_t timer_config = NRFX_TIMER_DEFAULT_CONFIG;
+    timer_config.frequency = NRF_TIMER_FREQ_16MHz;
+    timer_config.bit_width = NRF_TIMER_BIT_WIDTH_32;
+    err_code = nrfx_timer_init(&m_sample_timer, &timer_config, sample_timer_handler);
+    APP_ERROR_CHECK(err_code);
+
+    nrfx_rtc_config_t rtc_config = NRFX_RTC_DEFAULT_CONFIG;
+    rtc_config.prescaler = 0;
+    err_code = nrfx_rtc_init(&m_sample_rtc, &rtc_config, sample_rtc_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrfx_ppi_channel_alloc(&m_sample_ppi_channel);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+static sample_trigger_t sample_trigger_select(uint32_t frequency)
+{
+    uint32_t cc = 16000000 / frequency;
+
+    if (cc <= SAADC_INTERNAL_TIMER_CC_MAX)
+    {
+        return SAMPLE_TRIGGER_INTERNAL;
+    }
+    if (frequency > SAADC_RTC_TRIGGER_MAX_FREQUENCY)
+    {
+        return SAMPLE_TRIGGER_TIMER;
+    }
+    return SAMPLE_TRIGGER_RTC;
+}
+
+
+static void sample_trigger_stop(void)
+{
+    nrfx_err_t err_code;
+
+    switch (m_sample_trigger)
+    {
+        case SAMPLE_TRIGGER_INTERNAL:
+            nrf_saadc_continuous_mode_disable();
+            break;
+
+        case SAMPLE_TRIGGER_TIMER:
+            err_code = nrfx_ppi_channel_disable(m_sample_ppi_channel);
+            APP_ERROR_CHECK(err_code);
+            nrfx_timer_disable(&m_sample_timer);
+            break;
+
+        case SAMPLE_TRIGGER_RTC:
+            err_code = nrfx_ppi_channel_disable(m_sample_ppi_channel);
             APP_ERROR_CHECK(err_code);
+            nrfx_rtc_disable(&m_sample_rtc);
+            break;
+
+        default:
+            break;
+    }
+    m_sample_trigger = SAMPLE_TRIGGER_NONE;
+}
+
+
+// Sets the sample rate in Hz, and selects the trigger for it. Only the trigger is reconfigured, so this can be called
+// while sampling: the buffers given to the SAADC and the buffer queue are not touched.
+static void sample_rate_set(uint32_t frequency)
+{
+    nrfx_err_t err_code;
+
+    if ((frequency == 0) || (16000000 / frequency < SAADC_INTERNAL_TIMER_CC_MIN))
+    {
+        NRF_LOG_ERROR("Sample rate %u Hz outside legal range.", frequency);
+        APP_ERROR_CHECK(NRFX_ERROR_INVALID_PARAM);
+    }
+
+    sample_trigger_t trigger = sample_trigger_select(frequency);
+    sample_trigger_stop();
+
+    switch (trigger)
+    {
+        case SAMPLE_TRIGGER_INTERNAL:
+            // The internal timer is started by the SAMPLE task, and keeps running across buffers with start_on_end
+            nrf_saadc_continuous_mode_enable(16000000 / frequency);
+            nrf_saadc_task_trigger(NRF_SAADC_TASK_SAMPLE);
+            break;
+
+        case SAMPLE_TRIGGER_TIMER:
+            nrfx_timer_clear(&m_sample_timer);
+            nrfx_timer_extended_compare(&m_sample_timer,
+                                        NRF_TIMER_CC_CHANNEL0,
+                                        16000000 / frequency,
+                                        NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK,
+                                        false);
+            err_code = nrfx_ppi_channel_assign(m_sample_ppi_channel,
+                                               nrfx_timer_event_address_get(&m_sample_timer, NRF_TIMER_EVENT_COMPARE0),
+                                               nrf_saadc_task_address_get(NRF_SAADC_TASK_SAMPLE));
+            APP_ERROR_CHECK(err_code);
+            err_code = nrfx_ppi_channel_fork_assign(m_sample_ppi_channel, 0);
+            APP_ERROR_CHECK(err_code);
+            err_code = nrfx_ppi_channel_enable(m_sample_ppi_channel);
+            APP_ERROR_CHECK(err_code);
+            nrfx_timer_enable(&m_sample_timer);
+            break;
+
+        case SAMPLE_TRIGGER_RTC:
+            // The RTC has no COMPARE -> CLEAR short, the counter is cleared through the PPI fork
+            nrfx_rtc_counter_clear(&m_sample_rtc);
+            err_code = nrfx_rtc_cc_set(&m_sample_rtc, 0, ROUNDED_DIV(32768, frequency), false);
+            APP_ERROR_CHECK(err_code);
+            err_code = nrfx_ppi_channel_assign(m_sample_ppi_channel,
+                                               nrfx_rtc_event_address_get(&m_sample_rtc, NRF_RTC_EVENT_COMPARE_0),
+                                               nrf_saadc_task_address_get(NRF_SAADC_TASK_SAMPLE));
+            APP_ERROR_CHECK(err_code);
+            err_code = nrfx_ppi_channel_fork_assign(m_sample_ppi_channel,
+                                                    nrfx_rtc_task_address_get(&m_sample_rtc, NRF_RTC_TASK_CLEAR));
+            APP_ERROR_CHECK(err_code);
+            err_code = nrfx_ppi_channel_enable(m_sample_ppi_channel);
+            APP_ERROR_CHECK(err_code);
+            nrfx_rtc_enable(&m_sample_rtc);
+            break;
+
+        default:
             break;
     }
+
+    m_sample_trigger   = trigger;
+    m_sample_frequency = frequency;
+    NRF_LOG_INFO("Sample rate %u Hz, trigger: %s", frequency,
+                 (trigger == SAMPLE_TRIGGER_INTERNAL) ? "SAADC internal timer" :
+                 (trigger == SAMPLE_TRIGGER_TIMER)    ? "TIMER + PPI" : "RTC + PPI");
 }
 
 
-static void adc_start(uint32_t cc_value)
+static void adc_start(uint32_t frequency)
 {
     ret_code_t err_code;
 
+    // The SAADC is configured without internal timer. The trigger is selected by sample_rate_set() when sampling has started
     nrfx_saadc_adv_config_t saadc_adv_config = NRFX_SAADC_DEFAULT_ADV_CONFIG;
-    saadc_adv_config.internal_timer_cc = cc_value;
+    saadc_adv_config.internal_timer_cc = 0;
     saadc_adv_config.start_on_end = true;
 
     err_code = nrfx_saadc_advanced_mode_set((1<<0),
-                                            NRF_SAADC_RESOLUTION_10BIT,
+                                            SAADC_RESOLUTION,
                                             &saadc_adv_config,
                                             event_handler);
     APP_ERROR_CHECK(err_code);
                                             
     // Configure two buffers to ensure double buffering of samples, to avoid data loss when the sampling frequency is high
-    err_code = nrfx_saadc_buffer_set(&samples[next_free_buf_index()][0], SAADC_BUF_SIZE);
+    err_code = nrfx_saadc_buffer_set(buffer_next_free(), SAADC_BUF_SIZE);
     APP_ERROR_CHECK(err_code);
 
-    err_code = nrfx_saadc_buffer_set(&samples[next_free_buf_index()][0], SAADC_BUF_SIZE);
+    err_code = nrfx_saadc_buffer_set(buffer_next_free(), SAADC_BUF_SIZE);
     APP_ERROR_CHECK(err_code);
 
     err_code = nrfx_saadc_mode_trigger();
     APP_ERROR_CHECK(err_code);
+
+    sample_rate_set(frequency);
 }
 
 
@@ -135,23 +872,34 @@ int main(void)
     NRF_LOG_DEFAULT_BACKENDS_INIT();
     NRF_LOG_INFO("nrfx_saadc_api2 simple SAADC Continuous Sampling Example.");	
 
+    cycle_counter_init();
+    buffer_pool_init();
+
     err_code = nrfx_saadc_init(NRFX_SAADC_CONFIG_IRQ_PRIORITY);
     APP_ERROR_CHECK(err_code);
  
     err_code = nrfx_saadc_channels_config(&channel_config, 1);
     APP_ERROR_CHECK(err_code);
 
-    uint32_t adc_cc_value = 16000000 / SAADC_SAMPLE_FREQUENCY;
-    if(adc_cc_value < 80 || adc_cc_value > 2047)
-    {
-        NRF_LOG_ERROR("SAMPLERATE frequency outside legal range. Consider using a timer to trigger the ADC instead.");
-        APP_ERROR_CHECK(false);
-    }
-    adc_start(adc_cc_value);
+    sample_trigger_init();
+    adc_start(SAADC_SAMPLE_FREQUENCY);
 
     while (1)
     {
+        nrf_saadc_value_t * p_buffer;
+        while ((p_buffer = buffer_get_filled()) != NULL)
+        {
+            process_buffer(p_buffer);
+            buffer_release(p_buffer);
+            queue_stats_log();
+        }
+
+#if SAADC_BENCHMARK_ENABLED
+        benchmark_report();
+        while(NRF_LOG_PROCESS() != NRF_SUCCESS);
+#else
         while(NRF_LOG_PROCESS() != NRF_SUCCESS);
         __WFE();
+#endif
     }  
 }
@@ -0,0 +1,357 @@
+/**
+ * Copyright (c) 2014 - 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/**
+ * Fixed-point real FFT, magnitude and peak extraction for blocks of SAADC samples.
+ *
+ * spectrum_analyze() transforms a block of N real samples in place in a Q31 work buffer of N words, N a power of two
+ * from 16 to SPECTRUM_SIZE_MAX:
+ * - The block mean is removed, a Hann window is applied, and the samples are scaled so SAADC full scale is 0.5.
+ * - Even and odd samples are packed as the real and imaginary part of N / 2 complex values, which are transformed
+ *   with a radix-2 decimation-in-time FFT. Every stage halves its output, so nothing can overflow.
+ * - A split stage separates the spectra of the even and odd samples and combines them to bins 0 to N / 2.
+ * - The magnitudes are written back to the start of the buffer, Q15, where a full scale complex bin is 1.0.
+ *
+ * A sine of amplitude A codes centered on a bin gives a magnitude of A * 2^(13 - input bits), the Hann window has a
+ * coherent gain of 0.5. Between two bins the magnitude is up to 1.4 dB lower.
+ *
+ * The twiddle factors come from a constant quarter wave table, so no float math is used.
+ */
+#ifndef SPECTRUM_H__
+#define SPECTRUM_H__
+
+#include <stdint.h>
+
+#define SPECTRUM_SIZE_MAX      1024         // Largest block size, the twiddle table holds a quarter wave of this size
+
+typedef struct
+{
+    uint16_t bin;
+    int16_t  frac;                          // Interpolated offset from bin, in 1/256 bin
+    uint16_t magnitude;                     // Q15
+} spectrum_peak_t;
+
+// sin(2 pi k / SPECTRUM_SIZE_MAX) in Q31, k from 0 to SPECTRUM_SIZE_MAX / 4. round(sin(x) * 2^31), limited to INT32_MAX
+static const int32_t m_spectrum_sin_q31[SPECTRUM_SIZE_MAX / 4 + 1] =
+{
+             0,   13176712,   26352928,   39528151,   52701887,   65873638,   79042909,   92209205,
+     105372028,  118530885,  131685278,  144834714,  157978697,  171116733,  184248325,  197372981,
+     210490206,  223599506,  236700388,  249792358,  262874923,  275947592,  289009871,  302061269,
+     315101295,  328129457,  341145265,  354148230,  367137861,  380113669,  393075166,  406021865,
+     418953276,  431868915,  444768294,  457650927,  470516330,  483364019,  496193509,  509004318,
+     521795963,  534567963,  547319836,  560051104,  572761285,  585449903,  598116479,  610760536,
+     623381598,  635979190,  648552838,  661102068,  673626408,  686125387,  698598533,  711045377,
+     723465451,  735858287,  748223418,  760560380,  772868706,  785147934,  797397602,  809617249,
+     821806413,  833964638,  846091463,  858186435,  870249095,  882278992,  894275671,  906238681,
+     918167572,  930061894,  941921200,  953745043,  965532978,  977284562,  988999351, 1000676905,
+    1012316784, 1023918550, 1035481766, 1047005996, 1058490808, 1069935768, 1081340445, 1092704411,
+    1104027237, 1115308496, 1126547765, 1137744621, 1148898640, 1160009405, 1171076495, 1182099496,
+    1193077991, 1204011567, 1214899813, 1225742318, 1236538675, 1247288478, 1257991320, 1268646800,
+    1279254516, 1289814068, 1300325060, 1310787095, 1321199781, 1331562723, 1341875533, 1352137822,
+    1362349204, 1372509294, 1382617710, 1392674072, 1402678000, 1412629117, 1422527051, 1432371426,
+    1442161874, 1451898025, 1461579514, 1471205974, 1480777044, 1490292364, 1499751576, 1509154322,
+    1518500250, 1527789007, 1537020244, 1546193612, 1555308768, 1564365367, 1573363068, 1582301533,
+    1591180426, 1599999411, 1608758157, 1617456335, 1626093616, 1634669676, 1643184191, 1651636841,
+    1660027308, 1668355276, 1676620432, 1684822463, 1692961062, 1701035922, 1709046739, 1716993211,
+    1724875040, 1732691928, 1740443581, 1748129707, 1755750017, 1763304224, 1770792044, 1778213194,
+    1785567396, 1792854372, 1800073849, 1807225553, 1814309216, 1821324572, 1828271356, 1835149306,
+    1841958164, 1848697674, 1855367581, 1861967634, 1868497586, 1874957189, 1881346202, 1887664383,
+    1893911494, 1900087301, 1906191570, 1912224073, 1918184581, 1924072871, 1929888720, 1935631910,
+    1941302225, 1946899451, 1952423377, 1957873796, 1963250501, 1968553292, 1973781967, 1978936331,
+    1984016189, 1989021350, 1993951625, 1998806829, 2003586779, 2008291295, 2012920201, 2017473321,
+    2021950484, 2026351522, 2030676269, 2034924562, 2039096241, 2043191150, 2047209133, 2051150040,
+    2055013723, 2058800036, 2062508835, 2066139983, 2069693342, 2073168777, 2076566160, 2079885360,
+    2083126254, 2086288720, 2089372638, 2092377892, 2095304370, 2098151960, 2100920556, 2103610054,
+    2106220352, 2108751352, 2111202959, 2113575080, 2115867626, 2118080511, 2120213651, 2122266967,
+    2124240380, 2126133817, 2127947206, 2129680480, 2131333572, 2132906420, 2134398966, 2135811153,
+    2137142927, 2138394240, 2139565043, 2140655293, 2141664948, 2142593971, 2143442326, 2144209982,
+    2144896910, 2145503083, 2146028480, 2146473080, 2146836866, 2147119825, 2147321946, 2147443222,
+    2147483647
+};
+
+
+static inline int32_t spectrum_q31_mul(int32_t a, int32_t b)
+{
+    return (int32_t)(((int64_t)a * b) >> 31);
+}
+
+
+static inline uint32_t spectrum_isqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit  = 1UL << 30;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root   = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+
+// cos and sin of 2 pi k / size, for k from 0 to size / 2
+static inline void spectrum_twiddle(uint32_t k, uint32_t size, int32_t * p_cos, int32_t * p_sin)
+{
+    uint32_t quarter = SPECTRUM_SIZE_MAX / 4;
+    uint32_t i       = k * (SPECTRUM_SIZE_MAX / size);
+
+    if (i <= quarter)
+    {
+        *p_cos = m_spectrum_sin_q31[quarter - i];
+        *p_sin = m_spectrum_sin_q31[i];
+    }
+    else
+    {
+        *p_cos = -m_spectrum_sin_q31[i - quarter];
+        *p_sin = m_spectrum_sin_q31[2 * quarter - i];
+    }
+}
+
+
+// Removes the mean, applies the Hann window and scales full scale to 0.5, Q31
+static inline void spectrum_load(int16_t const * p_in, int32_t * p_out, uint32_t size, uint32_t input_bits)
+{
+    int32_t sum = 0;
+    for (uint32_t n = 0; n < size; n++)
+    {
+        sum += p_in[n];
+    }
+    int32_t mean = sum / (int32_t)size;
+
+    for (uint32_t n = 0; n < size; n++)
+    {
+        // The window is symmetric, w[n] = (1 - cos(2 pi n / N)) / 2
+        int32_t cos_q31;
+        int32_t sin_q31;
+        spectrum_twiddle((n <= size / 2) ? n : size - n, size, &cos_q31, &sin_q31);
+
+        int32_t window = (int32_t)((((int64_t)1 << 31) - cos_q31) >> 1);
+        int32_t value  = (int32_t)(p_in[n] - mean) * (1L << (30 - input_bits));
+        p_out[n] = spectrum_q31_mul(value, window);
+    }
+}
+
+
+// In-place complex FFT of bins interleaved Q31 values, scaled by 1 / bins
+static inline void spectrum_fft(int32_t * p_data, uint32_t bins)
+{
+    // Bit reversed reordering
+    for (uint32_t i = 0, j = 0; i < bins; i++)
+    {
+        if (i < j)
+        {
+            int32_t re = p_data[2 * i];
+            int32_t im = p_data[2 * i + 1];
+            p_data[2 * i]     = p_data[2 * j];
+            p_data[2 * i + 1] = p_data[2 * j + 1];
+            p_data[2 * j]     = re;
+            p_data[2 * j + 1] = im;
+        }
+
+        uint32_t bit = bins >> 1;
+        while (j & bit)
+        {
+            j  ^= bit;
+            bit >>= 1;
+        }
+        j |= bit;
+    }
+
+    for (uint32_t len = 2; len <= bins; len <<= 1)
+    {
+        uint32_t half = len / 2;
+        for (uint32_t k = 0; k < half; k++)
+        {
+            // W = e^(-j 2 pi k / len), loaded once for all butterflies that use it
+            int32_t w_cos;
+            int32_t w_sin;
+            spectrum_twiddle(k * (2 * bins / len), 2 * bins, &w_cos, &w_sin);
+
+            for (uint32_t start = 0; start < bins; start += len)
+            {
+                int32_t * p_a  = &p_data[2 * (start + k)];
+                int32_t * p_b  = &p_data[2 * (start + k + half)];
+                int32_t   t_re = spectrum_q31_mul(p_b[0], w_cos) + spectrum_q31_mul(p_b[1], w_sin);
+                int32_t   t_im = spectrum_q31_mul(p_b[1], w_cos) - spectrum_q31_mul(p_b[0], w_sin);
+                int32_t   a_re = p_a[0] >> 1;
+                int32_t   a_im = p_a[1] >> 1;
+
+                t_re >>= 1;
+                t_im >>= 1;
+                p_a[0] = a_re + t_re;
+                p_a[1] = a_im + t_im;
+                p_b[0] = a_re - t_re;
+                p_b[1] = a_im - t_im;
+            }
+        }
+    }
+}
+
+
+// Q31 to Q15, limited so the sum of two squares fits in 32 bits
+static inline int32_t spectrum_q15(int64_t value)
+{
+    value >>= 16;
+    return (int32_t)((value > 32767) ? 32767 : (value < -32767) ? -32767 : value);
+}
+
+
+static inline uint32_t spectrum_magnitude(int64_t re, int64_t im)
+{
+    int32_t re_q15 = spectrum_q15(re);
+    int32_t im_q15 = spectrum_q15(im);
+    return spectrum_isqrt((uint32_t)(re_q15 * re_q15) + (uint32_t)(im_q15 * im_q15));
+}
+
+
+// Splits the FFT of the packed even/odd samples into bins 0 to bins of the real FFT, and writes their magnitudes to
+// p_data[0] to p_data[bins]. Bins k and bins - k are computed from the same pair of complex values, and their
+// magnitudes are stored in the real part of these values, so the split is in place.
+static inline void spectrum_split(int32_t * p_data, uint32_t bins)
+{
+    for (uint32_t k = 0; k <= bins / 2; k++)
+    {
+        int32_t const * p_z = &p_data[2 * k];
+        int32_t const * p_m = &p_data[2 * ((bins - k) % bins)];
+
+        // Even part Fe = (Z[k] + conj(Z[M - k])) / 2, odd part Fo = -j (Z[k] - conj(Z[M - k])) / 2
+        int32_t fe_re = (p_z[0] >> 1) + (p_m[0] >> 1);
+        int32_t fe_im = (p_z[1] >> 1) - (p_m[1] >> 1);
+        int32_t fo_re = (p_z[1] >> 1) + (p_m[1] >> 1);
+        int32_t fo_im = (p_m[0] >> 1) - (p_z[0] >> 1);
+
+        // X[k] = Fe + W^k Fo and X[M - k] = conj(Fe - W^k Fo), W = e^(-j 2 pi / N)
+        int32_t w_cos;
+        int32_t w_sin;
+        spectrum_twiddle(k, 2 * bins, &w_cos, &w_sin);
+        int64_t t_re = (int64_t)spectrum_q31_mul(fo_re, w_cos) + spectrum_q31_mul(fo_im, w_sin);
+        int64_t t_im = (int64_t)spectrum_q31_mul(fo_im, w_cos) - spectrum_q31_mul(fo_re, w_sin);
+
+        uint32_t magnitude_k = spectrum_magnitude(fe_re + t_re, fe_im + t_im);
+        uint32_t magnitude_m = spectrum_magnitude(fe_re - t_re, fe_im - t_im);
+
+        if (k == 0)
+        {
+            p_data[0] = magnitude_k;
+            p_data[1] = magnitude_m;        // Bin bins, moved in place below
+        }
+        else
+        {
+            p_data[2 * k]          = magnitude_k;
+            p_data[2 * (bins - k)] = magnitude_m;
+        }
+    }
+
+    // Compact the magnitudes, p_data[2 * k] to p_data[k]. Each read is ahead of all writes
+    int32_t magnitude_last = p_data[1];
+    for (uint32_t k = 1; k < bins; k++)
+    {
+        p_data[k] = p_data[2 * k];
+    }
+    p_data[bins] = magnitude_last;
+}
+
+
+// Analyzes size samples of input_bits resolution in p_work, size words. Returns the magnitudes of bins 0 to size / 2,
+// Q15, at the start of p_work
+static inline int32_t const * spectrum_analyze(int16_t const * p_in, int32_t * p_work, uint32_t size, uint32_t input_bits)
+{
+    spectrum_load(p_in, p_work, size, input_bits);
+    spectrum_fft(p_work, size / 2);
+    spectrum_split(p_work, size / 2);
+    return p_work;
+}
+
+
+// Finds the largest local maxima of at least min_magnitude among bins 1 to bins - 1, strongest first. Returns the
+// number of peaks found
+static inline uint32_t spectrum_peaks_find(int32_t const * p_magnitude,
+                                           uint32_t        bins,
+                                           int32_t         min_magnitude,
+                                           spectrum_peak_t * p_peaks,
+                                           uint32_t        max_peaks)
+{
+    uint32_t count = 0;
+
+    for (uint32_t k = 1; k < bins; k++)
+    {
+        int32_t left   = p_magnitude[k - 1];
+        int32_t center = p_magnitude[k];
+        int32_t right  = p_magnitude[k + 1];
+
+        if ((center < min_magnitude) || (center <= left) || (center < right))
+        {
+            continue;
+        }
+        if ((count == max_peaks) && (center <= p_peaks[count - 1].magnitude))
+        {
+            continue;
+        }
+
+        // Insertion into the sorted list, the weakest peak is dropped when it is full
+        uint32_t i = (count < max_peaks) ? count++ : count - 1;
+        while ((i > 0) && (p_peaks[i - 1].magnitude < center))
+        {
+            p_peaks[i] = p_peaks[i - 1];
+            i--;
+        }
+
+        // Parabolic interpolation of the peak position between the neighbouring bins
+        int32_t curvature = 2 * center - left - right;
+        p_peaks[i].bin       = k;
+        p_peaks[i].frac      = (curvature > 0) ? (int16_t)(((right - left) * 128) / curvature) : 0;
+        p_peaks[i].magnitude = center;
+    }
+    return count;
+}
+
+#endif // SPECTRUM_H__
@@ -40,31 +40,190 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 #include <nrfx_saadc.h>
+#include "app_util_platform.h"
 #include "nrfx_timer.h"
 #include "nrfx_ppi.h"
 #include "nrf_delay.h"
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 #include "nrf_log_default_backends.h"
-
-
-#define ADC_CHANNELS_IN_USE     6   // Note: If changed, the logging during the NRFX_SAADC_EVT_DONE must be updated.
-#define SAADC_BUF_SIZE          ADC_CHANNELS_IN_USE
+#include "saadc_convert.h"
+#include "saadc_stats.h"
+
+
+#define SAADC_VDD_MV            3000    // Supply voltage, used to convert channels with NRF_SAADC_REFERENCE_VDD4 to mV
+#define SAADC_RESOLUTION        NRF_SAADC_RESOLUTION_14BIT
+
+// Channel table, one row per SAADC channel: X(channel index, positive input, gain, reference).
+// The channel configurations, count and mask below are generated from this table at build time. The conversion to
+// mV is derived from the channel configurations at startup, see saadc_convert.h
+#define SAADC_CHANNEL_TABLE(X)                                                      \
+    X(0, NRF_SAADC_INPUT_AIN0, NRF_SAADC_GAIN1_4, NRF_SAADC_REFERENCE_VDD4)         \
+    X(1, NRF_SAADC_INPUT_AIN1, NRF_SAADC_GAIN1_4, NRF_SAADC_REFERENCE_VDD4)         \
+    X(2, NRF_SAADC_INPUT_AIN2, NRF_SAADC_GAIN1_4, NRF_SAADC_REFERENCE_VDD4)         \
+    X(3, NRF_SAADC_INPUT_AIN3, NRF_SAADC_GAIN1_4, NRF_SAADC_REFERENCE_VDD4)         \
+    X(4, NRF_SAADC_INPUT_AIN4, NRF_SAADC_GAIN1_4, NRF_SAADC_REFERENCE_VDD4)         \
+    X(5, NRF_SAADC_INPUT_AIN5, NRF_SAADC_GAIN1_4, NRF_SAADC_REFERENCE_VDD4)
+
+#define SAADC_CHANNEL_COUNT_X(index, input, gain, reference)       + 1
+#define SAADC_CHANNEL_MASK_X(index, input, gain, reference)        | (1UL << (index))
+#define SAADC_CHANNEL_INPUT_BIT_X(index, input, gain, reference)   | (1UL << (input))
+#define SAADC_CHANNEL_INPUT_SUM_X(index, input, gain, reference)   + (1UL << (input))
+
+#define ADC_CHANNELS_IN_USE     (0 SAADC_CHANNEL_TABLE(SAADC_CHANNEL_COUNT_X))
+#define SAADC_CHANNEL_MASK      (0 SAADC_CHANNEL_TABLE(SAADC_CHANNEL_MASK_X))
+#define SAADC_SCANS_PER_BUFFER  10  // Number of complete scans in each buffer. The CPU is woken up once per buffer, not once per scan
+#define SAADC_BUF_SIZE          (ADC_CHANNELS_IN_USE * SAADC_SCANS_PER_BUFFER)
 #define SAADC_BUF_COUNT         2
 #define SAADC_SAMPLE_FREQUENCY  8000
-
+#define SAADC_STATS_ENABLED     1   // Set to 1 to log min/max/mean/RMS/variance of each channel every SAADC_STATS_WINDOW buffers, instead of every scan
+#define SAADC_STATS_WINDOW      1
+#define SAADC_DEINTERLEAVE_ENABLED 1    // Set to 1 to copy each buffer to one contiguous array per channel before the statistics, or 0 to read the channels in place with a stride
+#define SAADC_DEINTERLEAVE_BENCHMARK_ENABLED 0  // Set to 1 to log the cycles/sample of the de-interleave kernels at startup
+#define SAADC_CONVERT_BENCHMARK_ENABLED 0   // Set to 1 to log the cycles/sample and the error of the fixed-point mV conversion against float at startup
+#define SAADC_BENCHMARK_ENABLED 0   // Set to 1 to report samples/s, dropped buffers and handler time. Keeps the CPU awake, as DWT->CYCCNT is used as time base.
+#define SAADC_BENCHMARK_REPORT_INTERVAL_MS 5000
+#define SAADC_CHANNEL_SCHEDULER_ENABLED 0   // Set to 1 to convert each channel at its own rate from SAADC_CHANNEL_TICK_DIVIDER, instead of scanning all channels every tick
+#define SAADC_STREAM_SIZE       32  // Number of scheduled samples that can wait to be logged
+
+#if SAADC_CHANNEL_SCHEDULER_ENABLED && SAADC_BENCHMARK_ENABLED
+#error "SAADC_CHANNEL_SCHEDULER_ENABLED delivers one scan per tick to its own stream, set SAADC_BENCHMARK_ENABLED to 0."
+#endif
+
+// The statistics are logged from the DONE event, unless the benchmark or the channel scheduler takes it
+#define SAADC_STATS_LOG_ENABLED (SAADC_STATS_ENABLED && !SAADC_BENCHMARK_ENABLED && !SAADC_CHANNEL_SCHEDULER_ENABLED)
+
+#if !SAADC_CHANNEL_SCHEDULER_ENABLED
 static nrf_saadc_value_t samples[SAADC_BUF_COUNT][SAADC_BUF_SIZE];
+#endif
 static const nrfx_timer_t m_sample_timer = NRFX_TIMER_INSTANCE(1);
 static nrf_ppi_channel_t m_timer_saadc_ppi_channel;
-static nrf_ppi_channel_t m_saadc_internal_ppi_channel;
-static const uint32_t saadc_sampling_rate = 1000; // milliseconds (ms)
+static const uint32_t saadc_sampling_rate = 1000; // milliseconds (ms), time between scans
+
+STATIC_ASSERT(ADC_CHANNELS_IN_USE <= NRF_SAADC_CHANNEL_COUNT, "The SAADC has 8 channels");
+// Channel indexes must be 0 to ADC_CHANNELS_IN_USE - 1, and each analog input can only be used once
+STATIC_ASSERT(SAADC_CHANNEL_MASK == (1UL << ADC_CHANNELS_IN_USE) - 1, "Duplicate or missing channel index in SAADC_CHANNEL_TABLE");
+STATIC_ASSERT((0 SAADC_CHANNEL_TABLE(SAADC_CHANNEL_INPUT_BIT_X)) == (0 SAADC_CHANNEL_TABLE(SAADC_CHANNEL_INPUT_SUM_X)),
+              "Duplicate analog input in SAADC_CHANNEL_TABLE");
+
+// Same as NRFX_SAADC_DEFAULT_CHANNEL_SE, with the gain and reference from the table
+#define SAADC_CHANNEL_CONFIG_X(index, input, gain_value, reference_value)  \
+    {                                                                       \
+        .channel_config =                                                   \
+        {                                                                   \
+            .resistor_p = NRF_SAADC_RESISTOR_DISABLED,                      \
+            .resistor_n = NRF_SAADC_RESISTOR_DISABLED,                      \
+            .gain       = gain_value,                                       \
+            .reference  = reference_value,                                  \
+            .acq_time   = NRF_SAADC_ACQTIME_10US,                           \
+            .mode       = NRF_SAADC_MODE_SINGLE_ENDED,                      \
+            .burst      = NRF_SAADC_BURST_DISABLED,                         \
+        },                                                                  \
+        .pin_p         = input,                                             \
+        .pin_n         = NRF_SAADC_INPUT_DISABLED,                          \
+        .channel_index = index,                                             \
+    },
+
+static const nrfx_saadc_channel_t m_channel_configs[ADC_CHANNELS_IN_USE] = {SAADC_CHANNEL_TABLE(SAADC_CHANNEL_CONFIG_X)};
+static saadc_convert_t m_convert[ADC_CHANNELS_IN_USE];     // Conversion of each channel to mV, from m_channel_configs
+
+#if SAADC_CHANNEL_SCHEDULER_ENABLED
+// Channel n is converted every SAADC_CHANNEL_TICK_DIVIDER[n] timer ticks (saadc_sampling_rate ms)
+static const uint16_t SAADC_CHANNEL_TICK_DIVIDER[ADC_CHANNELS_IN_USE] = {1, 1, 1, 1, 10, 100};
+#endif
+
+static void event_handler(nrfx_saadc_evt_t const * p_event);
+
+#if SAADC_BENCHMARK_ENABLED
+typedef struct
+{
+    bool     running;               // Set after the first DONE event, enables gap detection
+    uint32_t done_count;            // Number of NRFX_SAADC_EVT_DONE events since last report
+    uint32_t sample_count;          // Number of samples delivered since last report
+    uint32_t dropped_buffers;       // Total number of buffer periods without a DONE event
+    uint32_t handler_cycles_max;    // Longest time spent in event_handler since last report
+    uint32_t handler_cycles_sum;    // Total time spent in event_handler since last report
+    uint32_t last_done_cycles;      // Timestamp of the previous DONE event
+} saadc_benchmark_t;
+
+static saadc_benchmark_t m_benchmark;
+
+
+static void benchmark_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
 
-static const nrf_saadc_input_t ANALOG_INPUT_MAP[NRF_SAADC_CHANNEL_COUNT] = {
-    NRF_SAADC_INPUT_AIN0, NRF_SAADC_INPUT_AIN1, NRF_SAADC_INPUT_AIN2, NRF_SAADC_INPUT_AIN3,
-    NRF_SAADC_INPUT_AIN4, NRF_SAADC_INPUT_AIN5, NRF_SAADC_INPUT_AIN6, NRF_SAADC_INPUT_AIN7};
+
+// Called on every DONE event. A gap of more than 1.5 buffer periods since the previous DONE means buffers were lost
+static void benchmark_done(uint32_t start_cycles, uint32_t size)
+{
+    // One buffer holds SAADC_BUF_SIZE / ADC_CHANNELS_IN_USE scans, one scan per timer period
+    uint32_t buf_period = (SystemCoreClock / 1000) * saadc_sampling_rate * (SAADC_BUF_SIZE / ADC_CHANNELS_IN_USE);
+
+    if (m_benchmark.running)
+    {
+        uint32_t interval = start_cycles - m_benchmark.last_done_cycles;
+        if (interval > buf_period + buf_period / 2)
+        {
+            m_benchmark.dropped_buffers += (interval + buf_period / 2) / buf_period - 1;
+        }
+    }
+    m_benchmark.running = true;
+    m_benchmark.last_done_cycles = start_cycles;
+    m_benchmark.done_count++;
+    m_benchmark.sample_count += size;
+}
+
+
+static void benchmark_handler_exit(uint32_t start_cycles)
+{
+    uint32_t cycles = DWT->CYCCNT - start_cycles;
+    m_benchmark.handler_cycles_sum += cycles;
+    if (cycles > m_benchmark.handler_cycles_max)
+    {
+        m_benchmark.handler_cycles_max = cycles;
+    }
+}
+
+
+// Called from main context. Prints a summary every SAADC_BENCHMARK_REPORT_INTERVAL_MS and restarts the measurement
+static void benchmark_report(void)
+{
+    static uint32_t last_report_cycles;
+    uint32_t now = DWT->CYCCNT;
+    uint32_t elapsed = now - last_report_cycles;
+
+    if (elapsed < (SystemCoreClock / 1000) * SAADC_BENCHMARK_REPORT_INTERVAL_MS)
+    {
+        return;
+    }
+    last_report_cycles = now;
+
+    saadc_benchmark_t snapshot;
+    CRITICAL_REGION_ENTER();
+    snapshot = m_benchmark;
+    m_benchmark.done_count         = 0;
+    m_benchmark.sample_count       = 0;
+    m_benchmark.handler_cycles_max = 0;
+    m_benchmark.handler_cycles_sum = 0;
+    CRITICAL_REGION_EXIT();
+
+    uint32_t cycles_per_us = SystemCoreClock / 1000000;
+    NRF_LOG_INFO("Samples/s: %u, dropped buffers: %u, handler time max/avg: %u/%u us",
+                 (uint32_t)(((uint64_t)snapshot.sample_count * SystemCoreClock) / elapsed),
+                 snapshot.dropped_buffers,
+                 snapshot.handler_cycles_max / cycles_per_us,
+                 (snapshot.done_count > 0) ? snapshot.handler_cycles_sum / snapshot.done_count / cycles_per_us : 0);
+}
+#endif // SAADC_BENCHMARK_ENABLED
 
 
+#if !SAADC_CHANNEL_SCHEDULER_ENABLED
 // Simple function to provide an index to the next input buffer
 // Will simply alernate between 0 and 1 when SAADC_BUF_COUNT is 2
 static uint32_t next_free_buf_index(void)
@@ -73,32 +232,536 @@ static uint32_t next_free_buf_index(void)
     buffer_index = (buffer_index + 1) % SAADC_BUF_COUNT;
     return buffer_index;
 }
+#endif
  
 
+#if (SAADC_STATS_LOG_ENABLED && SAADC_DEINTERLEAVE_ENABLED) || SAADC_DEINTERLEAVE_BENCHMARK_ENABLED
+// The de-interleave kernels copy a buffer of complete scans (ch0, ch1, ..., chN, ch0, ...) to one contiguous array per channel.
+// Sample n of channel ch is written to p_out[ch * scans + n].
+
+// Reference version, any number of channels
+static void deinterleave_generic(nrf_saadc_value_t const * p_in, uint32_t scans, uint32_t channels, nrf_saadc_value_t * p_out)
+{
+    for (uint32_t n = 0; n < scans; n++)
+    {
+        for (uint32_t ch = 0; ch < channels; ch++)
+        {
+            p_out[ch * scans + n] = *p_in++;
+        }
+    }
+}
+
+
+// Loads/stores two samples as one word. memcpy compiles to a single LDR/STR, which allows unaligned access on Cortex-M4
+static inline uint32_t pair_load(nrf_saadc_value_t const * p)
+{
+    uint32_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+
+static inline void pair_store(nrf_saadc_value_t * p, uint32_t word)
+{
+    memcpy(p, &word, sizeof(word));
+}
+
+
+// Two scans are handled per iteration. Word a holds (ch1 << 16 | ch0) of scan n, word b the same pair of scan n + 1.
+// Channel 0 gets (b << 16 | a[15:0]) and channel 1 (b[31:16] | a >> 16), which GCC maps to one PKHBT/PKHTB each
+#define PAIR_LO(a, b)   (((a) & 0xFFFF) | ((b) << 16))
+#define PAIR_HI(a, b)   (((a) >> 16) | ((b) & 0xFFFF0000))
+
+static void deinterleave_4(nrf_saadc_value_t const * p_in, uint32_t scans, nrf_saadc_value_t * p_out)
+{
+    nrf_saadc_value_t * p_ch0 = p_out;
+    nrf_saadc_value_t * p_ch1 = p_ch0 + scans;
+    nrf_saadc_value_t * p_ch2 = p_ch1 + scans;
+    nrf_saadc_value_t * p_ch3 = p_ch2 + scans;
+    uint32_t n;
+
+    for (n = 0; n + 1 < scans; n += 2)
+    {
+        uint32_t a01 = pair_load(&p_in[0]);
+        uint32_t a23 = pair_load(&p_in[2]);
+        uint32_t b01 = pair_load(&p_in[4]);
+        uint32_t b23 = pair_load(&p_in[6]);
+        pair_store(&p_ch0[n], PAIR_LO(a01, b01));
+        pair_store(&p_ch1[n], PAIR_HI(a01, b01));
+        pair_store(&p_ch2[n], PAIR_LO(a23, b23));
+        pair_store(&p_ch3[n], PAIR_HI(a23, b23));
+        p_in += 8;
+    }
+    if (n < scans)
+    {
+        p_ch0[n] = p_in[0];
+        p_ch1[n] = p_in[1];
+        p_ch2[n] = p_in[2];
+        p_ch3[n] = p_in[3];
+    }
+}
+
+
+static void deinterleave_6(nrf_saadc_value_t const * p_in, uint32_t scans, nrf_saadc_value_t * p_out)
+{
+    nrf_saadc_value_t * p_ch0 = p_out;
+    nrf_saadc_value_t * p_ch1 = p_ch0 + scans;
+    nrf_saadc_value_t * p_ch2 = p_ch1 + scans;
+    nrf_saadc_value_t * p_ch3 = p_ch2 + scans;
+    nrf_saadc_value_t * p_ch4 = p_ch3 + scans;
+    nrf_saadc_value_t * p_ch5 = p_ch4 + scans;
+    uint32_t n;
+
+    for (n = 0; n + 1 < scans; n += 2)
+    {
+        uint32_t a01 = pair_load(&p_in[0]);
+        uint32_t a23 = pair_load(&p_in[2]);
+        uint32_t a45 = pair_load(&p_in[4]);
+        uint32_t b01 = pair_load(&p_in[6]);
+        uint32_t b23 = pair_load(&p_in[8]);
+        uint32_t b45 = pair_load(&p_in[10]);
+        pair_store(&p_ch0[n], PAIR_LO(a01, b01));
+        pair_store(&p_ch1[n], PAIR_HI(a01, b01));
+        pair_store(&p_ch2[n], PAIR_LO(a23, b23));
+        pair_store(&p_ch3[n], PAIR_HI(a23, b23));
+        pair_store(&p_ch4[n], PAIR_LO(a45, b45));
+        pair_store(&p_ch5[n], PAIR_HI(a45, b45));
+        p_in += 12;
+    }
+    if (n < scans)
+    {
+        p_ch0[n] = p_in[0];
+        p_ch1[n] = p_in[1];
+        p_ch2[n] = p_in[2];
+        p_ch3[n] = p_in[3];
+        p_ch4[n] = p_in[4];
+        p_ch5[n] = p_in[5];
+    }
+}
+
+
+// De-interleaves scans * channels samples from p_in to p_out. The arrays must not overlap
+static void saadc_deinterleave(nrf_saadc_value_t const * p_in, uint32_t scans, uint32_t channels, nrf_saadc_value_t * p_out)
+{
+    switch (channels)
+    {
+        case 4:
+            deinterleave_4(p_in, scans, p_out);
+            break;
+
+        case 6:
+            deinterleave_6(p_in, scans, p_out);
+            break;
+
+        default:
+            deinterleave_generic(p_in, scans, channels, p_out);
+            break;
+    }
+}
+#endif
+
+
+#if SAADC_DEINTERLEAVE_BENCHMARK_ENABLED
+// Runs once at startup. Times the generic and the selected kernel on a buffer of SAADC_DEINTERLEAVE_BENCHMARK_SCANS scans,
+// for 4 channels (the BLE scan mode example), 6 channels and 5 channels (the generic fallback), and checks that both give
+// the same result
+#define SAADC_DEINTERLEAVE_BENCHMARK_SCANS  64
+
+static void deinterleave_benchmark_run(uint32_t channels)
+{
+    static nrf_saadc_value_t in[SAADC_DEINTERLEAVE_BENCHMARK_SCANS * NRF_SAADC_CHANNEL_COUNT];
+    static nrf_saadc_value_t out_ref[SAADC_DEINTERLEAVE_BENCHMARK_SCANS * NRF_SAADC_CHANNEL_COUNT];
+    static nrf_saadc_value_t out[SAADC_DEINTERLEAVE_BENCHMARK_SCANS * NRF_SAADC_CHANNEL_COUNT];
+    uint32_t size = SAADC_DEINTERLEAVE_BENCHMARK_SCANS * channels;
+    uint32_t generic_cycles;
+    uint32_t kernel_cycles;
+    uint32_t start;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        in[i] = (nrf_saadc_value_t)((i * 2654435761u) >> 20) - 2048;
+    }
+
+    start = DWT->CYCCNT;
+    deinterleave_generic(in, SAADC_DEINTERLEAVE_BENCHMARK_SCANS, channels, out_ref);
+    generic_cycles = DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    saadc_deinterleave(in, SAADC_DEINTERLEAVE_BENCHMARK_SCANS, channels, out);
+    kernel_cycles = DWT->CYCCNT - start;
+
+    // Cycles per sample, with two decimals
+    NRF_LOG_INFO("De-interleave %u channels: generic %u.%02u, kernel %u.%02u cycles/sample, %s",
+                 channels,
+                 generic_cycles / size, (generic_cycles * 100 / size) % 100,
+                 kernel_cycles / size, (kernel_cycles * 100 / size) % 100,
+                 (memcmp(out_ref, out, size * sizeof(nrf_saadc_value_t)) == 0) ? "match" : "MISMATCH");
+}
+
+
+static void deinterleave_benchmark(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    deinterleave_benchmark_run(4);
+    deinterleave_benchmark_run(6);
+    deinterleave_benchmark_run(5);
+}
+#endif
+
+
+#if SAADC_CONVERT_BENCHMARK_ENABLED
+// Runs once at startup, after adc_configure. Converts SAADC_CONVERT_BENCHMARK_SCANS scans to mV and to uV with
+// saadc_convert_buffer and with float math, and logs the cycles/sample of both and the largest difference
+#define SAADC_CONVERT_BENCHMARK_SCANS   64
+
+static void convert_benchmark_run(saadc_convert_unit_t unit, char const * p_unit_name)
+{
+    static nrf_saadc_value_t in[SAADC_CONVERT_BENCHMARK_SCANS * ADC_CHANNELS_IN_USE];
+    static int32_t out_fixed[SAADC_CONVERT_BENCHMARK_SCANS * ADC_CHANNELS_IN_USE];
+    static int32_t out_float[SAADC_CONVERT_BENCHMARK_SCANS * ADC_CHANNELS_IN_USE];
+    saadc_convert_t convert[ADC_CHANNELS_IN_USE];
+    float    per_code[ADC_CHANNELS_IN_USE];
+    uint32_t size = SAADC_CONVERT_BENCHMARK_SCANS * ADC_CHANNELS_IN_USE;
+    uint32_t fixed_cycles;
+    uint32_t float_cycles;
+    uint32_t start;
+    int32_t  diff_max = 0;
+
+    // Full range of the result, including small negative values
+    for (uint32_t i = 0; i < size; i++)
+    {
+        in[i] = (nrf_saadc_value_t)((i * 2654435761u) >> 18) - 64;
+    }
+    for (uint32_t ch = 0; ch < ADC_CHANNELS_IN_USE; ch++)
+    {
+        convert[ch]      = m_convert[ch];
+        convert[ch].unit = unit;
+        saadc_convert_trim(&convert[ch], 0, 0);
+        per_code[ch]     = (float)convert[ch].full_scale_uv / unit / (1UL << convert[ch].result_bits);
+    }
+
+    start = DWT->CYCCNT;
+    saadc_convert_buffer(convert, ADC_CHANNELS_IN_USE, in, out_fixed, size);
+    fixed_cycles = DWT->CYCCNT - start;
+
+    start = DWT->CYCCNT;
+    for (uint32_t ch = 0; ch < ADC_CHANNELS_IN_USE; ch++)
+    {
+        float scale = per_code[ch];
+        for (uint32_t i = ch; i < size; i += ADC_CHANNELS_IN_USE)
+        {
+            float value = in[i] * scale;
+            out_float[i] = (int32_t)(value < 0.0f ? value - 0.5f : value + 0.5f);
+        }
+    }
+    float_cycles = DWT->CYCCNT - start;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        int32_t diff = out_fixed[i] - out_float[i];
+        diff_max = MAX(diff_max, (diff < 0) ? -diff : diff);
+    }
+
+    // Cycles per sample, with two decimals
+    NRF_LOG_INFO("%s conversion: fixed-point %u.%02u, float %u.%02u cycles/sample, max difference %d %s",
+                 p_unit_name,
+                 fixed_cycles / size, (fixed_cycles * 100 / size) % 100,
+                 float_cycles / size, (float_cycles * 100 / size) % 100,
+                 diff_max, p_unit_name);
+}
+
+
+static void convert_benchmark(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    convert_benchmark_run(SAADC_CONVERT_UNIT_MV, "mV");
+    convert_benchmark_run(SAADC_CONVERT_UNIT_UV, "uV");
+}
+#endif
+
+
+#if SAADC_STATS_LOG_ENABLED
+// Samples of one channel, without copying. Sample n of the channel is p_samples[n * stride]
+typedef struct
+{
+    nrf_saadc_value_t const * p_samples;
+    uint32_t                  stride;
+    uint32_t                  count;
+} channel_view_t;
+
+
+#if SAADC_DEINTERLEAVE_ENABLED
+static nrf_saadc_value_t m_planar[ADC_CHANNELS_IN_USE * SAADC_SCANS_PER_BUFFER];   // De-interleaved copy of the last DONE buffer
+
+
+// De-interleaves a buffer of complete scans to m_planar, and returns one contiguous view per channel
+static void buffer_planar_views(nrf_saadc_value_t const * p_buffer, uint32_t size, uint32_t channels, channel_view_t * p_views)
+{
+    uint32_t scans = size / channels;
+
+    saadc_deinterleave(p_buffer, scans, channels, m_planar);
+    for (uint32_t ch = 0; ch < channels; ch++)
+    {
+        p_views[ch].p_samples = &m_planar[ch * scans];
+        p_views[ch].stride    = 1;
+        p_views[ch].count     = scans;
+    }
+}
+#else
+// Splits a buffer of complete scans into one view per channel. Sample i of the buffer belongs to channel i % channels
+static void buffer_channel_views(nrf_saadc_value_t const * p_buffer, uint32_t size, uint32_t channels, channel_view_t * p_views)
+{
+    for (uint32_t ch = 0; ch < channels; ch++)
+    {
+        p_views[ch].p_samples = &p_buffer[ch];
+        p_views[ch].stride    = channels;
+        p_views[ch].count     = size / channels;
+    }
+}
+#endif
+
+
+SAADC_STATS_WINDOW_DEF(m_stats, ADC_CHANNELS_IN_USE, SAADC_STATS_WINDOW);   // Summary of SAADC_STATS_WINDOW buffers
+
+
+// Adds one DONE buffer. Every SAADC_STATS_WINDOW buffers the summary is logged and the statistics restarted.
+// Returns true when a summary was logged
+static bool saadc_stats_buffer(nrf_saadc_value_t const * p_buffer, uint32_t size)
+{
+    saadc_stats_t * p_stats = saadc_stats_window_begin(&m_stats);
+
+    channel_view_t views[ADC_CHANNELS_IN_USE];
+#if SAADC_DEINTERLEAVE_ENABLED
+    buffer_planar_views(p_buffer, size, ADC_CHANNELS_IN_USE, views);
+#else
+    buffer_channel_views(p_buffer, size, ADC_CHANNELS_IN_USE, views);
+#endif
+    for (uint32_t ch = 0; ch < ADC_CHANNELS_IN_USE; ch++)
+    {
+        saadc_stats_add(&p_stats[ch], views[ch].p_samples, views[ch].stride, views[ch].count);
+    }
+
+    return saadc_stats_window_end(&m_stats);
+}
+#endif
+
+
+#if SAADC_CHANNEL_SCHEDULER_ENABLED
+// One converted sample in the per-channel stream
+typedef struct
+{
+    uint32_t          time_ms;      // Time of the timer tick that triggered the conversion, since start
+    uint8_t           channel;
+    nrf_saadc_value_t value;
+} channel_sample_t;
+
+static nrf_saadc_value_t m_sched_buffer[ADC_CHANNELS_IN_USE];
+static volatile bool     m_sched_armed;         // The SAADC is started and waits for the SAMPLE task of m_sched_armed_tick
+static uint32_t          m_sched_armed_tick;
+static uint32_t          m_sched_armed_mask;
+static uint32_t          m_sched_tick;          // Number of timer ticks since start
+
+static channel_sample_t  m_stream[SAADC_STREAM_SIZE];
+static uint32_t          m_stream_head;         // Index of the oldest sample
+static uint32_t          m_stream_count;
+static volatile uint32_t m_stream_dropped;
+
+
+// Returns the channels to convert at a tick, from SAADC_CHANNEL_TICK_DIVIDER
+static uint32_t sched_channel_mask(uint32_t tick)
+{
+    uint32_t channel_mask = 0;
+    for (uint32_t ch = 0; ch < ADC_CHANNELS_IN_USE; ch++)
+    {
+        if ((tick % SAADC_CHANNEL_TICK_DIVIDER[ch]) == 0)
+        {
+            channel_mask |= 1 << ch;
+        }
+    }
+    return channel_mask;
+}
+
+
+// Starts the SAADC with the channels of the given tick, so that the next SAMPLE task from the timer (through PPI)
+// converts exactly these channels. The SAADC must be idle, as the channel mask can only be changed between conversions
+static void sched_arm(uint32_t tick)
+{
+    ret_code_t err_code;
+    uint32_t channel_mask = sched_channel_mask(tick);
+    uint32_t channel_count = 0;
+
+    if (channel_mask == 0)
+    {
+        // Nothing to convert, the timer tick will arm the following one
+        m_sched_armed = false;
+        return;
+    }
+
+    for (uint32_t ch = 0; ch < ADC_CHANNELS_IN_USE; ch++)
+    {
+        channel_count += (channel_mask >> ch) & 1;
+    }
+
+    // One scan per buffer, and no next buffer, so that the SAADC stops after the END event
+    nrfx_saadc_adv_config_t saadc_adv_config = NRFX_SAADC_DEFAULT_ADV_CONFIG;
+    saadc_adv_config.internal_timer_cc = 0;
+    saadc_adv_config.start_on_end = false;
+
+    err_code = nrfx_saadc_advanced_mode_set(channel_mask,
+                                            SAADC_RESOLUTION,
+                                            &saadc_adv_config,
+                                            event_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrfx_saadc_buffer_set(m_sched_buffer, channel_count);
+    APP_ERROR_CHECK(err_code);
+
+    m_sched_armed      = true;
+    m_sched_armed_tick = tick;
+    m_sched_armed_mask = channel_mask;
+
+    err_code = nrfx_saadc_mode_trigger();
+    APP_ERROR_CHECK(err_code);
+}
+
+
+// Called on the DONE event of a scheduled scan. The SAADC stores the enabled channels in ascending order
+static void sched_done(nrf_saadc_value_t const * p_buffer, uint32_t size)
+{
+    uint32_t time_ms = m_sched_armed_tick * saadc_sampling_rate;
+    uint32_t i = 0;
+
+    for (uint32_t ch = 0; (ch < ADC_CHANNELS_IN_USE) && (i < size); ch++)
+    {
+        if ((m_sched_armed_mask & (1 << ch)) == 0)
+        {
+            continue;
+        }
+        if (m_stream_count == SAADC_STREAM_SIZE)
+        {
+            m_stream_dropped++;
+        }
+        else
+        {
+            channel_sample_t * p_sample = &m_stream[(m_stream_head + m_stream_count) % SAADC_STREAM_SIZE];
+            p_sample->time_ms = time_ms;
+            p_sample->channel = ch;
+            p_sample->value   = p_buffer[i];
+            m_stream_count++;
+        }
+        i++;
+    }
+}
+
+
+// Called from main context. Logs the samples in the per-channel stream
+static void sched_stream_process(void)
+{
+    static uint32_t dropped_logged;
+
+    if (m_stream_dropped != dropped_logged)
+    {
+        dropped_logged = m_stream_dropped;
+        NRF_LOG_WARNING("Stream full, %u samples dropped since start", dropped_logged);
+    }
+
+    while (true)
+    {
+        channel_sample_t sample;
+        bool             available = false;
+
+        CRITICAL_REGION_ENTER();
+        if (m_stream_count > 0)
+        {
+            sample = m_stream[m_stream_head];
+            m_stream_head = (m_stream_head + 1) % SAADC_STREAM_SIZE;
+            m_stream_count--;
+            available = true;
+        }
+        CRITICAL_REGION_EXIT();
+
+        if (!available)
+        {
+            break;
+        }
+        NRF_LOG_INFO("%8u ms ch%u: %6d", sample.time_ms, sample.channel, sample.value);
+    }
+}
+#endif
+
+
 static void timer_handler(nrf_timer_event_t event_type, void * p_context)
 {
+#if SAADC_CHANNEL_SCHEDULER_ENABLED
+    m_sched_tick++;
+    if (!m_sched_armed)
+    {
+        // No channel was converted at this tick, so there is no FINISHED event to arm the next one
+        sched_arm(m_sched_tick + 1);
+    }
+#endif
 }
 
 
 static void event_handler(nrfx_saadc_evt_t const * p_event)
 {
+#if !SAADC_CHANNEL_SCHEDULER_ENABLED
     ret_code_t err_code;
+#endif
+#if SAADC_BENCHMARK_ENABLED
+    uint32_t start_cycles = DWT->CYCCNT;
+#endif
+
     switch (p_event->type)
     {
         case NRFX_SAADC_EVT_DONE:
-            NRF_LOG_INFO("ADC Values: %6d %6d %6d %6d %6d %6d",
-                p_event->data.done.p_buffer[0], p_event->data.done.p_buffer[1], p_event->data.done.p_buffer[2], p_event->data.done.p_buffer[3], p_event->data.done.p_buffer[4], p_event->data.done.p_buffer[5]);
+#if SAADC_CHANNEL_SCHEDULER_ENABLED
+            sched_done(p_event->data.done.p_buffer, p_event->data.done.size);
+#elif SAADC_BENCHMARK_ENABLED
+            benchmark_done(start_cycles, p_event->data.done.size);
+#elif SAADC_STATS_LOG_ENABLED
+            saadc_stats_buffer(p_event->data.done.p_buffer, p_event->data.done.size);
+#else
+            // First scan in the buffer
+            for (uint32_t ch = 0; ch < ADC_CHANNELS_IN_USE; ch++)
+            {
+                int32_t value = p_event->data.done.p_buffer[ch];
+                NRF_LOG_INFO("CH%u: %6d, %4d mV", ch, value, saadc_convert_value(&m_convert[ch], value));
+            }
+#endif
             break;
 
         case NRFX_SAADC_EVT_BUF_REQ:
+#if !SAADC_CHANNEL_SCHEDULER_ENABLED
             // Set up the next available buffer
             err_code = nrfx_saadc_buffer_set(&samples[next_free_buf_index()][0], SAADC_BUF_SIZE);
             APP_ERROR_CHECK(err_code);
+#endif
+            break;
+
+#if SAADC_CHANNEL_SCHEDULER_ENABLED
+        case NRFX_SAADC_EVT_FINISHED:
+            // The SAADC is idle, set up the channels of the next tick
+            sched_arm(m_sched_armed_tick + 1);
+            break;
+#endif
+
+        case NRFX_SAADC_EVT_READY:
+            // The SAADC waits for the SAMPLE task from the timer. Comes once per tick with the scheduler
             break;
-                default:
+
+        default:
             NRF_LOG_INFO("SAADC evt %d", p_event->type);
             break;
     }
+
+#if SAADC_BENCHMARK_ENABLED
+    benchmark_handler_exit(start_cycles);
+#endif
 }
 
 
@@ -114,7 +777,7 @@ static void timer_init(void)
                                 NRF_TIMER_CC_CHANNEL0,
                                 nrfx_timer_ms_to_ticks(&m_sample_timer, saadc_sampling_rate),
                                 NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK,
-                                false);
+                                SAADC_CHANNEL_SCHEDULER_ENABLED);
 
     nrfx_timer_resume(&m_sample_timer);
 }
@@ -140,37 +803,29 @@ static void adc_configure(void)
 {
     ret_code_t err_code;
 
-    nrfx_saadc_adv_config_t saadc_adv_config = NRFX_SAADC_DEFAULT_ADV_CONFIG;
-    saadc_adv_config.internal_timer_cc = 0;
-    saadc_adv_config.start_on_end = true;
-
     err_code = nrfx_saadc_init(NRFX_SAADC_CONFIG_IRQ_PRIORITY);
     APP_ERROR_CHECK(err_code);
 
-    static nrfx_saadc_channel_t channel_configs[ADC_CHANNELS_IN_USE];
-
-    uint8_t channel_mask = 0;
-    for(int i = 0; i < ADC_CHANNELS_IN_USE; i++) {
-        nrf_saadc_input_t pin = ANALOG_INPUT_MAP[i];
-        // Apply default config to each channel
-        nrfx_saadc_channel_t config = NRFX_SAADC_DEFAULT_CHANNEL_SE(pin, i);
-
-        // Replace some parameters in default config
-        config.channel_config.reference = NRF_SAADC_REFERENCE_VDD4;          
-        config.channel_config.gain = NRF_SAADC_GAIN1_4;
-
-        // Copy to list of channel configs
-        memcpy(&channel_configs[i], &config, sizeof(config));
+    // The channel configurations are generated from SAADC_CHANNEL_TABLE at build time
+    err_code = nrfx_saadc_channels_config(m_channel_configs, ADC_CHANNELS_IN_USE);
+    APP_ERROR_CHECK(err_code);
 
-        // Update channel mask
-        channel_mask |= 1 << i;
+    for (uint32_t ch = 0; ch < ADC_CHANNELS_IN_USE; ch++)
+    {
+        saadc_convert_init(&m_convert[ch], &m_channel_configs[ch].channel_config, SAADC_RESOLUTION, SAADC_VDD_MV, SAADC_CONVERT_UNIT_MV);
     }
 
-    err_code = nrfx_saadc_channels_config(channel_configs, ADC_CHANNELS_IN_USE);
-    APP_ERROR_CHECK(err_code);
+#if SAADC_CHANNEL_SCHEDULER_ENABLED
+    // The first timer tick converts the channels of tick 1
+    sched_arm(1);
+#else
+    nrfx_saadc_adv_config_t saadc_adv_config = NRFX_SAADC_DEFAULT_ADV_CONFIG;
+    saadc_adv_config.internal_timer_cc = 0;
+    saadc_adv_config.start_on_end = true;
 
-    err_code = nrfx_saadc_advanced_mode_set(channel_mask,
-                                            NRF_SAADC_RESOLUTION_14BIT,
+
+    err_code = nrfx_saadc_advanced_mode_set(SAADC_CHANNEL_MASK,
+                                            SAADC_RESOLUTION,
                                             &saadc_adv_config,
                                             event_handler);
     APP_ERROR_CHECK(err_code);
@@ -184,6 +839,7 @@ static void adc_configure(void)
 
     err_code = nrfx_saadc_mode_trigger();
     APP_ERROR_CHECK(err_code);
+#endif
 }
 
 
@@ -197,13 +853,31 @@ int main(void)
     NRF_LOG_DEFAULT_BACKENDS_INIT();
     NRF_LOG_INFO("nrfx_saadc_api2 simple SAADC Continuous Sampling Example using timer and PPI.");	
 
+#if SAADC_BENCHMARK_ENABLED
+    benchmark_init();
+#endif
+#if SAADC_DEINTERLEAVE_BENCHMARK_ENABLED
+    deinterleave_benchmark();
+#endif
+
     adc_configure();
+#if SAADC_CONVERT_BENCHMARK_ENABLED
+    convert_benchmark();                            // Uses the conversion constants from adc_configure
+#endif
     ppi_init();
     timer_init();
 
     while (1)
     {
+#if SAADC_BENCHMARK_ENABLED
+        benchmark_report();
+        while(NRF_LOG_PROCESS() != NRF_SUCCESS);
+#else
+#if SAADC_CHANNEL_SCHEDULER_ENABLED
+        sched_stream_process();
+#endif
         while(NRF_LOG_PROCESS() != NRF_SUCCESS);
         __WFE();
+#endif
     }  
 }
@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) 2014 - 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/**
+ * Fixed-point conversion of SAADC results to mV or uV.
+ *
+ * The SAADC result is V * GAIN / REFERENCE * 2^m, with m = resolution for single-ended and resolution - 1 for
+ * differential channels. saadc_convert_init() derives a 32-bit multiplier and a shift from the gain, reference and
+ * mode of a channel configuration, so a result is converted with one multiply and one shift, and no float math:
+ *
+ *     out = ((result - offset) * multiplier + round) >> shift
+ *
+ * The shift is chosen as large as possible while (result - offset) * multiplier still fits in 32 bits for any
+ * result, so the relative error of the multiplier is below 2^-15 for every gain, reference and resolution.
+ * saadc_convert_trim() applies a gain and offset correction, e.g. from a two-point calibration against known
+ * input voltages.
+ */
+#ifndef SAADC_CONVERT_H__
+#define SAADC_CONVERT_H__
+
+#include <stdint.h>
+#include "nrf_saadc.h"
+
+#define SAADC_CONVERT_HEADROOM_BITS 2   // Bits kept free in the product for the gain trim and results above full scale
+
+// Output unit, the value is the number of uV per output unit
+typedef enum
+{
+    SAADC_CONVERT_UNIT_UV = 1,
+    SAADC_CONVERT_UNIT_MV = 1000,
+} saadc_convert_unit_t;
+
+// Conversion constants of one channel
+typedef struct
+{
+    int32_t  multiplier;
+    uint8_t  shift;
+    int16_t  offset;                    // Subtracted from the result before scaling, in SAADC codes
+    uint32_t full_scale_uv;             // Input voltage giving 2^m, before trim
+    uint8_t  result_bits;               // m, see above
+    saadc_convert_unit_t unit;
+} saadc_convert_t;
+
+
+// Returns the input voltage in uV that gives a result of 2^m
+static inline uint32_t saadc_convert_full_scale_uv(nrf_saadc_channel_config_t const * p_config, uint32_t vdd_mv)
+{
+    // Gain as numerator / denominator, indexed by nrf_saadc_gain_t
+    static const uint8_t gain_num[] = {1, 1, 1, 1, 1, 1, 2, 4};
+    static const uint8_t gain_den[] = {6, 5, 4, 3, 2, 1, 1, 1};
+
+    uint32_t reference_uv = (p_config->reference == NRF_SAADC_REFERENCE_INTERNAL) ? 600000 : (vdd_mv * 1000) / 4;
+
+    return (reference_uv * gain_den[p_config->gain]) / gain_num[p_config->gain];
+}
+
+
+// Applies a gain correction in ppm, and an offset in SAADC codes that is subtracted before scaling. Replaces any
+// previous trim
+static inline void saadc_convert_trim(saadc_convert_t * p_conv, int32_t gain_ppm, int16_t offset)
+{
+    uint64_t full_scale = ((uint64_t)p_conv->full_scale_uv * (uint32_t)(1000000 + gain_ppm)) / 1000000;
+    uint8_t  shift      = 0;
+
+    // Largest shift that keeps |result| * multiplier below 2^(31 - SAADC_CONVERT_HEADROOM_BITS). |result| is at most
+    // 2^m, so the multiplier is limited to 2^(31 - SAADC_CONVERT_HEADROOM_BITS - m)
+    while (((full_scale << (shift + 1)) / p_conv->unit) < (1ULL << (31 - SAADC_CONVERT_HEADROOM_BITS)))
+    {
+        shift++;
+    }
+
+    p_conv->shift      = shift;
+    p_conv->multiplier = (int32_t)((((full_scale << shift) >> (p_conv->result_bits - 1)) / p_conv->unit + 1) / 2);
+    p_conv->offset     = offset;
+}
+
+
+// Derives the conversion constants of a channel from its configuration. vdd_mv is only used for
+// NRF_SAADC_REFERENCE_VDD4
+static inline void saadc_convert_init(saadc_convert_t                  * p_conv,
+                                      nrf_saadc_channel_config_t const * p_config,
+                                      nrf_saadc_resolution_t             resolution,
+                                      uint32_t                           vdd_mv,
+                                      saadc_convert_unit_t               unit)
+{
+    // NRF_SAADC_RESOLUTION_8BIT to _14BIT
+    uint8_t bits = 8 + 2 * resolution;
+
+    p_conv->full_scale_uv = saadc_convert_full_scale_uv(p_config, vdd_mv);
+    p_conv->result_bits   = (p_config->mode == NRF_SAADC_MODE_DIFFERENTIAL) ? bits - 1 : bits;
+    p_conv->unit          = unit;
+    saadc_convert_trim(p_conv, 0, 0);
+}
+
+
+static inline int32_t saadc_convert_value(saadc_convert_t const * p_conv, nrf_saadc_value_t value)
+{
+    return ((value - p_conv->offset) * p_conv->multiplier + (1L << (p_conv->shift - 1))) >> p_conv->shift;
+}
+
+
+// Converts a buffer of interleaved samples, sample i belongs to channel i % channels and is converted with
+// p_conv[i % channels]. size must be a multiple of channels. The constants are loaded once per channel, so the
+// inner loop is a load, subtract, multiply-accumulate, shift and store per sample
+static inline void saadc_convert_buffer(saadc_convert_t   const * p_conv,
+                                        uint32_t                  channels,
+                                        nrf_saadc_value_t const * p_in,
+                                        int32_t                 * p_out,
+                                        uint32_t                  size)
+{
+    for (uint32_t ch = 0; ch < channels; ch++)
+    {
+        int32_t  multiplier = p_conv[ch].multiplier;
+        uint32_t shift      = p_conv[ch].shift;
+        int32_t  offset     = p_conv[ch].offset;
+        int32_t  round      = 1L << (shift - 1);
+
+        for (uint32_t i = ch; i < size; i += channels)
+        {
+            p_out[i] = ((p_in[i] - offset) * multiplier + round) >> shift;
+        }
+    }
+}
+
+#endif // SAADC_CONVERT_H__
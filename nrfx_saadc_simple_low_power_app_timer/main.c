@@ -78,51 +78,247 @@
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 #include "nrf_log_default_backends.h"
+#include "saadc_power.h"
+#include "saadc_convert.h"
+#include "saadc_stats.h"
  
 #define SAADC_CHANNEL_COUNT   1
 #define SAADC_SAMPLE_INTERVAL_MS 250
+#define SAADC_RESOLUTION      NRF_SAADC_RESOLUTION_12BIT
+#define SAADC_STATS_ENABLED   1     // Set to 1 to log min/max/mean/RMS/variance of each channel every SAADC_STATS_WINDOW samples, instead of every sample
+#define SAADC_STATS_WINDOW    4
+#define SAADC_SESSION_ENABLED 1     // Set to 1 to configure the sampling mode once and only re-arm the buffer and trigger on each tick. Set to 0 to call nrfx_saadc_simple_mode_set on every tick
+#define SAADC_TICK_BENCHMARK_ENABLED 0  // Set to 1 to log the CPU cycles spent per tick in sample_timer_handler and event_handler. Uses DWT->CYCCNT, do not use when measuring current consumption
+#define SAADC_TICK_BENCHMARK_WINDOW 16
+#define SAADC_COV_FILTER_ENABLED 0  // Set to 1 to only log a channel when its value has changed by more than the deadband since its last report. Replaces the per-sample log, so SAADC_STATS_ENABLED must be 0
+#define SAADC_COV_DEADBAND    8     // Absolute deadband in raw SAADC codes
+#define SAADC_COV_DEADBAND_PERMILLE 0   // Relative deadband in 1/1000 of the last reported value. The larger of the two deadbands is used
+#define SAADC_COV_KEEPALIVE_MS 10000    // Report each channel at least this often, even when its value has not changed
+#define SAADC_COV_MIN_INTERVAL_MS 0     // Minimum time between two reports of the same channel. 0 reports every change
+#define SAADC_COV_STATS_INTERVAL 240    // Log the number of reported against sampled values every n ticks
+
+#if SAADC_COV_FILTER_ENABLED && SAADC_STATS_ENABLED
+#error "SAADC_COV_FILTER_ENABLED filters the per-sample log, set SAADC_STATS_ENABLED to 0."
+#endif
 
 static volatile bool is_ready = true;
 static nrf_saadc_value_t samples[SAADC_CHANNEL_COUNT];
 static nrfx_saadc_channel_t channels[SAADC_CHANNEL_COUNT] = {NRFX_SAADC_DEFAULT_CHANNEL_SE(NRF_SAADC_INPUT_AIN0, 0)};
 
+static saadc_convert_t m_convert[SAADC_CHANNEL_COUNT];     // Conversion of each channel to mV, derived from channels[] at startup
+
 APP_TIMER_DEF(m_sample_timer_id);     /**< Handler for repeated timer used to blink LED 1. */
+
+#if SAADC_STATS_ENABLED
+SAADC_STATS_WINDOW_DEF(m_stats, SAADC_CHANNEL_COUNT, SAADC_STATS_WINDOW);   // Summary of SAADC_STATS_WINDOW buffers
+#endif
  
+#if SAADC_TICK_BENCHMARK_ENABLED
+// CPU time spent per tick. The CPU sleeps while the SAADC converts, and DWT->CYCCNT does not count during sleep
+static uint32_t m_tick_cycles_sum;      // Time spent in sample_timer_handler
+static uint32_t m_done_cycles_sum;      // Time spent in event_handler
+static uint32_t m_tick_count;
+
+
+static void tick_benchmark_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+
+// Logs the average over SAADC_TICK_BENCHMARK_WINDOW ticks, and restarts the measurement
+static void tick_benchmark_done(uint32_t done_cycles)
+{
+    m_done_cycles_sum += done_cycles;
+    if (++m_tick_count < SAADC_TICK_BENCHMARK_WINDOW)
+    {
+        return;
+    }
+
+    NRF_LOG_INFO("Cycles per tick: trigger %u, done %u, total %u (%u us)",
+                 m_tick_cycles_sum / m_tick_count,
+                 m_done_cycles_sum / m_tick_count,
+                 (m_tick_cycles_sum + m_done_cycles_sum) / m_tick_count,
+                 (m_tick_cycles_sum + m_done_cycles_sum) / m_tick_count / (SystemCoreClock / 1000000));
+    m_tick_cycles_sum = 0;
+    m_done_cycles_sum = 0;
+    m_tick_count      = 0;
+}
+#endif
+
+#if SAADC_COV_FILTER_ENABLED
+#define SAADC_COV_KEEPALIVE_TICKS    (SAADC_COV_KEEPALIVE_MS / SAADC_SAMPLE_INTERVAL_MS)
+#define SAADC_COV_MIN_INTERVAL_TICKS (SAADC_COV_MIN_INTERVAL_MS / SAADC_SAMPLE_INTERVAL_MS)
+
+// Change-of-value state of one channel
+typedef struct
+{
+    nrf_saadc_value_t last;     // Last reported value
+    uint32_t          silent;   // Ticks since the last report
+} cov_channel_t;
+
+static cov_channel_t m_cov[SAADC_CHANNEL_COUNT];
+static uint32_t      m_cov_ticks;
+static uint32_t      m_cov_reports;
+
+
+// Reports every channel on the first tick
+static void cov_filter_init(cov_channel_t * p_cov, uint32_t channels)
+{
+    for (uint32_t ch = 0; ch < channels; ch++)
+    {
+        p_cov[ch].last   = 0;
+        p_cov[ch].silent = SAADC_COV_KEEPALIVE_TICKS;
+    }
+}
+
+
+// Returns a mask of the channels in one scan that should be reported: channels that have moved by more than the deadband
+// since their last report, and were not reported within SAADC_COV_MIN_INTERVAL_MS, and channels silent for
+// SAADC_COV_KEEPALIVE_MS
+static uint32_t cov_filter_scan(cov_channel_t * p_cov, uint32_t channels, nrf_saadc_value_t const * p_scan)
+{
+    uint32_t mask = 0;
+
+    for (uint32_t ch = 0; ch < channels; ch++)
+    {
+        cov_channel_t * p        = &p_cov[ch];
+        int32_t         delta    = p_scan[ch] - p->last;
+        int32_t         deadband = ((p->last < 0 ? -p->last : p->last) * SAADC_COV_DEADBAND_PERMILLE) / 1000;
+
+        if (deadband < SAADC_COV_DEADBAND)
+        {
+            deadband = SAADC_COV_DEADBAND;
+        }
+
+        p->silent++;
+        if ((p->silent >= SAADC_COV_KEEPALIVE_TICKS) ||
+            (((delta > deadband) || (delta < -deadband)) && (p->silent >= SAADC_COV_MIN_INTERVAL_TICKS)))
+        {
+            p->last   = p_scan[ch];
+            p->silent = 0;
+            mask     |= 1UL << ch;
+        }
+    }
+    return mask;
+}
+
+
+// Counts the reports, and logs the reduction every SAADC_COV_STATS_INTERVAL ticks
+static void cov_filter_stats(uint32_t mask)
+{
+    for (; mask != 0; mask &= mask - 1)
+    {
+        m_cov_reports++;
+    }
+
+    if (++m_cov_ticks < SAADC_COV_STATS_INTERVAL)
+    {
+        return;
+    }
+
+    NRF_LOG_INFO("Change-of-value: %u of %u values reported",
+                 m_cov_reports, m_cov_ticks * SAADC_CHANNEL_COUNT);
+    m_cov_ticks   = 0;
+    m_cov_reports = 0;
+}
+#endif
+
 static void event_handler(nrfx_saadc_evt_t const * p_event)
 {
+#if SAADC_TICK_BENCHMARK_ENABLED
+    uint32_t start_cycles = DWT->CYCCNT;
+#endif
+
     if (p_event->type == NRFX_SAADC_EVT_DONE)
     {
+#if SAADC_STATS_ENABLED
+        saadc_stats_window_add(&m_stats, p_event->data.done.p_buffer, p_event->data.done.size);
+#elif SAADC_COV_FILTER_ENABLED
+        uint32_t mask = cov_filter_scan(m_cov, SAADC_CHANNEL_COUNT, p_event->data.done.p_buffer);
         for(int i = 0; i < p_event->data.done.size; i++)
         {
-            NRF_LOG_INFO("CH%d: %d", i, p_event->data.done.p_buffer[i]);
+            if (mask & (1UL << i))
+            {
+                NRF_LOG_INFO("CH%d: %d (%d mV)", i, p_event->data.done.p_buffer[i], saadc_convert_value(&m_convert[i], p_event->data.done.p_buffer[i]));
+            }
         }
+        cov_filter_stats(mask);
+#else
+        for(int i = 0; i < p_event->data.done.size; i++)
+        {
+            NRF_LOG_INFO("CH%d: %d (%d mV)", i, p_event->data.done.p_buffer[i], saadc_convert_value(&m_convert[i], p_event->data.done.p_buffer[i]));
+        }
+#endif
+
+        // Nothing more to convert until the next tick, see saadc_power.h
+        saadc_power_idle();
 
         is_ready = true;
     }
+
+#if SAADC_TICK_BENCHMARK_ENABLED
+    if (p_event->type == NRFX_SAADC_EVT_DONE)
+    {
+        tick_benchmark_done(DWT->CYCCNT - start_cycles);
+    }
+#endif
+}
+
+#if SAADC_SESSION_ENABLED
+// Configures the sampling mode once. It stays in the driver until the next mode is set, so each tick only needs to
+// set the buffer and trigger, see saadc_session_sample
+static void saadc_session_open(void)
+{
+    ret_code_t err_code;
+
+    err_code = nrfx_saadc_simple_mode_set((1<<0),
+                                          SAADC_RESOLUTION,
+                                          NRF_SAADC_OVERSAMPLE_DISABLED,
+                                          event_handler);
+    APP_ERROR_CHECK(err_code);
+}
+#endif
+
+
+static void saadc_session_sample(void)
+{
+    ret_code_t err_code;
+
+#if !SAADC_SESSION_ENABLED
+    err_code = nrfx_saadc_simple_mode_set((1<<0),
+                                          SAADC_RESOLUTION,
+                                          NRF_SAADC_OVERSAMPLE_DISABLED,
+                                          event_handler);
+    APP_ERROR_CHECK(err_code);
+#endif
+
+    err_code = nrfx_saadc_buffer_set(samples, SAADC_CHANNEL_COUNT);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrfx_saadc_mode_trigger();
+    APP_ERROR_CHECK(err_code);
 }
 
 /**@brief Timeout handler for the repeated timer.
  */
 static void sample_timer_handler(void * p_context)
 {
+#if SAADC_TICK_BENCHMARK_ENABLED
+    uint32_t start_cycles = DWT->CYCCNT;
+#endif
+
     if(is_ready)
     {
-        ret_code_t err_code;
-
-        err_code = nrfx_saadc_simple_mode_set((1<<0),
-                                              NRF_SAADC_RESOLUTION_12BIT,
-                                              NRF_SAADC_OVERSAMPLE_DISABLED,
-                                              event_handler);
-        APP_ERROR_CHECK(err_code);
-        
-        err_code = nrfx_saadc_buffer_set(samples, SAADC_CHANNEL_COUNT);
-        APP_ERROR_CHECK(err_code);
-
-        err_code = nrfx_saadc_mode_trigger();
-        APP_ERROR_CHECK(err_code);
-
+        saadc_session_sample();
         is_ready = false;
     }
+
+#if SAADC_TICK_BENCHMARK_ENABLED
+    m_tick_cycles_sum += DWT->CYCCNT - start_cycles;
+#endif
 }
 
 static void lfclk_config(void)
@@ -168,6 +364,22 @@ int main(void)
     err_code = nrfx_saadc_channels_config(channels, SAADC_CHANNEL_COUNT);
     APP_ERROR_CHECK(err_code);
 
+    // The supply voltage is not used with the internal reference of NRFX_SAADC_DEFAULT_CHANNEL_SE
+    for (uint32_t ch = 0; ch < SAADC_CHANNEL_COUNT; ch++)
+    {
+        saadc_convert_init(&m_convert[ch], &channels[ch].channel_config, SAADC_RESOLUTION, 0, SAADC_CONVERT_UNIT_MV);
+    }
+
+#if SAADC_SESSION_ENABLED
+    saadc_session_open();
+#endif
+#if SAADC_TICK_BENCHMARK_ENABLED
+    tick_benchmark_init();
+#endif
+#if SAADC_COV_FILTER_ENABLED
+    cov_filter_init(m_cov, SAADC_CHANNEL_COUNT);
+#endif
+
     timers_init();
 
     while (1)
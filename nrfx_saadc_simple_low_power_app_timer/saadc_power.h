@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2014 - 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/**
+ * SAADC power down on idle, with the workaround for Errata 212.
+ *
+ * On affected devices the SAADC is not powered down after some conversions, e.g. scan mode with burst and
+ * oversampling, and the System ON sleep current is stuck at 400-500 uA. The workaround power cycles the SAADC
+ * through an undocumented register, which resets all SAADC registers. saadc_power_idle() saves the registers
+ * first and writes them back afterwards, so the driver state stays valid and the next conversion can be triggered
+ * without configuring the SAADC again.
+ *
+ * Call saadc_power_idle() when the SAADC has gone idle, i.e. no conversion or calibration is running and the SAADC
+ * is not started, typically on the DONE event of the last buffer before sleep.
+ */
+#ifndef SAADC_POWER_H__
+#define SAADC_POWER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "nrf.h"
+#include "nrf_erratas.h"
+
+// Calibration results, kept by the workaround
+#define SAADC_POWER_CALIBRATION_REG_0   (*(volatile uint32_t *)0x40007640ul)
+#define SAADC_POWER_CALIBRATION_REG_1   (*(volatile uint32_t *)0x40007644ul)
+#define SAADC_POWER_CALIBRATION_REG_2   (*(volatile uint32_t *)0x40007648ul)
+#define SAADC_POWER_CONTROL_REG         (*(volatile uint32_t *)0x40007FFCul)
+
+// SAADC registers that are written by the drivers, and lost in the power cycle
+typedef struct
+{
+    uint32_t inten;
+    uint32_t enable;
+    uint32_t pselp[SAADC_CH_NUM];
+    uint32_t pseln[SAADC_CH_NUM];
+    uint32_t config[SAADC_CH_NUM];
+    uint32_t limit[SAADC_CH_NUM];
+    uint32_t resolution;
+    uint32_t oversample;
+    uint32_t samplerate;
+    uint32_t result_ptr;
+    uint32_t result_maxcnt;
+    uint32_t calibration[3];
+} saadc_power_regs_t;
+
+
+// Returns true when the Errata 212 workaround is needed on this device
+static inline bool saadc_power_workaround_needed(void)
+{
+    return nrf52_errata_212();
+}
+
+
+static inline void saadc_power_regs_save(saadc_power_regs_t * p_regs)
+{
+    p_regs->inten  = NRF_SAADC->INTEN;
+    p_regs->enable = NRF_SAADC->ENABLE;
+    for (uint32_t ch = 0; ch < SAADC_CH_NUM; ch++)
+    {
+        p_regs->pselp[ch]  = NRF_SAADC->CH[ch].PSELP;
+        p_regs->pseln[ch]  = NRF_SAADC->CH[ch].PSELN;
+        p_regs->config[ch] = NRF_SAADC->CH[ch].CONFIG;
+        p_regs->limit[ch]  = NRF_SAADC->CH[ch].LIMIT;
+    }
+    p_regs->resolution     = NRF_SAADC->RESOLUTION;
+    p_regs->oversample     = NRF_SAADC->OVERSAMPLE;
+    p_regs->samplerate     = NRF_SAADC->SAMPLERATE;
+    p_regs->result_ptr     = NRF_SAADC->RESULT.PTR;
+    p_regs->result_maxcnt  = NRF_SAADC->RESULT.MAXCNT;
+    p_regs->calibration[0] = SAADC_POWER_CALIBRATION_REG_0;
+    p_regs->calibration[1] = SAADC_POWER_CALIBRATION_REG_1;
+    p_regs->calibration[2] = SAADC_POWER_CALIBRATION_REG_2;
+}
+
+
+static inline void saadc_power_regs_restore(saadc_power_regs_t const * p_regs)
+{
+    SAADC_POWER_CALIBRATION_REG_0 = p_regs->calibration[0];
+    SAADC_POWER_CALIBRATION_REG_1 = p_regs->calibration[1];
+    SAADC_POWER_CALIBRATION_REG_2 = p_regs->calibration[2];
+    for (uint32_t ch = 0; ch < SAADC_CH_NUM; ch++)
+    {
+        NRF_SAADC->CH[ch].PSELP  = p_regs->pselp[ch];
+        NRF_SAADC->CH[ch].PSELN  = p_regs->pseln[ch];
+        NRF_SAADC->CH[ch].CONFIG = p_regs->config[ch];
+        NRF_SAADC->CH[ch].LIMIT  = p_regs->limit[ch];
+    }
+    NRF_SAADC->RESOLUTION    = p_regs->resolution;
+    NRF_SAADC->OVERSAMPLE    = p_regs->oversample;
+    NRF_SAADC->SAMPLERATE    = p_regs->samplerate;
+    NRF_SAADC->RESULT.PTR    = p_regs->result_ptr;
+    NRF_SAADC->RESULT.MAXCNT = p_regs->result_maxcnt;
+    NRF_SAADC->INTEN         = p_regs->inten;
+    NRF_SAADC->ENABLE        = p_regs->enable;
+}
+
+
+// Powers down the SAADC on devices affected by Errata 212. Must only be called when the SAADC is idle.
+// Returns true when the workaround was applied
+static inline bool saadc_power_idle(void)
+{
+    saadc_power_regs_t regs;
+
+    if (!saadc_power_workaround_needed())
+    {
+        return false;
+    }
+
+    saadc_power_regs_save(&regs);
+
+    SAADC_POWER_CONTROL_REG = 0ul;
+    (void)SAADC_POWER_CONTROL_REG;
+    SAADC_POWER_CONTROL_REG = 1ul;
+
+    saadc_power_regs_restore(&regs);
+    return true;
+}
+
+#endif // SAADC_POWER_H__
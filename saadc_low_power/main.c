@@ -58,6 +58,16 @@
  *                         expected temperature change rate, see the nRF52832 PS for more information. The
  *                         calibration interval can be adjusted with configuring the SAADC_CALIBRATION_INTERVAL
  *                         constant.
+ * - Calibration policy -> With SAADC_CALIBRATION_TEMP_POLICY set to 1, the die temperature is read from the TEMP peripheral
+ *                         every SAADC_TEMP_CHECK_INTERVAL DONE events, and offset calibration is only run when the
+ *                         temperature has changed more than SAADC_CALIBRATION_TEMP_DELTA since the last calibration,
+ *                         or after SAADC_CALIBRATION_MAX_AGE DONE events.
+ * - Limit mode -> Set SAADC_LIMIT_MODE_ENABLED to 1 to only wake up the CPU for samples outside SAADC_LIMIT_LOW..SAADC_LIMIT_HIGH,
+ *                 through the SAADC LIMITL/LIMITH events, and for a heartbeat from RTC1 every SAADC_LIMIT_HEARTBEAT_SAMPLES
+ *                 samples. PPI starts the SAADC for each sample and stops it again on END, so it is not left started
+ *                 between samples.
+ * - PPI triggering -> Set SAADC_PPI_TRIGGER_ENABLED to 1 to let the RTC COMPARE0 event trigger the SAADC SAMPLE task and
+ *                     the RTC CLEAR task through PPI, so the CPU is only woken up when a buffer is full.
  * The SAADC sample result is printed on UART. To see the UART output, a UART terminal (e.g. Realterm) can be configured on 
  * your PC with the UART configuration set in the uart_config function, which is also described in the saadc example documentation -> 
  * http://infocenter.nordicsemi.com/topic/com.nordic.infocenter.sdk5.v11.0.0/nrf_dev_saadc_example.html?cp=5_0_0_4_5_24
@@ -82,6 +92,12 @@
 #include "nrf_drv_power.h"
 #include "nrf_drv_clock.h"
 #include "nrf_drv_rtc.h"
+#include "nrf_drv_ppi.h"
+#include "nrf_timer.h"
+#include "nrf_temp.h"
+#include "saadc_power.h"
+#include "saadc_convert.h"
+#include "saadc_stats.h"
 
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
@@ -91,9 +107,39 @@
 #define RTC_CC_VALUE 8                            //Determines the RTC interrupt frequency and thereby the SAADC sampling frequency
 #define SAADC_SAMPLE_INTERVAL_MS 250              //Interval in milliseconds at which RTC times out and triggers SAADC sample task (
 #define SAADC_CALIBRATION_INTERVAL 5              //Determines how often the SAADC should be calibrated relative to NRF_DRV_SAADC_EVT_DONE event. E.g. value 5 will make the SAADC calibrate every fifth time the NRF_DRV_SAADC_EVT_DONE is received.
+#define SAADC_CALIBRATION_TEMP_POLICY 1           //Set to 1 to calibrate on die temperature change or age, see below. Set to 0 to calibrate every SAADC_CALIBRATION_INTERVAL DONE events.
+#define SAADC_TEMP_CHECK_INTERVAL 20              //Read the die temperature every n NRF_DRV_SAADC_EVT_DONE events (every 5 seconds with the default sample interval).
+#define SAADC_CALIBRATION_TEMP_DELTA 8            //Calibrate when the die temperature has changed this much since the last calibration, in 0.25 degC units (8 = 2 degC).
+#define SAADC_CALIBRATION_MAX_AGE 240             //Calibrate when the last calibration is older than n NRF_DRV_SAADC_EVT_DONE events, regardless of temperature (1 minute with the default sample interval).
+#define SAADC_CALIBRATION_GUARD_TICKS 2           //Calibration is only started when at least this many RTC ticks remain until the next sample trigger, so it completes in the idle gap between two samples.
+#define SAADC_LIMIT_MODE_ENABLED 0                //Set to 1 to only wake up the CPU when a sample is outside SAADC_LIMIT_LOW..SAADC_LIMIT_HIGH, and for a heartbeat. Requires SAADC_PPI_TRIGGER_ENABLED.
+#define SAADC_LIMIT_LOW 500                       //Samples below this value generate a LIMITL event, in raw SAADC codes (about 0.44 V with gain 1/6 and 12-bit resolution).
+#define SAADC_LIMIT_HIGH 3500                     //Samples above this value generate a LIMITH event, in raw SAADC codes (about 3.08 V).
+#define SAADC_LIMIT_HEARTBEAT_SAMPLES 240         //In limit mode RTC1 also wakes up the CPU once per this many samples, to log a heartbeat with the last sample (1 minute with the default sample interval).
 #define SAADC_SAMPLES_IN_BUFFER 1                 //Number of SAADC samples in RAM before returning a SAADC event. For low power SAADC set this constant to 1. Otherwise the EasyDMA will be enabled for an extended time which consumes high current.
 #define SAADC_OVERSAMPLE NRF_SAADC_OVERSAMPLE_DISABLED  //Oversampling setting for the SAADC. Setting oversample to 4x This will make the SAADC output a single averaged value when the SAMPLE task is triggered 4 times. Enable BURST mode to make the SAADC sample 4 times when triggering SAMPLE task once.
 #define SAADC_BURST_MODE 0                        //Set to 1 to enable BURST mode, otherwise set to 0.
+#define SAADC_PPI_TRIGGER_ENABLED 0               //Set to 1 to trigger SAADC SAMPLE and RTC CLEAR from RTC COMPARE0 through PPI, without waking up the CPU. Set to 0 to trigger sampling from rtc_handler.
+#define SAADC_STATS_ENABLED 1                     //Set to 1 to log min/max/mean/RMS/variance of the samples every SAADC_STATS_WINDOW buffers, instead of every sample.
+#define SAADC_STATS_WINDOW 8                      //Number of NRF_DRV_SAADC_EVT_DONE buffers summarized in each statistics log entry.
+#define SAADC_COV_FILTER_ENABLED 0                //Set to 1 to only log a sample when it has changed by more than the deadband since the last logged sample. Replaces the per-sample log, so SAADC_STATS_ENABLED must be 0.
+#define SAADC_COV_DEADBAND 8                      //Absolute deadband in raw SAADC codes.
+#define SAADC_COV_DEADBAND_PERMILLE 0             //Relative deadband in 1/1000 of the last logged sample. The larger of the two deadbands is used.
+#define SAADC_COV_KEEPALIVE_SAMPLES 40            //Log a sample at least every n samples, even when it has not changed (10 seconds with the default sample interval).
+#define SAADC_COV_MIN_INTERVAL_SAMPLES 0          //Minimum number of samples between two logged samples. 0 logs every change.
+#define SAADC_COV_STATS_INTERVAL 240              //Log the number of logged against converted samples every n samples.
+#define SAADC_BENCHMARK_ENABLED 0                 //Set to 1 to report samples/s, lost samples and handler time. Keeps the CPU awake, as DWT->CYCCNT is used as time base. Do not use when measuring current consumption.
+#define SAADC_BENCHMARK_REPORT_INTERVAL_MS 5000   //Interval in milliseconds between each benchmark report.
+
+#if SAADC_LIMIT_MODE_ENABLED && !SAADC_PPI_TRIGGER_ENABLED
+#error "SAADC_LIMIT_MODE_ENABLED requires SAADC_PPI_TRIGGER_ENABLED, otherwise rtc_handler wakes up the CPU for every sample."
+#endif
+#if SAADC_LIMIT_MODE_ENABLED && SAADC_BENCHMARK_ENABLED
+#error "SAADC_LIMIT_MODE_ENABLED does not deliver the samples in NRF_DRV_SAADC_EVT_DONE events, set SAADC_BENCHMARK_ENABLED to 0."
+#endif
+#if SAADC_COV_FILTER_ENABLED && (SAADC_STATS_ENABLED || SAADC_BENCHMARK_ENABLED)
+#error "SAADC_COV_FILTER_ENABLED filters the per-sample log, set SAADC_STATS_ENABLED and SAADC_BENCHMARK_ENABLED to 0."
+#endif
 
 
 const  nrf_drv_rtc_t           rtc = NRF_DRV_RTC_INSTANCE(2); /**< Declaring an instance of nrf_drv_rtc for RTC2. */
@@ -101,6 +147,165 @@ static uint32_t                rtc_ticks = RTC_US_TO_TICKS(SAADC_SAMPLE_INTERVAL
 static nrf_saadc_value_t       m_buffer_pool[2][SAADC_SAMPLES_IN_BUFFER];
 static uint32_t                m_adc_evt_counter = 0;
 static bool                    m_saadc_calibrate = false;      
+static volatile bool           m_saadc_calibrating = false;    //Set from calibration start until NRF_DRV_SAADC_EVT_CALIBRATEDONE. No sample must be triggered in this window
+static uint32_t                m_samples_triggered = 0;        //Number of SAMPLE tasks triggered from rtc_handler
+static uint32_t                m_samples_delivered = 0;        //Number of samples delivered in NRF_DRV_SAADC_EVT_DONE events
+static uint32_t                m_calibration_rtc_start;        //RTC counter when calibration was started
+static uint32_t                m_calibration_lost_samples = 0; //Sample triggers that fell inside a calibration window since start
+static uint32_t                m_calibration_count = 0;        //Number of completed offset calibrations since start
+static saadc_convert_t         m_convert;                      //Conversion of channel 0 results to mV, derived from the channel configuration in saadc_init
+#if SAADC_COV_FILTER_ENABLED
+static nrf_saadc_value_t       m_cov_last = 0;                 //Last logged sample
+static uint32_t                m_cov_silent = SAADC_COV_KEEPALIVE_SAMPLES;    //Samples since the last logged sample. Starts at the keep-alive, so the first sample is logged
+static uint32_t                m_cov_samples = 0;              //Samples converted since the last change-of-value report
+static uint32_t                m_cov_reports = 0;              //Samples logged since the last change-of-value report
+#endif
+#if SAADC_LIMIT_MODE_ENABLED
+static const nrf_drv_rtc_t     m_heartbeat_rtc = NRF_DRV_RTC_INSTANCE(1);    //Wakes up the CPU once per SAADC_LIMIT_HEARTBEAT_SAMPLES samples
+static uint32_t                m_limit_events = 0;             //Number of NRF_DRV_SAADC_EVT_LIMIT events since the last heartbeat
+#endif
+#if SAADC_CALIBRATION_TEMP_POLICY
+static bool                    m_temp_check = false;           //Set every SAADC_TEMP_CHECK_INTERVAL DONE events to read the die temperature in main context
+static bool                    m_calibration_temp_valid = false;
+static int32_t                 m_calibration_temp;             //Die temperature when the last calibration was requested, in 0.25 degC units
+static uint32_t                m_calibration_evt;              //m_adc_evt_counter when the last calibration was requested
+static uint32_t                m_temp_reads = 0;               //Number of TEMP measurements since start
+#endif
+#if SAADC_PPI_TRIGGER_ENABLED
+static nrf_ppi_channel_t       m_ppi_channel;
+#endif
+#if SAADC_LIMIT_MODE_ENABLED
+static nrf_ppi_channel_t       m_ppi_channel_started;          //SAADC STARTED to SAMPLE
+static nrf_ppi_channel_t       m_ppi_channel_end;              //SAADC END to STOP
+#endif
+
+#if SAADC_BENCHMARK_ENABLED
+typedef struct
+{
+    uint32_t trigger_count;         //Total number of SAMPLE tasks triggered from rtc_handler, or counted by TIMER1 with PPI triggering
+    uint32_t sample_total;          //Total number of samples delivered in DONE events
+    uint32_t sample_count;          //Number of samples delivered since last report
+    uint32_t done_count;            //Number of DONE events since last report
+    uint32_t handler_cycles_max;    //Longest time spent in saadc_callback since last report
+    uint32_t handler_cycles_sum;    //Total time spent in saadc_callback since last report
+    uint32_t calibration_start_cycles;  //Timestamp of the last calibration start
+    uint32_t calibration_cycles_max;    //Longest time from calibration start until NRF_DRV_SAADC_EVT_CALIBRATEDONE since start
+} saadc_benchmark_t;
+
+static saadc_benchmark_t m_benchmark;
+#if SAADC_PPI_TRIGGER_ENABLED
+#define BENCHMARK_TRIGGER_COUNTER NRF_TIMER1                           //Counts the RTC COMPARE0 events that trigger the SAADC through PPI
+static nrf_ppi_channel_t m_ppi_channel_trigger_count;                  //RTC COMPARE0 to TIMER1 COUNT
+#endif
+
+
+static void benchmark_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+
+static void benchmark_handler_exit(uint32_t start_cycles)
+{
+    uint32_t cycles = DWT->CYCCNT - start_cycles;
+    m_benchmark.handler_cycles_sum += cycles;
+    if (cycles > m_benchmark.handler_cycles_max)
+    {
+        m_benchmark.handler_cycles_max = cycles;
+    }
+}
+
+
+#if SAADC_PPI_TRIGGER_ENABLED
+//The SAMPLE task is triggered through PPI without any interrupt. A second PPI channel from RTC COMPARE0 lets TIMER1 count
+//the triggers in counter mode, so they are counted in hardware without waking up the CPU. Must be called after ppi_config
+static void benchmark_trigger_counter_init(void)
+{
+    uint32_t err_code;
+
+    nrf_timer_mode_set(BENCHMARK_TRIGGER_COUNTER, NRF_TIMER_MODE_LOW_POWER_COUNTER);
+    nrf_timer_bit_width_set(BENCHMARK_TRIGGER_COUNTER, NRF_TIMER_BIT_WIDTH_32);
+    nrf_timer_task_trigger(BENCHMARK_TRIGGER_COUNTER, NRF_TIMER_TASK_CLEAR);
+    nrf_timer_task_trigger(BENCHMARK_TRIGGER_COUNTER, NRF_TIMER_TASK_START);
+
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_channel_trigger_count);
+    APP_ERROR_CHECK(err_code);
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_channel_trigger_count,
+                                          nrf_drv_rtc_event_address_get(&rtc, NRF_RTC_EVENT_COMPARE_0),
+                                          nrf_timer_task_address_get(BENCHMARK_TRIGGER_COUNTER, NRF_TIMER_TASK_COUNT));
+    APP_ERROR_CHECK(err_code);
+    err_code = nrf_drv_ppi_channel_enable(m_ppi_channel_trigger_count);
+    APP_ERROR_CHECK(err_code);
+}
+
+
+//Returns the number of RTC COMPARE0 events since benchmark_trigger_counter_init
+static uint32_t benchmark_trigger_count_read(void)
+{
+    nrf_timer_task_trigger(BENCHMARK_TRIGGER_COUNTER, NRF_TIMER_TASK_CAPTURE0);
+    return nrf_timer_cc_read(BENCHMARK_TRIGGER_COUNTER, NRF_TIMER_CC_CHANNEL0);
+}
+#endif
+
+
+//Called from main context. Prints a summary every SAADC_BENCHMARK_REPORT_INTERVAL_MS and restarts the measurement.
+//Samples that were triggered but never delivered are reported as lost.
+static void benchmark_report(void)
+{
+    static uint32_t last_report_cycles;
+    uint32_t now = DWT->CYCCNT;
+    uint32_t elapsed = now - last_report_cycles;
+
+    if (elapsed < (SystemCoreClock / 1000) * SAADC_BENCHMARK_REPORT_INTERVAL_MS)
+    {
+        return;
+    }
+    last_report_cycles = now;
+
+    saadc_benchmark_t snapshot;
+#if SAADC_PPI_TRIGGER_ENABLED
+    static uint32_t last_trigger_count;
+    uint32_t triggers;
+#endif
+    CRITICAL_REGION_ENTER();
+#if SAADC_PPI_TRIGGER_ENABLED
+    //Read together with the snapshot, so the triggers of this interval are compared with its samples
+    uint32_t trigger_count = benchmark_trigger_count_read();
+    triggers = trigger_count - last_trigger_count;
+    last_trigger_count = trigger_count;
+    m_benchmark.trigger_count += triggers;
+#endif
+    snapshot = m_benchmark;
+    m_benchmark.done_count         = 0;
+    m_benchmark.sample_count       = 0;
+    m_benchmark.handler_cycles_max = 0;
+    m_benchmark.handler_cycles_sum = 0;
+    CRITICAL_REGION_EXIT();
+
+    //Up to two buffers may be in flight, those samples are not counted as lost
+    uint32_t in_flight = 2 * SAADC_SAMPLES_IN_BUFFER;
+    uint32_t pending   = snapshot.trigger_count - snapshot.sample_total;
+    uint32_t cycles_per_us = SystemCoreClock / 1000000;
+    NRF_LOG_INFO("Samples/s: %u, lost samples: %u, handler time max/avg: %u/%u us",
+                 (uint32_t)(((uint64_t)snapshot.sample_count * SystemCoreClock) / elapsed),
+                 (pending > in_flight) ? pending - in_flight : 0,
+                 snapshot.handler_cycles_max / cycles_per_us,
+                 (snapshot.done_count > 0) ? snapshot.handler_cycles_sum / snapshot.done_count / cycles_per_us : 0);
+#if SAADC_PPI_TRIGGER_ENABLED
+    //In the RTC interrupt mode rtc_handler wakes up the CPU for each of these triggers, in addition to saadc_callback
+    NRF_LOG_INFO("PPI triggers: %u, CPU wakeups: %u, %u wakeups saved compared with the RTC interrupt mode",
+                 triggers,
+                 snapshot.done_count,
+                 triggers);
+#endif
+}
+#endif //SAADC_BENCHMARK_ENABLED
+
+#if SAADC_STATS_ENABLED && !SAADC_BENCHMARK_ENABLED    //The benchmark replaces the statistics log
+SAADC_STATS_WINDOW_DEF(m_stats, 1, SAADC_STATS_WINDOW);                         //Summary of SAADC_STATS_WINDOW buffers
+#endif //SAADC_STATS_ENABLED
 
 static void rtc_handler(nrf_drv_rtc_int_type_t int_type)
 {
@@ -108,7 +313,18 @@ static void rtc_handler(nrf_drv_rtc_int_type_t int_type)
 	
     if (int_type == NRF_DRV_RTC_INT_COMPARE0)
     {
-        nrf_drv_saadc_sample();                                        //Trigger the SAADC SAMPLE task
+        if (m_saadc_calibrating)
+        {
+            m_calibration_lost_samples++;                              //The SAADC is calibrating and cannot sample, should not happen when the calibration fits in the idle gap
+        }
+        else
+        {
+            nrf_drv_saadc_sample();                                    //Trigger the SAADC SAMPLE task
+            m_samples_triggered++;
+#if SAADC_BENCHMARK_ENABLED
+            m_benchmark.trigger_count++;
+#endif
+        }
 			
         LEDS_INVERT(BSP_LED_0_MASK);                                   //Toggle LED1 to indicate SAADC sampling start
 		
@@ -136,7 +352,11 @@ static void rtc_config(void)
     err_code = nrf_drv_rtc_init(&rtc, &rtc_config, rtc_handler);                //Initialize the RTC with callback function rtc_handler. The rtc_handler must be implemented in this applicaiton. Passing NULL here for RTC configuration means that configuration will be taken from the sdk_config.h file.
     APP_ERROR_CHECK(err_code);
 
+#if SAADC_PPI_TRIGGER_ENABLED
+    err_code = nrf_drv_rtc_cc_set(&rtc, 0, rtc_ticks, false);                   //Set RTC compare value without interrupt. The COMPARE0 event is only routed to PPI, and the compare value is kept as no interrupt handler disables it
+#else
     err_code = nrf_drv_rtc_cc_set(&rtc, 0, rtc_ticks, true);                    //Set RTC compare value to trigger interrupt. Configure the interrupt frequency by adjust RTC_CC_VALUE and RTC_FREQUENCY constant in top of main.c
+#endif
     APP_ERROR_CHECK(err_code);
 
     //Power on RTC instance
@@ -144,46 +364,385 @@ static void rtc_config(void)
 }
 
 
+#if SAADC_PPI_TRIGGER_ENABLED
+static void ppi_config(void)
+{
+    uint32_t err_code;
+
+    err_code = nrf_drv_ppi_init();
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_channel);
+    APP_ERROR_CHECK(err_code);
+
+#if SAADC_LIMIT_MODE_ENABLED
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_channel,
+                                          nrf_drv_rtc_event_address_get(&rtc, NRF_RTC_EVENT_COMPARE_0),
+                                          nrf_saadc_task_address_get(NRF_SAADC_TASK_START));  //RTC COMPARE0 starts the SAADC, which is stopped between samples
+    APP_ERROR_CHECK(err_code);
+#else
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_channel,
+                                          nrf_drv_rtc_event_address_get(&rtc, NRF_RTC_EVENT_COMPARE_0),
+                                          nrf_drv_saadc_sample_task_get());                 //RTC COMPARE0 triggers the SAADC SAMPLE task
+    APP_ERROR_CHECK(err_code);
+#endif
+
+    err_code = nrf_drv_ppi_channel_fork_assign(m_ppi_channel,
+                                               nrf_drv_rtc_task_address_get(&rtc, NRF_RTC_TASK_CLEAR));  //and clears the RTC counter, so it counts rtc_ticks again
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrf_drv_ppi_channel_enable(m_ppi_channel);
+    APP_ERROR_CHECK(err_code);
+
+#if SAADC_LIMIT_MODE_ENABLED
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_channel_started);
+    APP_ERROR_CHECK(err_code);
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_channel_started,
+                                          nrf_saadc_event_address_get(NRF_SAADC_EVENT_STARTED),
+                                          nrf_saadc_task_address_get(NRF_SAADC_TASK_SAMPLE));   //Sample as soon as the buffer is latched
+    APP_ERROR_CHECK(err_code);
+    err_code = nrf_drv_ppi_channel_enable(m_ppi_channel_started);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrf_drv_ppi_channel_alloc(&m_ppi_channel_end);
+    APP_ERROR_CHECK(err_code);
+    err_code = nrf_drv_ppi_channel_assign(m_ppi_channel_end,
+                                          nrf_saadc_event_address_get(NRF_SAADC_EVENT_END),
+                                          nrf_saadc_task_address_get(NRF_SAADC_TASK_STOP));     //and stop the SAADC and its EasyDMA once the sample is in RAM
+    APP_ERROR_CHECK(err_code);
+    err_code = nrf_drv_ppi_channel_enable(m_ppi_channel_end);
+    APP_ERROR_CHECK(err_code);
+#endif
+}
+#endif
+
+
+#if SAADC_CALIBRATION_TEMP_POLICY
+//Reads the on-die temperature sensor, in 0.25 degC units. The measurement takes about 36 us, the CPU waits for it.
+//nrf_temp_read sign extends the 10-bit result for negative temperatures. The Errata 66 linearity settings of the nRF52832
+//are loaded from FICR by SystemInit, nrf_temp_init is called from main
+static int32_t temperature_read(void)
+{
+    int32_t temp;
+
+    NRF_TEMP->EVENTS_DATARDY = 0;
+    NRF_TEMP->TASKS_START = 1;
+    while (NRF_TEMP->EVENTS_DATARDY == 0);
+    NRF_TEMP->EVENTS_DATARDY = 0;
+    temp = nrf_temp_read();
+    NRF_TEMP->TASKS_STOP = 1;                                                   //Stop the analog front end, it is not powered down by the DATARDY event
+    m_temp_reads++;
+
+    return temp;
+}
+
+
+//Called from main context every SAADC_TEMP_CHECK_INTERVAL DONE events. Requests offset calibration when the die temperature
+//has changed more than SAADC_CALIBRATION_TEMP_DELTA, or the last calibration is older than SAADC_CALIBRATION_MAX_AGE DONE events
+static void saadc_calibration_policy(void)
+{
+    int32_t  temp  = temperature_read();
+    int32_t  drift = temp - m_calibration_temp;
+    uint32_t age   = m_adc_evt_counter - m_calibration_evt;
+
+    if (m_calibration_temp_valid &&
+        (drift < SAADC_CALIBRATION_TEMP_DELTA) && (drift > -SAADC_CALIBRATION_TEMP_DELTA) &&
+        (age < SAADC_CALIBRATION_MAX_AGE))
+    {
+        return;
+    }
+
+    NRF_LOG_INFO("Calibration requested, temperature %d/4 degC, drift %d/4 degC, age %u events", temp, drift, age);
+    m_calibration_temp_valid = true;
+    m_calibration_temp = temp;
+    m_calibration_evt  = m_adc_evt_counter;
+    m_saadc_calibrate  = true;                                                  //Calibrate in the idle gap before the next sample
+}
+
+
+//Compares with the fixed policy, which calibrates on DONE event 0, SAADC_CALIBRATION_INTERVAL, 2 * SAADC_CALIBRATION_INTERVAL, ...
+static void saadc_calibration_policy_log(void)
+{
+    uint32_t fixed_count = m_adc_evt_counter / SAADC_CALIBRATION_INTERVAL + 1;
+
+    NRF_LOG_INFO("Calibrations: %u (fixed interval: %u), temperature reads: %u",
+                 m_calibration_count, fixed_count, m_temp_reads);
+}
+#endif
+
+
+#if SAADC_COV_FILTER_ENABLED
+//Returns true if the sample should be logged: when it has moved by more than the deadband since the last logged sample, and the
+//last sample was logged at least SAADC_COV_MIN_INTERVAL_SAMPLES ago, or when no sample was logged for SAADC_COV_KEEPALIVE_SAMPLES
+static bool cov_filter_sample(nrf_saadc_value_t value)
+{
+    int32_t delta    = value - m_cov_last;
+    int32_t deadband = ((m_cov_last < 0 ? -m_cov_last : m_cov_last) * SAADC_COV_DEADBAND_PERMILLE) / 1000;
+
+    if(deadband < SAADC_COV_DEADBAND)
+    {
+        deadband = SAADC_COV_DEADBAND;
+    }
+
+    m_cov_samples++;
+    m_cov_silent++;
+    if((m_cov_silent >= SAADC_COV_KEEPALIVE_SAMPLES) ||
+       (((delta > deadband) || (delta < -deadband)) && (m_cov_silent >= SAADC_COV_MIN_INTERVAL_SAMPLES)))
+    {
+        m_cov_last   = value;
+        m_cov_silent = 0;
+        m_cov_reports++;
+        return true;
+    }
+    return false;
+}
+
+
+//Logs the reduction every SAADC_COV_STATS_INTERVAL samples
+static void cov_filter_stats(void)
+{
+    if(m_cov_samples >= SAADC_COV_STATS_INTERVAL)
+    {
+        NRF_LOG_INFO("Change-of-value: %u of %u samples logged", m_cov_reports, m_cov_samples);
+        m_cov_samples = 0;
+        m_cov_reports = 0;
+    }
+}
+#endif
+
+
+//Called on every NRF_DRV_SAADC_EVT_DONE event, or every heartbeat in limit mode. Sets the flags for the temperature check or
+//calibration, which run in main context
+static void saadc_maintenance_schedule(void)
+{
+#if SAADC_CALIBRATION_TEMP_POLICY
+    if((m_adc_evt_counter % SAADC_TEMP_CHECK_INTERVAL) == 0)                    //Evaluate if the die temperature should be checked. The calibration decision is made in main context, see saadc_calibration_policy
+    {
+        m_temp_check = true;
+    }
+#else
+    if((m_adc_evt_counter % SAADC_CALIBRATION_INTERVAL) == 0)                   //Evaluate if offset calibration should be performed. Configure the SAADC_CALIBRATION_INTERVAL constant to change the calibration frequency
+    {
+        m_saadc_calibrate = true;                                               // Set flag to trigger calibration in main context, in the idle gap before the next sample
+    }
+#endif
+}
+
+
+#if SAADC_LIMIT_MODE_ENABLED
+//RTC1 COMPARE0, once per SAADC_LIMIT_HEARTBEAT_SAMPLES samples. Logs the last sample and the number of wakeups per hour,
+//compared with the RTC interrupt mode, where the CPU wakes up in rtc_handler and saadc_callback for every sample
+static void heartbeat_rtc_handler(nrf_drv_rtc_int_type_t int_type)
+{
+    uint32_t heartbeat_ms = SAADC_LIMIT_HEARTBEAT_SAMPLES * SAADC_SAMPLE_INTERVAL_MS;
+    uint32_t wakeups_per_hour = (1 + m_limit_events) * (3600000 / heartbeat_ms);
+    ret_code_t err_code;
+
+    if (int_type != NRF_DRV_RTC_INT_COMPARE0)
+    {
+        return;
+    }
+
+    err_code = nrf_drv_rtc_cc_set(&m_heartbeat_rtc, 0, SAADC_LIMIT_HEARTBEAT_SAMPLES * rtc_ticks, true);
+    APP_ERROR_CHECK(err_code);
+    nrf_drv_rtc_counter_clear(&m_heartbeat_rtc);
+
+    NRF_LOG_INFO("Heartbeat: last sample %d mV, limit events %u, wakeups/h %u (RTC interrupt mode: %u)",
+                 saadc_convert_value(&m_convert, m_buffer_pool[0][0]),                  //Written by EasyDMA on every sample, see saadc_init
+                 m_limit_events,
+                 wakeups_per_hour,
+                 2 * (3600000 / SAADC_SAMPLE_INTERVAL_MS));
+    m_limit_events = 0;
+
+    saadc_maintenance_schedule();
+    m_adc_evt_counter++;
+}
+
+
+static void heartbeat_rtc_config(void)
+{
+    ret_code_t err_code;
+    nrf_drv_rtc_config_t rtc_config = NRF_DRV_RTC_DEFAULT_CONFIG;
+
+    rtc_config.prescaler = RTC_FREQ_TO_PRESCALER(RTC_FREQUENCY);                //Same tick as RTC2, so the heartbeat stays aligned to the samples
+    err_code = nrf_drv_rtc_init(&m_heartbeat_rtc, &rtc_config, heartbeat_rtc_handler);
+    APP_ERROR_CHECK(err_code);
+
+    err_code = nrf_drv_rtc_cc_set(&m_heartbeat_rtc, 0, SAADC_LIMIT_HEARTBEAT_SAMPLES * rtc_ticks, true);
+    APP_ERROR_CHECK(err_code);
+
+    nrf_drv_rtc_enable(&m_heartbeat_rtc);
+}
+#endif
+
+
 void saadc_callback(nrf_drv_saadc_evt_t const * p_event)
 {
     ret_code_t err_code;
+#if SAADC_BENCHMARK_ENABLED
+    uint32_t start_cycles = DWT->CYCCNT;
+#endif
+
+#if SAADC_LIMIT_MODE_ENABLED
+    if (p_event->type == NRF_DRV_SAADC_EVT_DONE)
+    {
+        return;                                                                 //The END interrupt is disabled in limit mode. The driver only reports the END event of the last sample when it handles a limit event, see heartbeat_rtc_handler
+    }
+#endif
+
     if (p_event->type == NRF_DRV_SAADC_EVT_DONE)                                //Capture offset calibration complete event
     {
 			
         LEDS_INVERT(BSP_LED_1_MASK);                                            //Toggle LED2 to indicate SAADC buffer full		
 
-        if((m_adc_evt_counter % SAADC_CALIBRATION_INTERVAL) == 0)               //Evaluate if offset calibration should be performed. Configure the SAADC_CALIBRATION_INTERVAL constant to change the calibration frequency
+        m_samples_delivered += p_event->data.done.size;
+#if SAADC_PPI_TRIGGER_ENABLED
+        nrf_rtc_event_clear(rtc.p_reg, NRF_RTC_EVENT_COMPARE_0);               //Only routed to PPI. Pending again when the next sample has been triggered, see saadc_calibration_window_open
+#endif
+
+        saadc_maintenance_schedule();
+
+#if SAADC_BENCHMARK_ENABLED
+        m_benchmark.done_count++;
+        m_benchmark.sample_count += p_event->data.done.size;
+        m_benchmark.sample_total += p_event->data.done.size;
+#elif SAADC_STATS_ENABLED
+        saadc_stats_window_add(&m_stats, p_event->data.done.p_buffer, p_event->data.done.size);   //Log a summary every SAADC_STATS_WINDOW buffers
+#elif SAADC_COV_FILTER_ENABLED
+        for (int i = 0; i < p_event->data.done.size; i++)
         {
-            m_saadc_calibrate = true;                                           // Set flag to trigger calibration in main context when SAADC is stopped
+            if(cov_filter_sample(p_event->data.done.p_buffer[i]))
+            {
+                NRF_LOG_INFO("ADC event number: %d, sample %d: %d mV", (int)m_adc_evt_counter, i, saadc_convert_value(&m_convert, p_event->data.done.p_buffer[i]));   //Only print samples that have changed, and the keep-alive
+            }
         }
-        
+        cov_filter_stats();
+#else
         NRF_LOG_INFO("ADC event number: %d\r\n",(int)m_adc_evt_counter);        //Print the event number on UART
 
         for (int i = 0; i < p_event->data.done.size; i++)
         {
-            NRF_LOG_INFO("%d\r\n", p_event->data.done.p_buffer[i]);             //Print the SAADC result on UART
+            NRF_LOG_INFO("%d (%d mV)\r\n", p_event->data.done.p_buffer[i], saadc_convert_value(&m_convert, p_event->data.done.p_buffer[i]));   //Print the SAADC result on UART
         }     
+#endif
         
-        if(m_saadc_calibrate == false)
+        if(m_saadc_calibrating == false)
         {
             err_code = nrf_drv_saadc_buffer_convert(p_event->data.done.p_buffer, SAADC_SAMPLES_IN_BUFFER);             //Set buffer so the SAADC can write to it again. 
             APP_ERROR_CHECK(err_code);
         }
         
         m_adc_evt_counter++;
+
+#if !SAADC_PPI_TRIGGER_ENABLED
+        if(m_saadc_calibrating == false)
+        {
+            saadc_power_idle();                                                 //The SAADC is stopped until nrf_drv_saadc_sample() starts it again. Power it down on devices affected by Errata 212
+        }
+#endif
   
     }
+#if SAADC_LIMIT_MODE_ENABLED
+    else if (p_event->type == NRF_DRV_SAADC_EVT_LIMIT)
+    {
+        m_limit_events++;
+        NRF_LOG_INFO("CH%u out of band, sample %s %d",
+                     p_event->data.limit.channel,
+                     (p_event->data.limit.limit_type == NRF_SAADC_LIMIT_LOW) ? "below" : "above",
+                     (p_event->data.limit.limit_type == NRF_SAADC_LIMIT_LOW) ? SAADC_LIMIT_LOW : SAADC_LIMIT_HIGH);
+    }
+#endif
     else if (p_event->type == NRF_DRV_SAADC_EVT_CALIBRATEDONE)
     {
         LEDS_INVERT(BSP_LED_2_MASK);                                                                    //Toggle LED3 to indicate SAADC calibration complete
         
+#if !SAADC_LIMIT_MODE_ENABLED                                                                           //In limit mode the buffer is not owned by the driver, and RESULT.PTR is kept through calibration
         err_code = nrf_drv_saadc_buffer_convert(m_buffer_pool[0], SAADC_SAMPLES_IN_BUFFER);             //Set buffer so the SAADC can write to it again. 
         APP_ERROR_CHECK(err_code);
-        err_code = nrf_drv_saadc_buffer_convert(m_buffer_pool[1], SAADC_SAMPLES_IN_BUFFER);             //Need to setup both buffers, as they were both removed with the call to nrf_drv_saadc_abort before calibration.
+        err_code = nrf_drv_saadc_buffer_convert(m_buffer_pool[1], SAADC_SAMPLES_IN_BUFFER);             //Need to setup both buffers, as they were both removed with the call to nrf_drv_saadc_abort before calibration. They were empty, so no samples were dropped.
         APP_ERROR_CHECK(err_code);
-        
-        NRF_LOG_INFO("SAADC calibration complete ! \r\n");                                              //Print on UART
+#endif
+
+#if SAADC_PPI_TRIGGER_ENABLED
+        if (nrf_drv_rtc_counter_get(&rtc) < m_calibration_rtc_start)                                    //The counter was cleared by a sample trigger during calibration
+        {
+            m_calibration_lost_samples++;
+        }
+#endif
+        m_saadc_calibrating = false;
+        m_calibration_count++;
+
+#if !SAADC_PPI_TRIGGER_ENABLED
+        saadc_power_idle();                                                                             //Calibration also leaves the SAADC powered on devices affected by Errata 212
+#endif
+
+#if SAADC_BENCHMARK_ENABLED
+        uint32_t calibration_cycles = DWT->CYCCNT - m_benchmark.calibration_start_cycles;
+        if (calibration_cycles > m_benchmark.calibration_cycles_max)
+        {
+            m_benchmark.calibration_cycles_max = calibration_cycles;
+        }
+        NRF_LOG_INFO("SAADC calibration complete in %u us (max %u us), lost samples: %u",
+                     calibration_cycles / (SystemCoreClock / 1000000),
+                     m_benchmark.calibration_cycles_max / (SystemCoreClock / 1000000),
+                     m_calibration_lost_samples);
+#else
+        NRF_LOG_INFO("SAADC calibration complete, lost samples: %u", m_calibration_lost_samples);     //Print on UART
+#endif
+#if SAADC_CALIBRATION_TEMP_POLICY
+        saadc_calibration_policy_log();
+#endif
+    }
+
+#if SAADC_BENCHMARK_ENABLED
+    benchmark_handler_exit(start_cycles);
+#endif
+}
+
+
+//Returns true when calibration can start without dropping samples: no sample has been triggered since the last
+//NRF_DRV_SAADC_EVT_DONE event, so the queued buffers are empty, and the next trigger is at least SAADC_CALIBRATION_GUARD_TICKS away
+static bool saadc_calibration_window_open(void)
+{
+#if SAADC_LIMIT_MODE_ENABLED
+    bool buffers_empty = (nrf_drv_rtc_counter_get(&rtc) > 0);                  //The SAADC is stopped through PPI after each sample, long before the first RTC tick has passed
+#elif SAADC_PPI_TRIGGER_ENABLED
+    bool buffers_empty = !nrf_rtc_event_pending(rtc.p_reg, NRF_RTC_EVENT_COMPARE_0);
+#else
+    bool buffers_empty = (m_samples_triggered == m_samples_delivered);
+#endif
+
+    return buffers_empty && (nrf_drv_rtc_counter_get(&rtc) + SAADC_CALIBRATION_GUARD_TICKS < rtc_ticks);
+}
+
+
+//Runs offset calibration in the idle gap between two sample triggers. Postponed until the window is open
+static void saadc_calibrate(void)
+{
+    bool window_open;
+
+    CRITICAL_REGION_ENTER();
+    window_open = saadc_calibration_window_open();
+    if (window_open)
+    {
+        m_saadc_calibrating = true;
+        m_saadc_calibrate = false;
+        m_calibration_rtc_start = nrf_drv_rtc_counter_get(&rtc);
+    }
+    CRITICAL_REGION_EXIT();
+
+    if (!window_open)
+    {
+        return;
     }
+
+#if SAADC_BENCHMARK_ENABLED
+    m_benchmark.calibration_start_cycles = DWT->CYCCNT;
+#endif
+    nrf_drv_saadc_abort();                                  //Calibration cannot be run if SAADC is busy. Only removes the two queued buffers, which are empty
+    NRF_LOG_INFO("SAADC calibration starting...");          //Print on UART
+
+    while(nrf_drv_saadc_calibrate_offset() != NRF_SUCCESS); //Trigger calibration task
 }
 
 
@@ -195,7 +754,11 @@ void saadc_init(void)
 
 	
     //Configure SAADC
+#if SAADC_PPI_TRIGGER_ENABLED
+    saadc_config.low_power_mode = false;                                                  //Disable low power mode. In low power mode the driver triggers START right before each sample from nrf_drv_saadc_sample(), which a SAMPLE task from PPI would bypass.
+#else
     saadc_config.low_power_mode = true;                                                   //Enable low power mode.
+#endif
     saadc_config.resolution = NRF_SAADC_RESOLUTION_12BIT;                                 //Set SAADC resolution to 12-bit. This will make the SAADC output values from 0 (when input voltage is 0V) to 2^12=4096 (when input voltage is 3.6V for channel gain setting of 1/6).
     saadc_config.oversample = SAADC_OVERSAMPLE;                                           //Set oversample to 4x. This will make the SAADC output a single averaged value when the SAMPLE task is triggered 4 times.
     saadc_config.interrupt_priority = APP_IRQ_PRIORITY_LOW;                               //Set SAADC interrupt to low priority.
@@ -223,11 +786,22 @@ void saadc_init(void)
     err_code = nrf_drv_saadc_channel_init(0, &channel_config);                            //Initialize SAADC channel 0 with the channel configuration
     APP_ERROR_CHECK(err_code);
 
+    saadc_convert_init(&m_convert, &channel_config, saadc_config.resolution, 0, SAADC_CONVERT_UNIT_MV);   //Derive the mV conversion from the gain and reference. The supply voltage is not used with the internal reference
+
+#if SAADC_LIMIT_MODE_ENABLED
+    nrf_drv_saadc_limits_set(0, SAADC_LIMIT_LOW, SAADC_LIMIT_HIGH);                       //Generate NRF_DRV_SAADC_EVT_LIMIT for samples of channel 0 outside the band. In-band samples only fill the buffer
+#endif
+
+#if SAADC_LIMIT_MODE_ENABLED
+    nrf_saadc_int_disable(NRF_SAADC_INT_END);                                             //The SAADC is started and stopped through PPI for every sample, see ppi_config. Only the limit events wake up the CPU
+    nrf_saadc_buffer_init(m_buffer_pool[0], SAADC_SAMPLES_IN_BUFFER);                     //Every START latches this buffer again, so it always holds the last sample
+#else
     err_code = nrf_drv_saadc_buffer_convert(m_buffer_pool[0],SAADC_SAMPLES_IN_BUFFER);    //Set SAADC buffer 1. The SAADC will start to write to this buffer
     APP_ERROR_CHECK(err_code);
     
     err_code = nrf_drv_saadc_buffer_convert(m_buffer_pool[1],SAADC_SAMPLES_IN_BUFFER);    //Set SAADC buffer 2. The SAADC will write to this buffer when buffer 1 is full. This will give the applicaiton time to process data in buffer 1.
     APP_ERROR_CHECK(err_code);
+#endif
 
 }
 
@@ -247,23 +821,47 @@ int main(void)
     NRF_LOG_DEFAULT_BACKENDS_INIT();
     NRF_LOG_INFO("SAADC Low Power Example.");	
 
+#if SAADC_BENCHMARK_ENABLED
+    benchmark_init();
+#endif
+
     lfclk_config();                                  //Configure low frequency 32kHz clock
     rtc_config();                                    //Configure RTC. The RTC will generate periodic interrupts. Requires 32kHz clock to operate.
 
     saadc_init();                                    //Initialize and start SAADC
+#if SAADC_PPI_TRIGGER_ENABLED
+    ppi_config();                                    //Connect RTC COMPARE0 to SAADC SAMPLE and RTC CLEAR
+#if SAADC_BENCHMARK_ENABLED
+    benchmark_trigger_counter_init();                //Count the RTC COMPARE0 events in TIMER1
+#endif
+#endif
+#if SAADC_LIMIT_MODE_ENABLED
+    heartbeat_rtc_config();                          //Wake up once per SAADC_LIMIT_HEARTBEAT_SAMPLES samples
+#endif
+#if SAADC_CALIBRATION_TEMP_POLICY
+    nrf_temp_init();                                 //Prepare the TEMP peripheral for temperature_read
+#endif
     
     while (1)
     {
+#if SAADC_CALIBRATION_TEMP_POLICY
+        if(m_temp_check == true)
+        {
+            m_temp_check = false;
+            saadc_calibration_policy();                      //Read the die temperature and decide whether to calibrate
+        }
+#endif
         if(m_saadc_calibrate == true)
         {
-            nrf_drv_saadc_abort();                                  // Abort all ongoing conversions. Calibration cannot be run if SAADC is busy
-            NRF_LOG_INFO("SAADC calibration starting...");    //Print on UART
-
-            while(nrf_drv_saadc_calibrate_offset() != NRF_SUCCESS); //Trigger calibration task
-            m_saadc_calibrate = false;
+            saadc_calibrate();                               //Calibrate in the idle gap before the next sample trigger
         }
+#if SAADC_BENCHMARK_ENABLED
+        benchmark_report();
+        while(NRF_LOG_PROCESS() != NRF_SUCCESS);
+#else
         while(NRF_LOG_PROCESS() != NRF_SUCCESS);
         nrf_pwr_mgmt_run();
+#endif
         
     }
 }
@@ -0,0 +1,235 @@
+/**
+ * Copyright (c) 2014 - 2017, Nordic Semiconductor ASA
+ * 
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ * 
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ * 
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ * 
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ */
+/**
+ * Block statistics of SAADC samples: min, max, mean, RMS and variance of each channel.
+ *
+ * Each sample is read once and the accumulators are kept in registers, so a buffer costs a load, two compares and
+ * two multiply-accumulates per sample. The sum is 32-bit, so at most 65536 samples per channel can be added between
+ * two resets. saadc_stats_log() computes the summary in integer math and logs it in raw SAADC codes.
+ *
+ * A window, defined with SAADC_STATS_WINDOW_DEF(), adds a number of buffers and logs one summary for all of them.
+ * saadc_stats_window_add() adds a buffer of interleaved scans. To add the channels from elsewhere, e.g. from a
+ * de-interleaved copy, call saadc_stats_window_begin(), saadc_stats_add() for each channel and
+ * saadc_stats_window_end().
+ */
+#ifndef SAADC_STATS_H__
+#define SAADC_STATS_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "nrf_saadc.h"
+#include "nrf_log.h"
+
+// Statistics of one channel
+typedef struct
+{
+    int16_t  min;
+    int16_t  max;
+    int32_t  sum;
+    uint64_t sum_sq;
+    uint32_t count;
+} saadc_stats_t;
+
+// Statistics of the channels of a scan, summarized every window buffers
+typedef struct
+{
+    saadc_stats_t * p_channels;
+    uint32_t        channels;
+    uint32_t        window;
+    uint32_t        buffers;            // Added since the last summary
+} saadc_stats_window_t;
+
+// Defines a window of name for channel_count channels, summarized every window_buffers buffers
+#define SAADC_STATS_WINDOW_DEF(name, channel_count, window_buffers)     \
+    static saadc_stats_t name##_channels[channel_count];                \
+    static saadc_stats_window_t name =                                  \
+    {                                                                   \
+        .p_channels = name##_channels,                                  \
+        .channels   = channel_count,                                    \
+        .window     = window_buffers,                                   \
+    }
+
+
+static inline void saadc_stats_reset(saadc_stats_t * p_stats, uint32_t channels)
+{
+    for (uint32_t ch = 0; ch < channels; ch++)
+    {
+        p_stats[ch].min    = INT16_MAX;
+        p_stats[ch].max    = INT16_MIN;
+        p_stats[ch].sum    = 0;
+        p_stats[ch].sum_sq = 0;
+        p_stats[ch].count  = 0;
+    }
+}
+
+
+// Adds count samples of one channel, sample n is p_samples[n * stride]
+static inline void saadc_stats_add(saadc_stats_t           * p_stats,
+                                   nrf_saadc_value_t const * p_samples,
+                                   uint32_t                  stride,
+                                   uint32_t                  count)
+{
+    // Work on local copies, so the accumulators stay in registers
+    int16_t  min    = p_stats->min;
+    int16_t  max    = p_stats->max;
+    int32_t  sum    = p_stats->sum;
+    uint64_t sum_sq = p_stats->sum_sq;
+
+    for (uint32_t n = 0; n < count; n++)
+    {
+        int16_t value = *p_samples;
+        if (value < min)
+        {
+            min = value;
+        }
+        if (value > max)
+        {
+            max = value;
+        }
+        sum       += value;
+        sum_sq    += (uint32_t)((int32_t)value * value);
+        p_samples += stride;
+    }
+
+    p_stats->min    = min;
+    p_stats->max    = max;
+    p_stats->sum    = sum;
+    p_stats->sum_sq = sum_sq;
+    p_stats->count += count;
+}
+
+
+// Adds a buffer of interleaved samples, sample i belongs to channel i % channels. size must be a multiple of channels
+static inline void saadc_stats_update(saadc_stats_t           * p_stats,
+                                      uint32_t                  channels,
+                                      nrf_saadc_value_t const * p_buffer,
+                                      uint32_t                  size)
+{
+    for (uint32_t ch = 0; ch < channels; ch++)
+    {
+        saadc_stats_add(&p_stats[ch], &p_buffer[ch], channels, size / channels);
+    }
+}
+
+
+// Integer square root, rounded down
+static inline uint32_t saadc_stats_isqrt(uint32_t value)
+{
+    uint32_t root = 0;
+    uint32_t bit  = 1UL << 30;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root   = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+
+// Logs min, max, mean, RMS and variance of each channel, in raw SAADC codes
+static inline void saadc_stats_log(saadc_stats_t const * p_stats, uint32_t channels)
+{
+    NRF_LOG_INFO("Statistics of %u samples per channel:", p_stats[0].count);
+    for (uint32_t ch = 0; ch < channels; ch++)
+    {
+        saadc_stats_t const * p = &p_stats[ch];
+        if (p->count == 0)
+        {
+            continue;
+        }
+
+        int32_t mean     = p->sum / (int32_t)p->count;
+        int64_t variance = ((int64_t)p->sum_sq - ((int64_t)p->sum * p->sum) / p->count) / p->count;
+
+        NRF_LOG_INFO("CH%u: min %d, max %d, mean %d, rms %u, var %u",
+                     ch, p->min, p->max, mean,
+                     saadc_stats_isqrt((uint32_t)(p->sum_sq / p->count)),
+                     (uint32_t)(variance > 0 ? variance : 0));
+    }
+}
+
+
+// Starts a buffer. Restarts the statistics on the first buffer of the window, and returns the channel statistics
+static inline saadc_stats_t * saadc_stats_window_begin(saadc_stats_window_t * p_window)
+{
+    if (p_window->buffers == 0)
+    {
+        saadc_stats_reset(p_window->p_channels, p_window->channels);
+    }
+    return p_window->p_channels;
+}
+
+
+// Ends a buffer. After the last buffer of the window the summary is logged and true returned
+static inline bool saadc_stats_window_end(saadc_stats_window_t * p_window)
+{
+    if (++p_window->buffers < p_window->window)
+    {
+        return false;
+    }
+    saadc_stats_log(p_window->p_channels, p_window->channels);
+    p_window->buffers = 0;
+    return true;
+}
+
+
+// Adds a buffer of interleaved scans to the window, see saadc_stats_update(). Returns true when a summary was logged
+static inline bool saadc_stats_window_add(saadc_stats_window_t    * p_window,
+                                          nrf_saadc_value_t const * p_buffer,
+                                          uint32_t                  size)
+{
+    saadc_stats_update(saadc_stats_window_begin(p_window), p_window->channels, p_buffer, size);
+    return saadc_stats_window_end(p_window);
+}
+
+#endif // SAADC_STATS_H__
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""Writes the input traces in host/traces, one value in mV per line at 1 Hz, for HOST_SIM_AIN<n>_TRACE.
+
+The traces model slow sensors on a 3 V supply, with the noise of a real front end included, as the host simulator
+adds no noise to played back traces:
+
+    temperature.txt  NTC divider, a slow drift of the room temperature
+    battery.txt      Supply divider, a slow discharge with a 2 s dip under radio load every 5 minutes
+    switch.txt       Contact input, toggling at random times, a few times per hour
+    light.txt        Photodiode, the daylight varying with the clouds, the noisiest of the four
+
+    python3 tools/make_traces.py [seconds]
+"""
+import math
+import os
+import random
+import sys
+
+TRACES_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'host', 'traces')
+
+
+def temperature(t, rng):
+    return 1400.0 + 40.0 * math.sin(2.0 * math.pi * t / 3600.0) + rng.gauss(0.0, 1.5)
+
+
+def battery(t, rng):
+    dip = 100.0 if t % 300 < 2 else 0.0
+    return 2900.0 - 30.0 * t / 3600.0 - dip + rng.gauss(0.0, 1.0)
+
+
+def make_switch(seconds, rng):
+    toggles = sorted(rng.uniform(0, seconds) for _ in range(max(1, seconds // 600)))
+
+    def switch(t, rng):
+        closed = sum(1 for toggle in toggles if toggle <= t) % 2
+        return (2800.0 if closed else 0.0) + rng.gauss(0.0, 2.0)
+    return switch
+
+
+def light(t, rng):
+    clouds = 0.6 * math.sin(2.0 * math.pi * t / 900.0) + 0.4 * math.sin(2.0 * math.pi * t / 240.0)
+    return 800.0 + 300.0 * clouds + rng.gauss(0.0, 4.0)
+
+
+def main():
+    seconds = int(sys.argv[1]) if len(sys.argv) > 1 else 3600
+    rng = random.Random(1)
+    traces = [('temperature', temperature), ('battery', battery), ('switch', make_switch(seconds, rng)),
+              ('light', light)]
+
+    os.makedirs(TRACES_DIR, exist_ok=True)
+    for name, model in traces:
+        with open(os.path.join(TRACES_DIR, name + '.txt'), 'w') as f:
+            f.write('# %s, mV at 1 Hz, written by tools/make_traces.py\n' % name)
+            for t in range(seconds):
+                f.write('%.1f\n' % model(t, rng))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Decoder of the binary NUS frames of ble_app_uart__saadc_timer_driven__scan_mode.
+
+Reads notifications as hex, one per line, and prints one CSV line per scan: the frame sequence number followed by
+the samples of the channels in the channel mask. Spaces, colons, dashes and a 0x prefix in the hex are ignored, so
+lines copied from nRF Connect or a sniffer can be used as they are. The frame layout is described in the README of
+the example.
+
+    python3 tools/nus_decode.py notifications.txt > samples.csv
+"""
+import argparse
+import csv
+import struct
+import sys
+
+FORMAT_RAW16 = 0
+FORMAT_DELTA_RICE = 1
+FORMAT_PACKED = 2
+
+HEADER_LEN = 4
+RICE_ESCAPE = 16
+RICE_A_INIT = 8
+RICE_RESET = 32
+
+
+class BitReader:
+    """Reads a bit stream, most significant bit first."""
+
+    def __init__(self, data):
+        self.value = int.from_bytes(data, 'big')
+        self.left = len(data) * 8
+
+    def read(self, bits):
+        if bits > self.left:
+            raise ValueError('frame ends in the middle of a sample')
+        self.left -= bits
+        return (self.value >> self.left) & ((1 << bits) - 1)
+
+
+def to_int16(value):
+    return value - 0x10000 if value & 0x8000 else value
+
+
+def decode_raw16(payload, channels):
+    count = len(payload) // 2
+    values = struct.unpack_from('<%dh' % count, payload)
+    return [list(values[i:i + channels]) for i in range(0, count - count % channels, channels)]
+
+
+def decode_delta_rice(payload, channels):
+    count = payload[0]
+    reader = BitReader(payload[1:])
+    prev = [to_int16(reader.read(16)) for _ in range(channels)]
+    scans = [list(prev)] if count > 0 else []
+    a = [RICE_A_INIT] * channels
+    n = [1] * channels
+    for _ in range(count - 1):
+        for ch in range(channels):
+            k = 0
+            while k < 15 and (n[ch] << k) < a[ch]:
+                k += 1
+            q = 0
+            while q < RICE_ESCAPE and reader.read(1):
+                q += 1
+            if q < RICE_ESCAPE:
+                z = (q << k) | reader.read(k)
+            else:
+                z = reader.read(16)
+            delta = (z >> 1) ^ -(z & 1)
+            prev[ch] = to_int16((prev[ch] + delta) & 0xFFFF)
+            a[ch] += z
+            n[ch] += 1
+            if n[ch] == RICE_RESET:
+                a[ch] >>= 1
+                n[ch] >>= 1
+        scans.append(list(prev))
+    return scans
+
+
+def decode_packed(payload, channels):
+    bits = payload[0]
+    if not 8 <= bits <= 16:
+        raise ValueError('%d bits per sample' % bits)
+    reader = BitReader(payload[1:])
+    count = reader.left // bits
+    samples = [reader.read(bits) for _ in range(count - count % channels)]
+    return [samples[i:i + channels] for i in range(0, len(samples), channels)]
+
+
+DECODERS = {
+    FORMAT_RAW16: decode_raw16,
+    FORMAT_DELTA_RICE: decode_delta_rice,
+    FORMAT_PACKED: decode_packed,
+}
+
+
+def decode_frame(frame):
+    """Decodes one frame. Returns (sequence number, channel mask, list of scans)."""
+    if len(frame) < HEADER_LEN:
+        raise ValueError('frame shorter than the header')
+    seq, mask, fmt = struct.unpack_from('<HBB', frame)
+    if fmt not in DECODERS:
+        raise ValueError('unknown sample format %d' % fmt)
+    channels = bin(mask).count('1')
+    if channels == 0:
+        raise ValueError('empty channel mask')
+    return seq, mask, DECODERS[fmt](frame[HEADER_LEN:], channels)
+
+
+def parse_hex(line):
+    text = line.strip()
+    if text.lower().startswith('0x'):
+        text = text[2:]
+    for separator in ' :-':
+        text = text.replace(separator, '')
+    return bytes.fromhex(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('input', nargs='?', type=argparse.FileType('r'), default=sys.stdin,
+                        help='notifications in hex, one per line (default: stdin)')
+    args = parser.parse_args()
+
+    writer = csv.writer(sys.stdout, lineterminator='\n')
+    header_mask = None
+    for number, line in enumerate(args.input, 1):
+        if not line.strip():
+            continue
+        try:
+            seq, mask, scans = decode_frame(parse_hex(line))
+        except ValueError as error:
+            sys.exit('line %d: %s' % (number, error))
+        if mask != header_mask:
+            writer.writerow(['seq'] + ['ch%d' % ch for ch in range(8) if mask & (1 << ch)])
+            header_mask = mask
+        for scan in scans:
+            writer.writerow([seq] + scan)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""Test of the calibration commands of ble_app_uart__saadc_timer_driven__scan_mode, run by ctest in the host build.
+
+Writes malformed and out of range "cal lo" commands to the NUS RX characteristic and checks the reply to each one.
+Then captures two point calibrations on a stepped input, one with an offset out of range that must be rejected, and
+one that must be accepted. Then sends "cal save" faster than the flash can keep up with, until the flash is full and
+garbage collection is queued while the FDS queue is full, and checks that the example keeps running.
+
+    python3 tools/test_cal_commands.py <host executable>
+"""
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+# Command and the reply expected to it
+PARSE_CASES = [
+    ('cal lo 9 100', 'CAL: invalid channel'),
+    ('cal lo 256 100', 'CAL: invalid channel'),
+    ('cal lo 4294967296 100', 'CAL: invalid channel'),
+    ('cal lo -1 100', 'CAL: invalid channel'),
+    ('cal lo x 100', 'CAL: invalid channel'),
+    ('cal lo', 'CAL: use cal lo|hi'),
+    ('cal lo 0', 'CAL: invalid voltage'),
+    ('cal lo 0 abc', 'CAL: invalid voltage'),
+    ('cal lo 0 -5', 'CAL: invalid voltage'),
+    ('cal lo 0 99999', 'CAL: invalid voltage'),
+    ('cal hi 1 4294967396', 'CAL: invalid voltage'),
+    ('cal lo 0 100 200', 'CAL: invalid voltage'),
+    ('cal lo 3 500', 'CAL CH3: low point 500 mV, raw '),
+]
+SAVES = 1500
+
+# AIN4 (CH0) steps between STEP_MV[0] and STEP_MV[1] every STEP_S seconds, a command is sent in the middle of each step.
+# The first calibration claims 1000 mV more than the input, the offset of 1365 codes at 12 bits is out of range. The
+# low point of the second one is first combined with the previous high point, which gives a gain out of range.
+# Command and a regular expression for the reply, an empty command for a reply to the previous capture
+STEP_MV = (500, 1000)
+STEP_S = 10
+OFFSET_CASES = [
+    ('cal lo 0 1500', r'CAL CH0: low point 1500 mV, raw '),
+    ('cal hi 0 2000', r'CAL CH0: high point 2000 mV, raw '),
+    ('', r'CAL CH0: offset -1[0-9]{3} out of range'),
+    ('cal lo 0 700', r'CAL CH0: low point 700 mV, raw '),
+    ('', r'CAL CH0: gain [0-9]+/32768 out of range'),
+    ('cal hi 0 1200', r'CAL CH0: high point 1200 mV, raw '),
+    ('', r'CAL CH0: gain 3[0-9]{4}/32768, offset -2[0-9]{2}, send'),
+]
+
+
+def run(executable, seconds, commands, **settings):
+    env = dict(os.environ, HOST_SIM_SECONDS=str(seconds), HOST_SIM_LOG='0', HOST_SIM_NUS_RX='|'.join(commands),
+               **settings)
+    result = subprocess.run([executable], env=env, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    output = result.stdout.decode('ascii', 'replace')
+    if result.returncode != 0:
+        sys.exit('%s\nexit code %d' % (output, result.returncode))
+    return [line.strip() for line in output.splitlines() if line.startswith('CAL')]
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    executable = sys.argv[1]
+
+    # The last command captures CAL_CAPTURE_SCANS buffers, 4 s at the default sample rate
+    replies = run(executable, len(PARSE_CASES) + 10, [command for command, _ in PARSE_CASES])
+    if len(replies) != len(PARSE_CASES):
+        sys.exit('%d replies to %d commands:\n%s' % (len(replies), len(PARSE_CASES), '\n'.join(replies)))
+    for (command, expected), reply in zip(PARSE_CASES, replies):
+        if not reply.startswith(expected):
+            sys.exit('"%s": replied "%s", expected "%s"' % (command, reply, expected))
+
+    commands = [command for command, _ in OFFSET_CASES if command]
+    with tempfile.TemporaryDirectory() as tmp:
+        trace = os.path.join(tmp, 'steps.txt')
+        with open(trace, 'w') as f:
+            for step in range(len(commands)):
+                f.write(('%d\n' % STEP_MV[step % 2]) * STEP_S)
+        replies = run(executable, len(commands) * STEP_S, commands, HOST_SIM_AIN4_TRACE=trace,
+                      HOST_SIM_TRACE_RATE='1', HOST_SIM_NUS_RX_MS=str(STEP_S * 1000 // 2 - 1000),
+                      HOST_SIM_NUS_RX_INTERVAL_MS=str(STEP_S * 1000))
+    if len(replies) != len(OFFSET_CASES) or \
+            any(not re.match(expected, reply) for (_, expected), reply in zip(OFFSET_CASES, replies)):
+        sys.exit('offset range, replied:\n%s\nexpected:\n%s' % ('\n'.join(replies),
+                                                                '\n'.join(e for _, e in OFFSET_CASES)))
+
+    # One command per connection event, with each FDS operation taking 100 ms
+    replies = run(executable, 60, ['cal save'] * SAVES, HOST_SIM_NUS_RX_INTERVAL_MS='1', HOST_SIM_FDS_OP_MS='100')
+    counts = {reply: replies.count(reply) for reply in set(replies)}
+    for reply in ('CAL: saved', 'CAL: flash busy, save again', 'CAL: flash full, garbage collection started, save again'):
+        if reply not in counts:
+            sys.exit('no "%s" reply to %d saves' % (reply, SAVES))
+
+    print('%d commands parsed, %d saves: %s' % (len(PARSE_CASES), SAVES,
+                                                ', '.join('%d "%s"' % (n, r) for r, n in sorted(counts.items()))))
+
+
+if __name__ == '__main__':
+    main()
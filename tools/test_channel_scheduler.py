@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""Per-channel rate test of nrfx_saadc_multi_channel_ppi with SAADC_CHANNEL_SCHEDULER_ENABLED, run by ctest.
+
+Gives every input a different constant voltage and runs the example for the given virtual time. Checks that channel
+n delivers a sample at every SAADC_CHANNEL_TICK_DIVIDER[n]-th timer tick and at no other tick, and that each sample
+holds the voltage of its own input, so the samples of a scan with only some channels enabled are not shifted.
+
+    python3 tools/test_channel_scheduler.py <host executable> [virtual seconds]
+"""
+import os
+import re
+import subprocess
+import sys
+
+# Scheduler settings, as in main.c. AIN n is sampled on channel n
+SAMPLING_RATE_MS = 1000
+TICK_DIVIDER = [1, 1, 1, 1, 10, 100]
+VDD_MV = 3000
+RESOLUTION_BITS = 14
+
+# Input n is held at INPUT_MV_STEP * (n + 1), the samples must be within VALUE_TOLERANCE codes of it
+INPUT_MV_STEP = 400
+VALUE_TOLERANCE = 2
+
+SAMPLE_LINE = re.compile(r'<info> app:\s+(\d+) ms ch(\d+):\s+(-?\d+)')
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    seconds = int(sys.argv[2]) if len(sys.argv) > 2 else 205
+
+    env = dict(os.environ, HOST_SIM_SECONDS=str(seconds), HOST_SIM_LOG='1')
+    for ch in range(len(TICK_DIVIDER)):
+        env['HOST_SIM_AIN%d' % ch] = '%d,0,0,0' % (INPUT_MV_STEP * (ch + 1))
+    result = subprocess.run([sys.argv[1]], env=env, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+    output = result.stdout.decode('ascii', 'replace')
+    if result.returncode != 0:
+        sys.exit('%s\nexit code %d' % (output, result.returncode))
+    if 'Stream full' in output:
+        sys.exit('%s\nthe sample stream overflowed' % output)
+
+    ticks = [[] for _ in TICK_DIVIDER]
+    errors = []
+    for match in SAMPLE_LINE.finditer(output):
+        time_ms, ch, value = (int(g) for g in match.groups())
+        expected = INPUT_MV_STEP * (ch + 1) * (1 << RESOLUTION_BITS) // VDD_MV
+        if abs(value - expected) > VALUE_TOLERANCE:
+            errors.append('%u ms ch%u: %d, expected %d' % (time_ms, ch, value, expected))
+        ticks[ch].append(time_ms // SAMPLING_RATE_MS)
+
+    # The last tick may be cut off by the end of the run
+    last_tick = max((t[-1] for t in ticks if t), default=0)
+    if last_tick < seconds - 1:
+        errors.append('samples up to tick %u of %u' % (last_tick, seconds))
+    for ch, divider in enumerate(TICK_DIVIDER):
+        expected = [tick for tick in range(1, last_tick + 1) if tick % divider == 0]
+        if ticks[ch] != expected:
+            missing = sorted(set(expected) - set(ticks[ch]))
+            extra = sorted(set(ticks[ch]) - set(expected))
+            errors.append('ch%u: %u samples, expected %u, missing ticks %s, unexpected ticks %s'
+                          % (ch, len(ticks[ch]), len(expected), missing[:5], extra[:5]))
+        print('ch%u: every %u ticks, %u samples in %u ticks' % (ch, divider, len(ticks[ch]), last_tick))
+
+    if errors:
+        sys.exit('\n'.join(errors))
+
+
+if __name__ == '__main__':
+    main()
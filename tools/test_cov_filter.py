@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Change-of-value filter test of ble_app_uart__saadc_timer_driven__scan_mode, run by ctest in the host build.
+
+Plays the traces in host/traces back on the four channels, in a host build that sends every scan as text and in one
+with SAADC_COV_FILTER_ENABLED. Checks that the filtered notifications are exactly the ones the filter should send for
+the values sampled in that run, and prints the reports and the 1M PHY airtime of both runs. The runs sample the
+traces at slightly different times, so a scan at a trace step can differ between them.
+
+    python3 tools/test_cov_filter.py <unfiltered executable> <filtered executable> [virtual seconds]
+"""
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+TRACES_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'host', 'traces')
+TRACES = ['temperature.txt', 'battery.txt', 'switch.txt', 'light.txt']
+FIRST_INPUT = 4  # The channel table samples AIN4 to AIN7
+
+# Filter settings and airtime estimate, as in main.c
+COV_DEADBAND = 8
+COV_DEADBAND_PERMILLE = 0
+COV_KEEPALIVE_SCANS = 10000 // 250
+COV_MIN_INTERVAL_SCANS = 0
+AIRTIME_OVERHEAD_BYTES = 17
+AIRTIME_US_PER_BYTE = 8
+
+
+def run(executable, seconds, tmp, name):
+    """Runs one build on the traces. Returns the sampled scans and the notifications."""
+    saadc_path = os.path.join(tmp, name + '_saadc.txt')
+    nus_path = os.path.join(tmp, name + '_nus.txt')
+    env = dict(os.environ, HOST_SIM_SECONDS=seconds, HOST_SIM_LOG='0', HOST_SIM_TRACE_RATE='1',
+               HOST_SIM_SAADC_DUMP=saadc_path, HOST_SIM_NUS_DUMP=nus_path)
+    for index, trace in enumerate(TRACES):
+        env['HOST_SIM_AIN%d_TRACE' % (FIRST_INPUT + index)] = os.path.join(TRACES_DIR, trace)
+    subprocess.run([executable], env=env, check=True, stdout=subprocess.DEVNULL)
+
+    with open(saadc_path) as f:
+        scans = [[int(v) for v in line.split()] for line in f if line.strip()]
+    with open(nus_path) as f:
+        notifications = [bytes.fromhex(line.strip()).decode('ascii') for line in f if line.strip()]
+    return scans, notifications
+
+
+def cov_filter(scans):
+    """Returns the text notification the filter sends for each scan, None for scans without reports."""
+    last = [0] * len(scans[0])
+    silent = [COV_KEEPALIVE_SCANS] * len(scans[0])
+    notifications = []
+    for scan in scans:
+        reported = []
+        for ch, value in enumerate(scan):
+            deadband = max(abs(last[ch]) * COV_DEADBAND_PERMILLE // 1000, COV_DEADBAND)
+            silent[ch] += 1
+            if silent[ch] >= COV_KEEPALIVE_SCANS or \
+                    (abs(value - last[ch]) > deadband and silent[ch] >= COV_MIN_INTERVAL_SCANS):
+                last[ch] = value
+                silent[ch] = 0
+                reported.append('CH%d: %d' % (ch, value))
+        notifications.append('\r\n'.join(reported) if reported else None)
+    return notifications
+
+
+def airtime_us(notifications):
+    return sum((AIRTIME_OVERHEAD_BYTES + len(n)) * AIRTIME_US_PER_BYTE for n in notifications)
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    seconds = sys.argv[3] if len(sys.argv) > 3 else '3600'
+
+    with tempfile.TemporaryDirectory() as tmp:
+        _, unfiltered = run(sys.argv[1], seconds, tmp, 'unfiltered')
+        scans, filtered = run(sys.argv[2], seconds, tmp, 'filtered')
+
+    if not unfiltered or not filtered:
+        sys.exit('no notifications were sent')
+
+    # Notifications are only sent while connected, so the filtered ones must be a contiguous run of the expected ones
+    expected = [n for n in cov_filter(scans) if n is not None]
+    if filtered[0] not in expected:
+        sys.exit('first notification %r was not expected' % filtered[0])
+    start = expected.index(filtered[0])
+    if expected[start:start + len(filtered)] != filtered:
+        mismatch = next(i for i, (a, b) in enumerate(zip(expected[start:], filtered)) if a != b)
+        sys.exit('notification %d is %r, expected %r' % (mismatch, filtered[mismatch], expected[start + mismatch]))
+
+    if airtime_us(filtered) >= airtime_us(unfiltered):
+        sys.exit('the filter did not reduce the airtime')
+
+    values = sum(len(re.findall('CH', n)) for n in unfiltered)
+    reports = sum(len(re.findall('CH', n)) for n in filtered)
+    print('Unfiltered: %d values in %d notifications, airtime %d us' %
+          (values, len(unfiltered), airtime_us(unfiltered)))
+    print('Filtered: %d values (%.1f %%) in %d notifications (%.1f %%), airtime %d us (%.1f %%)' %
+          (reports, 100.0 * reports / values, len(filtered), 100.0 * len(filtered) / len(unfiltered),
+           airtime_us(filtered), 100.0 * airtime_us(filtered) / airtime_us(unfiltered)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""Round-trip test of nus_decode.py against the C encoder, run by ctest in the host build.
+
+Runs a host build of the BLE example with the SAADC results and the NUS notifications written to files, decodes
+the notifications and checks that every frame holds consecutive scans exactly as the SAADC sampled them.
+
+    python3 tools/test_nus_decode.py <host executable> [virtual seconds]
+"""
+import os
+import subprocess
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import nus_decode  # noqa: E402
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    executable = sys.argv[1]
+    seconds = sys.argv[2] if len(sys.argv) > 2 else '5'
+
+    with tempfile.TemporaryDirectory() as tmp:
+        saadc_path = os.path.join(tmp, 'saadc.txt')
+        nus_path = os.path.join(tmp, 'nus.txt')
+        env = dict(os.environ, HOST_SIM_SECONDS=seconds, HOST_SIM_LOG='0',
+                   HOST_SIM_SAADC_DUMP=saadc_path, HOST_SIM_NUS_DUMP=nus_path)
+        subprocess.run([executable], env=env, check=True, stdout=subprocess.DEVNULL)
+
+        with open(saadc_path) as f:
+            sampled = [tuple(int(v) for v in line.split()) for line in f if line.strip()]
+        with open(nus_path) as f:
+            frames = [nus_decode.parse_hex(line) for line in f if line.strip()]
+
+    # Scans are looked up by value, the input noise makes them unique enough
+    positions = {}
+    for index, scan in enumerate(sampled):
+        positions.setdefault(scan, []).append(index)
+
+    formats = set()
+    scans_total = 0
+    payload_bytes = 0
+    last_index = -1
+    for number, frame in enumerate(frames):
+        seq, mask, scans = nus_decode.decode_frame(frame)
+        formats.add(frame[3])
+        if not scans:
+            sys.exit('frame %d (seq %d) has no scans' % (number, seq))
+        if len(scans[0]) != len(sampled[0]):
+            sys.exit('frame %d (seq %d): %d channels, the SAADC sampled %d' %
+                     (number, seq, len(scans[0]), len(sampled[0])))
+
+        match = None
+        for index in positions.get(tuple(scans[0]), []):
+            if index > last_index and [list(s) for s in sampled[index:index + len(scans)]] == scans:
+                match = index
+                break
+        if match is None:
+            sys.exit('frame %d (seq %d): decoded scans do not match the sampled values' % (number, seq))
+
+        last_index = match + len(scans) - 1
+        scans_total += len(scans)
+        payload_bytes += len(frame) - nus_decode.HEADER_LEN
+
+    if not frames:
+        sys.exit('no notifications were sent')
+
+    samples = scans_total * len(sampled[0])
+    print('%d frames in format %s, %d scans, %.2f bits/sample' %
+          (len(frames), ','.join(str(f) for f in sorted(formats)), scans_total, payload_bytes * 8.0 / samples))
+
+
+if __name__ == '__main__':
+    main()